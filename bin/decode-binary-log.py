@@ -0,0 +1,178 @@
+#!/usr/bin/env python3
+"""Decode a binary log saved by firmware built with LOG_BINARY_TRACE=1.
+
+Usage:
+    python bin/decode-binary-log.py binlog.bin
+    python bin/decode-binary-log.py --last 30 binlog.bin
+
+The device keeps every log call, whatever its level, as a format string id plus
+its raw arguments, and saves them to /prefs/binlog.bin after a critical error.
+The file carries the format strings it needs, so no firmware image is required.
+Lines are printed like the serial console prints them.
+"""
+from __future__ import annotations
+
+import argparse
+import datetime
+import re
+import struct
+import sys
+from typing import Dict, Iterator, List, Tuple
+
+LEVELS = ["TRACE", "DEBUG", "INFO ", "WARN ", "ERROR", "CRIT ", "HEAP "]
+LEVEL_TRUNCATED = 0x80
+NO_FORMAT = 0xFFFF
+RECORD_HEADER = struct.Struct("<HIHBB")
+
+# Same grammar the firmware uses to find the arguments of a format string
+CONVERSION_RE = re.compile(r"%([-+ #0-9.*]*)(hh|h|ll|l|j|z|t|L|q)?([diouxXceEfFgGaApsn%])")
+
+
+class Header:
+    def __init__(self, data: bytes):
+        magic, version, self.long_size, self.size_t_size, self.pointer_size = struct.unpack_from("<4sBBBB", data, 0)
+        if magic != b"MTBL":
+            raise ValueError("not a binary log")
+        if version != 1:
+            raise ValueError(f"unsupported binary log version {version}")
+        self.millis_now, self.rtc_now, self.dropped = struct.unpack_from("<III", data, 8)
+
+
+def parse(data: bytes) -> Tuple[Header, Dict[int, str], bytes]:
+    header = Header(data)
+    pos = 20
+    (count,) = struct.unpack_from("<H", data, pos)
+    pos += 2
+    formats = {}
+    for _ in range(count):
+        format_id, length = struct.unpack_from("<HH", data, pos)
+        pos += 4
+        formats[format_id] = data[pos : pos + length].decode("utf-8", "replace")
+        pos += length
+    (size,) = struct.unpack_from("<I", data, pos)
+    pos += 4
+    return header, formats, data[pos : pos + size]
+
+
+def integer_size(header: Header, length: str) -> int:
+    if length == "l":
+        return header.long_size
+    if length in ("ll", "q", "j"):
+        return 8
+    if length in ("z", "t"):
+        return header.size_t_size
+    return 4
+
+
+def take(args: bytes, pos: int, size: int) -> Tuple[bytes, int]:
+    if pos + size > len(args):
+        raise IndexError
+    return args[pos : pos + size], pos + size
+
+
+def render(header: Header, fmt: str, args: bytes) -> str:
+    """printf fmt with the raw arguments, conversions past the end of a truncated record print as '?'"""
+    out: List[str] = []
+    pos = 0
+    last = 0
+    for m in CONVERSION_RE.finditer(fmt):
+        out.append(fmt[last : m.start()])
+        last = m.end()
+        flags, length, conv = m.group(1), m.group(2) or "", m.group(3)
+        if conv == "%":
+            out.append("%")
+            continue
+        try:
+            stars = []
+            for _ in range(flags.count("*")):
+                raw, pos = take(args, pos, 4)
+                stars.append(struct.unpack("<i", raw)[0])
+            if conv in "diouxX":
+                size = integer_size(header, length)
+                raw, pos = take(args, pos, size)
+                value = int.from_bytes(raw, "little", signed=conv in "di")
+                if conv in "ouxX" and length in ("h", "hh"):
+                    value &= 0xFFFF if length == "h" else 0xFF
+                spec = "%" + flags + ("d" if conv in "iu" else conv)
+            elif conv == "c":
+                raw, pos = take(args, pos, 4)
+                value = chr(struct.unpack("<i", raw)[0] & 0xFF)
+                spec = "%" + flags + "c"
+            elif conv in "eEfFgGaA":
+                raw, pos = take(args, pos, 8)
+                value = struct.unpack("<d", raw)[0]
+                spec = "%" + flags + ("f" if conv in "aA" else conv)
+            elif conv == "p":
+                raw, pos = take(args, pos, header.pointer_size)
+                value = int.from_bytes(raw, "little")
+                spec = "0x%" + flags + "x"
+            elif conv == "s":
+                raw, pos = take(args, pos, 1)
+                text, pos = take(args, pos, raw[0])
+                value = text.decode("utf-8", "replace")
+                spec = "%" + flags + "s"
+            else:  # %n
+                continue
+            spec = spec.replace("*", "{}").format(*stars) if stars else spec
+            out.append(spec % value)
+        except IndexError:
+            out.append("?")
+    out.append(fmt[last:])
+    return "".join(out).rstrip("\n")
+
+
+def records(header: Header, formats: Dict[int, str], data: bytes) -> Iterator[Tuple[int, str, str, str]]:
+    """Yield (millis, level, thread, message) oldest first"""
+    pos = 0
+    while pos + RECORD_HEADER.size <= len(data):
+        length, millis, format_id, level, thread_length = RECORD_HEADER.unpack_from(data, pos)
+        if length < RECORD_HEADER.size:
+            break
+        body = data[pos + RECORD_HEADER.size : pos + length]
+        pos += length
+        thread = body[:thread_length].decode("utf-8", "replace")
+        args = body[thread_length:]
+        if format_id == NO_FORMAT or format_id not in formats:
+            message = "<format string not kept>"
+        else:
+            message = render(header, formats[format_id], args)
+        if level & LEVEL_TRUNCATED:
+            message += " <truncated>"
+        level &= ~LEVEL_TRUNCATED
+        yield millis, LEVELS[level] if level < len(LEVELS) else "?????", thread, message
+
+
+def format_time(header: Header, millis: int) -> str:
+    if not header.rtc_now:
+        return "??:??:??"
+    ago = ((header.millis_now - millis) & 0xFFFFFFFF) / 1000
+    when = datetime.datetime.fromtimestamp(header.rtc_now - ago, datetime.timezone.utc)
+    return when.strftime("%H:%M:%S")
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("file", help="binary log saved by the device")
+    parser.add_argument("--last", type=float, help="only the last SECONDS before the log was saved")
+    args = parser.parse_args()
+
+    with open(args.file, "rb") as f:
+        data = f.read()
+    try:
+        header, formats, body = parse(data)
+    except (ValueError, struct.error) as e:
+        print(f"{args.file}: {e}", file=sys.stderr)
+        return 1
+
+    if header.dropped:
+        print(f"({header.dropped} older records were overwritten)")
+    for millis, level, thread, message in records(header, formats, body):
+        if args.last is not None and ((header.millis_now - millis) & 0xFFFFFFFF) / 1000 > args.last:
+            continue
+        thread_part = f"[{thread}] " if thread else ""
+        print(f"{level} | {format_time(header, millis)} {millis // 1000} {thread_part}{message}")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
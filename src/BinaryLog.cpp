@@ -0,0 +1,323 @@
+#include "BinaryLog.h"
+#include <string.h>
+
+// Longest thread name kept
+static constexpr size_t MAX_THREAD_LENGTH = 15;
+// Record header: length, millis, format id, level, thread name length
+static constexpr size_t HEADER_SIZE = 2 + 4 + 2 + 1 + 1;
+// length of a free slot in the format table
+static constexpr uint16_t EMPTY = 0xffff;
+
+BinaryLog::BinaryLog(size_t capacity, size_t maxFormats, size_t formatBytes)
+    : capacity(capacity), formatBytes(formatBytes < EMPTY ? formatBytes : EMPTY - 1)
+{
+    // A power of two, so a probe sequence can use a mask. One slot always stays free to end the probing.
+    size_t size = 16;
+    while (size < maxFormats + 1 && size < 0x8000) // ids are 16 bits, NO_FORMAT included
+        size <<= 1;
+    this->maxFormats = size;
+
+    buf = new uint8_t[capacity];
+    formats = new Format[size];
+    for (size_t i = 0; i < size; i++)
+        formats[i].length = EMPTY;
+    formatText = new char[this->formatBytes];
+}
+
+BinaryLog::~BinaryLog()
+{
+    delete[] buf;
+    delete[] formats;
+    delete[] formatText;
+}
+
+uint16_t BinaryLog::intern(const char *format)
+{
+    // Almost every format is a literal logged again and again, so first try the id it had last time. The text is still
+    // compared, as some callers pass formats that live on the stack.
+    Recent &recent = recentFormats[((uintptr_t)format >> 2) % NUM_RECENT];
+    if (recent.format == format) {
+        const Format &f = formats[recent.id];
+        if (memcmp(formatText + f.offset, format, f.length) == 0 && format[f.length] == '\0')
+            return recent.id;
+    }
+
+    uint16_t id = internText(format);
+    if (id != NO_FORMAT) {
+        recent.format = format;
+        recent.id = id;
+    }
+    return id;
+}
+
+uint16_t BinaryLog::internText(const char *format)
+{
+    // FNV-1a over the text rather than the pointer
+    uint32_t hash = 2166136261u;
+    size_t length = 0;
+    for (const char *p = format; *p; p++, length++)
+        hash = (hash ^ (uint8_t)*p) * 16777619u;
+
+    size_t mask = maxFormats - 1;
+    for (size_t i = hash & mask;; i = (i + 1) & mask) {
+        Format &f = formats[i];
+        if (f.length == EMPTY) {
+            if (numFormats + 1 >= maxFormats || formatTextUsed + length > formatBytes)
+                return NO_FORMAT;
+            f.hash = hash;
+            f.offset = formatTextUsed;
+            f.length = length;
+            memcpy(formatText + formatTextUsed, format, length);
+            formatTextUsed += length;
+            numFormats++;
+            return i;
+        }
+        if (f.hash == hash && f.length == length && memcmp(formatText + f.offset, format, length) == 0)
+            return i;
+    }
+}
+
+size_t BinaryLog::encodeArgs(size_t pos, const char *format, va_list arg, bool &truncated)
+{
+// Copy one argument of the given type, as the bytes it has in memory
+#define PUT_ARG(type)                                                                                                            \
+    do {                                                                                                                         \
+        type value = va_arg(arg, type);                                                                                          \
+        if (pos + sizeof(value) > MAX_RECORD) {                                                                                  \
+            truncated = true;                                                                                                    \
+            return pos;                                                                                                          \
+        }                                                                                                                        \
+        memcpy(scratch + pos, &value, sizeof(value));                                                                            \
+        pos += sizeof(value);                                                                                                    \
+    } while (0)
+
+    for (const char *p = format; *p; p++) {
+        if (*p != '%')
+            continue;
+        p++;
+        if (*p == '%')
+            continue;
+
+        // Flags, width and precision, a * takes an int argument. The precision caps how much of a string is read.
+        int precision = -1;
+        while ((*p >= '0' && *p <= '9') || *p == '.' || *p == '-' || *p == '+' || *p == ' ' || *p == '#' || *p == '*') {
+            if (*p == '.') {
+                precision = 0;
+            } else if (*p == '*') {
+                int value = va_arg(arg, int);
+                if (pos + sizeof(value) > MAX_RECORD) {
+                    truncated = true;
+                    return pos;
+                }
+                memcpy(scratch + pos, &value, sizeof(value));
+                pos += sizeof(value);
+                if (precision == 0)
+                    precision = value < 0 ? -1 : value; // A negative precision is taken as none
+            } else if (precision >= 0 && *p >= '0' && *p <= '9') {
+                precision = precision * 10 + (*p - '0');
+            }
+            p++;
+        }
+
+        // Length modifier
+        char length = 0;
+        if (*p == 'h' || *p == 'l') {
+            length = *p++;
+            if (*p == length) {
+                length = length == 'l' ? 'q' : 'H'; // ll and hh
+                p++;
+            }
+        } else if (*p == 'j' || *p == 'z' || *p == 't' || *p == 'L' || *p == 'q') {
+            length = *p++;
+        }
+
+        switch (*p) {
+        case 'd':
+        case 'i':
+        case 'u':
+        case 'o':
+        case 'x':
+        case 'X':
+            // Whatever the signedness, the decoder knows from the conversion
+            if (length == 'l')
+                PUT_ARG(long);
+            else if (length == 'q' || length == 'j')
+                PUT_ARG(long long);
+            else if (length == 'z' || length == 't')
+                PUT_ARG(size_t);
+            else
+                PUT_ARG(int);
+            break;
+        case 'c':
+            PUT_ARG(int);
+            break;
+        case 'e':
+        case 'E':
+        case 'f':
+        case 'F':
+        case 'g':
+        case 'G':
+        case 'a':
+        case 'A':
+            if (length == 'L') {
+                double value = (double)va_arg(arg, long double);
+                if (pos + sizeof(value) > MAX_RECORD) {
+                    truncated = true;
+                    return pos;
+                }
+                memcpy(scratch + pos, &value, sizeof(value));
+                pos += sizeof(value);
+            } else {
+                PUT_ARG(double);
+            }
+            break;
+        case 'p':
+            PUT_ARG(void *);
+            break;
+        case 's': {
+            const char *s = va_arg(arg, const char *);
+            if (!s)
+                s = "(null)";
+            // Callers pass buffers which are not NUL terminated along with their length as precision
+            size_t len = strnlen(s, precision >= 0 && (size_t)precision < MAX_STRING ? precision : MAX_STRING);
+            if (pos + 1 + len > MAX_RECORD) {
+                truncated = true;
+                return pos;
+            }
+            scratch[pos++] = len;
+            memcpy(scratch + pos, s, len);
+            pos += len;
+            break;
+        }
+        case 'n':
+            (void)va_arg(arg, void *);
+            break;
+        case '\0':
+            return pos;
+        default:
+            // Not a conversion printf knows, so it takes no argument either
+            break;
+        }
+    }
+    return pos;
+#undef PUT_ARG
+}
+
+void BinaryLog::copyIn(size_t at, const uint8_t *src, size_t size)
+{
+    size_t first = capacity - at < size ? capacity - at : size;
+    memcpy(buf + at, src, first);
+    memcpy(buf, src + first, size - first);
+}
+
+void BinaryLog::copyOut(size_t at, uint8_t *dest, size_t size) const
+{
+    size_t first = capacity - at < size ? capacity - at : size;
+    memcpy(dest, buf + at, first);
+    memcpy(dest + first, buf, size - first);
+}
+
+void BinaryLog::evict()
+{
+    uint16_t length;
+    copyOut((head + capacity - used) % capacity, (uint8_t *)&length, sizeof(length));
+    used -= length;
+    records--;
+    dropped++;
+}
+
+void BinaryLog::record(const char *level, const char *thread, uint32_t millis, const char *format, va_list arg)
+{
+    if (paused) {
+        dropped++;
+        return;
+    }
+
+    uint16_t formatId = intern(format);
+    uint8_t levelCode;
+    switch (level[0]) {
+    case 'T':
+        levelCode = 0;
+        break;
+    case 'D':
+        levelCode = 1;
+        break;
+    case 'I':
+        levelCode = 2;
+        break;
+    case 'W':
+        levelCode = 3;
+        break;
+    case 'E':
+        levelCode = 4;
+        break;
+    case 'C':
+        levelCode = 5;
+        break;
+    default:
+        levelCode = 6; // HEAP
+    }
+    size_t threadLength = thread ? strnlen(thread, MAX_THREAD_LENGTH) : 0;
+
+    size_t pos = HEADER_SIZE;
+    if (threadLength)
+        memcpy(scratch + pos, thread, threadLength);
+    pos += threadLength;
+    if (formatId != NO_FORMAT) {
+        // Keep the arguments which fitted, the decoder stops at the end of the record
+        bool truncated = false;
+        pos = encodeArgs(pos, format, arg, truncated);
+        if (truncated)
+            levelCode |= LEVEL_TRUNCATED;
+    } else {
+        unknownFormats++;
+    }
+
+    uint16_t length = pos;
+    memcpy(scratch, &length, sizeof(length));
+    memcpy(scratch + 2, &millis, sizeof(millis));
+    memcpy(scratch + 6, &formatId, sizeof(formatId));
+    scratch[8] = levelCode;
+    scratch[9] = threadLength;
+
+    if (length > capacity)
+        return;
+    while (capacity - used < length)
+        evict();
+    copyIn(head, scratch, length);
+    head = (head + length) % capacity;
+    used += length;
+    records++;
+}
+
+size_t BinaryLog::dump(Print &out, uint32_t millisNow, uint32_t rtcNow) const
+{
+    size_t written = 0;
+    auto put = [&](const void *data, size_t size) { written += out.write((const uint8_t *)data, size); };
+
+    const uint8_t header[8] = {'M', 'T', 'B', 'L', VERSION, sizeof(long), sizeof(size_t), sizeof(void *)};
+    put(header, sizeof(header));
+    put(&millisNow, sizeof(millisNow));
+    put(&rtcNow, sizeof(rtcNow));
+    put(&dropped, sizeof(dropped));
+
+    uint16_t count = numFormats;
+    put(&count, sizeof(count));
+    for (size_t i = 0; i < maxFormats; i++) {
+        const Format &f = formats[i];
+        if (f.length == EMPTY)
+            continue;
+        uint16_t id = i;
+        put(&id, sizeof(id));
+        put(&f.length, sizeof(f.length));
+        put(formatText + f.offset, f.length);
+    }
+
+    uint32_t size = used;
+    put(&size, sizeof(size));
+    size_t tail = (head + capacity - used) % capacity;
+    size_t first = capacity - tail < used ? capacity - tail : used;
+    put(buf + tail, first);
+    put(buf, used - first);
+    return written;
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <Print.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Compact trace of log calls, kept without formatting them.
+ *
+ * Each call is stored as the id of its format string, its level, thread name, millis and the raw arguments, which costs
+ * a scan of the format string and a few copies instead of a printf. Format strings are interned by content the first time
+ * they are seen, so the trace can stay on at every level, including the ones which are not printed. When the ring is full
+ * the oldest records are overwritten.
+ *
+ * dump() writes the records together with the format strings they use, bin/decode-binary-log.py turns that back into text.
+ * Not thread safe: RedirectablePrint holds its log lock around every call.
+ */
+class BinaryLog
+{
+  public:
+    static constexpr uint8_t VERSION = 1;
+    /// Format id of records whose format string did not fit in the table, they have no arguments
+    static constexpr uint16_t NO_FORMAT = 0xffff;
+    /// Set in the level byte of a record whose arguments did not all fit
+    static constexpr uint8_t LEVEL_TRUNCATED = 0x80;
+    /// Longest string argument kept
+    static constexpr size_t MAX_STRING = 48;
+    /// Longest record, arguments past it are dropped
+    static constexpr size_t MAX_RECORD = 200;
+
+    /**
+     * @param capacity bytes of records
+     * @param maxFormats distinct format strings, rounded up to a power of two
+     * @param formatBytes bytes for the text of the format strings
+     */
+    BinaryLog(size_t capacity, size_t maxFormats, size_t formatBytes);
+    ~BinaryLog();
+
+    BinaryLog(const BinaryLog &) = delete;
+    BinaryLog &operator=(const BinaryLog &) = delete;
+
+    /// Record a log call, level is one of the MESHTASTIC_LOG_LEVEL_* strings
+    void record(const char *level, const char *thread, uint32_t millis, const char *format, va_list arg);
+
+    /// While paused, for example during dump(), calls are only counted as dropped
+    void setPaused(bool paused) { this->paused = paused; }
+
+    /**
+     * Write the format strings and records, oldest first. millisNow and rtcNow let the decoder turn record times into
+     * wall clock time, rtcNow is 0 if the time is not known.
+     * @return bytes written
+     */
+    size_t dump(Print &out, uint32_t millisNow, uint32_t rtcNow) const;
+
+    size_t getRecordCount() const { return records; }
+
+    /// @return records overwritten, or skipped while paused
+    uint32_t getDropped() const { return dropped; }
+
+    /// @return records whose format string was not kept
+    uint32_t getUnknownFormats() const { return unknownFormats; }
+
+  private:
+    struct Format {
+        uint32_t hash;
+        uint16_t offset; // in formatText
+        uint16_t length;
+    };
+
+    uint8_t *buf;
+    size_t capacity;
+    size_t head = 0; // next byte to write
+    size_t used = 0;
+    size_t records = 0;
+
+    Format *formats;
+    size_t maxFormats;
+    size_t numFormats = 0;
+    char *formatText;
+    size_t formatBytes;
+    size_t formatTextUsed = 0;
+
+    // Format strings by address, the last one seen in each slot
+    struct Recent {
+        const char *format;
+        uint16_t id;
+    };
+    static constexpr size_t NUM_RECENT = 16;
+    Recent recentFormats[NUM_RECENT] = {};
+
+    uint32_t dropped = 0;
+    uint32_t unknownFormats = 0;
+    bool paused = false;
+
+    uint8_t scratch[MAX_RECORD];
+
+    /// @return the id of format, adding it if it is new, or NO_FORMAT if there is no room
+    uint16_t intern(const char *format);
+    uint16_t internText(const char *format);
+
+    /// Encode the arguments format uses after pos in scratch, @return the end. truncated is set if they did not all fit.
+    size_t encodeArgs(size_t pos, const char *format, va_list arg, bool &truncated);
+
+    void copyIn(size_t at, const uint8_t *src, size_t size);
+    void copyOut(size_t at, uint8_t *dest, size_t size) const;
+
+    /// Drop the oldest record
+    void evict();
+};
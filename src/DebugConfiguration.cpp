@@ -143,6 +143,11 @@ bool Syslog::vlogf(uint16_t pri, const char *appName, const char *fmt, va_list a
     return result;
 }
 
+bool Syslog::log(uint16_t pri, const char *appName, const char *message)
+{
+    return this->_sendLog(pri, appName ? appName : this->_appName, message);
+}
+
 inline bool Syslog::_sendLog(uint16_t pri, const char *appName, const char *message)
 {
     int result;
@@ -0,0 +1,139 @@
+#include "LogRing.h"
+#include <string.h>
+
+// Longest level and thread names kept, the thread name matches LogRecord.source
+static constexpr size_t MAX_LEVEL_LENGTH = 15;
+static constexpr size_t MAX_THREAD_LENGTH = 31;
+// messageLength of the marker written where a record did not fit before the end of the buffer
+static constexpr uint16_t PADDING = 0xffff;
+
+struct RecordHeader {
+    uint16_t messageLength;
+    uint8_t levelLength;
+    uint8_t threadLength;
+    uint32_t millis;
+    uint32_t rtcSec;
+};
+static_assert(sizeof(RecordHeader) == LogRing::HEADER_SIZE, "RecordHeader layout");
+
+LogRing::LogRing(size_t capacity)
+{
+    // A power of two, so positions keep mapping to the same offsets when they wrap around 2^32
+    size_t size = 64;
+    while (size < capacity)
+        size <<= 1;
+    this->capacity = size;
+    buf = new uint8_t[size];
+}
+
+LogRing::~LogRing()
+{
+    delete[] buf;
+}
+
+uint32_t LogRing::recordStart(uint32_t pos) const
+{
+    size_t offset = pos % capacity;
+    size_t remaining = capacity - offset;
+    if (remaining < HEADER_SIZE)
+        return pos + remaining;
+
+    uint16_t messageLength;
+    memcpy(&messageLength, buf + offset, sizeof(messageLength));
+    return messageLength == PADDING ? pos + remaining : pos;
+}
+
+size_t LogRing::sizeAt(uint32_t pos) const
+{
+    RecordHeader header;
+    memcpy(&header, buf + pos % capacity, sizeof(header));
+    return recordSize(header.levelLength, header.threadLength, header.messageLength);
+}
+
+void LogRing::evict()
+{
+    tail = recordStart(tail);
+    uint32_t next = tail + sizeAt(tail);
+    for (uint8_t sink = 0; sink < NUM_SINKS; sink++) {
+        // Cursors never fall behind tail, so one that is before next has not read the record yet
+        if (cursors[sink] != head && (int32_t)(next - cursors[sink]) > 0) {
+            cursors[sink] = next;
+            dropped[sink]++;
+        }
+    }
+    tail = next;
+}
+
+void LogRing::append(const char *level, const char *thread, const char *message, size_t messageLength, uint32_t millis,
+                     uint32_t rtcSec)
+{
+    if (!level)
+        level = "";
+    if (!thread)
+        thread = "";
+    size_t levelLength = strnlen(level, MAX_LEVEL_LENGTH);
+    size_t threadLength = strnlen(thread, MAX_THREAD_LENGTH);
+    size_t fixed = recordSize(levelLength, threadLength, 0);
+    if (fixed >= capacity / 2)
+        return;
+    if (messageLength > capacity / 2 - fixed)
+        messageLength = capacity / 2 - fixed;
+    if (messageLength >= PADDING)
+        messageLength = PADDING - 1;
+    size_t size = fixed + messageLength;
+
+    // Start over at the beginning if the record would run past the end of the buffer
+    size_t offset = head % capacity;
+    size_t skipped = capacity - offset < size ? capacity - offset : 0;
+    while (capacity - (head - tail) < skipped + size)
+        evict();
+    if (skipped) {
+        if (skipped >= HEADER_SIZE)
+            memcpy(buf + offset, &PADDING, sizeof(PADDING));
+        head += skipped;
+        offset = 0;
+    }
+
+    RecordHeader header = {(uint16_t)messageLength, (uint8_t)levelLength, (uint8_t)threadLength, millis, rtcSec};
+    uint8_t *p = buf + offset;
+    memcpy(p, &header, sizeof(header));
+    p += sizeof(header);
+    memcpy(p, level, levelLength);
+    p[levelLength] = '\0';
+    p += levelLength + 1;
+    memcpy(p, thread, threadLength);
+    p[threadLength] = '\0';
+    p += threadLength + 1;
+    memcpy(p, message, messageLength);
+    p[messageLength] = '\0';
+    head += size;
+}
+
+bool LogRing::peek(Sink sink, Record &record) const
+{
+    if (cursors[sink] == head)
+        return false;
+    uint32_t pos = recordStart(cursors[sink]);
+
+    RecordHeader header;
+    const uint8_t *p = buf + pos % capacity;
+    memcpy(&header, p, sizeof(header));
+    p += sizeof(header);
+    record.level = (const char *)p;
+    p += header.levelLength + 1;
+    record.thread = (const char *)p;
+    p += header.threadLength + 1;
+    record.message = (const char *)p;
+    record.messageLength = header.messageLength;
+    record.millis = header.millis;
+    record.rtcSec = header.rtcSec;
+    return true;
+}
+
+void LogRing::pop(Sink sink)
+{
+    if (cursors[sink] == head)
+        return;
+    uint32_t pos = recordStart(cursors[sink]);
+    cursors[sink] = pos + sizeAt(pos);
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Formatted log lines waiting to go out to each log sink (serial, syslog, BLE).
+ *
+ * A line is formatted once and appended here together with its level, thread name and timestamps. Every sink has its own
+ * read cursor, so a slow sink never holds up the others and each line is only stored once. When the ring is full the
+ * oldest lines are overwritten, and any sink which had not read them yet counts them as dropped.
+ *
+ * Records never wrap around the end of the buffer, so a sink always gets a line as one contiguous, NUL terminated string.
+ * The buffer is allocated once in the constructor. Not thread safe: RedirectablePrint holds its log lock around every call.
+ */
+class LogRing
+{
+  public:
+    enum Sink : uint8_t { SINK_SERIAL, SINK_SYSLOG, SINK_BLE, NUM_SINKS };
+
+    /// A line as returned by peek(), pointing into the ring. Valid until the next append() or pop().
+    struct Record {
+        const char *level;
+        const char *thread; // empty if not logged from an OSThread
+        const char *message;
+        uint16_t messageLength; // not counting the NUL
+        uint32_t millis;
+        uint32_t rtcSec; // 0 if the time was not known
+    };
+
+    /// Bytes a record needs besides its strings
+    static constexpr size_t HEADER_SIZE = 12;
+
+    /// capacity is rounded up to a power of two
+    explicit LogRing(size_t capacity);
+    ~LogRing();
+
+    LogRing(const LogRing &) = delete;
+    LogRing &operator=(const LogRing &) = delete;
+
+    /**
+     * Add a line for every sink, overwriting the oldest ones if needed. A record can take at most half the ring, so that
+     * it always fits even when it has to start over at the beginning: longer messages are truncated.
+     */
+    void append(const char *level, const char *thread, const char *message, size_t messageLength, uint32_t millis,
+                uint32_t rtcSec);
+
+    /// @return false if the sink has read everything
+    bool peek(Sink sink, Record &record) const;
+
+    /// Move a sink on to its next line
+    void pop(Sink sink);
+
+    /// Skip everything a sink has not read yet, for sinks which are switched off
+    void skip(Sink sink) { cursors[sink] = head; }
+
+    bool isEmpty(Sink sink) const { return cursors[sink] == head; }
+
+    /// Bytes of the ring holding lines the sink has not read yet
+    size_t getUnread(Sink sink) const { return head - cursors[sink]; }
+
+    /// @return lines overwritten before the sink read them
+    uint32_t getDropped(Sink sink) const { return dropped[sink]; }
+
+    size_t getCapacity() const { return capacity; }
+
+    /// Room a record with these string lengths (not counting NULs) takes
+    static size_t recordSize(size_t levelLength, size_t threadLength, size_t messageLength)
+    {
+        return HEADER_SIZE + levelLength + 1 + threadLength + 1 + messageLength + 1;
+    }
+
+  private:
+    uint8_t *buf;
+    size_t capacity;
+    // Positions only ever grow, the byte offset is position % capacity. tail is the oldest record still stored.
+    uint32_t head = 0;
+    uint32_t tail = 0;
+    uint32_t cursors[NUM_SINKS] = {};
+    uint32_t dropped[NUM_SINKS] = {};
+
+    /// Position of the record at pos, skipping the unused end of the buffer if the record starts over at the beginning
+    uint32_t recordStart(uint32_t pos) const;
+
+    /// Size of the record at pos, which must be a recordStart()
+    size_t sizeAt(uint32_t pos) const;
+
+    /// Drop the oldest record
+    void evict();
+};
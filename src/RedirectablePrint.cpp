@@ -48,6 +48,19 @@ size_t RedirectablePrint::write(uint8_t c)
               // serial port said (which could be zero)
 }
 
+size_t RedirectablePrint::write(const uint8_t *buffer, size_t size)
+{
+#ifdef USE_SEGGER
+    SEGGER_RTT_Write(SEGGER_STDOUT_CH, buffer, size);
+#endif
+    // Account for legacy config transition
+    bool serialEnabled = config.has_security ? config.security.serial_enabled : config.device.serial_enabled;
+    if (!config.has_lora || serialEnabled)
+        dest->write(buffer, size);
+
+    return size;
+}
+
 size_t RedirectablePrint::vprintf(const char *logLevel, const char *format, va_list arg)
 {
     va_list copy;
@@ -95,35 +108,40 @@ size_t RedirectablePrint::vprintf(const char *logLevel, const char *format, va_l
     return len;
 }
 
-void RedirectablePrint::log_to_serial(const char *logLevel, const char *format, va_list arg)
+/// Color of a log level on the console, or NULL if it has none
+static const char *levelColor(const char *logLevel)
 {
-    size_t r = 0;
+    if (strcmp(logLevel, MESHTASTIC_LOG_LEVEL_DEBUG) == 0)
+        return "\u001b[34m";
+    if (strcmp(logLevel, MESHTASTIC_LOG_LEVEL_INFO) == 0)
+        return "\u001b[32m";
+    if (strcmp(logLevel, MESHTASTIC_LOG_LEVEL_WARN) == 0)
+        return "\u001b[33m";
+    if (strcmp(logLevel, MESHTASTIC_LOG_LEVEL_ERROR) == 0)
+        return "\u001b[31m";
+    if (strcmp(logLevel, MESHTASTIC_LOG_LEVEL_TRACE) == 0)
+        return "\u001b[35m";
+    return NULL;
+}
+
+void RedirectablePrint::log_to_serial(const LogRing::Record &record)
+{
+    // Only the header is formatted here, the message is written straight from the ring. It can add at most the colors,
+    // time, thread name and heap.
+    static char header[96];
 
 #ifdef ARCH_PORTDUINO
     bool color = !portduino_config.ascii_logs;
 #else
     bool color = true;
 #endif
+    const char *levelCode = color ? levelColor(record.level) : NULL;
+    // The message itself was never colored for TRACE
+    const char *messageCode = levelCode && strcmp(record.level, MESHTASTIC_LOG_LEVEL_TRACE) != 0 ? levelCode : NULL;
 
-    // include the header
-    if (color) {
-        if (strcmp(logLevel, MESHTASTIC_LOG_LEVEL_DEBUG) == 0)
-            Print::write("\u001b[34m", 5);
-        if (strcmp(logLevel, MESHTASTIC_LOG_LEVEL_INFO) == 0)
-            Print::write("\u001b[32m", 5);
-        if (strcmp(logLevel, MESHTASTIC_LOG_LEVEL_WARN) == 0)
-            Print::write("\u001b[33m", 5);
-        if (strcmp(logLevel, MESHTASTIC_LOG_LEVEL_ERROR) == 0)
-            Print::write("\u001b[31m", 5);
-        if (strcmp(logLevel, MESHTASTIC_LOG_LEVEL_TRACE) == 0)
-            Print::write("\u001b[35m", 5);
-    }
-
-    uint32_t rtc_sec = getValidTime(RTCQuality::RTCQualityDevice, true); // display local time on logfile
-    if (rtc_sec > 0) {
-        long hms = rtc_sec % SEC_PER_DAY;
-        // hms += tz.tz_dsttime * SEC_PER_HOUR;
-        // hms -= tz.tz_minuteswest * SEC_PER_MIN;
+    int len = snprintf(header, sizeof(header), "%s%s %s| ", levelCode ? levelCode : "", record.level, color ? "\u001b[0m" : "");
+    if (record.rtcSec > 0) {
+        long hms = record.rtcSec % SEC_PER_DAY;
         // mod `hms` to ensure in positive range of [0...SEC_PER_DAY)
         hms = (hms + SEC_PER_DAY) % SEC_PER_DAY;
 
@@ -131,123 +149,88 @@ void RedirectablePrint::log_to_serial(const char *logLevel, const char *format,
         int hour = hms / SEC_PER_HOUR;
         int min = (hms % SEC_PER_HOUR) / SEC_PER_MIN;
         int sec = (hms % SEC_PER_HOUR) % SEC_PER_MIN; // or hms % SEC_PER_MIN
-
-#ifdef ARCH_PORTDUINO
-        ::printf("%s ", logLevel);
-        if (color) {
-            ::printf("\u001b[0m");
-        }
-        ::printf("| %02d:%02d:%02d %u ", hour, min, sec, millis() / 1000);
-#else
-        printf("%s ", logLevel);
-        if (color) {
-            printf("\u001b[0m");
-        }
-        printf("| %02d:%02d:%02d %u ", hour, min, sec, millis() / 1000);
-#endif
+        len += snprintf(header + len, sizeof(header) - len, "%02d:%02d:%02d %u ", hour, min, sec, record.millis / 1000);
     } else {
-#ifdef ARCH_PORTDUINO
-        ::printf("%s ", logLevel);
-        if (color) {
-            ::printf("\u001b[0m");
-        }
-        ::printf("| ??:??:?? %u ", millis() / 1000);
-#else
-        printf("%s ", logLevel);
-        if (color) {
-            printf("\u001b[0m");
-        }
-        printf("| ??:??:?? %u ", millis() / 1000);
-#endif
-    }
-    auto thread = concurrency::OSThread::currentThread;
-    if (thread) {
-        print("[");
-        // printf("%p ", thread);
-        // assert(thread->ThreadName.length());
-        print(thread->ThreadName);
-        print("] ");
+        len += snprintf(header + len, sizeof(header) - len, "??:??:?? %u ", record.millis / 1000);
     }
-
+    if (record.thread[0] && len < (int)sizeof(header))
+        len += snprintf(header + len, sizeof(header) - len, "[%s] ", record.thread);
 #ifdef DEBUG_HEAP
     // Add heap free space bytes prefix before every log message
-#ifdef ARCH_PORTDUINO
-    ::printf("[heap %u] ", memGet.getFreeHeap());
-#else
-    printf("[heap %u] ", memGet.getFreeHeap());
+    if (len < (int)sizeof(header))
+        len += snprintf(header + len, sizeof(header) - len, "[heap %u] ", memGet.getFreeHeap());
 #endif
-#endif // DEBUG_HEAP
-
-    r += vprintf(logLevel, format, arg);
+    if (len > (int)sizeof(header) - 1)
+        len = sizeof(header) - 1;
+
+    Print::write(header, len);
+    if (messageCode)
+        Print::write(messageCode, 5);
+    Print::write(record.message, record.messageLength);
+    Print::write("\n", 1);
+    if (messageCode)
+        Print::write("\u001b[0m", 4);
 }
 
-void RedirectablePrint::log_to_syslog(const char *logLevel, const char *format, va_list arg)
+void RedirectablePrint::log_to_syslog(const LogRing::Record &record)
 {
 #if HAS_NETWORKING && !defined(ARCH_PORTDUINO)
-    // if syslog is in use, collect the log messages and send them to syslog
-    if (syslog.isEnabled()) {
-        int ll = 0;
-        switch (logLevel[0]) {
-        case 'D':
-            ll = SYSLOG_DEBUG;
-            break;
-        case 'I':
-            ll = SYSLOG_INFO;
-            break;
-        case 'W':
-            ll = SYSLOG_WARN;
-            break;
-        case 'E':
-            ll = SYSLOG_ERR;
-            break;
-        case 'C':
-            ll = SYSLOG_CRIT;
-            break;
-        default:
-            ll = 0;
-        }
-        auto thread = concurrency::OSThread::currentThread;
-        if (thread) {
-            syslog.vlogf(ll, thread->ThreadName.c_str(), format, arg);
-        } else {
-            syslog.vlogf(ll, format, arg);
-        }
+    int ll = 0;
+    switch (record.level[0]) {
+    case 'D':
+        ll = SYSLOG_DEBUG;
+        break;
+    case 'I':
+        ll = SYSLOG_INFO;
+        break;
+    case 'W':
+        ll = SYSLOG_WARN;
+        break;
+    case 'E':
+        ll = SYSLOG_ERR;
+        break;
+    case 'C':
+        ll = SYSLOG_CRIT;
+        break;
+    default:
+        ll = 0;
     }
+    syslog.log(ll, record.thread[0] ? record.thread : NULL, record.message);
+#else
+    (void)record;
 #endif
 }
 
-void RedirectablePrint::log_to_ble(const char *logLevel, const char *format, va_list arg)
+void RedirectablePrint::log_to_ble(const LogRing::Record &record)
 {
 #if !MESHTASTIC_EXCLUDE_BLUETOOTH
-    if (config.security.debug_log_api_enabled && !pauseBluetoothLogging) {
-        bool isBleConnected = false;
-#ifdef ARCH_ESP32
-        isBleConnected = nimbleBluetooth && nimbleBluetooth->isActive() && nimbleBluetooth->isConnected();
-#elif defined(ARCH_NRF52)
-        isBleConnected = nrf52Bluetooth != nullptr && nrf52Bluetooth->isConnected();
-#endif
-        if (isBleConnected) {
-            auto thread = concurrency::OSThread::currentThread;
-            meshtastic_LogRecord logRecord = meshtastic_LogRecord_init_zero;
-            logRecord.level = getLogLevel(logLevel);
-            vsprintf(logRecord.message, format, arg);
-            if (thread)
-                strcpy(logRecord.source, thread->ThreadName.c_str());
-            logRecord.time = getValidTime(RTCQuality::RTCQualityDevice, true);
-
-            auto buffer = std::unique_ptr<uint8_t[]>(new uint8_t[meshtastic_LogRecord_size]);
-            size_t size = pb_encode_to_bytes(buffer.get(), meshtastic_LogRecord_size, meshtastic_LogRecord_fields, &logRecord);
+    // Allocated the first time a phone asks for logs over BLE, most devices never do
+    struct BleLog {
+        meshtastic_LogRecord logRecord;
+        uint8_t buffer[meshtastic_LogRecord_size];
+    };
+    static BleLog *bleLog = nullptr;
+    if (!bleLog)
+        bleLog = new BleLog;
+
+    meshtastic_LogRecord &logRecord = bleLog->logRecord;
+    logRecord = meshtastic_LogRecord_init_zero;
+    logRecord.level = getLogLevel(record.level);
+    strncpy(logRecord.message, record.message, sizeof(logRecord.message) - 1);
+    strncpy(logRecord.source, record.thread, sizeof(logRecord.source) - 1);
+    logRecord.time = record.rtcSec;
+
+    uint8_t *buffer = bleLog->buffer;
+    size_t size = pb_encode_to_bytes(buffer, meshtastic_LogRecord_size, meshtastic_LogRecord_fields, &logRecord);
 #ifdef ARCH_ESP32
-            nimbleBluetooth->sendLog(buffer.get(), size);
+    nimbleBluetooth->sendLog(buffer, size);
 #elif defined(ARCH_NRF52)
-            nrf52Bluetooth->sendLog(buffer.get(), size);
+    nrf52Bluetooth->sendLog(buffer, size);
+#else
+    (void)size;
 #endif
-        }
-    }
 #else
-    (void)logLevel;
-    (void)format;
-    (void)arg;
+    (void)record;
 #endif
 }
 
@@ -274,75 +257,199 @@ meshtastic_LogRecord_Level RedirectablePrint::getLogLevel(const char *logLevel)
     return ll;
 }
 
-void RedirectablePrint::log(const char *logLevel, const char *format, ...)
+bool RedirectablePrint::lockLog()
+{
+#ifdef HAS_FREE_RTOS
+    return inDebugPrint != nullptr && xSemaphoreTake(inDebugPrint, portMAX_DELAY) == pdTRUE;
+#else
+    if (inDebugPrint)
+        return false;
+    inDebugPrint = true;
+    return true;
+#endif
+}
+
+void RedirectablePrint::unlockLog()
 {
+#ifdef HAS_FREE_RTOS
+    xSemaphoreGive(inDebugPrint);
+#else
+    inDebugPrint = false;
+#endif
+}
 
-    // append \n to format
-    size_t len = strlen(format);
-    auto newFormat = std::unique_ptr<char[]>(new char[len + 2]);
-    strcpy(newFormat.get(), format);
-    newFormat[len] = '\n';
-    newFormat[len + 1] = '\0';
+void RedirectablePrint::drainLocked()
+{
+    LogRing::Record record;
+    while (ring.peek(LogRing::SINK_SERIAL, record)) {
+        log_to_serial(record);
+        ring.pop(LogRing::SINK_SERIAL);
+    }
 
-#if ARCH_PORTDUINO
-    // level trace is special, two possible ways to handle it.
-    if (strcmp(logLevel, MESHTASTIC_LOG_LEVEL_TRACE) == 0) {
-        if (portduino_config.traceFilename != "") {
-            va_list arg;
-            va_start(arg, format);
-            try {
-                traceFile << va_arg(arg, char *) << std::endl;
-            } catch (const std::ios_base::failure &e) {
-            }
-            va_end(arg);
+#if HAS_NETWORKING && !defined(ARCH_PORTDUINO)
+    bool syslogEnabled = syslog.isEnabled();
+#else
+    bool syslogEnabled = false;
+#endif
+    if (syslogEnabled) {
+        while (ring.peek(LogRing::SINK_SYSLOG, record)) {
+            log_to_syslog(record);
+            ring.pop(LogRing::SINK_SYSLOG);
         }
-        if (portduino_config.logoutputlevel < level_trace && strcmp(logLevel, MESHTASTIC_LOG_LEVEL_TRACE) == 0) {
-            return;
+    } else {
+        ring.skip(LogRing::SINK_SYSLOG);
+    }
+
+    bool isBleConnected = false;
+#if !MESHTASTIC_EXCLUDE_BLUETOOTH
+    if (config.security.debug_log_api_enabled && !pauseBluetoothLogging) {
+#ifdef ARCH_ESP32
+        isBleConnected = nimbleBluetooth && nimbleBluetooth->isActive() && nimbleBluetooth->isConnected();
+#elif defined(ARCH_NRF52)
+        isBleConnected = nrf52Bluetooth != nullptr && nrf52Bluetooth->isConnected();
+#endif
+    }
+#endif
+    if (isBleConnected) {
+        while (ring.peek(LogRing::SINK_BLE, record)) {
+            log_to_ble(record);
+            ring.pop(LogRing::SINK_BLE);
         }
+    } else {
+        ring.skip(LogRing::SINK_BLE);
     }
-    if (portduino_config.logoutputlevel < level_debug && strcmp(logLevel, MESHTASTIC_LOG_LEVEL_DEBUG) == 0) {
-        return;
+}
+
+void RedirectablePrint::drainLog()
+{
+    if (lockLog()) {
+        drainLocked();
+        unlockLog();
+    }
+}
+
+bool RedirectablePrint::hasQueuedLog() const
+{
+    for (uint8_t sink = 0; sink < LogRing::NUM_SINKS; sink++)
+        if (!ring.isEmpty((LogRing::Sink)sink))
+            return true;
+    return false;
+}
+
+bool RedirectablePrint::isLevelEnabled(const char *logLevel)
+{
+#if ARCH_PORTDUINO
+    if (portduino_config.logoutputlevel < level_trace && strcmp(logLevel, MESHTASTIC_LOG_LEVEL_TRACE) == 0) {
+        return false;
+    } else if (portduino_config.logoutputlevel < level_debug && strcmp(logLevel, MESHTASTIC_LOG_LEVEL_DEBUG) == 0) {
+        return false;
     } else if (portduino_config.logoutputlevel < level_info && strcmp(logLevel, MESHTASTIC_LOG_LEVEL_INFO) == 0) {
-        return;
+        return false;
     } else if (portduino_config.logoutputlevel < level_warn && strcmp(logLevel, MESHTASTIC_LOG_LEVEL_WARN) == 0) {
-        return;
+        return false;
     }
 #endif
     if (moduleConfig.serial.override_console_serial_port && strcmp(logLevel, MESHTASTIC_LOG_LEVEL_DEBUG) == 0) {
-        return;
+        return false;
     }
+    return true;
+}
 
-#ifdef HAS_FREE_RTOS
-    if (inDebugPrint != nullptr && xSemaphoreTake(inDebugPrint, portMAX_DELAY) == pdTRUE) {
-#else
-    if (!inDebugPrint) {
-        inDebugPrint = true;
+#if LOG_BINARY_TRACE
+size_t RedirectablePrint::dumpBinaryLog(Print &out)
+{
+    // Not holding the lock while writing, as the filesystem may log too
+    if (!lockLog())
+        return 0;
+    binaryLog.setPaused(true);
+    unlockLog();
+
+    size_t size = binaryLog.dump(out, millis(), getValidTime(RTCQuality::RTCQualityDevice, true));
+
+    if (lockLog()) {
+        binaryLog.setPaused(false);
+        unlockLog();
+    }
+    return size;
+}
 #endif
 
+void RedirectablePrint::log(const char *logLevel, const char *format, ...)
+{
+#if ARCH_PORTDUINO
+    // level trace is special, two possible ways to handle it.
+    if (strcmp(logLevel, MESHTASTIC_LOG_LEVEL_TRACE) == 0 && portduino_config.traceFilename != "") {
         va_list arg;
-        va_list arg_copy;
-
         va_start(arg, format);
+        try {
+            traceFile << va_arg(arg, char *) << std::endl;
+        } catch (const std::ios_base::failure &e) {
+        }
+        va_end(arg);
+    }
+#endif
+    bool enabled = isLevelEnabled(logLevel);
+#if !LOG_BINARY_TRACE
+    if (!enabled)
+        return;
+#endif
 
-        va_copy(arg_copy, arg);
-        log_to_serial(logLevel, newFormat.get(), arg_copy);
-        va_end(arg_copy);
+    if (!lockLog())
+        return;
+
+    auto thread = concurrency::OSThread::currentThread;
+    const char *threadName = thread ? thread->ThreadName.c_str() : "";
+#if LOG_BINARY_TRACE
+    // Recorded even if not printed, the trace is only decoded after something went wrong
+    va_list binaryArg;
+    va_start(binaryArg, format);
+    binaryLog.record(logLevel, threadName, millis(), format, binaryArg);
+    va_end(binaryArg);
+    if (!enabled) {
+        unlockLog();
+        return;
+    }
+#endif
 
-        va_copy(arg_copy, arg);
-        log_to_syslog(logLevel, newFormat.get(), arg_copy);
-        va_end(arg_copy);
+    // Format the message once, every sink then reads it from the ring
+    va_list arg;
+    va_start(arg, format);
+    int len = vsnprintf(lineBuf, sizeof(lineBuf), format, arg);
+    va_end(arg);
+    if (len < 0)
+        len = 0;
+    // If the resulting string is longer than sizeof(lineBuf)-1 characters, the remaining characters are still counted
+    if (len > (int)sizeof(lineBuf) - 1)
+        len = sizeof(lineBuf) - 1;
+    for (int f = 0; f < len; f++) {
+        if (!std::isprint(static_cast<unsigned char>(lineBuf[f])) && lineBuf[f] != '\n')
+            lineBuf[f] = '#';
+    }
 
-        log_to_ble(logLevel, newFormat.get(), arg);
+    uint32_t rtc_sec = getValidTime(RTCQuality::RTCQualityDevice, true); // display local time on logfile
 
-        va_end(arg);
-#ifdef HAS_FREE_RTOS
-        xSemaphoreGive(inDebugPrint);
+#if LOG_DEFERRED_DRAIN
+    // Write out what is queued rather than overwrite lines a sink has not read yet. Starting over at the beginning of
+    // the ring can waste up to one more record.
+    size_t room = 2 * LogRing::recordSize(strlen(logLevel), strlen(threadName), len);
+    for (uint8_t sink = 0; sink < LogRing::NUM_SINKS; sink++)
+        if (ring.getUnread((LogRing::Sink)sink) + room > ring.getCapacity()) {
+            drainLocked();
+            break;
+        }
+    ring.append(logLevel, threadName, lineBuf, len, millis(), rtc_sec);
+    // Errors are often the last thing logged before a reboot or exit, so they do not wait for the console thread
+    bool urgent = strcmp(logLevel, MESHTASTIC_LOG_LEVEL_ERROR) == 0 || strcmp(logLevel, MESHTASTIC_LOG_LEVEL_CRIT) == 0;
+    if (urgent)
+        drainLocked();
+    unlockLog();
+    if (!urgent)
+        onLogQueued();
 #else
-        inDebugPrint = false;
+    ring.append(logLevel, threadName, lineBuf, len, millis(), rtc_sec);
+    drainLocked();
+    unlockLog();
 #endif
-    }
-
-    return;
 }
 
 void RedirectablePrint::hexDump(const char *logLevel, unsigned char *buf, uint16_t len)
@@ -1,11 +1,63 @@
 #pragma once
 
 #include "../freertosinc.h"
+#include "BinaryLog.h"
+#include "LogRing.h"
 #include "mesh/generated/meshtastic/mesh.pb.h"
 #include <Print.h>
 #include <stdarg.h>
 #include <string>
 
+// Longest formatted log message, longer ones are truncated. Embedded targets keep the size of the old printf buffer.
+#ifndef LOG_LINE_MAX
+#if ENABLE_JSON_LOGGING || defined(ARCH_PORTDUINO)
+#define LOG_LINE_MAX 512
+#else
+#define LOG_LINE_MAX 160
+#endif
+#endif
+
+// If 1, log() only queues lines and SerialConsole writes them out from its thread, so code that logs does not wait on the
+// serial port. Lines are still written at once if they would otherwise be overwritten before every sink read them, and
+// errors go out at once in case a reboot follows. Off on embedded targets, where the deeper ring would cost 8 KB of RAM.
+#ifndef LOG_DEFERRED_DRAIN
+#ifdef ARCH_PORTDUINO
+#define LOG_DEFERRED_DRAIN 1
+#else
+#define LOG_DEFERRED_DRAIN 0
+#endif
+#endif
+#ifndef LOG_DRAIN_INTERVAL_MS
+#define LOG_DRAIN_INTERVAL_MS 20
+#endif
+
+// Bytes of formatted log lines kept for the sinks, rounded up to a power of two. It must hold two lines of LOG_LINE_MAX.
+#ifndef LOG_RING_SIZE
+#if LOG_DEFERRED_DRAIN
+#define LOG_RING_SIZE 8192
+#else
+#define LOG_RING_SIZE (2 * LOG_LINE_MAX)
+#endif
+#endif
+
+// If 1, every log call is also kept in a BinaryLog whatever its level, so the lead up to a critical error can be saved to
+// BINARY_LOG_FILENAME and decoded with bin/decode-binary-log.py
+#ifndef LOG_BINARY_TRACE
+#define LOG_BINARY_TRACE 0
+#endif
+#ifndef BINARY_LOG_SIZE
+#define BINARY_LOG_SIZE 8192
+#endif
+#ifndef BINARY_LOG_FORMATS
+#define BINARY_LOG_FORMATS 256
+#endif
+#ifndef BINARY_LOG_FORMAT_BYTES
+#define BINARY_LOG_FORMAT_BYTES 12288
+#endif
+#ifndef BINARY_LOG_FILENAME
+#define BINARY_LOG_FILENAME "/prefs/binlog.bin"
+#endif
+
 /**
  * A Printable that can be switched to squirt its bytes to a different sink.
  * This class is mostly useful to allow debug printing to be redirected away from Serial
@@ -15,6 +67,13 @@ class RedirectablePrint : public Print
 {
     Print *dest;
 
+    // Every line is formatted once into here, then each sink (serial, syslog, BLE) reads it from the ring
+    LogRing ring{LOG_RING_SIZE};
+    char lineBuf[LOG_LINE_MAX];
+#if LOG_BINARY_TRACE
+    BinaryLog binaryLog{BINARY_LOG_SIZE, BINARY_LOG_FORMATS, BINARY_LOG_FORMAT_BYTES};
+#endif
+
 #ifdef HAS_FREE_RTOS
     SemaphoreHandle_t inDebugPrint = nullptr;
     StaticSemaphore_t _MutexStorageSpace;
@@ -30,7 +89,9 @@ class RedirectablePrint : public Print
     void rpInit();
     void setDestination(Print *dest);
 
+    using Print::write;
     virtual size_t write(uint8_t c);
+    virtual size_t write(const uint8_t *buffer, size_t size);
 
     /**
      * Debug logging print message
@@ -48,12 +109,37 @@ class RedirectablePrint : public Print
 
     std::string mt_sprintf(const std::string fmt_str, ...);
 
+    /// Write out the queued log lines, only needed with LOG_DEFERRED_DRAIN
+    void drainLog();
+
+    bool hasQueuedLog() const;
+
+    /// @return log lines overwritten before a sink wrote them out
+    uint32_t getDroppedLog(LogRing::Sink sink) const { return ring.getDropped(sink); }
+
+#if LOG_BINARY_TRACE
+    /// Write the binary trace to out, calls logged meanwhile are not recorded. @return bytes written
+    size_t dumpBinaryLog(Print &out);
+#endif
+
   protected:
     /// Subclasses can override if they need to change how we format over the serial port
-    virtual void log_to_serial(const char *logLevel, const char *format, va_list arg);
+    virtual void log_to_serial(const LogRing::Record &record);
     meshtastic_LogRecord_Level getLogLevel(const char *logLevel);
 
+    /// Called with LOG_DEFERRED_DRAIN when a line was queued, so the subclass can schedule drainLog()
+    virtual void onLogQueued() {}
+
   private:
-    void log_to_syslog(const char *logLevel, const char *format, va_list arg);
-    void log_to_ble(const char *logLevel, const char *format, va_list arg);
+    /// @return false if lines of this level are not printed right now
+    bool isLevelEnabled(const char *logLevel);
+
+    bool lockLog();
+    void unlockLog();
+
+    /// Write out the lines each sink has not read yet, with the log lock held
+    void drainLocked();
+
+    void log_to_syslog(const LogRing::Record &record);
+    void log_to_ble(const LogRing::Record &record);
 };
\ No newline at end of file
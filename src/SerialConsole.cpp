@@ -2,6 +2,7 @@
 #include "Default.h"
 #include "NodeDB.h"
 #include "PowerFSM.h"
+#include "SafeFile.h"
 #include "Throttle.h"
 #include "configuration.h"
 #include "time.h"
@@ -39,6 +40,10 @@ void consoleInit()
     (void)sc;
 #endif
     DEBUG_PORT.rpInit(); // Simply sets up semaphore
+#if ARCH_PORTDUINO && LOG_DEFERRED_DRAIN
+    // Write out the lines still queued when the native build exits
+    atexit([]() { console->drainLog(); });
+#endif
 }
 
 void consolePrintf(const char *format, ...)
@@ -80,6 +85,17 @@ SerialConsole::SerialConsole() : StreamAPI(&Port), RedirectablePrint(&Port), con
 
 int32_t SerialConsole::runOnce()
 {
+#if LOG_DEFERRED_DRAIN
+    logDrainScheduled = false;
+    drainLog();
+#endif
+#if LOG_BINARY_TRACE
+    if (binaryLogSaveRequested) {
+        binaryLogSaveRequested = false;
+        saveBinaryLog();
+    }
+#endif
+
 #ifdef HELTEC_MESH_SOLAR
     // After enabling the mesh solar serial port module configuration, command processing is handled by the serial port module.
     if (moduleConfig.serial.enabled && moduleConfig.serial.override_console_serial_port &&
@@ -89,6 +105,13 @@ int32_t SerialConsole::runOnce()
 #endif
 
     int32_t delay = runOncePart();
+#if LOG_DEFERRED_DRAIN
+    // Lines logged while we were busy, come back for them soon rather than when the port next has data
+    if (hasQueuedLog()) {
+        logDrainScheduled = true;
+        return min(delay, (int32_t)LOG_DRAIN_INTERVAL_MS);
+    }
+#endif
 #if defined(SERIAL_HAS_ON_RECEIVE) || defined(CONFIG_IDF_TARGET_ESP32S2)
     return Port.available() ? delay : INT32_MAX;
 #elif defined(IS_USB_SERIAL)
@@ -98,6 +121,42 @@ int32_t SerialConsole::runOnce()
 #endif
 }
 
+size_t SerialConsole::write(const uint8_t *buffer, size_t size)
+{
+    // Pass runs of bytes through in one write, prefixing any newlines with carriage return
+    size_t start = 0;
+    for (size_t i = 0; i < size; i++) {
+        if (buffer[i] == '\n') {
+            RedirectablePrint::write(buffer + start, i - start);
+            RedirectablePrint::write((const uint8_t *)"\r\n", 2);
+            start = i + 1;
+        }
+    }
+    if (start < size)
+        RedirectablePrint::write(buffer + start, size - start);
+    return size;
+}
+
+#if LOG_BINARY_TRACE
+void SerialConsole::requestBinaryLogSave()
+{
+    binaryLogSaveRequested = true;
+    setIntervalFromNow(0);
+}
+
+void SerialConsole::saveBinaryLog()
+{
+#ifdef FSCom
+    auto f = SafeFile(BINARY_LOG_FILENAME);
+    size_t size = dumpBinaryLog(f);
+    if (f.close())
+        LOG_INFO("Saved %u bytes of binary log to %s", (unsigned)size, BINARY_LOG_FILENAME);
+    else
+        LOG_ERROR("Can't write binary log to %s", BINARY_LOG_FILENAME);
+#endif
+}
+#endif
+
 void SerialConsole::flush()
 {
     Port.flush();
@@ -139,12 +198,20 @@ bool SerialConsole::handleToRadio(const uint8_t *buf, size_t len)
     }
 }
 
-void SerialConsole::log_to_serial(const char *logLevel, const char *format, va_list arg)
+void SerialConsole::log_to_serial(const LogRing::Record &record)
 {
     if (usingProtobufs && config.security.debug_log_api_enabled) {
-        meshtastic_LogRecord_Level ll = RedirectablePrint::getLogLevel(logLevel);
-        auto thread = concurrency::OSThread::currentThread;
-        emitLogRecord(ll, thread ? thread->ThreadName.c_str() : "", format, arg);
+        meshtastic_LogRecord_Level ll = RedirectablePrint::getLogLevel(record.level);
+        emitLogRecord(ll, record.thread, record.message, record.rtcSec);
     } else
-        RedirectablePrint::log_to_serial(logLevel, format, arg);
+        RedirectablePrint::log_to_serial(record);
+}
+
+void SerialConsole::onLogQueued()
+{
+    // Lines queued while one drain is pending go out with it
+    if (!logDrainScheduled) {
+        logDrainScheduled = true;
+        setIntervalFromNow(LOG_DRAIN_INTERVAL_MS);
+    }
 }
\ No newline at end of file
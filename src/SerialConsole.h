@@ -22,18 +22,25 @@ class SerialConsole : public StreamAPI, public RedirectablePrint, private concur
      */
     virtual bool handleToRadio(const uint8_t *buf, size_t len) override;
 
+    using RedirectablePrint::write;
     virtual size_t write(uint8_t c) override
     {
         if (c == '\n') // prefix any newlines with carriage return
             RedirectablePrint::write('\r');
         return RedirectablePrint::write(c);
     }
+    virtual size_t write(const uint8_t *buffer, size_t size) override;
 
     virtual int32_t runOnce() override;
 
     void flush();
     void rxInt();
 
+#if LOG_BINARY_TRACE
+    /// Save the binary trace to BINARY_LOG_FILENAME soon, from our thread rather than the caller's
+    void requestBinaryLogSave();
+#endif
+
   protected:
     /// Check the current underlying physical link to see if the client is currently connected
     virtual bool checkIsConnected() override;
@@ -41,7 +48,17 @@ class SerialConsole : public StreamAPI, public RedirectablePrint, private concur
     virtual void onNowHasData(uint32_t fromRadioNum) override;
 
     /// Possibly switch to protobufs if we see a valid protobuf message
-    virtual void log_to_serial(const char *logLevel, const char *format, va_list arg);
+    virtual void log_to_serial(const LogRing::Record &record) override;
+
+    virtual void onLogQueued() override;
+
+  private:
+    bool logDrainScheduled = false;
+#if LOG_BINARY_TRACE
+    bool binaryLogSaveRequested = false;
+
+    void saveBinaryLog();
+#endif
 };
 
 // A simple wrapper to allow non class aware code write to the console
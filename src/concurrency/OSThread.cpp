@@ -17,16 +17,16 @@ bool OSThread::showWaiting = false;
 
 const OSThread *OSThread::currentThread;
 
-ThreadController mainController, timerController;
+Scheduler mainController;
+ThreadController timerController;
 InterruptableDelay mainDelay;
 
 void OSThread::setup()
 {
-    mainController.ThreadName = "mainController";
     timerController.ThreadName = "timerController";
 }
 
-OSThread::OSThread(const char *_name, uint32_t period, ThreadController *_controller)
+OSThread::OSThread(const char *_name, uint32_t period, Scheduler *_controller)
     : Thread(NULL, period), controller(_controller)
 {
     assertIsSetup();
@@ -55,6 +55,17 @@ void OSThread::setIntervalFromNow(unsigned long _interval)
 
     // Cache the next run based on the last_run
     _cached_next_run = millis() + interval;
+
+    if (controller)
+        controller->reschedule(this);
+}
+
+IRAM_ATTR void OSThread::setInterval(unsigned long _interval)
+{
+    Thread::setInterval(_interval);
+
+    if (controller)
+        controller->reschedule(this);
 }
 
 bool OSThread::shouldRun(unsigned long time)
@@ -95,8 +106,9 @@ void OSThread::run()
 #endif
     runned();
 
+    // The scheduler looks at our new next run time when we return, no need to queue a reschedule
     if (newDelay >= 0)
-        setInterval(newDelay);
+        Thread::setInterval(newDelay);
 
     currentThread = NULL;
 }
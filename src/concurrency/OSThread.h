@@ -1,16 +1,19 @@
 #pragma once
 
+#include <atomic>
 #include <cstdlib>
 #include <stdint.h>
 
 #include "Thread.h"
 #include "ThreadController.h"
 #include "concurrency/InterruptableDelay.h"
+#include "concurrency/Scheduler.h"
 
 namespace concurrency
 {
 
-extern ThreadController mainController, timerController;
+extern Scheduler mainController;
+extern ThreadController timerController;
 extern InterruptableDelay mainDelay;
 
 #define RUN_SAME -1
@@ -30,7 +33,17 @@ extern InterruptableDelay mainDelay;
  */
 class OSThread : public Thread
 {
-    ThreadController *controller;
+    friend class Scheduler;
+
+    Scheduler *controller;
+
+    // Bookkeeping for the scheduler, only touched by Scheduler
+    enum SchedState : uint8_t { SCHED_NONE, SCHED_HEAP, SCHED_PARKED, SCHED_DUE };
+    SchedState schedState = SCHED_NONE;
+    int16_t schedIndex = -1; // Position in the heap or parked list
+    uint64_t schedKey = 0;   // Next run time on the scheduler clock, while in the heap
+    std::atomic<bool> schedPending{false};
+    OSThread *nextPending = nullptr; // Link in the scheduler pending list
 
     /// Show debugging info for disabled threads
     static bool showDisabled;
@@ -45,7 +58,7 @@ class OSThread : public Thread
     /// For debug printing only (might be null)
     static const OSThread *currentThread;
 
-    OSThread(const char *name, uint32_t period = 0, ThreadController *controller = &mainController);
+    OSThread(const char *name, uint32_t period = 0, Scheduler *controller = &mainController);
 
     virtual ~OSThread();
 
@@ -60,6 +73,11 @@ class OSThread : public Thread
      */
     void setIntervalFromNow(unsigned long _interval);
 
+    /**
+     * Wait a specified number msecs starting from the last time we were run. Safe to call from ISR.
+     */
+    void setInterval(unsigned long _interval);
+
   protected:
     /**
      * The method that will be called each time our thread gets a chance to run
@@ -0,0 +1,230 @@
+#include "Scheduler.h"
+#include "OSThread.h"
+#include "configuration.h"
+#include <assert.h>
+
+namespace concurrency
+{
+
+bool Scheduler::add(OSThread *t)
+{
+    for (int i = 0; i < MAX_THREADS; i++) {
+        if (!threads[i]) {
+            threads[i] = t;
+            numThreads++;
+            tick();
+            place(t);
+            return true;
+        }
+    }
+    return false;
+}
+
+void Scheduler::remove(OSThread *t)
+{
+    // Make sure t is no longer linked in the pending list before it goes away
+    processPending();
+
+    if (t->schedState == OSThread::SCHED_DUE) {
+        for (int i = 0; i < numDue; i++)
+            if (due[i] == t)
+                due[i] = nullptr;
+        t->schedState = OSThread::SCHED_NONE;
+    } else {
+        detach(t);
+    }
+
+    for (int i = 0; i < MAX_THREADS; i++) {
+        if (threads[i] == t) {
+            threads[i] = nullptr;
+            numThreads--;
+            break;
+        }
+    }
+}
+
+IRAM_ATTR void Scheduler::reschedule(OSThread *t)
+{
+    // Already queued, the main loop will look at its current state anyway
+    if (t->schedPending.exchange(true))
+        return;
+
+    OSThread *head = pendingHead.load(std::memory_order_relaxed);
+    do {
+        t->nextPending = head;
+    } while (!pendingHead.compare_exchange_weak(head, t, std::memory_order_release, std::memory_order_relaxed));
+}
+
+long Scheduler::runOrDelay()
+{
+    unsigned long now = tick();
+    processPending();
+    pollParked();
+
+    // Take every due thread out of the heap first, so a thread that asks to run again right away waits for the next call,
+    // the way each thread ran at most once per pass with ThreadController
+    numDue = 0;
+    while (heapSize > 0 && heap[0]->schedKey <= clockMsec) {
+        OSThread *t = heap[0];
+        heapRemove(0);
+        t->schedState = OSThread::SCHED_DUE;
+        due[numDue++] = t;
+    }
+
+    for (int i = 0; i < numDue; i++) {
+        OSThread *t = due[i];
+        if (!t)
+            continue; // Deleted by a thread that ran before it
+
+        if (t->shouldRun(now))
+            t->run();
+
+        // The thread might have deleted itself
+        if (due[i]) {
+            due[i] = nullptr;
+            t->schedState = OSThread::SCHED_NONE;
+            tick();
+            place(t);
+        }
+    }
+    numDue = 0;
+
+    // Threads that ran may have rescheduled or enabled others
+    tick();
+    processPending();
+    pollParked();
+
+    if (heapSize == 0)
+        return OSTHREAD_MAX_SLEEP_MSEC;
+    uint64_t next = heap[0]->schedKey;
+    if (next <= clockMsec)
+        return 0;
+    return (next - clockMsec < OSTHREAD_MAX_SLEEP_MSEC) ? (long)(next - clockMsec) : OSTHREAD_MAX_SLEEP_MSEC;
+}
+
+unsigned long Scheduler::tick()
+{
+    unsigned long now = millis();
+    if (clockStarted)
+        clockMsec += (unsigned long)(now - lastMillis);
+    clockStarted = true;
+    lastMillis = now;
+    return now;
+}
+
+void Scheduler::processPending()
+{
+    OSThread *t = pendingHead.exchange(nullptr, std::memory_order_acquire);
+    while (t) {
+        // Read the link before clearing the flag, after that an ISR may push t again
+        OSThread *next = t->nextPending;
+        t->schedPending.store(false);
+        // A due thread gets placed after it ran anyway
+        if (t->schedState == OSThread::SCHED_HEAP || t->schedState == OSThread::SCHED_PARKED) {
+            detach(t);
+            place(t);
+        }
+        t = next;
+    }
+}
+
+void Scheduler::pollParked()
+{
+    // Iterate backwards, since unparking moves the last entry into the freed slot
+    for (int i = numParked - 1; i >= 0; i--) {
+        OSThread *t = parked[i];
+        if (t->enabled) {
+            detach(t);
+            place(t);
+        }
+    }
+}
+
+void Scheduler::place(OSThread *t)
+{
+    assert(t->schedState == OSThread::SCHED_NONE);
+    if (t->enabled) {
+        // Signed difference, due times in the past are fine. long is as wide as millis() on every platform.
+        long untilDue = (long)(t->_cached_next_run - lastMillis);
+        t->schedKey = clockMsec + untilDue;
+        heapPush(t);
+    } else {
+        t->schedState = OSThread::SCHED_PARKED;
+        t->schedIndex = numParked;
+        parked[numParked++] = t;
+    }
+}
+
+void Scheduler::detach(OSThread *t)
+{
+    if (t->schedState == OSThread::SCHED_HEAP) {
+        heapRemove(t->schedIndex);
+    } else if (t->schedState == OSThread::SCHED_PARKED) {
+        OSThread *last = parked[--numParked];
+        parked[t->schedIndex] = last;
+        last->schedIndex = t->schedIndex;
+        parked[numParked] = nullptr;
+    }
+    t->schedState = OSThread::SCHED_NONE;
+    t->schedIndex = -1;
+}
+
+void Scheduler::heapPush(OSThread *t)
+{
+    t->schedState = OSThread::SCHED_HEAP;
+    heapSet(heapSize++, t);
+    siftUp(heapSize - 1);
+}
+
+void Scheduler::heapRemove(int index)
+{
+    OSThread *t = heap[index];
+    t->schedState = OSThread::SCHED_NONE;
+    t->schedIndex = -1;
+
+    OSThread *last = heap[--heapSize];
+    heap[heapSize] = nullptr;
+    if (index == heapSize)
+        return;
+    heapSet(index, last);
+    siftUp(index);
+    siftDown(last->schedIndex);
+}
+
+void Scheduler::siftUp(int index)
+{
+    OSThread *t = heap[index];
+    while (index > 0) {
+        int parent = (index - 1) / 2;
+        if (heap[parent]->schedKey <= t->schedKey)
+            break;
+        heapSet(index, heap[parent]);
+        index = parent;
+    }
+    heapSet(index, t);
+}
+
+void Scheduler::siftDown(int index)
+{
+    OSThread *t = heap[index];
+    while (true) {
+        int child = 2 * index + 1;
+        if (child >= heapSize)
+            break;
+        if (child + 1 < heapSize && heap[child + 1]->schedKey < heap[child]->schedKey)
+            child++;
+        if (t->schedKey <= heap[child]->schedKey)
+            break;
+        heapSet(index, heap[child]);
+        index = child;
+    }
+    heapSet(index, t);
+}
+
+void Scheduler::heapSet(int index, OSThread *t)
+{
+    heap[index] = t;
+    t->schedIndex = index;
+}
+
+} // namespace concurrency
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <atomic>
+#include <stdint.h>
+
+#include "ThreadController.h" // For MAX_THREADS
+
+/// Longest the main loop sleeps, bounds how late we notice a thread that another task enabled by setting `enabled` directly
+#ifndef OSTHREAD_MAX_SLEEP_MSEC
+#define OSTHREAD_MAX_SLEEP_MSEC 10000
+#endif
+
+namespace concurrency
+{
+
+class OSThread;
+
+/**
+ * Runs OSThreads when they are due, replacing ArduinoThread's ThreadController for the main loop.
+ *
+ * Enabled threads sit in a min-heap keyed by their next run time, so each runOrDelay() only touches the threads that are
+ * due and the returned delay is the exact time until the next one. Disabled threads are parked on a separate list, the
+ * only per-loop cost for them is a check of their `enabled` flag, since modules turn themselves on by setting it directly.
+ *
+ * Changing the interval of a thread (setInterval(), setIntervalFromNow(), disable()) queues it on a lock free pending
+ * list, which is safe from ISRs. The main loop moves it to its new place in the heap on the next runOrDelay().
+ */
+class Scheduler
+{
+  public:
+    /// Start scheduling t, returns false if MAX_THREADS are already registered
+    bool add(OSThread *t);
+
+    /// Stop scheduling t, must be called from the main loop. t may still be waiting for its turn in the current runOrDelay().
+    void remove(OSThread *t);
+
+    /// Note that the next run time of t may have changed. Safe to call from ISR.
+    void reschedule(OSThread *t);
+
+    /// Run all threads that are due, returns how many msecs until the next one is due
+    long runOrDelay();
+
+    /// For debug listings, index ranges from 0 to MAX_THREADS - 1, unused indexes return nullptr
+    OSThread *get(int index) const { return (index >= 0 && index < MAX_THREADS) ? threads[index] : nullptr; }
+
+    /// Number of registered threads (the parameter is only there for compatibility with ThreadController)
+    int size(bool cached = true) const { return numThreads; }
+
+  private:
+    OSThread *threads[MAX_THREADS] = {};
+    int numThreads = 0;
+
+    // Enabled threads, ordered by OSThread::schedKey
+    OSThread *heap[MAX_THREADS] = {};
+    int heapSize = 0;
+
+    // Disabled threads
+    OSThread *parked[MAX_THREADS] = {};
+    int numParked = 0;
+
+    // Threads taken out of the heap by the runOrDelay() in progress
+    OSThread *due[MAX_THREADS] = {};
+    int numDue = 0;
+
+    // Threads waiting for reschedule() to take effect, pushed from any context, drained by the main loop
+    std::atomic<OSThread *> pendingHead{nullptr};
+
+    // millis() extended to 64 bits, so heap keys never wrap. Starts high so due times in the past stay positive.
+    uint64_t clockMsec = (uint64_t)1 << 40;
+    unsigned long lastMillis = 0;
+    bool clockStarted = false;
+
+    /// Advance clockMsec, returns millis()
+    unsigned long tick();
+
+    /// Apply all pending reschedule() calls
+    void processPending();
+
+    /// Move threads that were enabled since we parked them into the heap
+    void pollParked();
+
+    /// Put t in the heap or on the parked list according to its current state
+    void place(OSThread *t);
+
+    /// Take t out of the heap or off the parked list
+    void detach(OSThread *t);
+
+    void heapPush(OSThread *t);
+    void heapRemove(int index);
+    void siftUp(int index);
+    void siftDown(int index);
+    void heapSet(int index, OSThread *t);
+};
+
+} // namespace concurrency
@@ -71,6 +71,11 @@ static struct uBloxGnssModelInfo {
 #define GPS_SOL_EXPIRY_MS 5000 // in millis. give 1 second time to combine different sentences. NMEA Frequency isn't higher anyway
 #define NMEA_MSG_GXGSA "GNGSA" // GSA message (GPGSA, GNGSA etc)
 
+// Bytes read from the GPS serial port at a time
+#ifndef GPS_READ_CHUNK
+#define GPS_READ_CHUNK 128
+#endif
+
 // For logging
 static const char *getGPSPowerStateString(GPSPowerState state)
 {
@@ -1218,6 +1223,7 @@ int32_t GPS::runOnce()
 // clear the GPS rx/tx buffer as quickly as possible
 void GPS::clearBuffer()
 {
+    framer.reset();
 #ifdef ARCH_ESP32
     _serial_gps->flush(false);
 #else
@@ -1692,14 +1698,14 @@ bool GPS::lookForLocation()
     fixQual = reader.fixQuality();
 
 #ifndef TINYGPS_OPTION_NO_STATISTICS
-    if (reader.failedChecksum() > lastChecksumFailCount) {
+    if (framer.getFailedChecksum() > lastChecksumFailCount) {
 // In a GPS_DEBUG build we want to log all of these. In production, we only care if there are many of them.
 #ifndef GPS_DEBUG
-        if (reader.failedChecksum() > 4)
+        if (framer.getFailedChecksum() > 4)
 #endif
-            LOG_WARN("%u new GPS checksum failures, for a total of %u", reader.failedChecksum() - lastChecksumFailCount,
-                     reader.failedChecksum());
-        lastChecksumFailCount = reader.failedChecksum();
+            LOG_WARN("%u new GPS checksum failures, for a total of %u", framer.getFailedChecksum() - lastChecksumFailCount,
+                     framer.getFailedChecksum());
+        lastChecksumFailCount = framer.getFailedChecksum();
     }
 #endif
 
@@ -1833,16 +1839,12 @@ bool GPS::hasLock()
 
 bool GPS::hasFlow()
 {
-    return reader.passedChecksum() > 0;
+    return framer.getPassedChecksum() > 0;
 }
 
 bool GPS::whileActive()
 {
-    unsigned int charsInBuf = 0;
     bool isValid = false;
-#ifdef GPS_DEBUG
-    std::string debugmsg = "";
-#endif
     if (powerState != GPS_ACTIVE) {
         clearBuffer();
         return false;
@@ -1853,28 +1855,40 @@ bool GPS::whileActive()
         clearBuffer();
     }
 #endif
-    // First consume any chars that have piled up at the receiver
-    while (_serial_gps->available() > 0) {
-        int c = _serial_gps->read();
-        UBXscratch[charsInBuf] = c;
+    static const char ubloxReboot[] = "$GPTXT,01,01,02,u-blox ag - www.u-blox.com*50";
+    auto onSentence = [&](const NMEAFramer::Sentence &s) {
 #ifdef GPS_DEBUG
-        debugmsg += vformat("%c", (c >= 32 && c <= 126) ? c : '.');
+        LOG_DEBUG("%.*s", (int)s.length, s.text);
+#endif
+        switch (s.type) {
+        case NMEAFramer::NMEA_GGA:
+        case NMEAFramer::NMEA_RMC:
+#ifndef TINYGPS_OPTION_NO_CUSTOM_FIELDS
+        case NMEAFramer::NMEA_GSA:
 #endif
-        isValid |= reader.encode(c);
-        if (charsInBuf > sizeof(UBXscratch) - 10 || c == '\r') {
-            if (strnstr((char *)UBXscratch, "$GPTXT,01,01,02,u-blox ag - www.u-blox.com*50", charsInBuf)) {
+            for (size_t i = 0; i < s.length; i++)
+                reader.encode(s.text[i]);
+            isValid |= reader.encode('\r');
+            reader.encode('\n');
+            break;
+        case NMEAFramer::NMEA_TXT:
+            if (s.length == sizeof(ubloxReboot) - 1 && memcmp(s.text, ubloxReboot, s.length) == 0)
                 rebootsSeen++;
-            }
-            charsInBuf = 0;
-        } else {
-            charsInBuf++;
+            break;
+        default:
+            break;
         }
+    };
+
+    // Consume whatever has piled up at the receiver in chunks, rather than a byte at a time
+    uint8_t chunk[GPS_READ_CHUNK];
+    int available;
+    while ((available = _serial_gps->available()) > 0) {
+        size_t n = _serial_gps->readBytes((char *)chunk, available < (int)sizeof(chunk) ? available : sizeof(chunk));
+        if (n == 0)
+            break;
+        framer.feed(chunk, n, onSentence);
     }
-#ifdef GPS_DEBUG
-    if (debugmsg != "") {
-        LOG_DEBUG(debugmsg.c_str());
-    }
-#endif
     return isValid;
 }
 void GPS::enable()
@@ -6,6 +6,7 @@
 
 #include "GPSStatus.h"
 #include "GpioLogic.h"
+#include "NMEAFramer.h"
 #include "Observer.h"
 #include "TinyGPS++.h"
 #include "concurrency/OSThread.h"
@@ -159,6 +160,7 @@ class GPS : private concurrency::OSThread
     GnssModel_t gnssModel = GNSS_MODEL_UNKNOWN;
 
     TinyGPSPlus reader;
+    NMEAFramer framer; // only complete sentences of the types reader uses get to it
     uint8_t fixQual = 0; // fix quality from GPGGA
     uint32_t lastChecksumFailCount = 0;
     uint8_t currentStep = 0;
@@ -0,0 +1,42 @@
+#include "NMEAFramer.h"
+
+static int hexValue(char c)
+{
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    if (c >= 'A' && c <= 'F')
+        return c - 'A' + 10;
+    if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    return -1;
+}
+
+bool NMEAFramer::finish(Sentence &s)
+{
+    // Without a checksum the parser would not take it either
+    if (starAt < 0)
+        return false;
+
+    int high = (size_t)starAt + 1 < s.length ? hexValue(s.text[starAt + 1]) : -1;
+    int low = (size_t)starAt + 2 < s.length ? hexValue(s.text[starAt + 2]) : -1;
+    if ((size_t)starAt + 3 != s.length || high < 0 || low < 0 || ((high << 4) | low) != checksum) {
+        failedChecksum++;
+        return false;
+    }
+    passedChecksum++;
+
+    // $ and a two letter talker id, then the sentence type. Proprietary sentences ($P...) are of no interest.
+    s.type = NMEA_OTHER;
+    if (starAt >= 6 && s.text[1] != 'P') {
+        const char *type = s.text + 3;
+        if (memcmp(type, "GGA", 3) == 0)
+            s.type = NMEA_GGA;
+        else if (memcmp(type, "RMC", 3) == 0)
+            s.type = NMEA_RMC;
+        else if (memcmp(type, "GSA", 3) == 0)
+            s.type = NMEA_GSA;
+        else if (memcmp(type, "TXT", 3) == 0)
+            s.type = NMEA_TXT;
+    }
+    return true;
+}
@@ -0,0 +1,155 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// Longest NMEA sentence kept, the standard allows 82 characters but some receivers send longer proprietary ones
+#ifndef NMEA_MAX_SENTENCE
+#define NMEA_MAX_SENTENCE 120
+#endif
+
+/**
+ * Splits the byte stream from a GNSS receiver into NMEA sentences, skipping interleaved UBX frames.
+ *
+ * Bytes are fed in whatever chunks the serial port returns. Only complete sentences with a valid checksum are passed on,
+ * without the CR LF, so the NMEA parser never sees the rest. A sentence which arrived within one chunk is passed as a
+ * pointer into that chunk, only sentences split across chunks are copied.
+ */
+class NMEAFramer
+{
+  public:
+    /// Sentence types we act on, by the three letters after the talker id
+    enum SentenceType : uint8_t { NMEA_OTHER, NMEA_GGA, NMEA_RMC, NMEA_GSA, NMEA_TXT };
+
+    struct Sentence {
+        const char *text; // from the '$' up to the two checksum digits
+        size_t length;
+        SentenceType type;
+    };
+
+    /// Feed received bytes, onSentence(const Sentence &) is called for each complete sentence with a valid checksum
+    template <typename F> void feed(const uint8_t *data, size_t length, F &&onSentence)
+    {
+        size_t start = 0; // where the current sentence began in data, if it did
+        for (size_t i = 0; i < length; i++) {
+            uint8_t c = data[i];
+            switch (state) {
+            case IDLE:
+                if (c == '$') {
+                    begin();
+                    start = i;
+                    // Copy later only if the sentence runs past the end of this chunk
+                } else if (c == UBX_SYNC_1) {
+                    state = UBX_SYNC;
+                }
+                break;
+
+            case NMEA:
+                if (c == '\r' || c == '\n') {
+                    Sentence s;
+                    if (copying) {
+                        s.text = line;
+                    } else {
+                        s.text = (const char *)data + start;
+                    }
+                    s.length = lineLength;
+                    state = IDLE;
+                    if (finish(s))
+                        onSentence(s);
+                } else if (c == '$') {
+                    // A new sentence before the end of the last one, which is dropped
+                    begin();
+                    start = i;
+                } else if (c < 0x20 || c > 0x7e || lineLength >= NMEA_MAX_SENTENCE) {
+                    state = c == UBX_SYNC_1 ? UBX_SYNC : IDLE;
+                } else {
+                    if (copying)
+                        line[lineLength] = c;
+                    lineLength++;
+                    if (c == '*')
+                        starAt = lineLength - 1;
+                    else if (starAt < 0)
+                        checksum ^= c;
+                }
+                break;
+
+            case UBX_SYNC:
+                state = c == UBX_SYNC_2 ? UBX_HEADER : IDLE;
+                ubxHeaderLength = 0;
+                if (c == '$') {
+                    begin();
+                    start = i;
+                }
+                break;
+
+            case UBX_HEADER:
+                // Class, id and a little endian payload length
+                ubxHeader[ubxHeaderLength++] = c;
+                if (ubxHeaderLength == sizeof(ubxHeader)) {
+                    size_t payloadLength = ubxHeader[2] | (ubxHeader[3] << 8);
+                    ubxRemaining = payloadLength + 2; // and two checksum bytes
+                    // Not a frame we could be sent while navigating, more likely noise: look for NMEA again
+                    state = payloadLength <= UBX_MAX_PAYLOAD ? UBX_PAYLOAD : IDLE;
+                }
+                break;
+
+            case UBX_PAYLOAD: {
+                // Skip the rest of the frame in one go
+                size_t skip = length - i < ubxRemaining ? length - i : ubxRemaining;
+                ubxRemaining -= skip;
+                i += skip - 1;
+                if (ubxRemaining == 0)
+                    state = IDLE;
+                break;
+            }
+            }
+        }
+
+        // Keep the start of a sentence which continues in the next chunk
+        if (state == NMEA && !copying) {
+            memcpy(line, data + start, lineLength);
+            copying = true;
+        }
+    }
+
+    /// Forget any partial sentence, for example after the receive buffer was flushed
+    void reset() { state = IDLE; }
+
+    uint32_t getPassedChecksum() const { return passedChecksum; }
+    uint32_t getFailedChecksum() const { return failedChecksum; }
+
+  private:
+    static constexpr uint8_t UBX_SYNC_1 = 0xb5;
+    static constexpr uint8_t UBX_SYNC_2 = 0x62;
+    static constexpr size_t UBX_MAX_PAYLOAD = 1024;
+
+    enum State : uint8_t { IDLE, NMEA, UBX_SYNC, UBX_HEADER, UBX_PAYLOAD };
+    State state = IDLE;
+
+    char line[NMEA_MAX_SENTENCE];
+    size_t lineLength = 0;
+    bool copying = false; // line holds the sentence so far, rather than the chunk it started in
+    int starAt = -1;
+    uint8_t checksum = 0;
+
+    uint8_t ubxHeader[4];
+    uint8_t ubxHeaderLength = 0;
+    size_t ubxRemaining = 0;
+
+    uint32_t passedChecksum = 0;
+    uint32_t failedChecksum = 0;
+
+    void begin()
+    {
+        state = NMEA;
+        line[0] = '$';
+        lineLength = 1;
+        copying = false;
+        starAt = -1;
+        checksum = 0;
+    }
+
+    /// Check the checksum and find the type. @return false if the sentence is to be dropped.
+    bool finish(Sentence &s);
+};
@@ -1142,6 +1142,22 @@ static LGFX *tft = nullptr;
 #include "SPILock.h"
 #include "TFTDisplay.h"
 #include <SPI.h>
+#include <algorithm>
+
+#if !defined(HACKADAY_COMMUNICATOR) && !defined(TFT_ESPI_VERSION)
+// LovyanGFX can send a rectangle with DMA while we prepare the next one
+#define TFT_PUSH_DMA 1
+#else
+#define TFT_PUSH_DMA 0
+#endif
+
+/// Load 4 bytes of the page buffer at once, at any alignment
+static inline uint32_t loadWord(const uint8_t *p)
+{
+    uint32_t word;
+    memcpy(&word, p, sizeof(word));
+    return word;
+}
 
 #ifdef UNPHONE
 #include "unPhone.h"
@@ -1184,111 +1200,167 @@ TFTDisplay::TFTDisplay(uint8_t address, int sda, int scl, OLEDDISPLAY_GEOMETRY g
 
 TFTDisplay::~TFTDisplay()
 {
-    // Clean up allocated line pixel buffer to prevent memory leak
-    if (linePixelBuffer != nullptr) {
-        free(linePixelBuffer);
-        linePixelBuffer = nullptr;
+    // Clean up the allocated pixel buffers to prevent memory leak
+    for (auto &pixels : blockPixelBuffer) {
+        if (pixels != nullptr) {
+            free(pixels);
+            pixels = nullptr;
+        }
+    }
+}
+
+bool TFTDisplay::findChangedBlock(uint32_t page, bool fromBlank, Block &block) const
+{
+    const uint8_t *now = buffer + page * displayWidth;
+    const uint8_t *was = buffer_back + page * displayWidth;
+    uint32_t first = 0, last = displayWidth;
+
+    // Compare a word at a time from both ends to find the changed columns, then narrow down to the byte
+    if (fromBlank) {
+        while (first + 4 <= displayWidth && loadWord(now + first) == 0)
+            first += 4;
+        while (first < displayWidth && now[first] == 0)
+            first++;
+        if (first == displayWidth)
+            return false;
+        while (last >= first + 4 && loadWord(now + last - 4) == 0)
+            last -= 4;
+        while (now[last - 1] == 0)
+            last--;
+    } else {
+        while (first + 4 <= displayWidth && loadWord(now + first) == loadWord(was + first))
+            first += 4;
+        while (first < displayWidth && now[first] == was[first])
+            first++;
+        if (first == displayWidth)
+            return false;
+        while (last >= first + 4 && loadWord(now + last - 4) == loadWord(was + last - 4))
+            last -= 4;
+        while (now[last - 1] == was[last - 1])
+            last--;
+    }
+
+    // Each byte is a column of the 8 rows in this page, collect which rows have changes
+    uint32_t changed = 0;
+    uint32_t x = first;
+    for (; x + 4 <= last; x += 4)
+        changed |= loadWord(now + x) ^ (fromBlank ? 0 : loadWord(was + x));
+    for (; x < last; x++)
+        changed |= now[x] ^ (fromBlank ? 0 : was[x]);
+    uint8_t rows = changed | (changed >> 8) | (changed >> 16) | (changed >> 24);
+
+    block.x = first;
+    block.w = last - first;
+    block.y = page * 8 + __builtin_ctz(rows);
+    block.h = page * 8 + (31 - __builtin_clz(rows)) + 1 - block.y;
+    return true;
+}
+
+bool TFTDisplay::mergeBlocks(Block &into, const Block &next) const
+{
+    uint32_t x = std::min(into.x, next.x);
+    uint32_t w = std::max(into.x + into.w, next.x + next.w) - x;
+    uint32_t h = next.y + next.h - into.y;
+    // Only while it still fits the pixel buffer and does not resend too many unchanged pixels
+    if (h > TFT_BLOCK_ROWS || 2 * w * h > 3 * (into.w * into.h + next.w * next.h))
+        return false;
+    into.x = x;
+    into.w = w;
+    into.h = h;
+    return true;
+}
+
+void TFTDisplay::fillBlock(const Block &block, uint16_t *pixels) const
+{
+    // Store colors byte-reversed so that the TFT library doesn't have to swap bytes in a separate step
+    const uint16_t colorTftMesh = __builtin_bswap16(TFT_MESH);
+    const uint16_t colorTftBlack = __builtin_bswap16(TFT_BLACK);
+
+    for (uint32_t y = block.y; y < block.y + block.h; y++) {
+        // get src pixels in the page based ordering the OLED lib uses
+        const uint8_t *src = buffer + (y / 8) * displayWidth + block.x;
+        const uint8_t mask = 1 << (y & 7);
+        for (uint32_t x = 0; x < block.w; x++)
+            *pixels++ = (src[x] & mask) ? colorTftMesh : colorTftBlack;
     }
 }
 
+void TFTDisplay::pushBlock(const Block &block, uint16_t *pixels)
+{
+#if defined(HACKADAY_COMMUNICATOR)
+    tft->draw16bitBeRGBBitmap(block.x, block.y, pixels, block.w, block.h);
+#elif TFT_PUSH_DMA
+    // Returns as soon as the transfer is started, the caller waits for it before touching pixels or the bus again
+    tft->pushImageDMA(block.x, block.y, block.w, block.h, pixels);
+#else
+    // This function accepts pixel data MSB first so it can dump the memory straight out the SPI port.
+    tft->pushRect(block.x, block.y, block.w, block.h, pixels);
+#endif
+}
+
 // Write the buffer to the display memory
 void TFTDisplay::display(bool fromBlank)
 {
     if (fromBlank)
         tft->fillScreen(TFT_BLACK);
 
-    concurrency::LockGuard g(spiLock);
-
-    uint32_t x, y;
-    uint32_t y_byteIndex;
-    uint8_t y_byteMask;
-    uint32_t x_FirstPixelUpdate;
-    uint32_t x_LastPixelUpdate;
-    bool isset, dblbuf_isset;
-    uint16_t colorTftMesh, colorTftBlack;
-    bool somethingChanged = false;
-
-    // Store colors byte-reversed so that TFT_eSPI doesn't have to swap bytes in a separate step
-    colorTftMesh = __builtin_bswap16(TFT_MESH);
-    colorTftBlack = __builtin_bswap16(TFT_BLACK);
-
-    y = 0;
-    while (y < displayHeight) {
-        y_byteIndex = (y / 8) * displayWidth;
-        y_byteMask = (1 << (y & 7));
-
-        // Step 1: Do a quick scan of 8 rows together. This allows fast-forwarding over unchanged screen areas.
-        if (y_byteMask == 1) {
-            if (!fromBlank) {
-                for (x = 0; x < displayWidth; x++) {
-                    if (buffer[x + y_byteIndex] != buffer_back[x + y_byteIndex])
-                        break;
-                }
-            } else {
-                for (x = 0; x < displayWidth; x++) {
-                    if (buffer[x + y_byteIndex] != 0)
-                        break;
-                }
-            }
-            if (x >= displayWidth) {
-                // No changed pixels found in these 8 rows, fast-forward to the next 8
-                y = y + 8;
-                continue;
-            }
+    // Find changed areas a page of 8 rows at a time, and send each as one rectangle. The SPI bus is only held while a
+    // rectangle is sent so the radio can get in between. With DMA the next rectangle is prepared while the last one is sent.
+    const uint32_t pages = (displayHeight + 7) / 8;
+    uint32_t page = 0;
+    Block block, next;
+    bool haveBlock = false, somethingChanged = false;
+    int current = 0;
+
+    auto nextBlock = [&](Block &out) {
+        if (!haveBlock) {
+            while (page < pages && !findChangedBlock(page, fromBlank, out))
+                page++;
+            if (page++ >= pages)
+                return false;
+        } else {
+            out = next;
+            haveBlock = false;
         }
-
-        // Step 2: Scan each of the 8 rows individually. Find the first pixel in each row that needs updating
-        for (x_FirstPixelUpdate = 0; x_FirstPixelUpdate < displayWidth; x_FirstPixelUpdate++) {
-            isset = buffer[x_FirstPixelUpdate + y_byteIndex] & y_byteMask;
-
-            if (!fromBlank) {
-                // get src pixel in the page based ordering the OLED lib uses
-                dblbuf_isset = buffer_back[x_FirstPixelUpdate + y_byteIndex] & y_byteMask;
-                if (isset != dblbuf_isset) {
-                    break;
-                }
-            } else if (isset) {
+        while (page < pages) {
+            if (!findChangedBlock(page++, fromBlank, next))
+                break;
+            if (!mergeBlocks(out, next)) {
+                haveBlock = true;
                 break;
             }
         }
+        return true;
+    };
 
-        // Did we find a pixel that needs updating on this row?
-        if (x_FirstPixelUpdate < displayWidth) {
-
-            // Quickly write out the first changed pixel (saves another array lookup)
-            linePixelBuffer[x_FirstPixelUpdate] = isset ? colorTftMesh : colorTftBlack;
-            x_LastPixelUpdate = x_FirstPixelUpdate;
-
-            // Step 3: copy all remaining pixels in this row into the pixel line buffer,
-            // while also recording the last pixel in the row that needs updating
-            for (x = x_FirstPixelUpdate + 1; x < displayWidth; x++) {
-                isset = buffer[x + y_byteIndex] & y_byteMask;
-                linePixelBuffer[x] = isset ? colorTftMesh : colorTftBlack;
-
-                if (!fromBlank) {
-                    dblbuf_isset = buffer_back[x + y_byteIndex] & y_byteMask;
-                    if (isset != dblbuf_isset) {
-                        x_LastPixelUpdate = x;
-                    }
-                } else if (isset) {
-                    x_LastPixelUpdate = x;
-                }
-            }
-#if defined(HACKADAY_COMMUNICATOR)
-            tft->draw16bitBeRGBBitmap(x_FirstPixelUpdate, y, &linePixelBuffer[x_FirstPixelUpdate],
-                                      (x_LastPixelUpdate - x_FirstPixelUpdate + 1), 1);
+    bool more = nextBlock(block);
+    if (more)
+        fillBlock(block, blockPixelBuffer[current]);
+    while (more) {
+#if TFT_PUSH_DMA
+        concurrency::LockGuard g(spiLock);
+        tft->startWrite();
+        pushBlock(block, blockPixelBuffer[current]);
+        current ^= 1;
+        more = nextBlock(block);
+        if (more)
+            fillBlock(block, blockPixelBuffer[current]);
+        tft->waitDMA();
+        tft->endWrite();
 #else
-            // Step 4: Send the changed pixels on this line to the screen as a single block transfer.
-            // This function accepts pixel data MSB first so it can dump the memory straight out the SPI port.
-            tft->pushRect(x_FirstPixelUpdate, y, (x_LastPixelUpdate - x_FirstPixelUpdate + 1), 1,
-                          &linePixelBuffer[x_FirstPixelUpdate]);
-#endif
-            somethingChanged = true;
+        {
+            concurrency::LockGuard g(spiLock);
+            pushBlock(block, blockPixelBuffer[current]);
         }
-        y++;
+        more = nextBlock(block);
+        if (more)
+            fillBlock(block, blockPixelBuffer[current]);
+#endif
+        somethingChanged = true;
     }
-    // Copy the Buffer to the Back Buffer
-    if (somethingChanged)
+
+    // Copy the Buffer to the Back Buffer. After a blank the screen matches it even if nothing was sent.
+    if (somethingChanged || fromBlank)
         memcpy(buffer_back, buffer, displayBufferSize);
 }
 
@@ -1505,12 +1577,21 @@ bool TFTDisplay::connect()
 #endif
     tft->fillScreen(TFT_BLACK);
 
-    if (this->linePixelBuffer == NULL) {
-        this->linePixelBuffer = (uint16_t *)malloc(sizeof(uint16_t) * displayWidth);
+    // With DMA one buffer is filled while the other is sent
+    for (int i = 0; i < (TFT_PUSH_DMA ? 2 : 1); i++) {
+        if (this->blockPixelBuffer[i] == NULL) {
+            size_t bytes = sizeof(uint16_t) * displayWidth * TFT_BLOCK_ROWS;
+#ifdef ARCH_ESP32
+            // Large allocations may otherwise end up in PSRAM, which SPI DMA can't read from
+            this->blockPixelBuffer[i] = (uint16_t *)heap_caps_malloc(bytes, MALLOC_CAP_DMA);
+#else
+            this->blockPixelBuffer[i] = (uint16_t *)malloc(bytes);
+#endif
 
-        if (!this->linePixelBuffer) {
-            LOG_ERROR("Not enough memory to create TFT line buffer\n");
-            return false;
+            if (!this->blockPixelBuffer[i]) {
+                LOG_ERROR("Not enough memory to create TFT pixel buffer\n");
+                return false;
+            }
         }
     }
     return true;
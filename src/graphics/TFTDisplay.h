@@ -3,11 +3,16 @@
 #include <GpioLogic.h>
 #include <OLEDDisplay.h>
 
+// Most rows sent to the screen as one rectangle, each pixel buffer holds this many full rows
+#ifndef TFT_BLOCK_ROWS
+#define TFT_BLOCK_ROWS 8
+#endif
+static_assert(TFT_BLOCK_ROWS >= 8, "TFT_BLOCK_ROWS must hold a block from one 8 row page of the display buffer");
+
 /**
  * An adapter class that allows using the LovyanGFX library as if it was an OLEDDisplay implementation.
  *
  * Remaining TODO:
- * optimize display() to only draw changed pixels (see other OLED subclasses for examples)
  * Use the fast NRF52 SPI API rather than the slow standard arduino version
  *
  * turn radio back on - currently with both on spi bus is fucked? or are we leaving chip select asserted?
@@ -62,5 +67,22 @@ class TFTDisplay : public OLEDDisplay
     // Connect to the display
     virtual bool connect() override;
 
-    uint16_t *linePixelBuffer = nullptr;
+  private:
+    /// A rectangle of the screen that needs sending, in pixels
+    struct Block {
+        uint32_t x, y, w, h;
+    };
+
+    /// Find the smallest rectangle around the changed pixels of a page of 8 rows. @return false if nothing changed.
+    bool findChangedBlock(uint32_t page, bool fromBlank, Block &block) const;
+
+    /// Grow into to also cover next, which starts further down the screen. @return false if that would not be worth it.
+    bool mergeBlocks(Block &into, const Block &next) const;
+
+    /// Convert a rectangle of the page buffer to RGB565 pixels
+    void fillBlock(const Block &block, uint16_t *pixels) const;
+
+    void pushBlock(const Block &block, uint16_t *pixels);
+
+    uint16_t *blockPixelBuffer[2] = {nullptr, nullptr};
 };
\ No newline at end of file
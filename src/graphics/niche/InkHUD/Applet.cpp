@@ -37,6 +37,57 @@ void InkHUD::Applet::drawPixel(int16_t x, int16_t y, uint16_t color)
         assignedTile->handleAppletPixel(x, y, static_cast<Color>(color));
 }
 
+// Draw a filled rectangle
+// AdafruitGFX also routes fillScreen, writeFillRect and the fast lines through here
+// Cropped here, then passed to the tile as a whole rectangle, instead of pixel by pixel
+void InkHUD::Applet::fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color)
+{
+    if (w < 0) {
+        x += w;
+        w = -w;
+    }
+    if (h < 0) {
+        y += h;
+        h = -h;
+    }
+
+    int x0 = max((int)x, (int)cropLeft);
+    int y0 = max((int)y, (int)cropTop);
+    int x1 = min(x + w, cropLeft + cropWidth);
+    int y1 = min(y + h, cropTop + cropHeight);
+    if (x0 < x1 && y0 < y1)
+        assignedTile->handleAppletRect(x0, y0, x1 - x0, y1 - y0, static_cast<Color>(color));
+}
+
+void InkHUD::Applet::drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color)
+{
+    fillRect(x, y, w, 1, color);
+}
+
+void InkHUD::Applet::drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color)
+{
+    fillRect(x, y, 1, h, color);
+}
+
+// Draw one character of text
+// AdafruitGFX would place a glyph pixel by pixel. Instead, its bitmap is passed to the tile whole, along with our crop region.
+// Anything out of the ordinary (built-in font, scaled text, text wrap, line breaks) is left to AdafruitGFX
+size_t InkHUD::Applet::write(uint8_t c)
+{
+    if (!gfxFont || wrap || textsize_x != 1 || textsize_y != 1 || c == '\n' || c == '\r' || c < gfxFont->first ||
+        c > gfxFont->last)
+        return GFX::write(c);
+
+    const GFXglyph *glyph = &gfxFont->glyph[c - gfxFont->first];
+    if (glyph->width > 0 && glyph->height > 0) {
+        ImageBuffer::Region crop = {cropLeft, cropTop, cropLeft + cropWidth, cropTop + cropHeight};
+        assignedTile->handleAppletBits(cursor_x + glyph->xOffset, cursor_y + glyph->yOffset, gfxFont->bitmap,
+                                       glyph->bitmapOffset * 8, glyph->width, glyph->height, static_cast<Color>(textcolor), crop);
+    }
+    cursor_x += glyph->xAdvance;
+    return 1;
+}
+
 // Link our applet to a tile
 // This can only be called by Tile::assignApplet
 // The tile determines the applets dimensions
@@ -126,6 +126,11 @@ class Applet : public GFX
 
   protected:
     void drawPixel(int16_t x, int16_t y, uint16_t color) override; // Place a single pixel. All drawing output passes through here
+    void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) override; // ..except filled rects and lines
+    void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) override;
+    void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) override;
+    size_t write(uint8_t c) override; // ..and glyphs of text, which skip the per-pixel path where possible
+    using GFX::write;
 
     void requestUpdate(EInk::UpdateTypes type = EInk::UpdateTypes::UNSPECIFIED,
                        bool full = true); // Ask WindowManager to schedule a display update
@@ -187,16 +187,12 @@ void InkHUD::MapApplet::getMapCenter(float *lat, float *lng)
         float yAvg = 0;
         float zAvg = 0;
 
-        // For each node in db
-        for (uint32_t i = 0; i < nodeDB->getNumMeshNodes(); i++) {
-            meshtastic_NodeInfoLite *node = nodeDB->getMeshNodeByIndex(i);
-
-            // Skip if no position
-            if (!nodeDB->hasValidPosition(node))
-                continue;
+        // For each node with a position
+        for (const NodePositionIndex::Entry &entry : nodeDB->getPositionIndex()) {
+            meshtastic_NodeInfoLite *node = nodeDB->getMeshNode(entry.num);
 
             // Skip if derived applet doesn't want to show this node on the map
-            if (!shouldDrawNode(node))
+            if (!node || !shouldDrawNode(node))
                 continue;
 
             // Latitude and Longitude of node, in radians
@@ -287,15 +283,11 @@ void InkHUD::MapApplet::getMapCenter(float *lat, float *lng)
     float easternmost = lngCenter;
     float westernmost = lngCenter;
 
-    for (size_t i = 0; i < nodeDB->getNumMeshNodes(); i++) {
-        meshtastic_NodeInfoLite *node = nodeDB->getMeshNodeByIndex(i);
-
-        // Skip if no position
-        if (!nodeDB->hasValidPosition(node))
-            continue;
+    for (const NodePositionIndex::Entry &entry : nodeDB->getPositionIndex()) {
+        meshtastic_NodeInfoLite *node = nodeDB->getMeshNode(entry.num);
 
         // Skip if derived applet doesn't want to show this node on the map
-        if (!shouldDrawNode(node))
+        if (!node || !shouldDrawNode(node))
             continue;
 
         // Check for a new top or bottom latitude
@@ -475,11 +467,11 @@ void InkHUD::MapApplet::drawLabeledMarker(meshtastic_NodeInfoLite *node)
 bool InkHUD::MapApplet::enoughMarkers()
 {
     size_t count = 0;
-    for (size_t i = 0; i < nodeDB->getNumMeshNodes(); i++) {
-        meshtastic_NodeInfoLite *node = nodeDB->getMeshNodeByIndex(i);
+    for (const NodePositionIndex::Entry &entry : nodeDB->getPositionIndex()) {
+        meshtastic_NodeInfoLite *node = nodeDB->getMeshNode(entry.num);
 
-        // Count nodes
-        if (nodeDB->hasValidPosition(node) && shouldDrawNode(node))
+        // Count nodes (only those with a valid position are indexed)
+        if (node && shouldDrawNode(node))
             count++;
 
         // We need to find two
@@ -497,16 +489,20 @@ void InkHUD::MapApplet::calculateAllMarkers()
     // Clear old markers
     markers.clear();
 
-    // For each node in db
-    for (uint32_t i = 0; i < nodeDB->getNumMeshNodes(); i++) {
-        meshtastic_NodeInfoLite *node = nodeDB->getMeshNodeByIndex(i);
+    // If we have a position, NodeDB's position index caches every node's distance and bearing from us.
+    // Offsetting those by where we sit relative to map center saves redoing the trig for each node, each render.
+    NodePositionIndex &positionIndex = nodeDB->getPositionIndex();
+    Marker ourMarker;
+    const NodePositionIndex::Entry *ourEntry = positionIndex.find(nodeDB->getNodeNum());
+    if (ourEntry)
+        ourMarker = calculateMarker(ourEntry->latitude_i * 1e-7, ourEntry->longitude_i * 1e-7, false, 0);
 
-        // Skip if no position
-        if (!nodeDB->hasValidPosition(node))
-            continue;
+    // For each node with a position
+    for (const NodePositionIndex::Entry &entry : positionIndex) {
+        meshtastic_NodeInfoLite *node = nodeDB->getMeshNode(entry.num);
 
         // Skip if derived applet doesn't want to show this node on the map
-        if (!shouldDrawNode(node))
+        if (!node || !shouldDrawNode(node))
             continue;
 
         // Skip if our own node
@@ -514,13 +510,24 @@ void InkHUD::MapApplet::calculateAllMarkers()
         if (node->num == nodeDB->getNodeNum())
             continue;
 
+        // Marker from the cached distance and bearing
+        float distance, bearing;
+        if (ourEntry && positionIndex.getDistanceBearing(node->num, &distance, &bearing)) {
+            Marker m;
+            m.eastMeters = ourMarker.eastMeters + sin(bearing) * distance;
+            m.northMeters = ourMarker.northMeters + cos(bearing) * distance;
+            m.hasHopsAway = node->has_hops_away;
+            m.hopsAway = node->hops_away;
+            markers.push_back(m);
+            continue;
+        }
+
         // Calculate marker and store it
-        markers.push_back(
-            calculateMarker(node->position.latitude_i * 1e-7,  // Lat, converted from Meshtastic's internal int32 style
-                            node->position.longitude_i * 1e-7, // Long, converted from Meshtastic's internal int32 style
-                            node->has_hops_away,               // Is the hopsAway number valid
-                            node->hops_away                    // Hops away
-                            ));
+        markers.push_back(calculateMarker(entry.latitude_i * 1e-7,  // Lat, converted from Meshtastic's internal int32 style
+                                          entry.longitude_i * 1e-7, // Long, converted from Meshtastic's internal int32 style
+                                          node->has_hops_away,      // Is the hopsAway number valid
+                                          node->hops_away           // Hops away
+                                          ));
     }
 }
 
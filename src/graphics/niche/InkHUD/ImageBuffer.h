@@ -0,0 +1,233 @@
+#ifdef MESHTASTIC_INCLUDE_INKHUD
+
+/*
+
+The 1-bit image which Renderer hands to the E-Ink driver
+
+- rows of bytes, 8 pixels per byte, leftmost pixel in the most significant bit
+- drawn to in the coordinates of the current display rotation
+- rotation is resolved once per rectangle or glyph, not once per pixel
+
+Rectangles are filled a byte at a time (memset for the middle of each row).
+Glyphs are copied a byte at a time when their rows run along the buffer's rows (rotation 0),
+otherwise pixel by pixel, stepping through the buffer without recalculating the rotation.
+
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+
+namespace NicheGraphics::InkHUD
+{
+
+class ImageBuffer
+{
+  public:
+    // Area which drawing is limited to, in rotated coordinates. Right and bottom are exclusive
+    struct Region {
+        int32_t left;
+        int32_t top;
+        int32_t right;
+        int32_t bottom;
+    };
+
+    // Use a buffer for a panel of this size (unrotated), which must hold ((width + 7) / 8) * height bytes
+    void begin(uint8_t *data, uint16_t width, uint16_t height)
+    {
+        this->data = data;
+        panelWidth = width;
+        panelHeight = height;
+        rowBytes = ((width - 1) / 8) + 1;
+    }
+
+    void setRotation(uint8_t rotation) { this->rotation = rotation & 3; }
+
+    // Size, in context of current rotation
+    uint16_t width() const { return (rotation & 1) ? panelHeight : panelWidth; }
+    uint16_t height() const { return (rotation & 1) ? panelWidth : panelHeight; }
+
+    // Set a single pixel. Value is 1 for white, 0 for black
+    void setPixel(int16_t x, int16_t y, uint8_t value)
+    {
+        if (x < 0 || y < 0 || x >= width() || y >= height())
+            return;
+        writeBit(bitAddress(x, y), value);
+    }
+
+    // Fill a rectangle, clipped to the display
+    void fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint8_t value)
+    {
+        if (w < 0) {
+            x += w;
+            w = -w;
+        }
+        if (h < 0) {
+            y += h;
+            h = -h;
+        }
+
+        // Rotate the rectangle, it is still a rectangle in the buffer
+        int32_t left = 0, top = 0, right = 0, bottom = 0;
+        switch (rotation) {
+        case 0:
+            left = x, top = y, right = x + w, bottom = y + h;
+            break;
+        case 1:
+            left = panelWidth - (y + h), top = x, right = panelWidth - y, bottom = x + w;
+            break;
+        case 2:
+            left = panelWidth - (x + w), top = panelHeight - (y + h), right = panelWidth - x, bottom = panelHeight - y;
+            break;
+        case 3:
+            left = y, top = panelHeight - (x + w), right = y + h, bottom = panelHeight - x;
+            break;
+        }
+
+        left = left < 0 ? 0 : left;
+        top = top < 0 ? 0 : top;
+        right = right > panelWidth ? panelWidth : right;
+        bottom = bottom > panelHeight ? panelHeight : bottom;
+        if (left >= right || top >= bottom)
+            return;
+
+        // Full width rows are one memset (unless the rows end in padding bits, which are left alone)
+        if (left == 0 && right == (int32_t)rowBytes * 8) {
+            memset(data + top * rowBytes, value ? 0xFF : 0x00, (bottom - top) * rowBytes);
+            return;
+        }
+
+        const uint32_t firstByte = left / 8;
+        const uint32_t lastByte = (right - 1) / 8;
+        const uint8_t leadingMask = 0xFF >> (left % 8);
+        const uint8_t trailingMask = 0xFF << (7 - ((right - 1) % 8));
+        for (int32_t row = top; row < bottom; row++) {
+            uint8_t *bytes = data + row * rowBytes;
+            if (firstByte == lastByte) {
+                writeMasked(bytes[firstByte], leadingMask & trailingMask, value);
+            } else {
+                writeMasked(bytes[firstByte], leadingMask, value);
+                if (lastByte > firstByte + 1)
+                    memset(bytes + firstByte + 1, value ? 0xFF : 0x00, lastByte - firstByte - 1);
+                writeMasked(bytes[lastByte], trailingMask, value);
+            }
+        }
+    }
+
+    // Set pixels wherever a bitmap has a 1 bit, leave the others as they were.
+    // The bitmap is w x h, in rows which are packed without padding, most significant bit first (as AdafruitGFX glyphs)
+    // Bits start at bitOffset. Only the part inside clip (and the display) is drawn.
+    void drawBits(int32_t x, int32_t y, const uint8_t *bits, uint32_t bitOffset, uint16_t w, uint16_t h, uint8_t value,
+                  const Region &clip)
+    {
+        // Part of the bitmap which is visible
+        int32_t left = clip.left > 0 ? clip.left : 0;
+        int32_t top = clip.top > 0 ? clip.top : 0;
+        int32_t right = clip.right < width() ? clip.right : width();
+        int32_t bottom = clip.bottom < height() ? clip.bottom : height();
+        const int32_t col0 = (left > x) ? left - x : 0;
+        const int32_t row0 = (top > y) ? top - y : 0;
+        const int32_t col1 = (right < x + w) ? right - x : w;
+        const int32_t row1 = (bottom < y + h) ? bottom - y : h;
+        if (col0 >= col1 || row0 >= row1)
+            return;
+
+        // How the buffer bit address changes when moving along a bitmap row, and down to the next row
+        const int32_t stride = rowBytes * 8;
+        int32_t stepX = 0, stepY = 0;
+        switch (rotation) {
+        case 0:
+            stepX = 1, stepY = stride;
+            break;
+        case 1:
+            stepX = stride, stepY = -1;
+            break;
+        case 2:
+            stepX = -1, stepY = -stride;
+            break;
+        case 3:
+            stepX = -stride, stepY = 1;
+            break;
+        }
+
+        int32_t rowAddress = bitAddress(x + col0, y + row0);
+        for (int32_t row = row0; row < row1; row++, rowAddress += stepY) {
+            uint32_t src = bitOffset + row * w + col0;
+            int32_t count = col1 - col0;
+            if (stepX == 1) {
+                // Bitmap row runs along a buffer row: copy a byte at a time
+                int32_t dst = rowAddress;
+                while (count > 0) {
+                    const int32_t n = count < 8 ? count : 8;
+                    const uint8_t chunk = readBits(bits, src, n);
+                    const uint16_t placed = (uint16_t)(chunk << 8) >> (dst % 8);
+                    writeMasked(data[dst / 8], placed >> 8, value);
+                    if (placed & 0xFF)
+                        writeMasked(data[dst / 8 + 1], placed & 0xFF, value);
+                    src += n;
+                    dst += n;
+                    count -= n;
+                }
+            } else {
+                int32_t dst = rowAddress;
+                for (; count > 0; count--, src++, dst += stepX) {
+                    if (bits[src / 8] & (0x80 >> (src % 8)))
+                        writeBit(dst, value);
+                }
+            }
+        }
+    }
+
+  private:
+    uint8_t *data = nullptr;
+    uint16_t panelWidth = 0;
+    uint16_t panelHeight = 0;
+    uint32_t rowBytes = 0;
+    uint8_t rotation = 0;
+
+    // Bit number of a pixel in the buffer, counting from the most significant bit of the first byte
+    int32_t bitAddress(int32_t x, int32_t y) const
+    {
+        int32_t px = x, py = y;
+        switch (rotation) {
+        case 1:
+            px = (panelWidth - 1) - y;
+            py = x;
+            break;
+        case 2:
+            px = (panelWidth - 1) - x;
+            py = (panelHeight - 1) - y;
+            break;
+        case 3:
+            px = y;
+            py = (panelHeight - 1) - x;
+            break;
+        }
+        return py * (int32_t)(rowBytes * 8) + px;
+    }
+
+    void writeBit(int32_t address, uint8_t value) { writeMasked(data[address / 8], 0x80 >> (address % 8), value); }
+
+    static void writeMasked(uint8_t &byte, uint8_t mask, uint8_t value)
+    {
+        if (value)
+            byte |= mask;
+        else
+            byte &= ~mask;
+    }
+
+    // Read n (1 to 8) bits starting at bit number first, left aligned in the result
+    static uint8_t readBits(const uint8_t *bits, uint32_t first, int32_t n)
+    {
+        const uint32_t shift = first % 8;
+        uint16_t word = bits[first / 8] << 8;
+        if (shift + n > 8) // Only touch the next byte if we need it, it may be past the end of the bitmap
+            word |= bits[first / 8 + 1];
+        return (uint8_t)((word << shift) >> 8) & (uint8_t)(0xFF << (8 - n));
+    }
+};
+
+} // namespace NicheGraphics::InkHUD
+
+#endif
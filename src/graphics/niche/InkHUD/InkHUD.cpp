@@ -376,4 +376,19 @@ void InkHUD::InkHUD::drawPixel(int16_t x, int16_t y, Color c)
     renderer->handlePixel(x, y, c);
 }
 
+// Place a filled rectangle into the image buffer
+// Same coordinates as drawPixel, already cropped by the applet and tile
+void InkHUD::InkHUD::fillRect(int16_t x, int16_t y, int16_t w, int16_t h, Color c)
+{
+    renderer->handleRect(x, y, w, h, c);
+}
+
+// Place the set bits of a bitmap (a font glyph) into the image buffer, within the clip region
+// Same coordinates as drawPixel
+void InkHUD::InkHUD::drawBits(int16_t x, int16_t y, const uint8_t *bits, uint32_t bitOffset, uint16_t w, uint16_t h, Color c,
+                              const ImageBuffer::Region &clip)
+{
+    renderer->handleBits(x, y, bits, bitOffset, w, h, c, clip);
+}
+
 #endif
\ No newline at end of file
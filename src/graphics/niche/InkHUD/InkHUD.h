@@ -15,6 +15,7 @@
 #include "graphics/niche/Drivers/EInk/EInk.h"
 
 #include "./AppletFont.h"
+#include "./ImageBuffer.h"
 
 #include <vector>
 
@@ -116,6 +117,9 @@ class InkHUD
 
     // Pass drawing output to Renderer
     void drawPixel(int16_t x, int16_t y, Color c);
+    void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, Color c);
+    void drawBits(int16_t x, int16_t y, const uint8_t *bits, uint32_t bitOffset, uint16_t w, uint16_t h, Color c,
+                  const ImageBuffer::Region &clip);
 
     // Shared data which persists between boots
     Persistence *persistence = nullptr;
@@ -42,6 +42,7 @@ void InkHUD::Renderer::setDriver(Drivers::EInk *driver)
 
     // Allocate the image buffer
     imageBuffer = new uint8_t[imageBufferWidth * imageBufferHeight];
+    image.begin(imageBuffer, driver->width, driver->height);
 }
 
 // Set the target number of FAST display updates in a row, before a FULL update is used for display health
@@ -112,15 +113,28 @@ void InkHUD::Renderer::awaitUpdate()
 }
 
 // Set a ready-to-draw pixel into the image buffer
-// All rotations / translations have already taken place: this buffer data is formatted ready for the driver
+// All translations have already taken place, the image buffer applies the display rotation
 void InkHUD::Renderer::handlePixel(int16_t x, int16_t y, Color c)
 {
-    rotatePixelCoords(&x, &y);
+    image.setRotation(settings->rotation);
+    image.setPixel(x, y, c);
+}
 
-    uint32_t byteNum = (y * imageBufferWidth) + (x / 8); // X data is 8 pixels per byte
-    uint8_t bitNum = 7 - (x % 8); // Invert order: leftmost bit (most significant) is leftmost pixel of byte.
+// Fill a rectangle of the image buffer
+// Rotated once for the whole rectangle, then written a byte at a time
+void InkHUD::Renderer::handleRect(int16_t x, int16_t y, int16_t w, int16_t h, Color c)
+{
+    image.setRotation(settings->rotation);
+    image.fillRect(x, y, w, h, c);
+}
 
-    bitWrite(imageBuffer[byteNum], bitNum, c);
+// Set the pixels of a bitmap (font glyph) in the image buffer, where its bits are set
+// Rotated once for the whole bitmap. Only drawn inside clip (the applet's crop, and its tile)
+void InkHUD::Renderer::handleBits(int16_t x, int16_t y, const uint8_t *bits, uint32_t bitOffset, uint16_t w, uint16_t h,
+                                  Color c, const ImageBuffer::Region &clip)
+{
+    image.setRotation(settings->rotation);
+    image.drawBits(x, y, bits, bitOffset, w, h, c, clip);
 }
 
 // Width of the display, relative to rotation
@@ -159,37 +173,6 @@ int32_t InkHUD::Renderer::runOnce()
         return OSThread::disable();
 }
 
-// Applies the system-wide rotation to pixel positions
-// This step is applied to image data which has already been translated by a Tile object
-// This is the final step before the pixel is placed into the image buffer
-// No return: values of the *x and *y parameters are modified by the method
-void InkHUD::Renderer::rotatePixelCoords(int16_t *x, int16_t *y)
-{
-    // Apply a global rotation to pixel locations
-    int16_t x1 = 0;
-    int16_t y1 = 0;
-    switch (settings->rotation) {
-    case 0:
-        x1 = *x;
-        y1 = *y;
-        break;
-    case 1:
-        x1 = (driver->width - 1) - *y;
-        y1 = *x;
-        break;
-    case 2:
-        x1 = (driver->width - 1) - *x;
-        y1 = (driver->height - 1) - *y;
-        break;
-    case 3:
-        x1 = *y;
-        y1 = (driver->height - 1) - *x;
-        break;
-    }
-    *x = x1;
-    *y = y1;
-}
-
 // Make an attempt to gather image data from some / all applets, and update the display
 // Might not be possible right now, if update already is progress.
 void InkHUD::Renderer::render(bool async)
@@ -266,71 +249,8 @@ void InkHUD::Renderer::clearBuffer()
 // Manually clear the pixels below a tile
 void InkHUD::Renderer::clearTile(Tile *t)
 {
-    // Rotate the tile dimensions
-    int16_t left = 0;
-    int16_t top = 0;
-    uint16_t tileW = 0;
-    uint16_t tileH = 0;
-    switch (settings->rotation) {
-    case 0:
-        left = t->getLeft();
-        top = t->getTop();
-        tileW = t->getWidth();
-        tileH = t->getHeight();
-        break;
-    case 1:
-        left = driver->width - (t->getTop() + t->getHeight());
-        top = t->getLeft();
-        tileW = t->getHeight();
-        tileH = t->getWidth();
-        break;
-    case 2:
-        left = driver->width - (t->getLeft() + t->getWidth());
-        top = driver->height - (t->getTop() + t->getHeight());
-        tileW = t->getWidth();
-        tileH = t->getHeight();
-        break;
-    case 3:
-        left = t->getTop();
-        top = driver->height - (t->getLeft() + t->getWidth());
-        tileW = t->getHeight();
-        tileH = t->getWidth();
-        break;
-    }
-
-    // Calculate the bounds to clear
-    uint16_t xStart = (left < 0) ? 0 : left;
-    uint16_t yStart = (top < 0) ? 0 : top;
-    if (xStart >= driver->width || yStart >= driver->height || left + tileW < 0 || top + tileH < 0)
-        return; // the box is completely off the screen
-    uint16_t xEnd = left + tileW;
-    uint16_t yEnd = top + tileH;
-    if (xEnd > driver->width)
-        xEnd = driver->width;
-    if (yEnd > driver->height)
-        yEnd = driver->height;
-
-    // Clear the pixels
-    if (xStart == 0 && xEnd == driver->width) { // full width box is easier to clear
-        memset(imageBuffer + (yStart * imageBufferWidth), 0xFF, (yEnd - yStart) * imageBufferWidth);
-    } else {
-        const uint16_t byteStart = (xStart / 8) + 1;
-        const uint16_t byteEnd = xEnd / 8;
-        const uint8_t leadingByte = 0xFF >> (xStart - ((byteStart - 1) * 8));
-        const uint8_t trailingByte = (0xFF00 >> (xEnd - (byteEnd * 8))) & 0xFF;
-        for (uint16_t i = yStart * imageBufferWidth; i < yEnd * imageBufferWidth; i += imageBufferWidth) {
-            // Set the leading byte
-            imageBuffer[i + byteStart - 1] |= leadingByte;
-
-            // Set the continuous bytes
-            if (byteStart < byteEnd)
-                memset(imageBuffer + i + byteStart, 0xFF, byteEnd - byteStart);
-
-            // Set the trailing byte
-            if (byteEnd != imageBufferWidth)
-                imageBuffer[i + byteEnd] |= trailingByte;
-        }
-    }
+    image.setRotation(settings->rotation);
+    image.fillRect(t->getLeft(), t->getTop(), t->getWidth(), t->getHeight(), WHITE);
 }
 
 void InkHUD::Renderer::checkLocks()
@@ -46,6 +46,9 @@ class Renderer : protected concurrency::OSThread
 
     // Receives pixel output from an applet (via a tile, which translates the coordinates)
     void handlePixel(int16_t x, int16_t y, Color c);
+    void handleRect(int16_t x, int16_t y, int16_t w, int16_t h, Color c);
+    void handleBits(int16_t x, int16_t y, const uint8_t *bits, uint32_t bitOffset, uint16_t w, uint16_t h, Color c,
+                    const ImageBuffer::Region &clip);
 
     // Size of display, in context of current rotation
 
@@ -56,9 +59,6 @@ class Renderer : protected concurrency::OSThread
     // Make attempts to render / update, once triggered by requestUpdate or forceUpdate
     int32_t runOnce() override;
 
-    // Apply the display rotation to handled pixels
-    void rotatePixelCoords(int16_t *x, int16_t *y);
-
     // Execute the render process now, then hand off to driver for display update
     void render(bool async = true);
 
@@ -80,6 +80,7 @@ class Renderer : protected concurrency::OSThread
     uint16_t imageBufferHeight = 0;
     uint16_t imageBufferWidth = 0;
     uint32_t imageBufferSize = 0; // Bytes
+    ImageBuffer image;            // Draws into imageBuffer, applying the display rotation
 
     SystemApplet *lockRendering = nullptr; // Render this applet *only*
     SystemApplet *lockRequests = nullptr;  // Honor update requests from this applet *only*
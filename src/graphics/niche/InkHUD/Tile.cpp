@@ -190,6 +190,33 @@ void InkHUD::Tile::handleAppletPixel(int16_t x, int16_t y, Color c)
     }
 }
 
+// Receive a filled rectangle from the assigned applet
+// Translated and cropped the same way as handleAppletPixel
+void InkHUD::Tile::handleAppletRect(int16_t x, int16_t y, int16_t w, int16_t h, Color c)
+{
+    // Move from applet-space to tile-space, and crop to tile borders
+    int16_t x0 = max(x + left, (int)left);
+    int16_t y0 = max(y + top, (int)top);
+    int16_t x1 = min(x + w + left, left + width);
+    int16_t y1 = min(y + h + top, top + height);
+
+    if (x0 < x1 && y0 < y1)
+        inkhud->fillRect(x0, y0, x1 - x0, y1 - y0, c);
+}
+
+// Receive the bitmap of a glyph from the assigned applet, with the region (applet's crop) it may draw in
+// Translated and cropped the same way as handleAppletPixel
+void InkHUD::Tile::handleAppletBits(int16_t x, int16_t y, const uint8_t *bits, uint32_t bitOffset, uint16_t w, uint16_t h,
+                                    Color c, ImageBuffer::Region clip)
+{
+    clip.left = max(clip.left + left, (int32_t)left);
+    clip.top = max(clip.top + top, (int32_t)top);
+    clip.right = min(clip.right + left, (int32_t)(left + width));
+    clip.bottom = min(clip.bottom + top, (int32_t)(top + height));
+
+    inkhud->drawBits(x + left, y + top, bits, bitOffset, w, h, c, clip);
+}
+
 // Used in Renderer for clearing the tile
 int16_t InkHUD::Tile::getLeft()
 {
@@ -29,6 +29,9 @@ class Tile
     void setRegion(uint8_t layoutSize, uint8_t tileIndex);                      // Assign region automatically, based on layout
     void setRegion(int16_t left, int16_t top, uint16_t width, uint16_t height); // Assign region manually
     void handleAppletPixel(int16_t x, int16_t y, Color c);                      // Receive px output from assigned applet
+    void handleAppletRect(int16_t x, int16_t y, int16_t w, int16_t h, Color c); // Receive filled rect from assigned applet
+    void handleAppletBits(int16_t x, int16_t y, const uint8_t *bits, uint32_t bitOffset, uint16_t w, uint16_t h, Color c,
+                          ImageBuffer::Region clip); // Receive glyph from assigned applet, drawn only within clip
     int16_t getLeft();
     int16_t getTop();
     uint16_t getWidth();
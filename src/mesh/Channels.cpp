@@ -73,7 +73,12 @@ meshtastic_Channel &Channels::fixupChannel(ChannelIndex chIndex)
             *meshtastic_channelSettings.name = '\0';
     }
 
+    generation++;
+    if (hashes[chIndex] >= 0)
+        channelsByHash[hashes[chIndex]] &= ~(1 << chIndex);
     hashes[chIndex] = generateHash(chIndex);
+    if (hashes[chIndex] >= 0)
+        channelsByHash[hashes[chIndex]] |= (1 << chIndex);
 
     return ch;
 }
@@ -337,6 +342,7 @@ void Channels::setChannel(const meshtastic_Channel &c)
                 channelFile.channels[i].role = meshtastic_Channel_Role_SECONDARY;
 
     old = c; // slam in the new settings/role
+    generation++;
 }
 
 bool Channels::anyMqttEnabled()
@@ -419,6 +425,12 @@ bool Channels::decryptForHash(ChannelIndex chIndex, ChannelHash channelHash)
     }
 }
 
+ChannelMask Channels::getChannelsForHash(ChannelHash channelHash)
+{
+    // Ignore channels past the end of the table, their hashes may be left over from a config with more channels
+    return channelsByHash[channelHash] & (ChannelMask)((1u << getNumChannels()) - 1);
+}
+
 bool Channels::setDefaultPresetCryptoForHash(ChannelHash channelHash)
 {
     // Iterate all known presets
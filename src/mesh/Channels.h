@@ -14,6 +14,11 @@ typedef uint8_t ChannelIndex;
  */
 typedef uint8_t ChannelHash;
 
+/** A set of channel indexes, bit n set means channel n is a member
+ */
+typedef uint8_t ChannelMask;
+static_assert(MAX_NUM_CHANNELS <= sizeof(ChannelMask) * 8, "ChannelMask too small for MAX_NUM_CHANNELS");
+
 /** The container/on device API for working with channels */
 class Channels
 {
@@ -28,6 +33,12 @@ class Channels
     /// the precomputed hashes for each of our channels, or -1 for invalid
     int16_t hashes[MAX_NUM_CHANNELS] = {};
 
+    /// for every possible channel hash, the channels that currently have it (inverse of hashes, kept in step by fixupChannel)
+    ChannelMask channelsByHash[256] = {};
+
+    /// bumped whenever channel settings may have changed
+    uint32_t generation = 1;
+
   public:
     Channels() {}
 
@@ -98,6 +109,15 @@ class Channels
 
     int16_t getHash(ChannelIndex i) { return hashes[i]; }
 
+    /// Changes whenever channel settings may have changed, so anything derived from them can be cached until then
+    uint32_t getGeneration() const { return generation; }
+
+    /** Return the channels whose hash matches, i.e. the only ones worth trying to decode a packet with that hash
+     *
+     * Usually zero or one bit is set, different channels only share a hash by chance.
+     */
+    ChannelMask getChannelsForHash(ChannelHash channelHash);
+
   private:
     /** Given a channel index, change to use the crypto key specified by that index
      *
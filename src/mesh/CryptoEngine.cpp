@@ -34,6 +34,7 @@ void CryptoEngine::generateKeyPair(uint8_t *pubKey, uint8_t *privKey)
 
     LOG_DEBUG("Generate Curve25519 keypair");
     Curve25519::dh1(public_key, private_key);
+    clearSharedKeyCache();
     memcpy(pubKey, public_key, sizeof(public_key));
     memcpy(privKey, private_key, sizeof(private_key));
 }
@@ -55,6 +56,7 @@ bool CryptoEngine::regeneratePublicKey(uint8_t *pubKey, uint8_t *privKey)
         }
         memcpy(private_key, privKey, sizeof(private_key));
         memcpy(public_key, pubKey, sizeof(public_key));
+        clearSharedKeyCache();
     } else {
         LOG_WARN("X25519 key generation failed due to blank private key");
         return false;
@@ -88,10 +90,9 @@ bool CryptoEngine::encryptCurve25519(uint32_t toNode, uint32_t fromNode, meshtas
         LOG_DEBUG("Node %d or their public_key not found", toNode);
         return false;
     }
-    if (!setDHPublicKey(remotePublic.bytes)) {
+    if (!loadSharedKey(remotePublic.bytes)) {
         return false;
     }
-    hash(shared_key, 32);
     initNonce(fromNode, packetNum, extraNonceTmp);
 
     // Calculate the shared secret with the destination node and encrypt
@@ -130,10 +131,9 @@ bool CryptoEngine::decryptCurve25519(uint32_t fromNode, meshtastic_UserLite_publ
     }
 
     // Calculate the shared secret with the sending node and decrypt
-    if (!setDHPublicKey(remotePublic.bytes)) {
+    if (!loadSharedKey(remotePublic.bytes)) {
         return false;
     }
-    hash(shared_key, 32);
 
     initNonce(fromNode, packetNum, extraNonce);
     printBytes("Attempt decrypt with nonce: ", nonce, 13);
@@ -144,6 +144,41 @@ bool CryptoEngine::decryptCurve25519(uint32_t fromNode, meshtastic_UserLite_publ
 void CryptoEngine::setDHPrivateKey(uint8_t *_private_key)
 {
     memcpy(private_key, _private_key, 32);
+    clearSharedKeyCache();
+}
+
+bool CryptoEngine::loadSharedKey(uint8_t *remotePublic)
+{
+    SharedKeyCacheEntry *oldest = &sharedKeyCache[0];
+    for (auto &entry : sharedKeyCache) {
+        if (entry.lastUsed && memcmp(entry.public_key, remotePublic, 32) == 0) {
+            entry.lastUsed = ++sharedKeyCacheClock;
+            memcpy(shared_key, entry.shared_key, 32);
+            sharedKeyCacheHits++;
+            return true;
+        }
+        if (entry.lastUsed < oldest->lastUsed)
+            oldest = &entry;
+    }
+
+    sharedKeyCacheMisses++;
+    if (!setDHPublicKey(remotePublic)) {
+        return false;
+    }
+    hash(shared_key, 32);
+
+    // Evict the least recently used entry, an empty one always wins since its lastUsed is 0
+    memcpy(oldest->public_key, remotePublic, 32);
+    memcpy(oldest->shared_key, shared_key, 32);
+    oldest->lastUsed = ++sharedKeyCacheClock;
+    return true;
+}
+
+void CryptoEngine::clearSharedKeyCache()
+{
+    // Wipe the derived keys rather than just marking the entries empty, they are as sensitive as private_key
+    memset(sharedKeyCache, 0, sizeof(sharedKeyCache));
+    sharedKeyCacheClock = 0;
 }
 
 /**
@@ -231,12 +266,7 @@ void CryptoEngine::decrypt(uint32_t fromNode, uint64_t packetId, size_t numBytes
 // Generic implementation of AES-CTR encryption.
 void CryptoEngine::encryptAESCtr(CryptoKey _key, uint8_t *_nonce, size_t numBytes, uint8_t *bytes)
 {
-    std::unique_ptr<CTRCommon> ctr;
-    if (_key.length == 16)
-        ctr = std::unique_ptr<CTRCommon>(new CTR<AES128>());
-    else
-        ctr = std::unique_ptr<CTRCommon>(new CTR<AES256>());
-    ctr->setKey(_key.bytes, _key.length);
+    CTRCommon *ctr = getAesCtr(_key);
     static uint8_t scratch[MAX_BLOCKSIZE];
     memcpy(scratch, bytes, numBytes);
     memset(scratch + numBytes, 0,
@@ -247,6 +277,28 @@ void CryptoEngine::encryptAESCtr(CryptoKey _key, uint8_t *_nonce, size_t numByte
     ctr->encrypt(bytes, scratch, numBytes);
 }
 
+CTRCommon *CryptoEngine::getAesCtr(const CryptoKey &k)
+{
+    AesCtrCacheEntry *oldest = &aesCtrCache[0];
+    for (auto &entry : aesCtrCache) {
+        if (entry.ctr && entry.key.length == k.length && memcmp(entry.key.bytes, k.bytes, k.length) == 0) {
+            entry.lastUsed = ++aesCtrCacheClock;
+            return entry.ctr.get();
+        }
+        if (entry.lastUsed < oldest->lastUsed)
+            oldest = &entry;
+    }
+
+    if (k.length == 16)
+        oldest->ctr = std::unique_ptr<CTRCommon>(new CTR<AES128>());
+    else
+        oldest->ctr = std::unique_ptr<CTRCommon>(new CTR<AES256>());
+    oldest->ctr->setKey(k.bytes, k.length);
+    oldest->key = k;
+    oldest->lastUsed = ++aesCtrCacheClock;
+    return oldest->ctr.get();
+}
+
 /**
  * Init our 128 bit nonce for a new packet
  */
@@ -22,6 +22,16 @@ struct CryptoKey {
  */
 
 #define MAX_BLOCKSIZE 256
+
+#ifndef AES_KEY_CACHE_SIZE
+/// Number of expanded channel keys kept by encryptAESCtr, so each packet does not redo the AES key schedule
+#define AES_KEY_CACHE_SIZE MAX_NUM_CHANNELS
+#endif
+
+#ifndef PKI_SHARED_KEY_CACHE_SIZE
+/// Number of remote public keys whose derived PKI shared key is kept, so repeat traffic with a peer skips the X25519 step
+#define PKI_SHARED_KEY_CACHE_SIZE 8
+#endif
 #define TEST_CURVE25519_FIELD_OPS // Exposes Curve25519::isWeakPoint() for testing keys
 
 class CryptoEngine
@@ -51,6 +61,11 @@ class CryptoEngine
     virtual void aesEncrypt(uint8_t *in, uint8_t *out);
     std::unique_ptr<AESSmall256> aes = nullptr;
 
+    /// Number of PKI packets whose shared key came from the cache
+    uint32_t getSharedKeyCacheHits() const { return sharedKeyCacheHits; }
+    /// Number of PKI packets that needed a full Curve25519 computation
+    uint32_t getSharedKeyCacheMisses() const { return sharedKeyCacheMisses; }
+
 #endif
 
     /**
@@ -81,6 +96,26 @@ class CryptoEngine
 #if !(MESHTASTIC_EXCLUDE_PKI)
     uint8_t shared_key[32] = {0};
     uint8_t private_key[32] = {0};
+
+    struct SharedKeyCacheEntry {
+        uint8_t public_key[32];
+        uint8_t shared_key[32]; // Already hashed, ready to use as the AES-CCM key
+        uint32_t lastUsed;      // 0 marks an empty entry
+    };
+    SharedKeyCacheEntry sharedKeyCache[PKI_SHARED_KEY_CACHE_SIZE] = {};
+    uint32_t sharedKeyCacheClock = 0;
+    uint32_t sharedKeyCacheHits = 0;
+    uint32_t sharedKeyCacheMisses = 0;
+
+    /**
+     * Put the hashed shared key for remotePublic in shared_key, from the cache if we have talked to this peer recently.
+     *
+     * @return false if the key exchange failed (e.g. a weak public key), failures are not cached
+     */
+    bool loadSharedKey(uint8_t *remotePublic);
+
+    /// Forget all cached shared keys, must be called whenever private_key changes
+    void clearSharedKeyCache();
 #endif
     /**
      * Init our 128 bit nonce for a new packet
@@ -91,6 +126,18 @@ class CryptoEngine
      * a 32 bit block counter (starts at zero)
      */
     void initNonce(uint32_t fromNode, uint64_t packetId, uint32_t extraNonce = 0);
+
+  private:
+    struct AesCtrCacheEntry {
+        CryptoKey key = {};
+        std::unique_ptr<CTRCommon> ctr; // Key already set, nullptr while the entry is unused
+        uint32_t lastUsed = 0;
+    };
+    AesCtrCacheEntry aesCtrCache[AES_KEY_CACHE_SIZE];
+    uint32_t aesCtrCacheClock = 0;
+
+    /// Return a CTR cipher with k already set, expanding the key only if it is not one of the recently used ones
+    CTRCommon *getAesCtr(const CryptoKey &k);
 };
 
 extern CryptoEngine *crypto;
\ No newline at end of file
@@ -0,0 +1,22 @@
+#include "DebugStats.h"
+#include "CryptoEngine.h"
+#include "MeshTypes.h"
+#include "PacketLatency.h"
+#include "RadioLibInterface.h"
+#include "configuration.h"
+
+void logDebugStats()
+{
+#if !(MESHTASTIC_EXCLUDE_PKI)
+    LOG_DEBUG("pki_shared_key_cache_hits=%u, pki_shared_key_cache_misses=%u", crypto->getSharedKeyCacheHits(),
+              crypto->getSharedKeyCacheMisses());
+#endif
+    LOG_DEBUG("packet_pool_in_use=%u, packet_pool_high_water=%u, packet_pool_alloc_failures=%u", packetPool.getNumInUse(),
+              packetPool.getHighWaterMark(), packetPool.getAllocFailures());
+    if (RadioLibInterface::instance && RadioLibInterface::instance->rebroadcastCWCount) {
+        const RadioLibInterface *radio = RadioLibInterface::instance;
+        LOG_DEBUG("rebroadcast_cw_count=%u, rebroadcast_cw_avg=%.1f, rebroadcast_cw_widened=%u", radio->rebroadcastCWCount,
+                  (float)radio->rebroadcastCWSum / radio->rebroadcastCWCount, radio->rebroadcastCWWidened);
+    }
+    packetLatency.log();
+}
@@ -0,0 +1,8 @@
+#pragma once
+
+/**
+ * LOG_DEBUG the counters kept to tune the mesh code: PKI shared key cache, packet pool, rebroadcast contention window
+ * and packet latency. Called whenever the local stats are reported, so new counters go here rather than into the
+ * telemetry module.
+ */
+void logDebugStats();
@@ -2,6 +2,7 @@
 
 #include <Arduino.h>
 #include <assert.h>
+#include <atomic>
 #include <functional>
 #include <memory>
 
@@ -69,11 +70,40 @@ template <class T> class Allocator
     /// Return a buffer for use by others
     virtual void release(T *p) = 0;
 
+    /// Number of objects currently handed out
+    uint32_t getNumInUse() const { return inUse; }
+
+    /// The most objects that were handed out at the same time, for sizing pools from field data
+    uint32_t getHighWaterMark() const { return highWaterMark; }
+
+    /// Number of allocations that failed because no storage was left
+    uint32_t getAllocFailures() const { return allocFailures; }
+
   protected:
     // Alloc some storage
     virtual T *alloc(TickType_t maxWait) = 0;
 
+    /// Update the usage counters after an alloc() attempt, safe to call from ISR
+    void countAlloc(bool succeeded)
+    {
+        if (!succeeded) {
+            allocFailures.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        uint32_t n = inUse.fetch_add(1, std::memory_order_relaxed) + 1;
+        uint32_t high = highWaterMark.load(std::memory_order_relaxed);
+        while (n > high && !highWaterMark.compare_exchange_weak(high, n, std::memory_order_relaxed))
+            ;
+    }
+
+    /// Update the usage counters after a successful release(), safe to call from ISR
+    void countRelease() { inUse.fetch_sub(1, std::memory_order_relaxed); }
+
   private:
+    std::atomic<uint32_t> inUse{0};
+    std::atomic<uint32_t> highWaterMark{0};
+    std::atomic<uint32_t> allocFailures{0};
+
     // std::unique_ptr Deleter function; calls release().
     const std::function<void(T *)> deleter;
 };
@@ -93,6 +123,7 @@ template <class T> class MemoryDynamic : public Allocator<T>
         LOG_HEAP("Freeing 0x%x", p);
 
         free(p);
+        this->countRelease();
     }
 
   protected:
@@ -101,25 +132,41 @@ template <class T> class MemoryDynamic : public Allocator<T>
     {
         T *p = (T *)malloc(sizeof(T));
         assert(p);
+        this->countAlloc(p != nullptr);
         return p;
     }
 };
 
 /**
  * A static memory pool that uses a fixed buffer instead of heap allocation
+ *
+ * Free slots form a singly linked list, so alloc() and release() are O(1). The list head is updated with a single
+ * compare-and-swap and carries a tag that changes on every update, so a slot that is popped and pushed back by an ISR
+ * in the middle of another alloc() can't corrupt the list (ABA). Both are safe to call from ISR.
  */
 template <class T, int MaxSize> class MemoryPool : public Allocator<T>
 {
   private:
+    // Slot numbers are 16 bit, the top two values are markers
+    static constexpr uint16_t END_OF_LIST = 0xFFFF;
+    static constexpr uint16_t IN_USE = 0xFFFE;
+    static_assert(MaxSize > 0 && MaxSize < IN_USE, "MemoryPool slot numbers are 16 bit");
+
     T pool[MaxSize];
-    bool used[MaxSize];
+    // For free slots the next free slot (or END_OF_LIST), IN_USE for slots that are handed out
+    std::atomic<uint16_t> next[MaxSize];
+    // Low 16 bits: first free slot, high 16 bits: tag bumped on every change
+    std::atomic<uint32_t> freeHead{0};
+
+    static uint32_t makeHead(uint32_t oldHead, uint16_t slot) { return ((oldHead + 0x10000) & 0xFFFF0000) | slot; }
 
   public:
-    MemoryPool() : pool{}, used{}
+    MemoryPool() : pool{}
     {
-        // Arrays are now zero-initialized by member initializer list
         // pool array: all elements are default-constructed (zero for POD types)
-        // used array: all elements are false (zero-initialized)
+        // every slot starts out free, linked in address order
+        for (int i = 0; i < MaxSize; i++)
+            next[i].store(i + 1 < MaxSize ? i + 1 : END_OF_LIST, std::memory_order_relaxed);
     }
 
     /// Return a buffer for use by others
@@ -133,8 +180,14 @@ template <class T, int MaxSize> class MemoryPool : public Allocator<T>
         // Find the index of this pointer in our pool
         int index = p - pool;
         if (index >= 0 && index < MaxSize) {
-            assert(used[index]); // Should be marked as used
-            used[index] = false;
+            assert(next[index].load(std::memory_order_relaxed) == IN_USE); // Should be marked as used
+            // Count before the slot can be taken again, so the high water mark never exceeds MaxSize
+            this->countRelease();
+            uint32_t head = freeHead.load(std::memory_order_relaxed);
+            do {
+                next[index].store(head & 0xFFFF, std::memory_order_relaxed);
+            } while (!freeHead.compare_exchange_weak(head, makeHead(head, index), std::memory_order_release,
+                                                     std::memory_order_relaxed));
             LOG_HEAP("Released static pool item %d at 0x%x", index, p);
         } else {
             LOG_WARN("Pointer 0x%x not from our pool!", p);
@@ -145,16 +198,23 @@ template <class T, int MaxSize> class MemoryPool : public Allocator<T>
     // Alloc some storage from our static pool
     virtual T *alloc(TickType_t maxWait) override
     {
-        // Find first free slot
-        for (int i = 0; i < MaxSize; i++) {
-            if (!used[i]) {
-                used[i] = true;
+        // Pop the first free slot
+        uint32_t head = freeHead.load(std::memory_order_acquire);
+        while ((head & 0xFFFF) != END_OF_LIST) {
+            uint16_t i = head & 0xFFFF;
+            // If another context took slot i meanwhile this reads garbage, but then the tag changed and the swap fails
+            uint16_t after = next[i].load(std::memory_order_relaxed);
+            if (freeHead.compare_exchange_weak(head, makeHead(head, after), std::memory_order_acquire,
+                                               std::memory_order_acquire)) {
+                next[i].store(IN_USE, std::memory_order_relaxed);
+                this->countAlloc(true);
                 LOG_HEAP("Allocated static pool item %d at 0x%x", i, &pool[i]);
                 return &pool[i];
             }
         }
 
         // No free slots available - return nullptr instead of asserting
+        this->countAlloc(false);
         LOG_WARN("No free slots available in static memory pool!");
         return nullptr;
     }
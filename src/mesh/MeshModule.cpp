@@ -8,6 +8,8 @@
 #include <assert.h>
 
 std::vector<MeshModule *> *MeshModule::modules;
+MeshModule::DispatchTable *MeshModule::dispatchTable;
+bool MeshModule::dispatchTableValid;
 
 const meshtastic_MeshPacket *MeshModule::currentRequest;
 uint8_t MeshModule::numPeriodicModules = 0;
@@ -25,6 +27,7 @@ MeshModule::MeshModule(const char *_name) : name(_name)
         modules = new std::vector<MeshModule *>();
 
     modules->push_back(this);
+    dispatchTableValid = false;
 }
 
 void MeshModule::setup() {}
@@ -34,6 +37,92 @@ MeshModule::~MeshModule()
     auto it = std::find(modules->begin(), modules->end(), this);
     assert(it != modules->end());
     modules->erase(it);
+    dispatchTableValid = false;
+}
+
+static bool portLess(const std::pair<meshtastic_PortNum, std::vector<MeshModule *>> &entry, meshtastic_PortNum port)
+{
+    return entry.first < port;
+}
+
+void MeshModule::buildDispatchTable()
+{
+    if (!dispatchTable)
+        dispatchTable = new DispatchTable();
+    auto &table = *dispatchTable;
+    table.byPort.clear();
+    table.otherPorts.clear();
+    table.encrypted.clear();
+
+    // A list for every claimed portnum
+    for (auto pi : *modules) {
+        meshtastic_PortNum port;
+        if (!pi->getDispatchPort(port))
+            continue;
+        auto it = std::lower_bound(table.byPort.begin(), table.byPort.end(), port, portLess);
+        if (it == table.byPort.end() || it->first != port)
+            table.byPort.insert(it, {port, {}});
+    }
+
+    // Fill them in creation order, modules which did not claim a portnum go in every list
+    for (auto pi : *modules) {
+        meshtastic_PortNum port;
+        bool claimed = pi->getDispatchPort(port);
+        for (auto &entry : table.byPort) {
+            if (!claimed || entry.first == port)
+                entry.second.push_back(pi);
+        }
+        if (!claimed)
+            table.otherPorts.push_back(pi);
+        if (pi->encryptedOk)
+            table.encrypted.push_back(pi);
+    }
+
+    dispatchTableValid = true;
+    LOG_DEBUG("Module dispatch: %u modules, %u portnums claimed, %u modules see every portnum", (unsigned)modules->size(),
+              (unsigned)table.byPort.size(), (unsigned)table.otherPorts.size());
+}
+
+const std::vector<MeshModule *> &MeshModule::modulesFor(const meshtastic_MeshPacket &mp)
+{
+    if (!dispatchTableValid)
+        buildDispatchTable();
+    auto &table = *dispatchTable;
+
+    if (mp.which_payload_variant != meshtastic_MeshPacket_decoded_tag)
+        return table.encrypted;
+
+    const meshtastic_PortNum port = mp.decoded.portnum;
+    auto it = std::lower_bound(table.byPort.begin(), table.byPort.end(), port, portLess);
+    if (it != table.byPort.end() && it->first == port)
+        return it->second;
+    return table.otherPorts;
+}
+
+bool MeshModule::isOnBoundChannel(ChannelIndex chIndex)
+{
+    if (boundChannelsGeneration != channels.getGeneration()) {
+        boundChannels = 0;
+        for (ChannelIndex i = 0; i < channels.getNumChannels() && i < MAX_NUM_CHANNELS; i++) {
+            if (strcasecmp(channels.getByIndex(i).settings.name, boundChannel) == 0)
+                boundChannels |= (1 << i);
+        }
+        boundChannelsGeneration = channels.getGeneration();
+    }
+    return chIndex < MAX_NUM_CHANNELS && (boundChannels & (1 << chIndex));
+}
+
+void MeshModule::logHandlingStats()
+{
+    if (!modules)
+        return;
+    for (auto pi : *modules) {
+        const HandlingStats &stats = pi->handlingStats;
+        if (stats.packets == 0)
+            continue;
+        LOG_DEBUG("Module '%s' handled %u packets, avg %u us, max %u us", pi->name, stats.packets,
+                  (uint32_t)(stats.totalMicros / stats.packets), stats.maxMicros);
+    }
 }
 
 // ⚠️ **Only call once** to set the initial delay before a module starts broadcasting periodically
@@ -101,7 +190,9 @@ void MeshModule::callModules(meshtastic_MeshPacket &mp, RxSource src)
     auto ourNodeNum = nodeDB->getNodeNum();
     bool toUs = isBroadcast(mp.to) || isToUs(&mp);
 
-    for (auto i = modules->begin(); i != modules->end(); ++i) {
+    // Only the modules which can want this packet, in the order they were created
+    const std::vector<MeshModule *> &candidates = modulesFor(mp);
+    for (auto i = candidates.begin(); i != candidates.end(); ++i) {
         auto &pi = **i;
 
         pi.currentRequest = &mp;
@@ -121,16 +212,13 @@ void MeshModule::callModules(meshtastic_MeshPacket &mp, RxSource src)
 
             moduleFound = true;
 
-            /// received channel (or NULL if not decoded)
-            meshtastic_Channel *ch = isDecoded ? &channels.getByIndex(mp.channel) : NULL;
-
             /// Is the channel this packet arrived on acceptable? (security check)
             /// Note: we can't know channel names for encrypted packets, so those are NEVER sent to boundChannel modules
 
             /// Also: if a packet comes in on the local PC interface, we don't check for bound channels, because it is TRUSTED and
             /// it needs to to be able to fetch the initial admin packets without yet knowing any channels.
 
-            bool rxChannelOk = !pi.boundChannel || (mp.from == 0) || (ch && strcasecmp(ch->settings.name, pi.boundChannel) == 0);
+            bool rxChannelOk = !pi.boundChannel || (mp.from == 0) || (isDecoded && pi.isOnBoundChannel(mp.channel));
 
             if (!rxChannelOk) {
                 // no one should have already replied!
@@ -142,9 +230,15 @@ void MeshModule::callModules(meshtastic_MeshPacket &mp, RxSource src)
                 } else
                     printPacket("packet on wrong channel, but can't respond", &mp);
             } else {
+                uint32_t started = micros();
                 ProcessMessage handled = pi.handleReceived(mp);
 
                 pi.alterReceived(mp);
+                uint32_t elapsed = micros() - started;
+                pi.handlingStats.packets++;
+                pi.handlingStats.totalMicros += elapsed;
+                if (elapsed > pi.handlingStats.maxMicros)
+                    pi.handlingStats.maxMicros = elapsed;
 
                 // Possibly send replies (but only if the message was directed to us specifically, i.e. not for promiscious
                 // sniffing) also: we only let the one module send a reply, once that happens, remaining modules are not
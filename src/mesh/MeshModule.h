@@ -76,6 +76,18 @@ class MeshModule
      */
     static void callModules(meshtastic_MeshPacket &mp, RxSource src = RX_SRC_RADIO);
 
+    /// Time a module has spent in handleReceived() and alterReceived()
+    struct HandlingStats {
+        uint32_t packets = 0;
+        uint64_t totalMicros = 0;
+        uint32_t maxMicros = 0;
+    };
+    const HandlingStats &getHandlingStats() const { return handlingStats; }
+    const char *getName() const { return name; }
+
+    /// Log the handling time of every module which has handled a packet
+    static void logHandlingStats();
+
     static std::vector<MeshModule *> GetMeshModulesWithUIFrames(int startIndex);
     static void observeUIEvents(Observer<const UIFrameEvent *> *observer);
     static AdminMessageHandleResult handleAdminMessageForAllModules(const meshtastic_MeshPacket &mp,
@@ -157,6 +169,15 @@ class MeshModule
      */
     virtual bool wantPacket(const meshtastic_MeshPacket *p) = 0;
 
+    /**
+     * If wantPacket() can only ever accept decoded packets for one portnum, say which, and callModules will not offer this
+     * module anything else. Return false (the default) to be asked about every packet.
+     */
+    virtual bool getDispatchPort(meshtastic_PortNum &port) const { return false; }
+
+    /// The modules callModules will offer a packet to, in the order they were created
+    static const std::vector<MeshModule *> &modulesFor(const meshtastic_MeshPacket &mp);
+
     /** Called to handle a particular incoming message
 
     @return ProcessMessage::STOP if you've guaranteed you've handled this message and no other handlers should be considered for
@@ -220,6 +241,25 @@ class MeshModule
 #endif
 
   private:
+    /// The modules callModules offers each packet to, in the order they were created
+    struct DispatchTable {
+        std::vector<std::pair<meshtastic_PortNum, std::vector<MeshModule *>>> byPort; // sorted by portnum
+        std::vector<MeshModule *> otherPorts; // decoded packets on a portnum which no module claims
+        std::vector<MeshModule *> encrypted;  // packets we could not decode
+    };
+
+    /// Built on first use after modules are created, and again after one is added or removed
+    static DispatchTable *dispatchTable;
+    static bool dispatchTableValid;
+    static void buildDispatchTable();
+
+    /// Channels named boundChannel, cached until the channel settings change
+    ChannelMask boundChannels = 0;
+    uint32_t boundChannelsGeneration = 0;
+    bool isOnBoundChannel(ChannelIndex chIndex);
+
+    HandlingStats handlingStats;
+
     /**
      * If any of the current chain of modules has already sent a reply, it will be here.  This is useful to allow
      * the RoutingModule to avoid sending redundant acks
@@ -3,7 +3,7 @@
 #include "configuration.h"
 #include <assert.h>
 
-#include <algorithm>
+#include <iterator>
 
 /// @return the priority of the specified packet
 inline uint32_t getPriority(const meshtastic_MeshPacket *p)
@@ -12,27 +12,25 @@ inline uint32_t getPriority(const meshtastic_MeshPacket *p)
     return pri;
 }
 
-/// @return "true" if "p1" is ordered before "p2"
-bool CompareMeshPacketFunc(const meshtastic_MeshPacket *p1, const meshtastic_MeshPacket *p2)
+/// @return "true" if this entry is ordered before "other"
+bool MeshPacketQueue::Entry::operator<(const Entry &other) const
 {
-    assert(p1 && p2);
-
-    // If one packet is in the late transmit window, prefer the other one
-    if ((bool)p1->tx_after != (bool)p2->tx_after) {
-        return !p1->tx_after;
-    }
-
-    auto p1p = getPriority(p1), p2p = getPriority(p2);
+    // Packets in the late transmit window live in their own set, so only priority and origin are compared here.
     // If priorities differ, use that
     // for equal priorities, prefer packets already on mesh.
-    return (p1p != p2p) ? (p1p > p2p) : (!isFromUs(p1) && isFromUs(p2));
+    if (priority != other.priority)
+        return priority > other.priority;
+    if (fromUs != other.fromUs)
+        return !fromUs;
+    // Otherwise first come, first served. Signed difference so the order survives seq wrapping around.
+    return (int32_t)(seq - other.seq) < 0;
 }
 
 MeshPacketQueue::MeshPacketQueue(size_t _maxLen) : maxLen(_maxLen) {}
 
 bool MeshPacketQueue::empty()
 {
-    return queue.empty();
+    return normal.empty() && late.empty();
 }
 
 /**
@@ -68,7 +66,7 @@ void fixPriority(meshtastic_MeshPacket *p)
 bool MeshPacketQueue::enqueue(meshtastic_MeshPacket *p, bool *dropped)
 {
     // no space - try to replace a lower priority packet in the queue
-    if (queue.size() >= maxLen) {
+    if (size() >= maxLen) {
         bool replaced = replaceLowerPriorityPacket(p);
         if (!replaced) {
             LOG_WARN("TX queue is full, and there is no lower-priority packet available to evict in favour of 0x%08x", p->id);
@@ -83,9 +81,11 @@ bool MeshPacketQueue::enqueue(meshtastic_MeshPacket *p, bool *dropped)
         *dropped = false;
     }
 
-    // Find the correct position using upper_bound to maintain a stable order
-    auto it = std::upper_bound(queue.begin(), queue.end(), p, CompareMeshPacketFunc);
-    queue.insert(it, p); // Insert packet at the found position
+    Entry e = {p, idKey(getFrom(p), p->id), nextSeq++, (uint8_t)getPriority(p), isFromUs(p)};
+    EntrySet &set = p->tx_after ? late : normal;
+    // Equal entries can't exist thanks to seq, so this always inserts
+    auto it = set.insert(e).first;
+    byId.emplace(e.key, it);
     return true;
 }
 
@@ -95,9 +95,10 @@ meshtastic_MeshPacket *MeshPacketQueue::dequeue()
         return NULL;
     }
 
-    auto *p = queue.front();
-    queue.erase(queue.begin()); // Remove the highest-priority packet
-    return p;
+    // Remove the highest-priority packet
+    if (!normal.empty())
+        return erase(normal, normal.begin());
+    return erase(late, late.begin());
 }
 
 meshtastic_MeshPacket *MeshPacketQueue::getFront()
@@ -106,36 +107,64 @@ meshtastic_MeshPacket *MeshPacketQueue::getFront()
         return NULL;
     }
 
-    auto *p = queue.front();
+    return normal.empty() ? late.begin()->p : normal.begin()->p;
+}
+
+meshtastic_MeshPacket *MeshPacketQueue::erase(EntrySet &set, EntrySet::iterator it)
+{
+    meshtastic_MeshPacket *p = it->p;
+    auto range = byId.equal_range(it->key);
+    for (auto i = range.first; i != range.second; ++i) {
+        if (i->second == it) {
+            byId.erase(i);
+            break;
+        }
+    }
+    set.erase(it);
     return p;
 }
 
-/** Get a packet from this queue. Returns a pointer to the packet, or NULL if not found. */
-meshtastic_MeshPacket *MeshPacketQueue::getPacketFromQueue(NodeNum from, PacketId id)
+template <typename Filter>
+std::unordered_multimap<uint64_t, MeshPacketQueue::EntrySet::iterator>::iterator
+MeshPacketQueue::findEntry(NodeNum from, PacketId id, Filter filter)
 {
-    for (auto it = queue.begin(); it != queue.end(); it++) {
-        auto p = (*it);
-        if (getFrom(p) == from && p->id == id) {
-            return p;
+    // The same packet may be queued more than once (e.g. a retransmission), pick the copy that goes out first
+    auto range = byId.equal_range(idKey(from, id));
+    auto found = byId.end();
+    for (auto i = range.first; i != range.second; ++i) {
+        const Entry &e = *i->second;
+        if (!filter(e.p))
+            continue;
+        if (found == byId.end()) {
+            found = i;
+            continue;
         }
+        const Entry &best = *found->second;
+        bool eLate = e.p->tx_after, bestLate = best.p->tx_after;
+        if (eLate != bestLate ? !eLate : e < best)
+            found = i;
     }
+    return found;
+}
 
-    return NULL;
+/** Get a packet from this queue. Returns a pointer to the packet, or NULL if not found. */
+meshtastic_MeshPacket *MeshPacketQueue::getPacketFromQueue(NodeNum from, PacketId id)
+{
+    auto found = findEntry(from, id, [](const meshtastic_MeshPacket *) { return true; });
+    return found != byId.end() ? found->second->p : NULL;
 }
 
 /** Attempt to find and remove a packet from this queue.  Returns a pointer to the removed packet, or NULL if not found */
 meshtastic_MeshPacket *MeshPacketQueue::remove(NodeNum from, PacketId id, bool tx_normal, bool tx_late, uint8_t hop_limit_lt)
 {
-    for (auto it = queue.begin(); it != queue.end(); it++) {
-        auto p = (*it);
-        if (getFrom(p) == from && p->id == id && ((tx_normal && !p->tx_after) || (tx_late && p->tx_after)) &&
-            (!hop_limit_lt || p->hop_limit < hop_limit_lt)) {
-            queue.erase(it);
-            return p;
-        }
-    }
+    auto found = findEntry(from, id, [&](const meshtastic_MeshPacket *p) {
+        return ((tx_normal && !p->tx_after) || (tx_late && p->tx_after)) && (!hop_limit_lt || p->hop_limit < hop_limit_lt);
+    });
+    if (found == byId.end())
+        return NULL;
 
-    return NULL;
+    auto it = found->second;
+    return erase(it->p->tx_after ? late : normal, it);
 }
 
 /* Attempt to find a packet from this queue. Return true if it was found. */
@@ -151,62 +180,61 @@ bool MeshPacketQueue::find(const NodeNum from, const PacketId id)
 bool MeshPacketQueue::replaceLowerPriorityPacket(meshtastic_MeshPacket *p)
 {
 
-    if (queue.empty()) {
+    if (empty()) {
         return false; // No packets to replace
     }
 
     // Check if the packet at the back has a lower priority than the new packet
-    auto *backPacket = queue.back();
-    if (!backPacket->tx_after && backPacket->priority < p->priority) {
-        LOG_WARN("Dropping packet 0x%08x to make room in the TX queue for higher-priority packet 0x%08x", backPacket->id, p->id);
-        // Remove the back packet
-        queue.pop_back();
-        packetPool.release(backPacket);
-        // Insert the new packet in the correct order
-        enqueue(p);
-        return true;
-    }
-
-    if (backPacket->tx_after) {
-        // Check if there's a non-late packet with lower priority
-        auto it = queue.end();
-        auto refPacket = *--it;
-        for (; refPacket->tx_after && it != queue.begin(); refPacket = *--it)
-            ;
-        if (!refPacket->tx_after && refPacket->priority < p->priority) {
-            LOG_WARN("Dropping non-late packet 0x%08x to make room in the TX queue for higher-priority packet 0x%08x",
-                     refPacket->id, p->id);
-            queue.erase(it);
-            packetPool.release(refPacket);
+    if (late.empty()) {
+        auto back = std::prev(normal.end());
+        if (back->priority < p->priority) {
+            LOG_WARN("Dropping packet 0x%08x to make room in the TX queue for higher-priority packet 0x%08x", back->p->id,
+                     p->id);
+            // Remove the back packet
+            packetPool.release(erase(normal, back));
             // Insert the new packet in the correct order
             enqueue(p);
             return true;
         }
+        // If the back packet's priority is not lower, no replacement occurs
+        return false;
     }
 
-    if (backPacket->tx_after) {
-        // Check if there's a late packet at the queue end
-        auto now = millis();
-        if (backPacket->tx_after < now && (!p->tx_after || backPacket->tx_after > p->tx_after)) {
-            int32_t dt = (int32_t)(backPacket->tx_after - now);
-            if (p->tx_after) {
-                LOG_WARN("Dropping late packet 0x%08x with TX delay %dms to make room in the TX queue for packet 0x%08x with "
-                         "TX delay %ums",
-                         backPacket->id, dt, p->id, p->tx_after - now);
-
-            } else {
-                LOG_WARN("Dropping late packet 0x%08x with TX delay %dms to make room in the TX queue for packet 0x%08x "
-                         "with no TX delay",
-                         backPacket->id, dt, p->id);
-            }
-            queue.pop_back();
-            packetPool.release(backPacket);
+    // Check if there's a non-late packet with lower priority
+    if (!normal.empty()) {
+        auto ref = std::prev(normal.end());
+        if (ref->priority < p->priority) {
+            LOG_WARN("Dropping non-late packet 0x%08x to make room in the TX queue for higher-priority packet 0x%08x",
+                     ref->p->id, p->id);
+            packetPool.release(erase(normal, ref));
             // Insert the new packet in the correct order
             enqueue(p);
             return true;
         }
     }
 
+    // Check if there's a late packet at the queue end
+    auto back = std::prev(late.end());
+    meshtastic_MeshPacket *backPacket = back->p;
+    auto now = millis();
+    if (backPacket->tx_after < now && (!p->tx_after || backPacket->tx_after > p->tx_after)) {
+        int32_t dt = (int32_t)(backPacket->tx_after - now);
+        if (p->tx_after) {
+            LOG_WARN("Dropping late packet 0x%08x with TX delay %dms to make room in the TX queue for packet 0x%08x with "
+                     "TX delay %ums",
+                     backPacket->id, dt, p->id, p->tx_after - now);
+
+        } else {
+            LOG_WARN("Dropping late packet 0x%08x with TX delay %dms to make room in the TX queue for packet 0x%08x "
+                     "with no TX delay",
+                     backPacket->id, dt, p->id);
+        }
+        packetPool.release(erase(late, back));
+        // Insert the new packet in the correct order
+        enqueue(p);
+        return true;
+    }
+
     // If the back packet's priority is not lower, no replacement occurs
     return false;
-}
\ No newline at end of file
+}
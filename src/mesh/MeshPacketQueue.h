@@ -2,15 +2,46 @@
 
 #include "MeshTypes.h"
 
-#include <queue>
+#include <set>
+#include <unordered_map>
 
 /**
  * A priority queue of packets
+ *
+ * Packets are kept in two ordered sets, one for packets that may be sent right away and one for packets in the late
+ * transmit window (tx_after set), plus a hash index on (from, id). Enqueue, dequeue and removal by id are O(log n),
+ * lookups by id are O(1).
  */
 class MeshPacketQueue
 {
+    /// The ordering fields of a queued packet, captured when it is enqueued
+    struct Entry {
+        meshtastic_MeshPacket *p;
+        uint64_t key; // idKey() of the packet, for finding it in byId again
+        uint32_t seq; // Enqueue order, keeps packets that otherwise compare equal in FIFO order
+        uint8_t priority;
+        bool fromUs;
+
+        /// @return true if this entry is sent before other
+        bool operator<(const Entry &other) const;
+    };
+
+    typedef std::set<Entry> EntrySet;
+
     size_t maxLen;
-    std::vector<meshtastic_MeshPacket *> queue;
+    uint32_t nextSeq = 0;
+    EntrySet normal; // Packets without tx_after, these always go before late ones
+    EntrySet late;   // Packets in the late transmit window
+    std::unordered_multimap<uint64_t, EntrySet::iterator> byId;
+
+    static uint64_t idKey(NodeNum from, PacketId id) { return ((uint64_t)from << 32) | id; }
+
+    /// Find the queued copy of (from, id) that is sent first among those accepted by filter, or byId.end()
+    template <typename Filter>
+    std::unordered_multimap<uint64_t, EntrySet::iterator>::iterator findEntry(NodeNum from, PacketId id, Filter filter);
+
+    /// Take the entry at it out of its set and the index, and return its packet
+    meshtastic_MeshPacket *erase(EntrySet &set, EntrySet::iterator it);
 
     /** Replace a lower priority package in the queue with 'mp' (provided there are lower pri packages). Return true if replaced.
      */
@@ -28,11 +59,14 @@ class MeshPacketQueue
     bool empty();
 
     /** return amount of free packets in Queue */
-    size_t getFree() { return maxLen - queue.size(); }
+    size_t getFree() { return maxLen - size(); }
 
     /** return total size of the Queue */
     size_t getMaxLen() { return maxLen; }
 
+    /** return number of packets in the Queue */
+    size_t size() const { return normal.size() + late.size(); }
+
     meshtastic_MeshPacket *dequeue();
 
     meshtastic_MeshPacket *getFront();
@@ -46,4 +80,4 @@ class MeshPacketQueue
 
     /* Attempt to find a packet from this queue. Return true if it was found. */
     bool find(const NodeNum from, const PacketId id);
-};
\ No newline at end of file
+};
@@ -305,6 +305,9 @@ void MeshService::sendToPhone(meshtastic_MeshPacket *p)
 {
     perhapsDecode(p);
 
+    // Before the StoreForward check, clients with their own queue do not read the StoreForward history
+    packetToPhone.notifyObservers(p);
+
 #ifdef ARCH_ESP32
 #if !MESHTASTIC_EXCLUDE_STOREFORWARD
     if (moduleConfig.store_forward.enabled && storeForwardModule->isServer() &&
@@ -316,6 +319,12 @@ void MeshService::sendToPhone(meshtastic_MeshPacket *p)
 #endif
 #endif
 
+    if (packetsFannedOut && sharedQueueReaders == 0) {
+        releaseToPool(p); // Only clients with their own copy are connected
+        fromNum++;
+        return;
+    }
+
     if (toPhoneQueue.numFree() == 0) {
         if (p->decoded.portnum == meshtastic_PortNum_TEXT_MESSAGE_APP ||
             p->decoded.portnum == meshtastic_PortNum_RANGE_TEST_APP) {
@@ -103,6 +103,17 @@ class MeshService
     /// Called when some new packets have arrived from one of the radios
     Observable<uint32_t> fromNumChanged;
 
+    /// Called with every packet for the phone, for clients which keep their own copy instead of reading toPhoneQueue
+    /// (several TCP API clients, see APIServerPort). The packet still belongs to MeshService.
+    Observable<const meshtastic_MeshPacket *> packetToPhone;
+
+    /// Set once some clients get their packets through packetToPhone. toPhoneQueue is then only filled while
+    /// sharedQueueReaders > 0, so it does not fill up with nobody reading it.
+    bool packetsFannedOut = false;
+
+    /// Connected API clients which read toPhoneQueue, counted by PhoneAPI
+    uint8_t sharedQueueReaders = 0;
+
     /// Called when radio config has changed (radios should observe this and set their hardware as required)
     Observable<void *> configChanged;
 
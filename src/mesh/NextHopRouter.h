@@ -87,6 +87,21 @@ class NextHopRouter : public FloodingRouter
         return min(d, r);
     }
 
+    /** Whether the node with ourRelayID may relay a packet asking for nextHop */
+    static bool mayRelay(uint8_t nextHop, uint8_t ourRelayID)
+    {
+        return nextHop == NO_NEXT_HOP_PREFERENCE || nextHop == ourRelayID;
+    }
+
+    /**
+     * Whether an ACK or reply shows that the node which relayed it to us is the next hop towards its sender: it also relayed
+     * the original packet, or we were the only relayer and the ACK came straight from the destination
+     */
+    static bool learnsNextHop(bool weWereRelayer, bool ackRelayerWasRelayer, bool weWereSoleRelayer, bool direct)
+    {
+        return (weWereRelayer && ackRelayerWasRelayer) || (direct && weWereSoleRelayer);
+    }
+
     // The number of retransmissions intermediate nodes will do (actually 1 less than this)
     constexpr static uint8_t NUM_INTERMEDIATE_RETX = 2;
     // The number of retransmissions the original sender will do
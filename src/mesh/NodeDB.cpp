@@ -443,6 +443,7 @@ NodeDB::NodeDB()
         config.has_position = true;
         info->has_position = true;
         info->position = TypeConversions::ConvertToPositionLite(fixedGPS);
+        updatePositionIndex(info);
         nodeDB->setLocalPosition(fixedGPS);
         config.position.fixed_position = true;
 #endif
@@ -541,6 +542,8 @@ void NodeDB::installDefaultNodeDatabase()
     nodeDatabase.nodes = std::vector<meshtastic_NodeInfoLite>(MAX_NUM_NODES);
     numMeshNodes = 0;
     meshNodes = &nodeDatabase.nodes;
+    reindexMeshNodes();
+    nodeJournal.invalidate();
 }
 
 void NodeDB::installDefaultConfig(bool preserveKey = false)
@@ -1012,21 +1015,24 @@ void NodeDB::resetNodes(bool keepFavorites)
 {
     if (!config.position.fixed_position)
         clearLocalPosition();
-    numMeshNodes = 1;
     if (keepFavorites) {
         LOG_INFO("Clearing node database - preserving favorites");
-        for (size_t i = 0; i < meshNodes->size(); i++) {
-            meshtastic_NodeInfoLite &node = meshNodes->at(i);
-            if (i > 0 && !node.is_favorite) {
-                node = meshtastic_NodeInfoLite();
-            } else {
-                numMeshNodes += 1;
-            }
-        };
     } else {
         LOG_INFO("Clearing node database - removing favorites");
-        std::fill(nodeDatabase.nodes.begin() + 1, nodeDatabase.nodes.end(), meshtastic_NodeInfoLite());
     }
+    // Entries are not stored in display order, so look for our own node (and favorites) by content rather than position
+    size_t newPos = 0;
+    for (size_t i = 0; i < numMeshNodes; i++) {
+        const meshtastic_NodeInfoLite &node = meshNodes->at(i);
+        if (node.num == getNodeNum() || (keepFavorites && node.is_favorite)) {
+            if (newPos != i)
+                meshNodes->at(newPos) = node;
+            newPos++;
+        }
+    }
+    std::fill(nodeDatabase.nodes.begin() + newPos, nodeDatabase.nodes.end(), meshtastic_NodeInfoLite());
+    numMeshNodes = newPos;
+    reindexMeshNodes();
     devicestate.has_rx_text_message = false;
     devicestate.has_rx_waypoint = false;
     saveNodeDatabaseToDisk();
@@ -1037,20 +1043,38 @@ void NodeDB::resetNodes(bool keepFavorites)
 
 void NodeDB::removeNodeByNum(NodeNum nodeNum)
 {
-    int newPos = 0, removed = 0;
-    for (int i = 0; i < numMeshNodes; i++) {
-        if (meshNodes->at(i).num != nodeNum)
-            meshNodes->at(newPos++) = meshNodes->at(i);
-        else
+    int removed = 0;
+    // A sweep rather than getMeshNode(): nodeIndex only holds the first of duplicate entries, and those must go as well.
+    // Going backwards, the entry eraseMeshNode() moves into the hole has already been looked at.
+    for (size_t i = numMeshNodes; i-- > 0;) {
+        if (meshNodes->at(i).num == nodeNum) {
+            eraseMeshNode(i);
             removed++;
+        }
     }
-    numMeshNodes -= removed;
-    std::fill(nodeDatabase.nodes.begin() + numMeshNodes, nodeDatabase.nodes.begin() + numMeshNodes + 1,
-              meshtastic_NodeInfoLite());
     LOG_DEBUG("NodeDB::removeNodeByNum purged %d entries. Save changes", removed);
     saveNodeDatabaseToDisk();
 }
 
+/// Remove the entry at storage position pos by moving the last entry into its place, so at most one entry moves
+void NodeDB::eraseMeshNode(size_t pos)
+{
+    size_t last = numMeshNodes - 1;
+    nodeOrder.remove(pos);
+    positionIndex.remove(meshNodes->at(pos).num);
+    nodeIndex.remove(meshNodes->at(pos).num);
+    if (pos != last) {
+        nodeIndex.remove(meshNodes->at(last).num);
+        nodeOrder.remove(last);
+        meshNodes->at(pos) = meshNodes->at(last);
+        nodeIndex.insert(pos);
+        nodeOrder.insert(pos);
+    }
+    meshNodes->at(last) = meshtastic_NodeInfoLite();
+    numMeshNodes--;
+    nodeIndex.setNumNodes(numMeshNodes);
+}
+
 void NodeDB::clearLocalPosition()
 {
     meshtastic_NodeInfoLite *node = getMeshNode(nodeDB->getNodeNum());
@@ -1058,6 +1082,7 @@ void NodeDB::clearLocalPosition()
     node->position.longitude_i = 0;
     node->position.altitude = 0;
     node->position.time = 0;
+    updatePositionIndex(node);
     setLocalPosition(meshtastic_Position_init_default);
     localPositionUpdatedSinceBoot = false;
 }
@@ -1083,6 +1108,7 @@ void NodeDB::cleanupMeshDB()
     numMeshNodes -= removed;
     std::fill(nodeDatabase.nodes.begin() + numMeshNodes, nodeDatabase.nodes.begin() + numMeshNodes + removed,
               meshtastic_NodeInfoLite());
+    reindexMeshNodes();
     LOG_DEBUG("cleanupMeshDB purged %d entries", removed);
 }
 
@@ -1147,6 +1173,8 @@ void NodeDB::pickNewNodeNum()
     LOG_DEBUG("Use nodenum 0x%x ", nodeNum);
 
     myNodeInfo.my_node_num = nodeNum;
+    positionIndex.setOurNode(nodeNum);
+    sortMeshDB(); // our own node is listed first
 }
 
 /** Load a protobuf from a file, return LoadFileResult */
@@ -1232,10 +1260,14 @@ void NodeDB::loadFromDisk()
 #endif
     auto state = loadProto(nodeDatabaseFileName, getMaxNodesAllocatedSize(), sizeof(meshtastic_NodeDatabase),
                            &meshtastic_NodeDatabase_msg, &nodeDatabase);
+    bool journalIntact = false;
+    size_t journalBytes = 0;
     if (nodeDatabase.version < DEVICESTATE_MIN_VER) {
         LOG_WARN("NodeDatabase %d is old, discard", nodeDatabase.version);
         installDefaultNodeDatabase();
     } else {
+        if (state == LoadFileResult::LOAD_SUCCESS)
+            journalIntact = replayNodeJournal(nodeDatabase.nodes, journalBytes);
         meshNodes = &nodeDatabase.nodes;
         numMeshNodes = nodeDatabase.nodes.size();
         LOG_INFO("Loaded saved nodedatabase version %d, with nodes count: %d", nodeDatabase.version, nodeDatabase.nodes.size());
@@ -1246,6 +1278,10 @@ void NodeDB::loadFromDisk()
         numMeshNodes = MAX_NUM_NODES;
     }
     meshNodes->resize(MAX_NUM_NODES);
+    reindexMeshNodes();
+    // Until we know what is on disk, the next save writes a whole new snapshot
+    if (journalIntact)
+        nodeJournal.markPersisted(meshNodes, numMeshNodes, journalBytes);
 
     // static DeviceState scratch; We no longer read into a tempbuf because this structure is 15KB of valuable RAM
     state = loadProto(deviceStateFileName, meshtastic_DeviceState_size, sizeof(meshtastic_DeviceState),
@@ -1519,11 +1555,80 @@ bool NodeDB::saveNodeDatabaseToDisk()
 #ifdef FSCom
     spiLock->lock();
     FSCom.mkdir("/prefs");
+    bool haveSnapshot = FSCom.exists(nodeDatabaseFileName);
+    spiLock->unlock();
+
+    // Append just the nodes that changed, unless the journal has grown big enough that a fresh snapshot is cheaper
+    if (haveSnapshot && nodeJournal.hasSnapshot() && nodeJournal.getJournalBytes() < NODEDB_JOURNAL_MAX_BYTES) {
+        std::vector<uint8_t> records;
+        if (nodeJournal.diff(meshNodes, numMeshNodes, NODEDB_JOURNAL_MAX_BYTES - nodeJournal.getJournalBytes(), records)) {
+            if (records.empty()) {
+                LOG_DEBUG("NodeDB unchanged since last save");
+                return true;
+            }
+            if (NodeDBJournal::appendToFile(nodeJournalFileName, records.data(), records.size())) {
+                nodeJournal.commit(records.size());
+                LOG_INFO("Journaled %u bytes of NodeDB changes, journal now %u bytes", (unsigned)records.size(),
+                         (unsigned)nodeJournal.getJournalBytes());
+                return true;
+            }
+        }
+    }
+
+    // The snapshot includes everything in the journal. Delete the journal first, so a stale one can never be replayed on
+    // top of a newer snapshot if we lose power in between.
+    spiLock->lock();
+    if (FSCom.exists(nodeJournalFileName))
+        FSCom.remove(nodeJournalFileName);
     spiLock->unlock();
 #endif
     size_t nodeDatabaseSize;
     pb_get_encoded_size(&nodeDatabaseSize, meshtastic_NodeDatabase_fields, &nodeDatabase);
-    return saveProto(nodeDatabaseFileName, nodeDatabaseSize, &meshtastic_NodeDatabase_msg, &nodeDatabase, false);
+    bool okay = saveProto(nodeDatabaseFileName, nodeDatabaseSize, &meshtastic_NodeDatabase_msg, &nodeDatabase, false);
+    if (okay)
+        nodeJournal.markPersisted(meshNodes, numMeshNodes);
+    else
+        nodeJournal.invalidate();
+    return okay;
+}
+
+bool NodeDB::replayNodeJournal(std::vector<meshtastic_NodeInfoLite> &nodes, size_t &journalBytes)
+{
+    std::vector<uint8_t> journal;
+    journalBytes = 0;
+    if (!NodeDBJournal::readFile(nodeJournalFileName, journal))
+        return true;
+    journalBytes = journal.size();
+
+    // Runs before the index is built, nodes may still hold the blank entries from the snapshot, so search by content
+    size_t pos = 0, applied = 0;
+    NodeDBJournal::RecordType type;
+    meshtastic_NodeInfoLite node;
+    while (pos < journal.size()) {
+        size_t len = NodeDBJournal::decodeRecord(journal.data() + pos, journal.size() - pos, type, node);
+        if (len == 0)
+            break;
+        pos += len;
+        applied++;
+
+        auto existing = std::find_if(nodes.begin(), nodes.end(),
+                                     [&node](const meshtastic_NodeInfoLite &n) { return n.num == node.num; });
+        if (type == NodeDBJournal::RECORD_REMOVE) {
+            if (existing != nodes.end())
+                nodes.erase(existing);
+        } else if (existing != nodes.end()) {
+            *existing = node;
+        } else {
+            nodes.push_back(node);
+        }
+    }
+    LOG_INFO("Replayed %u NodeDB journal records", (unsigned)applied);
+
+    if (pos < journal.size()) {
+        LOG_WARN("NodeDB journal damaged after %u of %u bytes, ignore the rest", (unsigned)pos, (unsigned)journal.size());
+        return false;
+    }
+    return true;
 }
 
 bool NodeDB::saveToDiskNoRetry(int saveWhat)
@@ -1622,7 +1727,7 @@ bool NodeDB::saveToDisk(int saveWhat)
 const meshtastic_NodeInfoLite *NodeDB::readNextMeshNode(uint32_t &readIndex)
 {
     if (readIndex < numMeshNodes)
-        return &meshNodes->at(readIndex++);
+        return &meshNodes->at(nodeOrder.at(readIndex++));
     else
         return NULL;
 }
@@ -1727,6 +1832,7 @@ void NodeDB::updatePosition(uint32_t nodeId, const meshtastic_Position &p, RxSou
             info->position.time = tmp_time;
     }
     info->has_position = true;
+    updatePositionIndex(info);
     updateGUIforNode = info;
     notifyObservers(true); // Force an update whether or not our node counts have changed
 }
@@ -1782,6 +1888,7 @@ void NodeDB::addFromContact(meshtastic_SharedContact contact)
         info->is_favorite = false;
         info->has_device_metrics = false;
         info->has_position = false;
+        updatePositionIndex(info);
         info->user.public_key.size = 0;
         memset(info->user.public_key.bytes, 0, sizeof(info->user.public_key.bytes));
     } else {
@@ -1811,9 +1918,10 @@ void NodeDB::addFromContact(meshtastic_SharedContact contact)
         }
         // Mark the node's key as manually verified to indicate trustworthiness.
         updateGUIforNode = info;
-        sortMeshDB();
         notifyObservers(true); // Force an update whether or not our node counts have changed
     }
+    // Either branch may have changed is_favorite
+    updateNodeOrder(info);
     saveNodeDatabaseToDisk();
 }
 
@@ -1924,7 +2032,7 @@ void NodeDB::updateFrom(const meshtastic_MeshPacket &mp)
             info->has_hops_away = true;
             info->hops_away = hopsAway;
         }
-        sortMeshDB();
+        updateNodeOrder(info);
     }
 }
 
@@ -1933,7 +2041,7 @@ void NodeDB::set_favorite(bool is_favorite, uint32_t nodeId)
     meshtastic_NodeInfoLite *lite = getMeshNode(nodeId);
     if (lite && lite->is_favorite != is_favorite) {
         lite->is_favorite = is_favorite;
-        sortMeshDB();
+        updateNodeOrder(lite);
         saveNodeDatabaseToDisk();
     }
 }
@@ -2000,36 +2108,43 @@ bool NodeDB::isFromOrToFavoritedNode(const meshtastic_MeshPacket &p)
 void NodeDB::pause_sort(bool paused)
 {
     sortingIsPaused = paused;
+    if (!sortingIsPaused && nodeOrderIsStale)
+        sortMeshDB();
 }
 
+/// Full re-sort of the display order, only needed after sorting was paused or our node number changed.
+/// Only the 16 bit links in nodeOrder change, the NodeInfoLite entries themselves never move.
 void NodeDB::sortMeshDB()
 {
-    if (!sortingIsPaused && (lastSort == 0 || !Throttle::isWithinTimespanMs(lastSort, 1000 * 5))) {
-        lastSort = millis();
-        bool changed = true;
-        while (changed) { // dumb reverse bubble sort, but probably not bad for what we're doing
-            changed = false;
-            for (int i = numMeshNodes - 1; i > 0; i--) { // lowest case this should examine is i == 1
-                if (meshNodes->at(i - 1).num == getNodeNum()) {
-                    // noop
-                } else if (meshNodes->at(i).num ==
-                           getNodeNum()) { // in the oddball case our own node num is not at location 0, put it there
-                    // TODO: Look for at(i-1) also matching own node num, and throw the DB in the trash
-                    std::swap(meshNodes->at(i), meshNodes->at(i - 1));
-                    changed = true;
-                } else if (meshNodes->at(i).is_favorite && !meshNodes->at(i - 1).is_favorite) {
-                    std::swap(meshNodes->at(i), meshNodes->at(i - 1));
-                    changed = true;
-                } else if (!meshNodes->at(i).is_favorite && meshNodes->at(i - 1).is_favorite) {
-                    // noop
-                } else if (meshNodes->at(i).last_heard > meshNodes->at(i - 1).last_heard) {
-                    std::swap(meshNodes->at(i), meshNodes->at(i - 1));
-                    changed = true;
-                }
-            }
-        }
-        LOG_INFO("Sort took %u milliseconds", millis() - lastSort);
+    if (sortingIsPaused) {
+        nodeOrderIsStale = true;
+        return;
+    }
+    uint32_t start = millis();
+    nodeOrder.rebuild(meshNodes, numMeshNodes, getNodeNum());
+    nodeOrderIsStale = false;
+    LOG_DEBUG("Sort took %u milliseconds", millis() - start);
+}
+
+void NodeDB::updateNodeOrder(const meshtastic_NodeInfoLite *node)
+{
+    if (!node || node < meshNodes->data() || node >= meshNodes->data() + numMeshNodes)
+        return;
+    if (sortingIsPaused) {
+        nodeOrderIsStale = true;
+        return;
     }
+    nodeOrder.update(node - meshNodes->data());
+}
+
+/// Rebuild the NodeNum and position indexes and display order after entries were compacted or reloaded
+void NodeDB::reindexMeshNodes()
+{
+    nodeIndex.rebuild(meshNodes, numMeshNodes);
+    positionIndex.rebuild(meshNodes, numMeshNodes, getNodeNum());
+    // The order has to cover the moved entries even while sorting is paused, rebuilding it sorts them anyway
+    nodeOrder.rebuild(meshNodes, numMeshNodes, getNodeNum());
+    nodeOrderIsStale = false;
 }
 
 uint8_t NodeDB::getMeshNodeChannel(NodeNum n)
@@ -2052,11 +2167,11 @@ std::string NodeDB::getNodeId() const
 /// NOTE: This function might be called from an ISR
 meshtastic_NodeInfoLite *NodeDB::getMeshNode(NodeNum n)
 {
-    for (int i = 0; i < numMeshNodes; i++)
-        if (meshNodes->at(i).num == n)
-            return &meshNodes->at(i);
+    int32_t i = nodeIndex.find(n);
+    if (i == NodeNumIndex::NOT_FOUND)
+        return NULL;
 
-    return NULL;
+    return &meshNodes->at(i);
 }
 
 // returns true if the maximum number of nodes is reached or we are running low on memory
@@ -2071,6 +2186,8 @@ meshtastic_NodeInfoLite *NodeDB::getOrCreateMeshNode(NodeNum n)
     meshtastic_NodeInfoLite *lite = getMeshNode(n);
 
     if (!lite) {
+        // by default add the node at the end
+        size_t pos = numMeshNodes;
         if (isFull()) {
             LOG_INFO("Node database full with %i nodes and %u bytes free. Erasing oldest entry", numMeshNodes,
                      memGet.getFreeHeap());
@@ -2079,7 +2196,9 @@ meshtastic_NodeInfoLite *NodeDB::getOrCreateMeshNode(NodeNum n)
             uint32_t oldestBoring = UINT32_MAX;
             int oldestIndex = -1;
             int oldestBoringIndex = -1;
-            for (int i = 1; i < numMeshNodes; i++) {
+            for (int i = 0; i < numMeshNodes; i++) {
+                if (meshNodes->at(i).num == getNodeNum())
+                    continue;
                 // Simply the oldest non-favorite, non-ignored, non-verified node
                 if (!meshNodes->at(i).is_favorite && !meshNodes->at(i).is_ignored &&
                     !(meshNodes->at(i).bitfield & NODEINFO_BITFIELD_IS_KEY_MANUALLY_VERIFIED_MASK) &&
@@ -2100,19 +2219,23 @@ meshtastic_NodeInfoLite *NodeDB::getOrCreateMeshNode(NodeNum n)
             }
 
             if (oldestIndex != -1) {
-                // Shove the remaining nodes down the chain
-                for (int i = oldestIndex; i < numMeshNodes - 1; i++) {
-                    meshNodes->at(i) = meshNodes->at(i + 1);
-                }
+                // Reuse the evicted entry in place, storage order does not matter so nothing else has to move
+                nodeOrder.remove(oldestIndex);
+                positionIndex.remove(meshNodes->at(oldestIndex).num);
+                nodeIndex.remove(meshNodes->at(oldestIndex).num);
+                pos = oldestIndex;
                 (numMeshNodes)--;
             }
         }
-        // add the node at the end
-        lite = &meshNodes->at((numMeshNodes)++);
+        lite = &meshNodes->at(pos);
+        (numMeshNodes)++;
 
         // everything is missing except the nodenum
         memset(lite, 0, sizeof(*lite));
         lite->num = n;
+        nodeIndex.insert(pos);
+        // Added even while sorting is paused, so the node can be listed; its place is fixed when sorting resumes
+        nodeOrder.insert(pos);
         LOG_INFO("Adding node to database with %i nodes and %u bytes free!", numMeshNodes, memGet.getFreeHeap());
     }
 
@@ -2255,6 +2378,13 @@ void recordCriticalError(meshtastic_CriticalErrorCode code, uint32_t address, co
     error_code = code;
     error_address = address;
 
+#if LOG_BINARY_TRACE
+    // Keep what led up to this, unless writing to flash is what failed
+    if (console && code != meshtastic_CriticalErrorCode_FLASH_CORRUPTION_RECOVERABLE &&
+        code != meshtastic_CriticalErrorCode_FLASH_CORRUPTION_UNRECOVERABLE)
+        console->requestBinaryLogSave();
+#endif
+
     // Currently portuino is mostly used for simulation.  Make sure the user notices something really bad happened
 #ifdef ARCH_PORTDUINO
     LOG_ERROR("A critical failure occurred");
@@ -9,6 +9,10 @@
 #include <vector>
 
 #include "MeshTypes.h"
+#include "NodeDBJournal.h"
+#include "NodeNumIndex.h"
+#include "NodeOrderIndex.h"
+#include "NodePositionIndex.h"
 #include "NodeStatus.h"
 #include "configuration.h"
 #include "mesh-pb-constants.h"
@@ -98,6 +102,7 @@ extern meshtastic_Position localPosition;
 static constexpr const char *deviceStateFileName = "/prefs/device.proto";
 static constexpr const char *legacyPrefFileName = "/prefs/db.proto";
 static constexpr const char *nodeDatabaseFileName = "/prefs/nodes.proto";
+static constexpr const char *nodeJournalFileName = "/prefs/nodes.journal";
 static constexpr const char *configFileName = "/prefs/config.proto";
 static constexpr const char *uiconfigFileName = "/prefs/uiconfig.proto";
 static constexpr const char *moduleConfigFileName = "/prefs/module.proto";
@@ -205,6 +210,21 @@ class NodeDB
      */
     void pause_sort(bool paused);
 
+    /**
+     * Move a node to its place in the display order after its is_favorite or last_heard changed.
+     * Code that edits those fields directly (rather than through set_favorite/updateFrom) must call this.
+     */
+    void updateNodeOrder(const meshtastic_NodeInfoLite *node);
+
+    /**
+     * Re-index a node after its has_position or position changed.
+     * Code that edits those fields directly (rather than through updatePosition) must call this.
+     */
+    void updatePositionIndex(const meshtastic_NodeInfoLite *node) { positionIndex.update(node); }
+
+    /// Nodes with a valid position, for map and distance queries
+    NodePositionIndex &getPositionIndex() { return positionIndex; }
+
     /// @return our node number
     NodeNum getNodeNum() { return myNodeInfo.my_node_num; }
 
@@ -247,10 +267,11 @@ class NodeDB
 
     const meshtastic_NodeInfoLite *readNextMeshNode(uint32_t &readIndex);
 
+    /// @return the x'th node in display order (our node, favorites, then most recently heard)
     meshtastic_NodeInfoLite *getMeshNodeByIndex(size_t x)
     {
         assert(x < numMeshNodes);
-        return &meshNodes->at(x);
+        return &meshNodes->at(nodeOrder.at(x));
     }
 
     virtual meshtastic_NodeInfoLite *getMeshNode(NodeNum n);
@@ -310,9 +331,12 @@ class NodeDB
   private:
     bool duplicateWarned = false;
     bool localPositionUpdatedSinceBoot = false;
-    uint32_t lastNodeDbSave = 0;    // when we last saved our db to flash
-    uint32_t lastBackupAttempt = 0; // when we last tried a backup automatically or manually
-    uint32_t lastSort = 0;          // When last sorted the nodeDB
+    uint32_t lastNodeDbSave = 0;     // when we last saved our db to flash
+    uint32_t lastBackupAttempt = 0;  // when we last tried a backup automatically or manually
+    NodeNumIndex nodeIndex;          // NodeNum -> position in meshNodes, must be rebuilt whenever entries move
+    NodePositionIndex positionIndex; // nodes with a valid position by grid cell, with cached distance from ours
+    NodeDBJournal nodeJournal;       // what of meshNodes is on disk, so saves only append the changes
+    NodeOrderIndex nodeOrder;        // positions in meshNodes in display order, must be rebuilt whenever entries move
     /// Find a node in our DB, create an empty NodeInfoLite if missing
     meshtastic_NodeInfoLite *getOrCreateMeshNode(NodeNum n);
 
@@ -320,6 +344,7 @@ class NodeDB
      * Internal boolean to track sorting paused
      */
     bool sortingIsPaused = false;
+    bool nodeOrderIsStale = false; // an order update was skipped while sorting was paused
 
     /// pick a provisional nodenum we hope no one is using
     void pickNewNodeNum();
@@ -327,6 +352,9 @@ class NodeDB
     /// read our db from flash
     void loadFromDisk();
 
+    /// apply the changes journaled since the last nodes.proto snapshot, @return false if the journal was damaged
+    bool replayNodeJournal(std::vector<meshtastic_NodeInfoLite> &nodes, size_t &journalBytes);
+
     /// purge db entries without user info
     void cleanupMeshDB();
 
@@ -342,6 +370,9 @@ class NodeDB
     bool saveDeviceStateToDisk();
     bool saveNodeDatabaseToDisk();
     void sortMeshDB();
+
+    void eraseMeshNode(size_t pos);
+    void reindexMeshNodes();
 };
 
 extern NodeDB *nodeDB;
@@ -0,0 +1,176 @@
+#include "NodeDBJournal.h"
+#include "FSCommon.h"
+#include "SPILock.h"
+#include "configuration.h"
+#include "mesh-pb-constants.h"
+#include <ErriezCRC32.h>
+#include <string.h>
+
+void NodeDBJournal::markPersisted(const std::vector<meshtastic_NodeInfoLite> *nodes, size_t numNodes, size_t journalBytes)
+{
+    persisted.clear();
+    pending.clear();
+    persisted.reserve(numNodes);
+    for (size_t i = 0; i < numNodes; i++) {
+        if (nodes->at(i).num != 0) // blank entries are never journaled
+            persisted[nodes->at(i).num] = nodeCrc(nodes->at(i));
+    }
+    this->journalBytes = journalBytes;
+    snapshotValid = true;
+}
+
+void NodeDBJournal::invalidate()
+{
+    persisted.clear();
+    pending.clear();
+    journalBytes = 0;
+    snapshotValid = false;
+}
+
+bool NodeDBJournal::diff(const std::vector<meshtastic_NodeInfoLite> *nodes, size_t numNodes, size_t maxBytes,
+                         std::vector<uint8_t> &out)
+{
+    out.clear();
+    pending.clear();
+    pending.reserve(numNodes);
+
+    uint8_t record[MAX_RECORD_SIZE];
+    for (size_t i = 0; i < numNodes; i++) {
+        const meshtastic_NodeInfoLite &node = nodes->at(i);
+        if (node.num == 0)
+            continue;
+        uint32_t crc = nodeCrc(node);
+        pending[node.num] = crc;
+
+        auto it = persisted.find(node.num);
+        if (it != persisted.end() && it->second == crc)
+            continue;
+        size_t len = encodeUpsert(node, record, sizeof(record));
+        if (len == 0 || out.size() + len > maxBytes)
+            return false;
+        out.insert(out.end(), record, record + len);
+    }
+
+    for (const auto &entry : persisted) {
+        if (pending.count(entry.first))
+            continue;
+        size_t len = encodeRemove(entry.first, record, sizeof(record));
+        if (out.size() + len > maxBytes)
+            return false;
+        out.insert(out.end(), record, record + len);
+    }
+    return true;
+}
+
+void NodeDBJournal::commit(size_t appendedBytes)
+{
+    persisted.swap(pending);
+    pending.clear();
+    journalBytes += appendedBytes;
+}
+
+size_t NodeDBJournal::encodeUpsert(const meshtastic_NodeInfoLite &node, uint8_t *buf, size_t bufSize)
+{
+    if (bufSize < MAX_RECORD_SIZE)
+        return 0;
+    // An all default node encodes to nothing, anything else encoding to nothing is a failure
+    size_t payloadLen = pb_encode_to_bytes(buf + 3, bufSize - RECORD_OVERHEAD, &meshtastic_NodeInfoLite_msg, &node);
+    if (payloadLen == 0 && node.num != 0)
+        return 0;
+    return finishRecord(RECORD_UPSERT, buf, payloadLen);
+}
+
+size_t NodeDBJournal::encodeRemove(NodeNum n, uint8_t *buf, size_t bufSize)
+{
+    if (bufSize < RECORD_OVERHEAD + 4)
+        return 0;
+    for (int i = 0; i < 4; i++)
+        buf[3 + i] = (n >> (8 * i)) & 0xff;
+    return finishRecord(RECORD_REMOVE, buf, 4);
+}
+
+size_t NodeDBJournal::finishRecord(RecordType type, uint8_t *buf, size_t payloadLen)
+{
+    buf[0] = type;
+    buf[1] = payloadLen & 0xff;
+    buf[2] = (payloadLen >> 8) & 0xff;
+    uint32_t crc = crc32Buffer(buf, 3 + payloadLen);
+    for (int i = 0; i < 4; i++)
+        buf[3 + payloadLen + i] = (crc >> (8 * i)) & 0xff;
+    return payloadLen + RECORD_OVERHEAD;
+}
+
+size_t NodeDBJournal::decodeRecord(const uint8_t *buf, size_t len, RecordType &type, meshtastic_NodeInfoLite &node)
+{
+    if (len < RECORD_OVERHEAD)
+        return 0;
+    size_t payloadLen = buf[1] | (buf[2] << 8);
+    if (payloadLen > meshtastic_NodeInfoLite_size || len < payloadLen + RECORD_OVERHEAD)
+        return 0;
+
+    const uint8_t *crcBytes = buf + 3 + payloadLen;
+    uint32_t crc = crcBytes[0] | (crcBytes[1] << 8) | (crcBytes[2] << 16) | ((uint32_t)crcBytes[3] << 24);
+    if (crc != crc32Buffer(buf, 3 + payloadLen))
+        return 0;
+
+    memset(&node, 0, sizeof(node));
+    const uint8_t *payload = buf + 3;
+    if (buf[0] == RECORD_UPSERT) {
+        if (!pb_decode_from_bytes(payload, payloadLen, &meshtastic_NodeInfoLite_msg, &node))
+            return 0;
+    } else if (buf[0] == RECORD_REMOVE && payloadLen == 4) {
+        node.num = payload[0] | (payload[1] << 8) | (payload[2] << 16) | ((uint32_t)payload[3] << 24);
+    } else {
+        return 0;
+    }
+    type = (RecordType)buf[0];
+    return payloadLen + RECORD_OVERHEAD;
+}
+
+/// CRC over the in-RAM struct. Stale padding bytes can only cause a spurious (harmless) record, never a missed change.
+uint32_t NodeDBJournal::nodeCrc(const meshtastic_NodeInfoLite &node)
+{
+    return crc32Buffer(&node, sizeof(node));
+}
+
+bool NodeDBJournal::appendToFile(const char *filename, const uint8_t *data, size_t len)
+{
+#ifdef FSCom
+    concurrency::LockGuard g(spiLock);
+    auto f = FSCom.open(filename, FILE_O_APPEND);
+    if (!f) {
+        LOG_ERROR("Could not open %s for append", filename);
+        return false;
+    }
+    size_t written = f.write(data, len);
+    f.flush();
+    f.close();
+    if (written != len) {
+        LOG_ERROR("Short write to %s, %u of %u bytes", filename, (unsigned)written, (unsigned)len);
+        return false;
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool NodeDBJournal::readFile(const char *filename, std::vector<uint8_t> &out)
+{
+    out.clear();
+#ifdef FSCom
+    concurrency::LockGuard g(spiLock);
+    if (!FSCom.exists(filename))
+        return false;
+    auto f = FSCom.open(filename, FILE_O_READ);
+    if (!f)
+        return false;
+    out.resize(f.size());
+    size_t got = f.read(out.data(), out.size());
+    out.resize(got);
+    f.close();
+    return true;
+#else
+    return false;
+#endif
+}
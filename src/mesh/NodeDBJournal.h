@@ -0,0 +1,85 @@
+#pragma once
+
+#include "MeshTypes.h"
+#include "mesh/generated/meshtastic/deviceonly.pb.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <unordered_map>
+#include <vector>
+
+/// Largest journal we append to before folding it into a full nodes.proto snapshot
+#ifndef NODEDB_JOURNAL_MAX_BYTES
+#define NODEDB_JOURNAL_MAX_BYTES 8192
+#endif
+
+/**
+ * Append-only journal of per-node changes on top of the nodes.proto snapshot.
+ *
+ * Rewriting the whole NodeDatabase for every favorite or ignore toggle costs hundreds of KB of flash writes on large
+ * meshes. Instead we remember a CRC of every node as it is on disk, and on save only append records for the nodes whose
+ * CRC changed (or that disappeared). Once the journal grows past NODEDB_JOURNAL_MAX_BYTES the caller writes a fresh
+ * snapshot and deletes the journal. On boot the journal is replayed on top of the snapshot.
+ *
+ * Each record is: type (1 byte), payload length (2 bytes, little endian), payload, CRC32 over everything before it. An
+ * upsert carries the protobuf encoded NodeInfoLite, a remove the 4 byte NodeNum. A record cut short by a power loss fails
+ * its CRC, replay stops there.
+ */
+class NodeDBJournal
+{
+  public:
+    enum RecordType : uint8_t { RECORD_UPSERT = 1, RECORD_REMOVE = 2 };
+
+    static constexpr size_t RECORD_OVERHEAD = 1 + 2 + 4;
+    static constexpr size_t MAX_RECORD_SIZE = RECORD_OVERHEAD + meshtastic_NodeInfoLite_size;
+
+    /**
+     * Remember the first numNodes entries of nodes as what is on disk now, after loading or writing a snapshot.
+     * @param journalBytes size of the journal file that is part of that state
+     */
+    void markPersisted(const std::vector<meshtastic_NodeInfoLite> *nodes, size_t numNodes, size_t journalBytes = 0);
+
+    /// Forget the persisted state, so the next save writes a full snapshot
+    void invalidate();
+
+    /// @return true if markPersisted() was called since the last invalidate(), so appending is an option
+    bool hasSnapshot() const { return snapshotValid; }
+
+    /// @return the size of the journal file as far as we know
+    size_t getJournalBytes() const { return journalBytes; }
+
+    /**
+     * Encode records for everything that changed since the persisted state into out.
+     * @return false if the records would take more than maxBytes, then a snapshot is the cheaper option
+     */
+    bool diff(const std::vector<meshtastic_NodeInfoLite> *nodes, size_t numNodes, size_t maxBytes, std::vector<uint8_t> &out);
+
+    /// The records from the last diff() reached the disk, make them the persisted state
+    void commit(size_t appendedBytes);
+
+    /// Encode a record into buf, @return its size or 0 if buf is too small
+    static size_t encodeUpsert(const meshtastic_NodeInfoLite &node, uint8_t *buf, size_t bufSize);
+    static size_t encodeRemove(NodeNum n, uint8_t *buf, size_t bufSize);
+
+    /**
+     * Decode the record at the start of buf. For RECORD_REMOVE only node.num is set.
+     * @return the size of the record, or 0 if buf does not start with a complete, intact record
+     */
+    static size_t decodeRecord(const uint8_t *buf, size_t len, RecordType &type, meshtastic_NodeInfoLite &node);
+
+    /// Append data to the journal file, @return false on failure
+    static bool appendToFile(const char *filename, const uint8_t *data, size_t len);
+
+    /// Read the whole journal file into out, @return false if there is none
+    static bool readFile(const char *filename, std::vector<uint8_t> &out);
+
+  private:
+    // NodeNum -> CRC of the node as it is on disk
+    std::unordered_map<NodeNum, uint32_t> persisted;
+    // What persisted becomes once the records from diff() are committed
+    std::unordered_map<NodeNum, uint32_t> pending;
+    size_t journalBytes = 0;
+    bool snapshotValid = false;
+
+    static uint32_t nodeCrc(const meshtastic_NodeInfoLite &node);
+    static size_t finishRecord(RecordType type, uint8_t *buf, size_t payloadLen);
+};
@@ -0,0 +1,110 @@
+#include "NodeNumIndex.h"
+#include "configuration.h"
+#include <algorithm>
+
+void NodeNumIndex::rebuild(const std::vector<meshtastic_NodeInfoLite> *nodes, size_t numNodes)
+{
+    this->nodes = nodes;
+    numIndexed = 0;
+    active = false;
+    if (!nodes)
+        return;
+
+    // Size the table for the whole backing vector (MAX_NUM_NODES), so appends never push us past a 50% load factor
+    size_t capacity = std::max(nodes->size(), numNodes);
+    if (capacity > MAX_INDEXED_NODES) {
+        LOG_WARN("NodeNumIndex: %u nodes exceed index capacity, fall back to linear lookup", (unsigned)capacity);
+        slots.clear();
+        numIndexed = numNodes;
+        return;
+    }
+
+    uint32_t tableSize = 16;
+    uint8_t bits = 4;
+    while (tableSize < capacity * 2) {
+        tableSize <<= 1;
+        bits++;
+    }
+    if (slots.size() != tableSize) {
+        slots.assign(tableSize, EMPTY_SLOT);
+    } else {
+        std::fill(slots.begin(), slots.end(), EMPTY_SLOT);
+    }
+    mask = tableSize - 1;
+    shift = 32 - bits;
+    active = true;
+
+    for (size_t i = 0; i < numNodes; i++)
+        insert(i);
+}
+
+void NodeNumIndex::insert(size_t pos)
+{
+    if (!nodes)
+        return;
+    if (pos >= numIndexed)
+        numIndexed = pos + 1;
+    if (!active)
+        return;
+
+    NodeNum n = nodes->at(pos).num;
+    uint32_t slot = slotFor(n);
+    while (slots[slot] != EMPTY_SLOT) {
+        // Duplicate nodenums should never happen, but if they do keep the first one like the old linear scan did
+        if (nodes->at(slots[slot] - 1).num == n)
+            return;
+        slot = (slot + 1) & mask;
+    }
+    slots[slot] = (uint16_t)(pos + 1);
+}
+
+void NodeNumIndex::remove(NodeNum n)
+{
+    if (!active)
+        return;
+
+    uint32_t slot = slotFor(n);
+    while (slots[slot] != EMPTY_SLOT && nodes->at(slots[slot] - 1).num != n)
+        slot = (slot + 1) & mask;
+    if (slots[slot] == EMPTY_SLOT)
+        return;
+
+    // Backward shift deletion: pull later entries of the probe run into the hole, so no tombstones are needed
+    uint32_t hole = slot;
+    uint32_t next = (hole + 1) & mask;
+    while (slots[next] != EMPTY_SLOT) {
+        uint32_t home = slotFor(nodes->at(slots[next] - 1).num);
+        // Move the entry unless its home slot lies cyclically in (hole, next]
+        if (((next - home) & mask) >= ((next - hole) & mask)) {
+            slots[hole] = slots[next];
+            hole = next;
+        }
+        next = (next + 1) & mask;
+    }
+    slots[hole] = EMPTY_SLOT;
+}
+
+int32_t NodeNumIndex::find(NodeNum n) const
+{
+    if (!active)
+        return scan(n);
+
+    uint32_t slot = slotFor(n);
+    while (slots[slot] != EMPTY_SLOT) {
+        size_t pos = slots[slot] - 1;
+        if (pos < numIndexed && nodes->at(pos).num == n)
+            return (int32_t)pos;
+        slot = (slot + 1) & mask;
+    }
+    return NOT_FOUND;
+}
+
+int32_t NodeNumIndex::scan(NodeNum n) const
+{
+    if (!nodes)
+        return NOT_FOUND;
+    for (size_t i = 0; i < numIndexed; i++)
+        if (nodes->at(i).num == n)
+            return (int32_t)i;
+    return NOT_FOUND;
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "MeshTypes.h"
+#include "mesh/generated/meshtastic/deviceonly.pb.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+/**
+ * Open-addressing hash index from NodeNum to a position in the NodeDB node vector.
+ *
+ * Slots only hold (position + 1), the key is read back from the node vector itself. This keeps the table at two bytes
+ * per slot, which matters on targets where MAX_NUM_NODES is a couple of hundred and RAM is tight.
+ *
+ * The index is a cache over the vector: anything that moves entries around (compaction, reload) must call rebuild()
+ * afterwards. Appends and in-place replacement of a single entry can use insert() and remove().
+ */
+class NodeNumIndex
+{
+  public:
+    /// Returned by find() when the node is not in the index
+    static constexpr int32_t NOT_FOUND = -1;
+
+    /// Discard the current contents and index the first numNodes entries of nodes
+    void rebuild(const std::vector<meshtastic_NodeInfoLite> *nodes, size_t numNodes);
+
+    /// Index nodes->at(pos), either a freshly appended entry or a slot whose previous node was remove()d
+    void insert(size_t pos);
+
+    /// Drop n from the index. Must be called while its entry in the node vector still holds n.
+    void remove(NodeNum n);
+
+    /// @return the position of n in the node vector, or NOT_FOUND
+    /// NOTE: read-only, safe to call from the same contexts as NodeDB::getMeshNode
+    int32_t find(NodeNum n) const;
+
+    /// Shrink the range that is considered valid, after the tail entries were remove()d
+    void setNumNodes(size_t numNodes) { numIndexed = numNodes; }
+
+    /// @return true if lookups are served from the hash table, false if we fell back to linear scans
+    bool isActive() const { return active; }
+
+  private:
+    // A slot holding EMPTY_SLOT is free, otherwise it holds position + 1
+    static constexpr uint16_t EMPTY_SLOT = 0;
+    // Largest node count we can address with 16 bit slots
+    static constexpr size_t MAX_INDEXED_NODES = UINT16_MAX - 1;
+
+    const std::vector<meshtastic_NodeInfoLite> *nodes = nullptr;
+    size_t numIndexed = 0;
+    std::vector<uint16_t> slots;
+    uint32_t mask = 0;
+    uint8_t shift = 32;
+    bool active = false;
+
+    /// Fibonacci hash of a NodeNum onto the table. Node numbers are mostly the low MAC bytes, so take the high product bits.
+    uint32_t slotFor(NodeNum n) const { return (uint32_t)(n * 0x9E3779B1u) >> shift; }
+
+    /// Linear scan used when the table could not be allocated or the node count does not fit in a slot
+    int32_t scan(NodeNum n) const;
+};
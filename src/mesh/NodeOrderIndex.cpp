@@ -0,0 +1,135 @@
+#include "NodeOrderIndex.h"
+#include "configuration.h"
+#include <algorithm>
+
+void NodeOrderIndex::rebuild(const std::vector<meshtastic_NodeInfoLite> *nodes, size_t numNodes, NodeNum ourNode)
+{
+    this->nodes = nodes;
+    this->ourNode = ourNode;
+    root = NOT_FOUND;
+    if (!nodes) {
+        links.clear();
+        return;
+    }
+
+    // Positions are 16 bit, NOT_FOUND included. Portduino clamps MaxNodes below this, embedded targets are far below it.
+    size_t capacity = std::min(std::max(nodes->size(), numNodes), (size_t)NOT_FOUND);
+    links.assign(capacity, {NOT_FOUND, NOT_FOUND, NOT_FOUND, 0});
+    // Inserting in storage order keeps nodes which compare equal in that order, like the stable sort this replaces
+    for (size_t i = 0; i < numNodes && i < capacity; i++)
+        insert(i);
+}
+
+bool NodeOrderIndex::before(uint16_t a, uint16_t b) const
+{
+    const meshtastic_NodeInfoLite &x = nodes->at(a);
+    const meshtastic_NodeInfoLite &y = nodes->at(b);
+    if (x.num == ourNode || y.num == ourNode)
+        return x.num == ourNode && y.num != ourNode;
+    if (x.is_favorite != y.is_favorite)
+        return x.is_favorite;
+    return x.last_heard > y.last_heard;
+}
+
+uint32_t NodeOrderIndex::priority(uint16_t pos)
+{
+    // murmur3 finalizer, positions are handed out in sequence and must not give the treap a skewed shape
+    uint32_t h = pos + 1;
+    h ^= h >> 16;
+    h *= 0x85ebca6b;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35;
+    h ^= h >> 16;
+    return h;
+}
+
+void NodeOrderIndex::pull(uint16_t t)
+{
+    Links &l = links[t];
+    l.size = 1 + sizeOf(l.left) + sizeOf(l.right);
+    if (l.left != NOT_FOUND)
+        links[l.left].parent = t;
+    if (l.right != NOT_FOUND)
+        links[l.right].parent = t;
+}
+
+void NodeOrderIndex::split(uint16_t t, uint16_t pos, uint16_t &lower, uint16_t &upper)
+{
+    if (t == NOT_FOUND) {
+        lower = upper = NOT_FOUND;
+    } else if (before(pos, t)) {
+        split(links[t].left, pos, lower, links[t].left);
+        pull(t);
+        upper = t;
+    } else {
+        split(links[t].right, pos, links[t].right, upper);
+        pull(t);
+        lower = t;
+    }
+}
+
+uint16_t NodeOrderIndex::merge(uint16_t a, uint16_t b)
+{
+    if (a == NOT_FOUND)
+        return b;
+    if (b == NOT_FOUND)
+        return a;
+    if (priority(a) > priority(b)) {
+        links[a].right = merge(links[a].right, b);
+        pull(a);
+        return a;
+    }
+    links[b].left = merge(a, links[b].left);
+    pull(b);
+    return b;
+}
+
+void NodeOrderIndex::insert(uint16_t pos)
+{
+    if (!nodes || pos >= links.size() || links[pos].size != 0)
+        return;
+
+    links[pos] = {NOT_FOUND, NOT_FOUND, NOT_FOUND, 1};
+    uint16_t lower, upper;
+    split(root, pos, lower, upper);
+    root = merge(merge(lower, pos), upper);
+    links[root].parent = NOT_FOUND;
+}
+
+void NodeOrderIndex::remove(uint16_t pos)
+{
+    if (pos >= links.size() || links[pos].size == 0)
+        return;
+
+    // Put the merged children where pos was, then everything above it has one node less
+    uint16_t parent = links[pos].parent;
+    uint16_t replacement = merge(links[pos].left, links[pos].right);
+    if (replacement != NOT_FOUND)
+        links[replacement].parent = parent;
+    if (parent == NOT_FOUND)
+        root = replacement;
+    else if (links[parent].left == pos)
+        links[parent].left = replacement;
+    else
+        links[parent].right = replacement;
+    for (uint16_t t = parent; t != NOT_FOUND; t = links[t].parent)
+        links[t].size--;
+    links[pos] = {NOT_FOUND, NOT_FOUND, NOT_FOUND, 0};
+}
+
+uint16_t NodeOrderIndex::at(size_t rank) const
+{
+    uint16_t t = root;
+    while (t != NOT_FOUND) {
+        size_t leftSize = sizeOf(links[t].left);
+        if (rank < leftSize) {
+            t = links[t].left;
+        } else if (rank == leftSize) {
+            return t;
+        } else {
+            rank -= leftSize + 1;
+            t = links[t].right;
+        }
+    }
+    return NOT_FOUND;
+}
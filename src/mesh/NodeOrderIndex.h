@@ -0,0 +1,74 @@
+#pragma once
+
+#include "MeshTypes.h"
+#include "mesh/generated/meshtastic/deviceonly.pb.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+/**
+ * Display order of the NodeDB nodes: our own node first, then favorites, then everyone else, each group most recently
+ * heard first. Nodes which compare equal stay in the order they were added.
+ *
+ * The order is a treap of positions in the node vector. Each position only stores its links and the size of its subtree
+ * (four 16 bit words), its priority is a hash of the position. Adding, removing or moving a node after its key changed,
+ * and looking up the n'th node are all O(log n) expected, and the large NodeInfoLite entries never move.
+ *
+ * Like NodeNumIndex this is a cache over the node vector: NodeDB must rebuild() it after entries were compacted or
+ * reloaded, or our node number changed, and update() a node whenever its is_favorite or last_heard changes.
+ */
+class NodeOrderIndex
+{
+  public:
+    /// Returned by at() for a rank past the end
+    static constexpr uint16_t NOT_FOUND = UINT16_MAX;
+
+    /// Discard the current contents and order the first numNodes entries of nodes
+    void rebuild(const std::vector<meshtastic_NodeInfoLite> *nodes, size_t numNodes, NodeNum ourNode);
+
+    /// Order nodes->at(pos), either a freshly appended entry or a slot whose previous node was remove()d
+    void insert(uint16_t pos);
+
+    /// Drop the node at pos. Only its links are used, so its entry may already have changed or been overwritten.
+    void remove(uint16_t pos);
+
+    /// Move the node at pos to its place after its is_favorite or last_heard changed
+    void update(uint16_t pos)
+    {
+        remove(pos);
+        insert(pos);
+    }
+
+    /// @return the position in the node vector of the rank'th node in display order, or NOT_FOUND
+    uint16_t at(size_t rank) const;
+
+    size_t size() const { return sizeOf(root); }
+
+    /// @return true if the node at position a is listed before the one at b
+    bool before(uint16_t a, uint16_t b) const;
+
+  private:
+    struct Links {
+        uint16_t left;
+        uint16_t right;
+        uint16_t parent;
+        uint16_t size; // nodes in the subtree rooted here, 0 if this position is not ordered
+    };
+
+    const std::vector<meshtastic_NodeInfoLite> *nodes = nullptr;
+    NodeNum ourNode = 0;
+    std::vector<Links> links;
+    uint16_t root = NOT_FOUND;
+
+    /// Heap priority of a position, a hash so it does not depend on where the node ranks
+    static uint32_t priority(uint16_t pos);
+
+    uint16_t sizeOf(uint16_t t) const { return t == NOT_FOUND ? 0 : links[t].size; }
+    void pull(uint16_t t);
+
+    /// Split the subtree at t into the nodes listed before or together with pos, and those listed after it
+    void split(uint16_t t, uint16_t pos, uint16_t &lower, uint16_t &upper);
+
+    /// Join two subtrees where every node of a is listed before every node of b, @return the new root
+    uint16_t merge(uint16_t a, uint16_t b);
+};
@@ -0,0 +1,277 @@
+#include "NodePositionIndex.h"
+#include "gps/GeoCoord.h"
+#include <algorithm>
+
+// Rows and columns have to fit in 16 bits of the cell key: 360 degrees is 3.6e9 units, 2^16 columns need cells of 2^16 units
+static_assert(NODE_POSITION_CELL_SHIFT >= 16 && NODE_POSITION_CELL_SHIFT < 32, "NODE_POSITION_CELL_SHIFT out of range");
+
+static bool hasValidPosition(const meshtastic_NodeInfoLite &node)
+{
+    return node.has_position && (node.position.latitude_i != 0 || node.position.longitude_i != 0);
+}
+
+static bool entryBefore(const NodePositionIndex::Entry &a, const NodePositionIndex::Entry &b)
+{
+    return a.cell != b.cell ? a.cell < b.cell : a.num < b.num;
+}
+
+static bool cellBefore(const NodePositionIndex::Entry &e, uint32_t cell)
+{
+    return e.cell < cell;
+}
+
+bool NodePositionIndex::numBefore(const NumCell &c, NodeNum n)
+{
+    return c.num < n;
+}
+
+uint32_t NodePositionIndex::latitudeRow(int32_t latitude_i)
+{
+    int64_t fromSouthPole = std::min(std::max((int64_t)latitude_i + 900000000, (int64_t)0), (int64_t)1800000000);
+    return (uint32_t)fromSouthPole >> NODE_POSITION_CELL_SHIFT;
+}
+
+uint32_t NodePositionIndex::longitudeColumn(int32_t longitude_i)
+{
+    int64_t fromAntimeridian = std::min(std::max((int64_t)longitude_i + 1800000000, (int64_t)0), (int64_t)3600000000);
+    return (uint32_t)fromAntimeridian >> NODE_POSITION_CELL_SHIFT;
+}
+
+void NodePositionIndex::rebuild(const std::vector<meshtastic_NodeInfoLite> *nodes, size_t numNodes, NodeNum ourNode)
+{
+    clear();
+    this->ourNode = ourNode;
+    if (!nodes)
+        return;
+
+    for (size_t i = 0; i < numNodes && i < nodes->size(); i++) {
+        const meshtastic_NodeInfoLite &node = nodes->at(i);
+        if (!hasValidPosition(node))
+            continue;
+        entries.push_back({cellFor(node.position.latitude_i, node.position.longitude_i), node.num, node.position.latitude_i,
+                           node.position.longitude_i, 0, 0, 0});
+        if (node.num == ourNode)
+            setOrigin(true, node.position.latitude_i, node.position.longitude_i);
+    }
+    std::sort(entries.begin(), entries.end(), entryBefore);
+
+    cellsByNum.reserve(entries.size());
+    for (const Entry &e : entries)
+        cellsByNum.push_back({e.num, e.cell});
+    std::sort(cellsByNum.begin(), cellsByNum.end(), [](const NumCell &a, const NumCell &b) { return a.num < b.num; });
+}
+
+void NodePositionIndex::setOurNode(NodeNum n)
+{
+    ourNode = n;
+    const Entry *e = find(n);
+    setOrigin(e != NULL, e ? e->latitude_i : 0, e ? e->longitude_i : 0);
+}
+
+void NodePositionIndex::clear()
+{
+    entries.clear();
+    cellsByNum.clear();
+    setOrigin(false, 0, 0);
+}
+
+int32_t NodePositionIndex::indexOf(NodeNum n) const
+{
+    // Callers come from NodeDB and know the node, not its cell: look the cell up first, then the entry within it
+    auto c = std::lower_bound(cellsByNum.begin(), cellsByNum.end(), n, numBefore);
+    if (c == cellsByNum.end() || c->num != n)
+        return -1;
+    Entry key = {c->cell, n, 0, 0, 0, 0, 0};
+    auto it = std::lower_bound(entries.begin(), entries.end(), key, entryBefore);
+    if (it == entries.end() || it->num != n)
+        return -1;
+    return (int32_t)(it - entries.begin());
+}
+
+const NodePositionIndex::Entry *NodePositionIndex::find(NodeNum n) const
+{
+    int32_t i = indexOf(n);
+    return i < 0 ? NULL : &entries[i];
+}
+
+void NodePositionIndex::insert(NodeNum n, int32_t latitude_i, int32_t longitude_i)
+{
+    Entry e = {cellFor(latitude_i, longitude_i), n, latitude_i, longitude_i, 0, 0, 0};
+    entries.insert(std::lower_bound(entries.begin(), entries.end(), e, entryBefore), e);
+    cellsByNum.insert(std::lower_bound(cellsByNum.begin(), cellsByNum.end(), n, numBefore), {n, e.cell});
+}
+
+void NodePositionIndex::erase(size_t i)
+{
+    auto c = std::lower_bound(cellsByNum.begin(), cellsByNum.end(), entries[i].num, numBefore);
+    if (c != cellsByNum.end() && c->num == entries[i].num)
+        cellsByNum.erase(c);
+    entries.erase(entries.begin() + i);
+}
+
+void NodePositionIndex::remove(NodeNum n)
+{
+    int32_t i = indexOf(n);
+    if (i >= 0)
+        erase(i);
+    if (n == ourNode)
+        setOrigin(false, 0, 0);
+}
+
+void NodePositionIndex::update(const meshtastic_NodeInfoLite *node)
+{
+    if (!node)
+        return;
+    bool valid = hasValidPosition(*node);
+    int32_t latitude_i = node->position.latitude_i;
+    int32_t longitude_i = node->position.longitude_i;
+    if (node->num == ourNode)
+        setOrigin(valid, latitude_i, longitude_i);
+
+    int32_t i = indexOf(node->num);
+    if (i >= 0) {
+        Entry &e = entries[i];
+        if (valid && e.latitude_i == latitude_i && e.longitude_i == longitude_i)
+            return; // Not moved, keep the cached distance
+        if (valid && e.cell == cellFor(latitude_i, longitude_i)) {
+            // Moved within its cell, so its place in the order stays the same
+            e.latitude_i = latitude_i;
+            e.longitude_i = longitude_i;
+            e.generation = 0;
+            return;
+        }
+        erase(i);
+    }
+    if (valid)
+        insert(node->num, latitude_i, longitude_i);
+}
+
+void NodePositionIndex::setOrigin(bool valid, int32_t latitude_i, int32_t longitude_i)
+{
+    if (valid == originValid && latitude_i == originLatitude_i && longitude_i == originLongitude_i)
+        return;
+    originValid = valid;
+    originLatitude_i = latitude_i;
+    originLongitude_i = longitude_i;
+    // Every cached distance is now stale. 0 is reserved for entries which were never computed.
+    if (++originGeneration == 0)
+        originGeneration = 1;
+}
+
+void NodePositionIndex::refresh(Entry &e)
+{
+    if (e.generation == originGeneration)
+        return;
+    if (e.num == ourNode) {
+        e.distanceMeters = 0;
+        e.bearingRadians = 0;
+    } else {
+        double ourLat = originLatitude_i * 1e-7, ourLon = originLongitude_i * 1e-7;
+        double theirLat = e.latitude_i * 1e-7, theirLon = e.longitude_i * 1e-7;
+        e.distanceMeters = GeoCoord::latLongToMeter(theirLat, theirLon, ourLat, ourLon);
+        e.bearingRadians = GeoCoord::bearing(ourLat, ourLon, theirLat, theirLon);
+    }
+    e.generation = originGeneration;
+}
+
+bool NodePositionIndex::getDistanceBearing(NodeNum n, float *distanceMeters, float *bearingRadians)
+{
+    if (!originValid)
+        return false;
+    int32_t i = indexOf(n);
+    if (i < 0)
+        return false;
+
+    Entry &e = entries[i];
+    refresh(e);
+    if (distanceMeters)
+        *distanceMeters = e.distanceMeters;
+    if (bearingRadians)
+        *bearingRadians = e.bearingRadians;
+    return true;
+}
+
+void NodePositionIndex::scanRow(uint32_t row, uint32_t firstColumn, uint32_t lastColumn, int32_t minLatitude_i,
+                                int32_t maxLatitude_i, int32_t minLongitude_i, int32_t maxLongitude_i, NodeNum *out,
+                                size_t maxCount, size_t &found) const
+{
+    uint32_t lastCell = (row << 16) | lastColumn;
+    auto it = std::lower_bound(entries.begin(), entries.end(), (row << 16) | firstColumn, cellBefore);
+    for (; it != entries.end() && it->cell <= lastCell; ++it) {
+        if (it->latitude_i < minLatitude_i || it->latitude_i > maxLatitude_i)
+            continue;
+        if (it->longitude_i < minLongitude_i || it->longitude_i > maxLongitude_i)
+            continue;
+        if (found < maxCount)
+            out[found] = it->num;
+        found++;
+    }
+}
+
+size_t NodePositionIndex::findInBox(int32_t minLatitude_i, int32_t minLongitude_i, int32_t maxLatitude_i, int32_t maxLongitude_i,
+                                    NodeNum *out, size_t maxCount) const
+{
+    size_t found = 0;
+    if (minLatitude_i > maxLatitude_i)
+        return 0;
+
+    uint32_t firstRow = latitudeRow(minLatitude_i), lastRow = latitudeRow(maxLatitude_i);
+    bool crossesAntimeridian = minLongitude_i > maxLongitude_i;
+
+    // A box spanning more rows than there are nodes is quicker to check node by node
+    if (lastRow - firstRow + 1 > entries.size()) {
+        for (const Entry &e : entries) {
+            if (e.latitude_i < minLatitude_i || e.latitude_i > maxLatitude_i)
+                continue;
+            bool inside = crossesAntimeridian ? (e.longitude_i >= minLongitude_i || e.longitude_i <= maxLongitude_i)
+                                              : (e.longitude_i >= minLongitude_i && e.longitude_i <= maxLongitude_i);
+            if (!inside)
+                continue;
+            if (found < maxCount)
+                out[found] = e.num;
+            found++;
+        }
+        return found;
+    }
+
+    for (uint32_t row = firstRow; row <= lastRow; row++) {
+        if (crossesAntimeridian) {
+            scanRow(row, longitudeColumn(minLongitude_i), longitudeColumn(INT32_MAX), minLatitude_i, maxLatitude_i,
+                    minLongitude_i, INT32_MAX, out, maxCount, found);
+            scanRow(row, longitudeColumn(INT32_MIN), longitudeColumn(maxLongitude_i), minLatitude_i, maxLatitude_i, INT32_MIN,
+                    maxLongitude_i, out, maxCount, found);
+        } else {
+            scanRow(row, longitudeColumn(minLongitude_i), longitudeColumn(maxLongitude_i), minLatitude_i, maxLatitude_i,
+                    minLongitude_i, maxLongitude_i, out, maxCount, found);
+        }
+    }
+    return found;
+}
+
+size_t NodePositionIndex::findNearest(NodeNum *out, size_t maxCount)
+{
+    if (!originValid || maxCount == 0)
+        return 0;
+
+    // Insertion into a short sorted list: maxCount is a screenful of nodes, and no memory is allocated per frame.
+    // out holds positions in entries until the end, so comparing against them needs no lookups.
+    size_t count = 0;
+    for (size_t i = 0; i < entries.size(); i++) {
+        Entry &e = entries[i];
+        if (e.num == ourNode)
+            continue;
+        refresh(e);
+        if (count == maxCount && e.distanceMeters >= entries[out[count - 1]].distanceMeters)
+            continue;
+
+        size_t pos = count < maxCount ? count++ : maxCount - 1;
+        while (pos > 0 && entries[out[pos - 1]].distanceMeters > e.distanceMeters) {
+            out[pos] = out[pos - 1];
+            pos--;
+        }
+        out[pos] = i;
+    }
+    for (size_t i = 0; i < count; i++)
+        out[i] = entries[out[i]].num;
+    return count;
+}
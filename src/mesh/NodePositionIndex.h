@@ -0,0 +1,117 @@
+#pragma once
+
+#include "MeshTypes.h"
+#include "mesh/generated/meshtastic/deviceonly.pb.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+// Grid cells are 2^NODE_POSITION_CELL_SHIFT units of 1e-7 degrees on a side, 20 is about 0.1 degrees (11km north-south)
+#ifndef NODE_POSITION_CELL_SHIFT
+#define NODE_POSITION_CELL_SHIFT 20
+#endif
+
+/**
+ * Spatial index over the NodeDB nodes which have a valid position.
+ *
+ * Entries are kept sorted by grid cell (row by latitude, then longitude), so a bounding box query only visits the cells
+ * it overlaps. A second, smaller list sorted by node number remembers each node's cell, so looking a node up is two
+ * binary searches. Each entry also caches its distance and bearing from the origin, our own node, which are only recomputed
+ * after either of them moved. Renderers can then ask for these every frame without doing the trigonometry again.
+ *
+ * Like NodeNumIndex this is a cache over the node vector: NodeDB must rebuild() it after entries were compacted or
+ * reloaded, and update() a node whenever its position changes.
+ */
+class NodePositionIndex
+{
+  public:
+    struct Entry {
+        uint32_t cell;
+        NodeNum num;
+        int32_t latitude_i;
+        int32_t longitude_i;
+        // Valid while generation matches the origin's, 0 if never computed
+        uint32_t generation;
+        float distanceMeters;
+        float bearingRadians;
+    };
+
+    /// Discard the current contents and index the nodes with a valid position, our own one as the origin
+    void rebuild(const std::vector<meshtastic_NodeInfoLite> *nodes, size_t numNodes, NodeNum ourNode);
+
+    /// Our node number changed, measure from its entry from now on
+    void setOurNode(NodeNum n);
+
+    /// Add, move or (if it has no valid position anymore) drop a node after its position changed
+    void update(const meshtastic_NodeInfoLite *node);
+
+    /// Drop a node from the index, does nothing if it was not indexed
+    void remove(NodeNum n);
+
+    void clear();
+
+    size_t size() const { return entries.size(); }
+
+    /// Indexed nodes in grid order, for callers which want every node with a position
+    const Entry *begin() const { return entries.data(); }
+    const Entry *end() const { return entries.data() + entries.size(); }
+
+    /// @return the entry for n, or NULL if it has no valid position
+    const Entry *find(NodeNum n) const;
+
+    /// @return true if our own node has a valid position to measure from
+    bool hasOrigin() const { return originValid; }
+
+    /**
+     * Distance and bearing (radians, clockwise from north) from our own node to n, as GeoCoord::latLongToMeter() and
+     * GeoCoord::bearing() give them. Computed at most once per move of either node.
+     * @return false if either of them has no valid position
+     */
+    bool getDistanceBearing(NodeNum n, float *distanceMeters, float *bearingRadians);
+
+    /**
+     * Nodes whose position is inside a box, edges included. If minLongitude_i is greater than maxLongitude_i the box
+     * crosses the antimeridian.
+     * @return how many were found, at most maxCount are written to out
+     */
+    size_t findInBox(int32_t minLatitude_i, int32_t minLongitude_i, int32_t maxLatitude_i, int32_t maxLongitude_i, NodeNum *out,
+                     size_t maxCount) const;
+
+    /**
+     * The nodes closest to our own node, nearest first. Our own node is not included.
+     * @return how many were written to out, 0 if we have no position
+     */
+    size_t findNearest(NodeNum *out, size_t maxCount);
+
+  private:
+    struct NumCell {
+        NodeNum num;
+        uint32_t cell;
+    };
+
+    std::vector<Entry> entries;
+    std::vector<NumCell> cellsByNum; // same nodes as entries, sorted by num
+    NodeNum ourNode = 0;
+    bool originValid = false;
+    int32_t originLatitude_i = 0;
+    int32_t originLongitude_i = 0;
+    uint32_t originGeneration = 1;
+
+    static bool numBefore(const NumCell &c, NodeNum n);
+    static uint32_t latitudeRow(int32_t latitude_i);
+    static uint32_t longitudeColumn(int32_t longitude_i);
+    static uint32_t cellFor(int32_t latitude_i, int32_t longitude_i)
+    {
+        return (latitudeRow(latitude_i) << 16) | longitudeColumn(longitude_i);
+    }
+
+    int32_t indexOf(NodeNum n) const;
+    void insert(NodeNum n, int32_t latitude_i, int32_t longitude_i);
+    void erase(size_t i);
+    void setOrigin(bool valid, int32_t latitude_i, int32_t longitude_i);
+    void refresh(Entry &e);
+
+    /// Scan one row of cells between two longitude columns, appending matches to out
+    void scanRow(uint32_t row, uint32_t firstColumn, uint32_t lastColumn, int32_t minLatitude_i, int32_t maxLatitude_i,
+                 int32_t minLongitude_i, int32_t maxLongitude_i, NodeNum *out, size_t maxCount, size_t &found) const;
+};
@@ -22,6 +22,10 @@ PacketHistory::PacketHistory(uint32_t size) : recentPacketsCapacity(0), recentPa
         LOG_WARN("Packet History - Invalid size %d, using default %d", size, PACKETHISTORY_MAX);
         size = PACKETHISTORY_MAX; // Use default size if invalid
     }
+    if (size >= NO_SLOT) { // Slots are indexed with 16 bits
+        LOG_WARN("Packet History - Size %d too large, using %d", size, NO_SLOT - 1);
+        size = NO_SLOT - 1;
+    }
 
     // Allocate memory for the recent packets array
     recentPacketsCapacity = size;
@@ -35,6 +39,24 @@ PacketHistory::PacketHistory(uint32_t size) : recentPacketsCapacity(0), recentPa
 
     // Initialize the recent packets array to zero
     memset(recentPackets, 0, sizeof(PacketRecord) * recentPacketsCapacity);
+
+    // One bucket per slot (rounded up to a power of two) keeps the chains at about one record
+    uint32_t numBuckets = 1;
+    while (numBuckets < recentPacketsCapacity)
+        numBuckets <<= 1;
+    hashMask = numBuckets - 1;
+    hashBuckets = new uint16_t[numBuckets];
+    hashNext = new uint16_t[recentPacketsCapacity];
+    lruPrev = new uint16_t[recentPacketsCapacity];
+    lruNext = new uint16_t[recentPacketsCapacity];
+    if (!hashBuckets || !hashNext || !lruPrev || !lruNext) {
+        LOG_ERROR("Packet History - Memory allocation failed for index of %d entries", size);
+        delete[] recentPackets;
+        recentPackets = NULL;
+        recentPacketsCapacity = 0; // mark allocation fail
+        return;
+    }
+    memset(hashBuckets, 0xFF, sizeof(uint16_t) * numBuckets); // all NO_SLOT
 }
 
 PacketHistory::~PacketHistory()
@@ -42,6 +64,11 @@ PacketHistory::~PacketHistory()
     recentPacketsCapacity = 0;
     delete[] recentPackets;
     recentPackets = NULL;
+    delete[] hashBuckets;
+    delete[] hashNext;
+    delete[] lruPrev;
+    delete[] lruNext;
+    hashBuckets = hashNext = lruPrev = lruNext = NULL;
 }
 
 /** Update recentPackets and return true if we have already seen this packet */
@@ -205,17 +232,15 @@ PacketHistory::PacketRecord *PacketHistory::find(NodeNum sender, PacketId id)
         return NULL;
     }
 
-    PacketRecord *it = NULL;
-    for (it = recentPackets; it < (recentPackets + recentPacketsCapacity); ++it) {
-        if (it->id == id && it->sender == sender) {
+    uint16_t slot = findSlot(sender, id);
+    if (slot != NO_SLOT) {
+        PacketRecord *it = &recentPackets[slot];
 #if VERBOSE_PACKET_HISTORY
-            LOG_DEBUG("Packet History - find: s=%08x id=%08x FOUND nh=%02x rby=%02x %02x %02x age=%d slot=%d/%d", it->sender,
-                      it->id, it->next_hop, it->relayed_by[0], it->relayed_by[1], it->relayed_by[2], millis() - (it->rxTimeMsec),
-                      it - recentPackets, recentPacketsCapacity);
+        LOG_DEBUG("Packet History - find: s=%08x id=%08x FOUND nh=%02x rby=%02x %02x %02x age=%d slot=%d/%d", it->sender, it->id,
+                  it->next_hop, it->relayed_by[0], it->relayed_by[1], it->relayed_by[2], millis() - (it->rxTimeMsec), slot,
+                  recentPacketsCapacity);
 #endif
-            // only the first match is returned, so be careful not to create duplicate entries
-            return it; // Return pointer to the found record
-        }
+        return it; // Return pointer to the found record
     }
 
 #if VERBOSE_PACKET_HISTORY
@@ -224,65 +249,100 @@ PacketHistory::PacketRecord *PacketHistory::find(NodeNum sender, PacketId id)
     return NULL; // Not found
 }
 
+/** Walk the hash chain for (sender, id)
+ * @return slot of the record, NO_SLOT if not found */
+uint16_t PacketHistory::findSlot(NodeNum sender, PacketId id) const
+{
+    for (uint16_t slot = hashBuckets[bucketOf(sender, id)]; slot != NO_SLOT; slot = hashNext[slot]) {
+        if (recentPackets[slot].id == id && recentPackets[slot].sender == sender)
+            return slot;
+    }
+    return NO_SLOT;
+}
+
+/** Take a used slot out of its hash chain and the LRU ring */
+void PacketHistory::unlinkSlot(uint16_t slot)
+{
+    uint16_t *link = &hashBuckets[bucketOf(recentPackets[slot].sender, recentPackets[slot].id)];
+    while (*link != slot && *link != NO_SLOT)
+        link = &hashNext[*link];
+    if (*link == slot)
+        *link = hashNext[slot];
+
+    if (lruPrev[slot] != NO_SLOT)
+        lruNext[lruPrev[slot]] = lruNext[slot];
+    else
+        lruOldest = lruNext[slot];
+    if (lruNext[slot] != NO_SLOT)
+        lruPrev[lruNext[slot]] = lruPrev[slot];
+    else
+        lruNewest = lruPrev[slot];
+}
+
+/** Hash the record now stored in slot and make it the newest in the LRU ring */
+void PacketHistory::linkNewestSlot(uint16_t slot)
+{
+    uint32_t bucket = bucketOf(recentPackets[slot].sender, recentPackets[slot].id);
+    hashNext[slot] = hashBuckets[bucket];
+    hashBuckets[bucket] = slot;
+
+    lruPrev[slot] = lruNewest;
+    lruNext[slot] = NO_SLOT;
+    if (lruNewest != NO_SLOT)
+        lruNext[lruNewest] = slot;
+    else
+        lruOldest = slot;
+    lruNewest = slot;
+}
+
 /** Insert/Replace oldest PacketRecord in recentPackets. */
 void PacketHistory::insert(const PacketRecord &r)
 {
     uint32_t now_millis = millis(); // Should not jump with time changes
     uint32_t OldtrxTimeMsec = 0;
     PacketRecord *tu = NULL; // Will insert here.
-    PacketRecord *it = NULL;
 
-    // Find a free, matching or oldest used slot in the recentPackets array
-    for (it = recentPackets; it < (recentPackets + recentPacketsCapacity); ++it) {
-        if (it->id == 0 && it->sender == 0 /*&& rxTimeMsec == 0*/) { // Record is empty
-            tu = it;                                                 // Remember the free slot
+    // Use the matching record, else a never used slot, else the least recently stored one
+    uint16_t slot = findSlot(r.sender, r.id);
+    if (slot != NO_SLOT) {
+        OldtrxTimeMsec = now_millis - recentPackets[slot].rxTimeMsec; // ..and save current entry's age
 #if VERBOSE_PACKET_HISTORY >= 2
-            LOG_DEBUG("Packet History - insert: Free slot@ %d/%d", tu - recentPackets, recentPacketsCapacity);
+        LOG_DEBUG("Packet History - insert: Matched slot@ %d/%d age=%d", slot, recentPacketsCapacity, OldtrxTimeMsec);
 #endif
-            // We have that, Exit the loop
-            it = (recentPackets + recentPacketsCapacity);
-        } else if (it->id == r.id && it->sender == r.sender) { // Record matches the packet we want to insert
-            tu = it;                                           // Remember the matching slot
-            OldtrxTimeMsec = now_millis - it->rxTimeMsec;      // ..and save current entry's age
+    } else if (slotsUsed < recentPacketsCapacity) {
+        slot = slotsUsed;
 #if VERBOSE_PACKET_HISTORY >= 2
-            LOG_DEBUG("Packet History - insert: Matched slot@ %d/%d age=%d", tu - recentPackets, recentPacketsCapacity,
-                      OldtrxTimeMsec);
+        LOG_DEBUG("Packet History - insert: Free slot@ %d/%d", slot, recentPacketsCapacity);
 #endif
-            // We have that, Exit the loop
-            it = (recentPackets + recentPacketsCapacity);
-        } else {
-            if (it->rxTimeMsec == 0) {
+    } else {
+        slot = lruOldest;
+        if (slot != NO_SLOT) {
+            if (recentPackets[slot].rxTimeMsec == 0) {
                 LOG_WARN(
                     "Packet History - insert: Found packet s=%08x id=%08x with rxTimeMsec = 0, slot %d/%d. Should never happen!",
-                    it->sender, it->id, it - recentPackets, recentPacketsCapacity);
+                    recentPackets[slot].sender, recentPackets[slot].id, slot, recentPacketsCapacity);
             }
-            if ((now_millis - it->rxTimeMsec) > OldtrxTimeMsec) { // 49.7 days rollover friendly
-                OldtrxTimeMsec = now_millis - it->rxTimeMsec;
-                tu = it; // remember the oldest packet
+            OldtrxTimeMsec = now_millis - recentPackets[slot].rxTimeMsec; // 49.7 days rollover friendly
 #if VERBOSE_PACKET_HISTORY >= 2
-                LOG_DEBUG("Packet History - insert: Older slot@ %d/%d age=%d", tu - recentPackets, recentPacketsCapacity,
-                          OldtrxTimeMsec);
+            LOG_DEBUG("Packet History - insert: Older slot@ %d/%d age=%d", slot, recentPacketsCapacity, OldtrxTimeMsec);
 #endif
-            }
-            // keep looking for oldest till entire array is checked
         }
     }
 
-    if (tu == NULL) {
+    if (slot == NO_SLOT) {
         LOG_ERROR("Packet History - insert: No free slot, no matched packet, no oldest to reuse. Something leaked."); // mx
         // assert(false); // This should never happen, we should always have at least one packet to clear
         return; // Return early if we can't update the history
     }
+    tu = &recentPackets[slot];
 
 #if VERBOSE_PACKET_HISTORY
     if (tu->id == 0 && tu->sender == 0) {
-        LOG_DEBUG("Packet History - insert: slot@ %d/%d is NEW", tu - recentPackets, recentPacketsCapacity);
+        LOG_DEBUG("Packet History - insert: slot@ %d/%d is NEW", slot, recentPacketsCapacity);
     } else if (tu->id == r.id && tu->sender == r.sender) {
-        LOG_DEBUG("Packet History - insert: slot@ %d/%d MATCHED, age=%d", tu - recentPackets, recentPacketsCapacity,
-                  OldtrxTimeMsec);
+        LOG_DEBUG("Packet History - insert: slot@ %d/%d MATCHED, age=%d", slot, recentPacketsCapacity, OldtrxTimeMsec);
     } else {
-        LOG_DEBUG("Packet History - insert: slot@ %d/%d REUSE OLDEST, age=%d", tu - recentPackets, recentPacketsCapacity,
-                  OldtrxTimeMsec);
+        LOG_DEBUG("Packet History - insert: slot@ %d/%d REUSE OLDEST, age=%d", slot, recentPacketsCapacity, OldtrxTimeMsec);
     }
 #endif
 
@@ -315,9 +375,9 @@ void PacketHistory::insert(const PacketRecord &r)
 #endif
 
 #if VERBOSE_PACKET_HISTORY
-    LOG_DEBUG("Packet History - insert: Store slot@ %d/%d s=%08x id=%08x nh=%02x rby=%02x %02x %02x rxT=%d BEFORE",
-              tu - recentPackets, recentPacketsCapacity, tu->sender, tu->id, tu->next_hop, tu->relayed_by[0], tu->relayed_by[1],
-              tu->relayed_by[2], tu->rxTimeMsec);
+    LOG_DEBUG("Packet History - insert: Store slot@ %d/%d s=%08x id=%08x nh=%02x rby=%02x %02x %02x rxT=%d BEFORE", slot,
+              recentPacketsCapacity, tu->sender, tu->id, tu->next_hop, tu->relayed_by[0], tu->relayed_by[1], tu->relayed_by[2],
+              tu->rxTimeMsec);
 #endif
 
     if (r.rxTimeMsec == 0) {
@@ -327,12 +387,17 @@ void PacketHistory::insert(const PacketRecord &r)
         return; // Return early if we can't update the history
     }
 
+    if (slot < slotsUsed)
+        unlinkSlot(slot); // Matched or evicted record, unhash it under its old key
+    else
+        slotsUsed++;
     *tu = r; // store the packet
+    linkNewestSlot(slot);
 
 #if VERBOSE_PACKET_HISTORY
-    LOG_DEBUG("Packet History - insert: Store slot@ %d/%d s=%08x id=%08x nh=%02x rby=%02x %02x %02x rxT=%d AFTER",
-              tu - recentPackets, recentPacketsCapacity, tu->sender, tu->id, tu->next_hop, tu->relayed_by[0], tu->relayed_by[1],
-              tu->relayed_by[2], tu->rxTimeMsec);
+    LOG_DEBUG("Packet History - insert: Store slot@ %d/%d s=%08x id=%08x nh=%02x rby=%02x %02x %02x rxT=%d AFTER", slot,
+              recentPacketsCapacity, tu->sender, tu->id, tu->next_hop, tu->relayed_by[0], tu->relayed_by[1], tu->relayed_by[2],
+              tu->rxTimeMsec);
 #endif
 }
 
@@ -396,6 +461,23 @@ bool PacketHistory::wasRelayer(const uint8_t relayer, const PacketRecord &r, boo
     return found;
 }
 
+uint8_t PacketHistory::countRelayers(const uint32_t id, const NodeNum sender, const uint8_t except)
+{
+    if (!initOk())
+        return 0;
+
+    const PacketRecord *found = find(sender, id);
+    if (found == NULL)
+        return 0;
+
+    uint8_t count = 0;
+    for (uint8_t i = 0; i < NUM_RELAYERS; ++i) {
+        if (found->relayed_by[i] != 0 && found->relayed_by[i] != except)
+            count++;
+    }
+    return count;
+}
+
 // Remove a relayer from the list of relayers of a packet in the history given an ID and sender
 void PacketHistory::removeRelayer(const uint8_t relayer, const uint32_t id, const NodeNum sender)
 {
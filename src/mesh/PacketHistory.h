@@ -28,13 +28,34 @@ class PacketHistory
         0; // Can be set in constructor, no need to recompile. Used to allocate memory for mx_recentPackets.
     PacketRecord *recentPackets = NULL; // Simple and fixed in size. Debloat.
 
+    // Hash index and LRU ring over recentPackets. Kept outside PacketRecord as 16 bit slot numbers, so records stay 20B
+    // and the index costs ~10B per slot. Every insert refreshes rxTimeMsec, so the LRU head is always the oldest record.
+    static constexpr uint16_t NO_SLOT = 0xFFFF;
+    uint16_t *hashBuckets = NULL; // First slot of each bucket's chain
+    uint16_t *hashNext = NULL;    // Next slot in the same bucket's chain
+    uint16_t *lruPrev = NULL;     // Towards the oldest record
+    uint16_t *lruNext = NULL;     // Towards the newest record
+    uint16_t lruOldest = NO_SLOT;
+    uint16_t lruNewest = NO_SLOT;
+    uint32_t hashMask = 0;
+    uint32_t slotsUsed = 0; // Slots [slotsUsed, recentPacketsCapacity) have never been used
+
+    uint32_t bucketOf(NodeNum sender, PacketId id) const
+    {
+        uint32_t h = (sender * 0x9E3779B1u) ^ id;
+        return (h ^ (h >> 16)) & hashMask;
+    }
+    uint16_t findSlot(NodeNum sender, PacketId id) const;
+    void unlinkSlot(uint16_t slot);
+    void linkNewestSlot(uint16_t slot);
+
     /** Find a packet record in history.
      * @param sender NodeNum
      * @param id PacketId
      * @return pointer to PacketRecord if found, NULL if not found */
     PacketRecord *find(NodeNum sender, PacketId id);
 
-    /** Insert/Replace oldest PacketRecord in mx_recentPackets.
+    /** Insert/Replace oldest PacketRecord in mx_recentPackets. O(1), the oldest record is the LRU ring head.
      * @param r PacketRecord to insert or replace */
     void insert(const PacketRecord &r); // Insert or replace a packet record in the history
 
@@ -70,6 +91,10 @@ class PacketHistory
      * @return true if node was indeed a relayer, false if not */
     bool wasRelayer(const uint8_t relayer, const uint32_t id, const NodeNum sender, bool *wasSole = nullptr);
 
+    /* Count the relayers of a packet in the history given an ID and sender, leaving out except (e.g. ourselves)
+     * @return the number of relayers, 0 if the packet is not in the history */
+    uint8_t countRelayers(const uint32_t id, const NodeNum sender, const uint8_t except = 0);
+
     // Remove a relayer from the list of relayers of a packet in the history given an ID and sender
     void removeRelayer(const uint8_t relayer, const uint32_t id, const NodeNum sender);
 
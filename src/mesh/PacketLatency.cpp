@@ -0,0 +1,109 @@
+#include "PacketLatency.h"
+#include "configuration.h"
+
+PacketLatency packetLatency;
+
+uint32_t LatencyHistogram::bucketLimit(uint8_t bucket)
+{
+    static const uint16_t steps[3] = {1, 2, 5};
+    if (bucket >= NUM_BUCKETS - 1)
+        return UINT32_MAX;
+    uint32_t limit = 100 * steps[bucket % 3];
+    for (uint8_t decade = bucket / 3; decade > 0; decade--)
+        limit *= 10;
+    return limit;
+}
+
+void LatencyHistogram::record(uint32_t micros)
+{
+    uint8_t bucket = 0;
+    while (micros >= bucketLimit(bucket))
+        bucket++;
+    buckets[bucket]++;
+    count++;
+    if (micros > max)
+        max = micros;
+}
+
+void LatencyHistogram::clear()
+{
+    *this = LatencyHistogram();
+}
+
+uint32_t LatencyHistogram::percentile(uint8_t percent) const
+{
+    if (count == 0)
+        return 0;
+    // Samples at or below the wanted one, rounded up so the 100th percentile is the last sample
+    uint64_t wanted = ((uint64_t)count * percent + 99) / 100;
+    if (wanted == 0)
+        wanted = 1;
+    uint64_t seen = 0;
+    for (uint8_t bucket = 0; bucket < NUM_BUCKETS; bucket++) {
+        seen += buckets[bucket];
+        if (seen >= wanted)
+            return bucketLimit(bucket) < max ? bucketLimit(bucket) : max;
+    }
+    return max;
+}
+
+const char *PacketLatency::stageName(Stage stage)
+{
+    switch (stage) {
+    case STAGE_ISR_TO_ROUTER:
+        return "isr_to_router";
+    case STAGE_DECODE:
+        return "decode";
+    case STAGE_MODULES:
+        return "modules";
+    case STAGE_TX_QUEUE:
+        return "tx_queue";
+    case STAGE_AIRTIME:
+        return "airtime";
+    default:
+        return "unknown";
+    }
+}
+
+void PacketLatency::mark(const meshtastic_MeshPacket *p, uint32_t startMicros)
+{
+    for (auto &m : marks) {
+        if (m.packet == p) {
+            m.id = p->id;
+            m.micros = startMicros;
+            return;
+        }
+    }
+    marks[nextMark] = {p, p->id, startMicros};
+    nextMark = (nextMark + 1) % PACKET_LATENCY_MARKS;
+}
+
+void PacketLatency::finish(Stage stage, const meshtastic_MeshPacket *p)
+{
+    for (auto &m : marks) {
+        if (m.packet == p) {
+            uint32_t elapsed = micros() - m.micros;
+            if (m.id == p->id && elapsed <= PACKET_LATENCY_MAX_MICROS)
+                record(stage, elapsed);
+            m.packet = NULL;
+            return;
+        }
+    }
+}
+
+void PacketLatency::clear()
+{
+    for (auto &h : histograms)
+        h.clear();
+}
+
+void PacketLatency::log() const
+{
+    for (uint8_t stage = 0; stage < NUM_STAGES; stage++) {
+        const LatencyHistogram &h = histograms[stage];
+        if (h.getCount() == 0)
+            continue;
+        LOG_DEBUG("Latency %s: n=%u p50<=%uus p90<=%uus max=%uus", stageName((Stage)stage), h.getCount(), h.percentile(50),
+                  h.percentile(90), h.getMax());
+    }
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "MeshTypes.h"
+#include <stdint.h>
+
+// Packets which can be waiting between the start and end of a stage at once (radio queues plus some slack)
+#ifndef PACKET_LATENCY_MARKS
+#define PACKET_LATENCY_MARKS 32
+#endif
+
+// Marks older than this are stale (the packet was dropped and its pool slot reused) and are not recorded
+#ifndef PACKET_LATENCY_MAX_MICROS
+#define PACKET_LATENCY_MAX_MICROS (60 * 1000 * 1000UL)
+#endif
+
+/**
+ * Counts of how long something took, in fixed buckets from under 100us to over 5s (1-2-5 steps).
+ */
+class LatencyHistogram
+{
+  public:
+    static constexpr uint8_t NUM_BUCKETS = 16;
+
+    void record(uint32_t micros);
+
+    void clear();
+
+    /// Exclusive upper limit of a bucket in microseconds, UINT32_MAX for the last one
+    static uint32_t bucketLimit(uint8_t bucket);
+
+    /// Upper limit of the bucket the given percentage of samples falls in (at most the maximum), 0 if nothing was recorded
+    uint32_t percentile(uint8_t percent) const;
+
+    uint32_t getCount() const { return count; }
+    uint32_t getMax() const { return max; }
+    const uint32_t *getBuckets() const { return buckets; }
+
+  private:
+    uint32_t buckets[NUM_BUCKETS] = {};
+    uint32_t count = 0;
+    uint32_t max = 0;
+};
+
+/**
+ * Where time goes on the packet hot path, one histogram per stage:
+ * - ISR to router: radio interrupt until the router takes the packet from its queue
+ * - decode: perhapsDecode()
+ * - modules: MeshModule::callModules()
+ * - TX queue: queued for sending until the transmit starts
+ * - airtime: transmit start until the TX done interrupt is handled
+ *
+ * Stages which span queues mark() the packet when they start, and finish() looks the mark up when they end.
+ */
+class PacketLatency
+{
+  public:
+    enum Stage : uint8_t { STAGE_ISR_TO_ROUTER, STAGE_DECODE, STAGE_MODULES, STAGE_TX_QUEUE, STAGE_AIRTIME, NUM_STAGES };
+
+    static const char *stageName(Stage stage);
+
+    void record(Stage stage, uint32_t micros) { histograms[stage].record(micros); }
+
+    /// Remember when a stage started for a packet, replacing any older mark for it
+    void mark(const meshtastic_MeshPacket *p, uint32_t startMicros);
+
+    /// Record the time since the packet was marked and forget the mark. Does nothing if it was not marked, or if the mark
+    /// belongs to an earlier packet which had the same pool slot or is older than PACKET_LATENCY_MAX_MICROS.
+    void finish(Stage stage, const meshtastic_MeshPacket *p);
+
+    const LatencyHistogram &get(Stage stage) const { return histograms[stage]; }
+
+    void clear();
+
+    /// Log a line per stage with count, median, 90th percentile and maximum
+    void log() const;
+
+  private:
+    LatencyHistogram histograms[NUM_STAGES];
+
+    struct Mark {
+        const meshtastic_MeshPacket *packet;
+        PacketId id; // pool slots are reused, so the pointer alone could match a mark left by a dropped packet
+        uint32_t micros;
+    };
+    // Oldest marks are overwritten, so packets which never finish a stage (dropped, cancelled) don't use up the table
+    Mark marks[PACKET_LATENCY_MARKS] = {};
+    uint8_t nextMark = 0;
+};
+
+extern PacketLatency packetLatency;
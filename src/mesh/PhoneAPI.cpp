@@ -52,6 +52,9 @@ void PhoneAPI::handleStartConfig()
     if (!isConnected()) {
         onConnectionChanged(true);
         observe(&service->fromNumChanged);
+        sharedQueueReader = readsSharedQueue();
+        if (sharedQueueReader)
+            service->sharedQueueReaders++;
 #ifdef FSCom
         observe(&xModem.packetReady);
 #endif
@@ -104,6 +107,9 @@ void PhoneAPI::close()
         state = STATE_SEND_NOTHING;
         resetReadIndex();
         unobserve(&service->fromNumChanged);
+        if (sharedQueueReader)
+            service->sharedQueueReaders--;
+        sharedQueueReader = false;
 #ifdef FSCom
         unobserve(&xModem.packetReady);
 #endif
@@ -723,14 +729,14 @@ bool PhoneAPI::available()
 
 #ifdef ARCH_ESP32
 #if !MESHTASTIC_EXCLUDE_STOREFORWARD
-        // Check if StoreForward has packets stored for us.
-        if (!packetForPhone && storeForwardModule)
+        // Check if StoreForward has packets stored for us. Clients with their own queue already got a copy of each.
+        if (!packetForPhone && storeForwardModule && readsSharedQueue())
             packetForPhone = storeForwardModule->getForPhone();
 #endif
 #endif
 
         if (!packetForPhone)
-            packetForPhone = service->getForPhone();
+            packetForPhone = getPacketForPhone();
         hasPacket = !!packetForPhone;
         return hasPacket;
     }
@@ -830,6 +836,11 @@ bool PhoneAPI::handleToRadioPacket(meshtastic_MeshPacket &p)
 }
 
 /// If the mesh service tells us fromNum has changed, tell the phone
+meshtastic_MeshPacket *PhoneAPI::getPacketForPhone()
+{
+    return service->getForPhone();
+}
+
 int PhoneAPI::onNotify(uint32_t newValue)
 {
     bool timeout = checkConnectionTimeout(); // a handy place to check if we've heard from the phone (since the BLE version
@@ -52,6 +52,9 @@ class PhoneAPI
 
     State state = STATE_SEND_NOTHING;
 
+    /// Counted in MeshService::sharedQueueReaders while connected
+    bool sharedQueueReader = false;
+
     uint8_t config_state = 0;
 
     // Hashmap of timestamps for last time we received a packet on the API per portnum
@@ -159,6 +162,13 @@ class PhoneAPI
      */
     virtual void onNowHasData(uint32_t fromRadioNum) {}
 
+    /// Return the next mesh packet for this client. Connections that are handed their own copy of every packet (several TCP
+    /// clients, see APIServerPort) override this, everyone else shares the MeshService queue.
+    virtual meshtastic_MeshPacket *getPacketForPhone();
+
+    /// @return false if getPacketForPhone() does not read the MeshService queue, see MeshService::sharedQueueReaders
+    virtual bool readsSharedQueue() { return true; }
+
     /// Subclasses can use these lifecycle hooks for transport-specific behavior around config/steady-state
     /// (i.e. BLE connection params)
     virtual void onConfigStart() {}
@@ -561,8 +561,7 @@ uint32_t RadioInterface::getRetransmissionMsec(const meshtastic_MeshPacket *p)
     uint32_t packetAirtime = getPacketTime(numbytes + sizeof(PacketHeader));
     // Make sure enough time has elapsed for this packet to be sent and an ACK is received.
     // LOG_DEBUG("Waiting for flooding message with airtime %d and slotTime is %d", packetAirtime, slotTimeMsec);
-    float channelUtil = airTime->channelUtilizationPercent();
-    uint8_t CWsize = map(channelUtil, 0, 100, CWmin, CWmax);
+    uint8_t CWsize = getCWsizeForUtil(airTime->channelUtilizationPercent());
     // Assuming we pick max. of CWsize and there will be a client with SNR at half the range
     return 2 * packetAirtime + (pow_of_2(CWsize) + 2 * CWmax + pow_of_2(int((CWmax + CWmin) / 2))) * slotTimeMsec +
            PROCESSING_TIME_MSEC;
@@ -575,11 +574,17 @@ uint32_t RadioInterface::getTxDelayMsec()
     The pool to take a random multiple from is the contention window (CW), which size depends on the
     current channel utilization. */
     float channelUtil = airTime->channelUtilizationPercent();
-    uint8_t CWsize = map(channelUtil, 0, 100, CWmin, CWmax);
+    uint8_t CWsize = getCWsizeForUtil(channelUtil);
     // LOG_DEBUG("Current channel utilization is %f so setting CWsize to %d", channelUtil, CWsize);
     return random(0, pow_of_2(CWsize)) * slotTimeMsec;
 }
 
+/** The CW size to use for our own packets at this channel utilization */
+uint8_t RadioInterface::getCWsizeForUtil(float channelUtil)
+{
+    return map(channelUtil, 0, 100, CWmin, CWmax);
+}
+
 /** The CW size to use when calculating SNR_based delays */
 uint8_t RadioInterface::getCWsize(float snr)
 {
@@ -592,12 +597,48 @@ uint8_t RadioInterface::getCWsize(float snr)
     return map(snr, SNR_MIN, SNR_MAX, CWmin, CWmax);
 }
 
+/** How many slots the random delay of a rebroadcast with this CW is picked from */
+uint32_t RadioInterface::getRebroadcastWindowSlots(uint8_t CWsize, bool likeRouter)
+{
+    return likeRouter ? 2 * CWsize : pow_of_2(CWsize);
+}
+
+/** How many steps to widen the CW of a rebroadcast by, for channel utilization and other nodes already relaying it */
+uint8_t RadioInterface::getCongestionCWsteps(const meshtastic_MeshPacket *p)
+{
+    float channelUtil = airTime ? airTime->channelUtilizationPercent() : 0;
+    // Our queued copy has us as relay_node. Besides us, the history holds the node we heard it from and anyone heard relaying
+    // it since.
+    uint8_t relayers = router ? router->countRelayers(p->id, getFrom(p), p->relay_node) : 0;
+    return getCongestionCWsteps(channelUtil, relayers);
+}
+
+uint8_t RadioInterface::getCongestionCWsteps(float channelUtil, uint8_t otherRelayers)
+{
+    uint32_t steps = (uint32_t)(channelUtil / REBROADCAST_CW_UTIL_STEP);
+    if (otherRelayers > 1)
+        steps += otherRelayers - 1;
+    return min(steps, (uint32_t)REBROADCAST_CW_MAX_EXTRA);
+}
+
+/** A CW widened by steps, never past CWmax */
+uint8_t RadioInterface::widenCWsize(uint8_t CWsize, uint8_t steps)
+{
+    return min((uint8_t)(CWsize + steps), CWmax);
+}
+
+uint32_t RadioInterface::getRebroadcastWorstSlots(float snr)
+{
+    // getTxDelayMsecWeighted() may widen the CW for congestion, so the worst case has to assume the widest it can get
+    uint8_t CWsize = widenCWsize(getCWsize(snr), REBROADCAST_CW_MAX_EXTRA);
+    // offset the maximum delay for routers: (2 * CWmax * slotTimeMsec)
+    return getRebroadcastOffsetSlots(false) + getRebroadcastWindowSlots(CWsize, false);
+}
+
 /** The worst-case SNR_based packet delay */
 uint32_t RadioInterface::getTxDelayMsecWeightedWorst(float snr)
 {
-    uint8_t CWsize = getCWsize(snr);
-    // offset the maximum delay for routers: (2 * CWmax * slotTimeMsec)
-    return (2 * CWmax * slotTimeMsec) + pow_of_2(CWsize) * slotTimeMsec;
+    return getRebroadcastWorstSlots(snr) * slotTimeMsec;
 }
 
 /** Returns true if we should rebroadcast early like a ROUTER */
@@ -620,14 +661,22 @@ uint32_t RadioInterface::getTxDelayMsecWeighted(meshtastic_MeshPacket *p)
     uint32_t delay = 0;
     uint8_t CWsize = getCWsize(snr);
     // LOG_DEBUG("rx_snr of %f so setting CWsize to:%d", snr, CWsize);
-    if (shouldRebroadcastEarlyLikeRouter(p)) {
-        delay = random(0, 2 * CWsize) * slotTimeMsec;
-        LOG_DEBUG("rx_snr found in packet. Router: setting tx delay:%d", delay);
-    } else {
-        // offset the maximum delay for routers: (2 * CWmax * slotTimeMsec)
-        delay = (2 * CWmax * slotTimeMsec) + random(0, pow_of_2(CWsize)) * slotTimeMsec;
-        LOG_DEBUG("rx_snr found in packet. Setting tx delay:%d", delay);
+    // A busy channel or others already relaying: spread out more, up to the largest window
+    uint8_t snrCWsize = CWsize;
+    if (CWsize < CWmax)
+        CWsize = widenCWsize(CWsize, getCongestionCWsteps(p));
+    if (p->id != rebroadcastCWId || getFrom(p) != rebroadcastCWFrom) {
+        rebroadcastCWId = p->id;
+        rebroadcastCWFrom = getFrom(p);
+        rebroadcastCWCount++;
+        rebroadcastCWSum += CWsize;
+        if (CWsize > snrCWsize)
+            rebroadcastCWWidened++;
     }
+    bool likeRouter = shouldRebroadcastEarlyLikeRouter(p);
+    // offset the maximum delay for routers: (2 * CWmax * slotTimeMsec)
+    delay = (getRebroadcastOffsetSlots(likeRouter) + random(0, getRebroadcastWindowSlots(CWsize, likeRouter))) * slotTimeMsec;
+    LOG_DEBUG("rx_snr found in packet. %s tx delay:%d", likeRouter ? "Router: setting" : "Setting", delay);
 
     return delay;
 }
@@ -886,11 +935,16 @@ void RadioInterface::applyModemConfig()
   - Tx/Rx turnaround time (maximum of SX126x and SX127x);
   - MAC processing time (measured on T-beam) */
 uint32_t RadioInterface::computeSlotTimeMsec()
+{
+    return computeSlotTimeMsec(bw, sf, myRegion->wideLora);
+}
+
+uint32_t RadioInterface::computeSlotTimeMsec(float bw, uint8_t sf, bool wideLora)
 {
     float sumPropagationTurnaroundMACTime = 0.2 + 0.4 + 7; // in milliseconds
     float symbolTime = pow_of_2(sf) / bw;                  // in milliseconds
 
-    if (myRegion->wideLora) {
+    if (wideLora) {
         // CAD duration derived from AN1200.22 of SX1280
         return (NUM_SYM_CAD_24GHZ + (2 * sf + 3) / 32) * symbolTime + sumPropagationTurnaroundMACTime;
     } else {
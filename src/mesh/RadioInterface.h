@@ -27,6 +27,16 @@ typedef struct _meshtastic_Config_LoRaConfig meshtastic_Config_LoRaConfig;
 #define PACKET_FLAGS_HOP_START_MASK 0xE0
 #define PACKET_FLAGS_HOP_START_SHIFT 5
 
+// Rebroadcasts wait in a contention window one step (twice as many slots) larger for each this many percent of channel
+// utilization, and for each other node already heard relaying the packet
+#ifndef REBROADCAST_CW_UTIL_STEP
+#define REBROADCAST_CW_UTIL_STEP 20
+#endif
+// Most steps the window grows by for congestion. It never grows past CWmax.
+#ifndef REBROADCAST_CW_MAX_EXTRA
+#define REBROADCAST_CW_MAX_EXTRA 3
+#endif
+
 /**
  * This structure has to exactly match the wire layout when sent over the radio link.  Used to keep compatibility
  * with the old radiohead implementation.
@@ -92,15 +102,27 @@ class RadioInterface
     uint8_t sf = 9;
     uint8_t cr = 5;
 
-    const uint8_t NUM_SYM_CAD = 2;       // Number of symbols used for CAD, 2 is the default since RadioLib 6.3.0 as per AN1200.48
-    const uint8_t NUM_SYM_CAD_24GHZ = 4; // Number of symbols used for CAD in 2.4 GHz, 4 is recommended in AN1200.22 of SX1280
+    // Number of symbols used for CAD, 2 is the default since RadioLib 6.3.0 as per AN1200.48
+    static constexpr uint8_t NUM_SYM_CAD = 2;
+    // Number of symbols used for CAD in 2.4 GHz, 4 is recommended in AN1200.22 of SX1280
+    static constexpr uint8_t NUM_SYM_CAD_24GHZ = 4;
     uint32_t slotTimeMsec = computeSlotTimeMsec();
     uint16_t preambleLength = 16;    // 8 is default, but we use longer to increase the amount of sleep time when receiving
     uint32_t preambleTimeMsec = 165; // calculated on startup, this is the default for LongFast
     const uint32_t PROCESSING_TIME_MSEC =
-        4500;                // time to construct, process and construct a packet again (empirically determined)
-    const uint8_t CWmin = 3; // minimum CWsize
-    const uint8_t CWmax = 8; // maximum CWsize
+        4500; // time to construct, process and construct a packet again (empirically determined)
+
+  public:
+    static constexpr uint8_t CWmin = 3; // minimum CWsize
+    static constexpr uint8_t CWmax = 8; // maximum CWsize
+
+    /// Contention windows picked for rebroadcasts: how many, their sum (for the average) and how many were widened by congestion
+    uint32_t rebroadcastCWCount = 0, rebroadcastCWSum = 0, rebroadcastCWWidened = 0;
+
+  protected:
+    // The last rebroadcast counted above, a busy channel makes us pick its window again
+    NodeNum rebroadcastCWFrom = 0;
+    PacketId rebroadcastCWId = 0;
 
     meshtastic_MeshPacket *sendingPacket = NULL; // The packet we are currently sending
     uint32_t lastTxStart = 0L;
@@ -129,6 +151,31 @@ class RadioInterface
      */
     static void bootstrapLoRaConfigFromPreset(meshtastic_Config_LoRaConfig &loraConfig);
 
+    /** Slot time for these modem settings: CAD duration plus propagation, turnaround and MAC processing time */
+    static uint32_t computeSlotTimeMsec(float bw, uint8_t sf, bool wideLora);
+
+    /** The CW to use when calculating SNR_based delays */
+    static uint8_t getCWsize(float snr);
+
+    /** The CW to use for our own packets at this channel utilization */
+    static uint8_t getCWsizeForUtil(float channelUtil);
+
+    /** Slots a rebroadcast waits before its random delay, so routers go before everyone else */
+    static uint32_t getRebroadcastOffsetSlots(bool likeRouter) { return likeRouter ? 0 : 2 * CWmax; }
+
+    /** How many slots the random delay of a rebroadcast with this CW is picked from */
+    static uint32_t getRebroadcastWindowSlots(uint8_t CWsize, bool likeRouter);
+
+    /** Steps to widen a rebroadcast CW by at this channel utilization, with this many other nodes heard relaying it */
+    static uint8_t getCongestionCWsteps(float channelUtil, uint8_t otherRelayers);
+
+    /** A CW widened by steps, never past CWmax */
+    static uint8_t widenCWsize(uint8_t CWsize, uint8_t steps);
+
+    /** Slots until the last rebroadcast at this SNR can go out, with its CW widened as far as congestion can widen it.
+     * The late rebroadcast window starts here. */
+    static uint32_t getRebroadcastWorstSlots(float snr);
+
     /**
      * Return true if we think the board can go to sleep (i.e. our tx queue is empty, we are not sending or receiving)
      *
@@ -187,8 +234,8 @@ class RadioInterface
     /** The delay to use when we want to send something */
     [[nodiscard]] uint32_t getTxDelayMsec();
 
-    /** The CW to use when calculating SNR_based delays */
-    [[nodiscard]] uint8_t getCWsize(float snr);
+    /** How many steps to widen the CW of a rebroadcast by, for channel utilization and other nodes already relaying it */
+    [[nodiscard]] uint8_t getCongestionCWsteps(const meshtastic_MeshPacket *p);
 
     /** The worst-case SNR_based packet delay */
     [[nodiscard]] uint32_t getTxDelayMsecWeightedWorst(float snr);
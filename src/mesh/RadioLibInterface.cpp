@@ -1,6 +1,7 @@
 #include "RadioLibInterface.h"
 #include "MeshTypes.h"
 #include "NodeDB.h"
+#include "PacketLatency.h"
 #include "PowerMon.h"
 #include "SPILock.h"
 #include "Throttle.h"
@@ -56,6 +57,7 @@ RadioLibInterface::RadioLibInterface(LockingArduinoHal *hal, RADIOLIB_PIN_TYPE c
 void INTERRUPT_ATTR RadioLibInterface::isrLevel0Common(PendingISR cause)
 {
     instance->disableInterrupt();
+    instance->isrMicros = micros();
 
     BaseType_t xHigherPriorityTaskWoken;
     instance->notifyFromISR(&xHigherPriorityTaskWoken, cause, true);
@@ -178,6 +180,7 @@ ErrorCode RadioLibInterface::send(meshtastic_MeshPacket *p)
 
     LOG_DEBUG("txGood=%d,txRelay=%d,rxGood=%d,rxBad=%d", txGood, txRelay, rxGood, rxBad);
     bool dropped = false;
+    packetLatency.mark(p, micros());
     ErrorCode res = txQueue.enqueue(p, &dropped) ? ERRNO_OK : ERRNO_UNKNOWN;
 
     if (dropped) {
@@ -411,6 +414,7 @@ void RadioLibInterface::completeSending()
         // Packet has been sent, count it toward our TX airtime utilization.
         uint32_t xmitMsec = getPacketTime(p);
         airTime->logAirtime(TX_LOG, xmitMsec);
+        packetLatency.finish(PacketLatency::STAGE_AIRTIME, p);
 
         txGood++;
         if (!isFromUs(p))
@@ -510,6 +514,7 @@ void RadioLibInterface::handleReceiveInterrupt()
 
             airTime->logAirtime(RX_LOG, rxMsec);
 
+            packetLatency.mark(mp, isrMicros);
             deliverToReceiver(mp);
         }
     }
@@ -538,6 +543,7 @@ void RadioLibInterface::checkRxDoneIrqFlag()
 {
     if (iface->checkIrq(RADIOLIB_IRQ_RX_DONE)) {
         LOG_WARN("caught missed RX_DONE");
+        isrMicros = micros();
         notify(ISR_RX, true);
     }
 }
@@ -564,6 +570,7 @@ bool RadioLibInterface::startSend(meshtastic_MeshPacket *txp)
         packetPool.release(txp);
         return false;
     } else {
+        packetLatency.finish(PacketLatency::STAGE_TX_QUEUE, txp);
         configHardwareForSend(); // must be after setStandby
 
         size_t numbytes = beginSending(txp);
@@ -582,6 +589,7 @@ bool RadioLibInterface::startSend(meshtastic_MeshPacket *txp)
             // bits
             enableInterrupt(isrTxLevel0);
             lastTxStart = millis();
+            packetLatency.mark(txp, micros());
             printPacket("Started Tx", txp);
         }
 
@@ -62,6 +62,9 @@ class RadioLibInterface : public RadioInterface, protected concurrency::Notified
 
     MeshPacketQueue txQueue = MeshPacketQueue(MAX_TX_QUEUE);
 
+    /// micros() at the last radio interrupt, for the latency of received packets
+    volatile uint32_t isrMicros = 0;
+
   protected:
     ModemType_t modemType = RADIOLIB_MODEM_LORA;
     DataRate_t getDataRate() const { return {.lora = {.spreadingFactor = sf, .bandwidth = bw, .codingRate = cr}}; }
@@ -4,6 +4,7 @@
 #include "MeshRadio.h"
 #include "MeshService.h"
 #include "NodeDB.h"
+#include "PacketLatency.h"
 #include "RTC.h"
 
 #include "configuration.h"
@@ -138,6 +139,7 @@ int32_t Router::runOnce()
     meshtastic_MeshPacket *mp;
     while ((mp = fromRadioQueue.dequeuePtr(0)) != NULL) {
         // printPacket("handle fromRadioQ", mp);
+        packetLatency.finish(PacketLatency::STAGE_ISR_TO_ROUTER, mp);
         perhapsHandleReceived(mp);
     }
 
@@ -466,10 +468,11 @@ DecodeState perhapsDecode(meshtastic_MeshPacket *p)
 
     // assert(p->which_payloadVariant == MeshPacket_encrypted_tag);
     if (!decrypted) {
-        // Try to find a channel that works with this hash
-        for (chIndex = 0; chIndex < channels.getNumChannels(); chIndex++) {
+        // Try to find a channel that works with this hash, only channels with a matching hash can have sent it
+        ChannelMask candidates = channels.getChannelsForHash(p->channel);
+        for (chIndex = 0; candidates; chIndex++, candidates >>= 1) {
             // Try to use this hash/channel pair
-            if (channels.decryptForHash(chIndex, p->channel)) {
+            if ((candidates & 1) && channels.decryptForHash(chIndex, p->channel)) {
                 // we have to copy into a scratch buffer, because these bytes are a union with the decoded protobuf. Create a
                 // fresh copy for each decrypt attempt.
                 memcpy(bytes, p->encrypted.bytes, rawSize);
@@ -553,7 +556,9 @@ DecodeState perhapsDecode(meshtastic_MeshPacket *p)
                 }
             }
             if (portduino_config.JSONFilter == (_meshtastic_PortNum)0 || portduino_config.JSONFilter == p->decoded.portnum) {
-                JSONFile << MeshPacketSerializer::JsonSerialize(p, false) << std::endl;
+                static char jsonBuffer[MESHPACKET_JSON_BUFFER_SIZE];
+                if (MeshPacketSerializer::JsonSerialize(p, jsonBuffer, sizeof(jsonBuffer), false))
+                    JSONFile << jsonBuffer << std::endl;
             }
         }
 #endif
@@ -725,7 +730,11 @@ void Router::handleReceived(meshtastic_MeshPacket *p, RxSource src)
     DEBUG_HEAP_AFTER("Router::handleReceived", p_encrypted);
 
     // Take those raw bytes and convert them back into a well structured protobuf we can understand
+    bool needsDecode = p->which_payload_variant == meshtastic_MeshPacket_encrypted_tag;
+    uint32_t decodeStart = micros();
     auto decodedState = perhapsDecode(p);
+    if (needsDecode)
+        packetLatency.record(PacketLatency::STAGE_DECODE, micros() - decodeStart);
     if (decodedState == DecodeState::DECODE_FATAL) {
         // Fatal decoding error, we can't do anything with this packet
         LOG_WARN("Fatal decode error, dropping packet");
@@ -772,7 +781,9 @@ void Router::handleReceived(meshtastic_MeshPacket *p, RxSource src)
     // call modules here
     // If this could be a spoofed packet, don't let the modules see it.
     if (!skipHandle) {
+        uint32_t modulesStart = micros();
         MeshModule::callModules(*p, src);
+        packetLatency.record(PacketLatency::STAGE_MODULES, micros() - modulesStart);
 
 #if !MESHTASTIC_EXCLUDE_MQTT
         if (p_encrypted == nullptr) {
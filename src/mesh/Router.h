@@ -92,6 +92,9 @@ class Router : protected concurrency::OSThread, protected PacketHistory
         before us */
     uint32_t rxDupe = 0, txRelayCanceled = 0;
 
+    // Lets the radio see how many nodes already relayed a packet it is waiting to rebroadcast
+    using PacketHistory::countRelayers;
+
     // pointer to the encrypted packet
     meshtastic_MeshPacket *p_encrypted = nullptr;
 
@@ -23,6 +23,16 @@ class SinglePortModule : public MeshModule
      */
     virtual bool wantPacket(const meshtastic_MeshPacket *p) override { return p->decoded.portnum == ourPortNum; }
 
+    /**
+     * Only offered packets for ourPortNum. Subclasses whose wantPacket() also accepts other portnums must override this to
+     * return false.
+     */
+    virtual bool getDispatchPort(meshtastic_PortNum &port) const override
+    {
+        port = ourPortNum;
+        return true;
+    }
+
     /**
      * Return a mesh packet which has been preinited as a data packet with a particular port number.
      * You can then send this packet (after customizing any of the payload fields you might need) with
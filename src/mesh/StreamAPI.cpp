@@ -13,7 +13,7 @@ int32_t StreamAPI::runOncePart()
     auto result = readStream();
     writeStream();
     checkConnectionTimeout();
-    return result;
+    return writePending ? 0 : result;
 }
 
 int32_t StreamAPI::runOncePart(char *buf, uint16_t bufLen)
@@ -21,7 +21,7 @@ int32_t StreamAPI::runOncePart(char *buf, uint16_t bufLen)
     auto result = readStream(buf, bufLen);
     writeStream();
     checkConnectionTimeout();
-    return result;
+    return writePending ? 0 : result;
 }
 
 /**
@@ -48,11 +48,13 @@ void StreamAPI::writeStream()
 {
     if (canWrite) {
         uint32_t len;
+        uint16_t written = 0;
         do {
             // Send every packet we can
             len = getFromRadio(txBuf + HEADER_LEN);
             emitTxBuffer(len);
-        } while (len);
+        } while (len && (!maxWritesPerPass || ++written < maxWritesPerPass));
+        writePending = len != 0;
     }
 }
 
@@ -212,6 +214,18 @@ void StreamAPI::emitLogRecord(meshtastic_LogRecord_Level level, const char *src,
     emitTxBuffer(pb_encode_to_bytes(txBuf + HEADER_LEN, meshtastic_FromRadio_size, &meshtastic_FromRadio_msg, &fromRadioScratch));
 }
 
+void StreamAPI::emitLogRecord(meshtastic_LogRecord_Level level, const char *src, const char *message, uint32_t rtcSec)
+{
+    // In case we send a FromRadio packet
+    memset(&fromRadioScratch, 0, sizeof(fromRadioScratch));
+    fromRadioScratch.which_payload_variant = meshtastic_FromRadio_log_record_tag;
+    fromRadioScratch.log_record.level = level;
+    fromRadioScratch.log_record.time = rtcSec;
+    strncpy(fromRadioScratch.log_record.source, src, sizeof(fromRadioScratch.log_record.source) - 1);
+    strncpy(fromRadioScratch.log_record.message, message, sizeof(fromRadioScratch.log_record.message) - 1);
+    emitTxBuffer(pb_encode_to_bytes(txBuf + HEADER_LEN, meshtastic_FromRadio_size, &meshtastic_FromRadio_msg, &fromRadioScratch));
+}
+
 /// Hookable to find out when connection changes
 void StreamAPI::onConnectionChanged(bool connected)
 {
@@ -42,6 +42,9 @@ class StreamAPI : public PhoneAPI
     /// time of last rx, used, to slow down our polling if we haven't heard from anyone
     uint32_t lastRxMsec = 0;
 
+    /// writeStream stopped because of maxWritesPerPass while there may be more to send
+    bool writePending = false;
+
   public:
     StreamAPI(Stream *_stream) : stream(_stream) {}
 
@@ -84,9 +87,16 @@ class StreamAPI : public PhoneAPI
     /// Are we allowed to write packets to our output stream (subclasses can turn this off - i.e. SerialConsole)
     bool canWrite = true;
 
+    /// Max FromRadio packets written per runOncePart, 0 for no limit. Lets several connections take turns instead of one
+    /// long config download holding up the rest.
+    uint16_t maxWritesPerPass = 0;
+
     /// Subclasses can use this scratch buffer if they wish
     uint8_t txBuf[MAX_STREAM_BUF_SIZE] = {0};
 
     /// Low level function to emit a protobuf encapsulated log record
     void emitLogRecord(meshtastic_LogRecord_Level level, const char *src, const char *format, va_list arg);
+
+    /// Same for a message which was already formatted, rtcSec is when it was logged
+    void emitLogRecord(meshtastic_LogRecord_Level level, const char *src, const char *message, uint32_t rtcSec);
 };
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include "ServerAPI.h"
+#include "MeshService.h"
 #include "configuration.h"
 #include <Arduino.h>
 
@@ -6,17 +7,20 @@ template <typename T>
 ServerAPI<T>::ServerAPI(T &_client) : StreamAPI(&client), concurrency::OSThread("ServerAPI"), client(_client)
 {
     LOG_INFO("Incoming API connection");
+    maxWritesPerPass = API_CLIENT_WRITES_PER_PASS;
 }
 
 template <typename T> ServerAPI<T>::~ServerAPI()
 {
     client.stop();
+    releaseQueuedPackets();
 }
 
 template <typename T> void ServerAPI<T>::close()
 {
     client.stop(); // drop tcp connection
     StreamAPI::close();
+    releaseQueuedPackets();
 }
 
 /// Check the current underlying physical link to see if the client is currently connected
@@ -25,6 +29,43 @@ template <typename T> bool ServerAPI<T>::checkIsConnected()
     return client.connected();
 }
 
+template <typename T> void ServerAPI<T>::enqueuePacket(const meshtastic_MeshPacket &packet)
+{
+    meshtastic_MeshPacket *p = packetPool.allocCopy(packet);
+    if (!p) {
+        droppedPackets++;
+        return;
+    }
+    if (packetQueue.size() >= MAX_API_CLIENT_PACKETS) {
+        service->releaseToPool(packetQueue.front());
+        packetQueue.pop_front();
+        if (droppedPackets++ == 0)
+            LOG_WARN("API client not keeping up, drop its oldest packets");
+    }
+    packetQueue.push_back(p);
+}
+
+template <typename T> meshtastic_MeshPacket *ServerAPI<T>::getPacketForPhone()
+{
+    if (!ownPacketQueue)
+        return PhoneAPI::getPacketForPhone();
+    if (packetQueue.empty())
+        return nullptr;
+    meshtastic_MeshPacket *p = packetQueue.front();
+    packetQueue.pop_front();
+    return p;
+}
+
+template <typename T> void ServerAPI<T>::releaseQueuedPackets()
+{
+    for (auto p : packetQueue)
+        service->releaseToPool(p);
+    packetQueue.clear();
+    if (droppedPackets)
+        LOG_INFO("API client dropped %u packets it did not read in time", droppedPackets);
+    droppedPackets = 0;
+}
+
 template <class T> int32_t ServerAPI<T>::runOnce()
 {
     if (client.connected()) {
@@ -37,18 +78,38 @@ template <class T> int32_t ServerAPI<T>::runOnce()
     }
 }
 
-template <class T, class U> APIServerPort<T, U>::APIServerPort(int port) : U(port), concurrency::OSThread("ApiServer") {}
+template <class T, class U>
+APIServerPort<T, U>::APIServerPort(int port, size_t maxClients)
+    : U(port), concurrency::OSThread("ApiServer"), maxClients(maxClients ? maxClients : 1)
+{
+}
 
 template <class T, class U> void APIServerPort<T, U>::init()
 {
     U::begin();
+    if (maxClients > 1) {
+        packetObserver.observe(&service->packetToPhone);
+        service->packetsFannedOut = true;
+    }
+}
+
+template <class T, class U> int APIServerPort<T, U>::onPacketToPhone(const meshtastic_MeshPacket *p)
+{
+    // Clients still downloading their config keep the packet for afterwards, like the shared queue would
+    for (auto &api : openAPIs)
+        if (api->isConnected())
+            api->enqueuePacket(*p);
+    return 0;
 }
 
 template <class T, class U> int32_t APIServerPort<T, U>::runOnce()
 {
-    // Clean up previous connection if its client already disconnected
-    if (openAPI && !openAPI->checkIsConnected()) {
-        openAPI.reset();
+    // Clean up connections whose client already disconnected
+    for (auto it = openAPIs.begin(); it != openAPIs.end();) {
+        if (!(*it)->checkIsConnected())
+            it = openAPIs.erase(it);
+        else
+            ++it;
     }
 
 #ifdef ARCH_ESP32
@@ -63,8 +124,13 @@ template <class T, class U> int32_t APIServerPort<T, U>::runOnce()
     auto client = U::available();
 #endif
     if (client) {
-        // Close any previous connection (see FIXME in header file)
-        if (openAPI) {
+        if (openAPIs.size() >= maxClients) {
+            if (maxClients > 1) {
+                LOG_WARN("Refuse TCP connection, all %u API client slots are in use", (unsigned)maxClients);
+                client.stop();
+                return 100;
+            }
+            // A single slot: close the previous connection, see the class comment
 #if RAK_4631
             // RAK13800 Ethernet requests periodically take more time
             // This backoff addresses most cases keeping max wait < 1s
@@ -76,14 +142,16 @@ template <class T, class U> int32_t APIServerPort<T, U>::runOnce()
             }
 #endif
             LOG_INFO("Force close previous TCP connection");
-            openAPI.reset();
+            openAPIs.clear();
         }
 
-        openAPI.reset(new T(client));
+        openAPIs.emplace_back(new T(client));
+        if (maxClients > 1)
+            openAPIs.back()->useOwnPacketQueue();
     }
 
 #if RAK_4631
     waitTime = 100;
 #endif
     return 100; // only check occasionally for incoming connections
-}
\ No newline at end of file
+}
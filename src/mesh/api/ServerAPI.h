@@ -1,10 +1,30 @@
 #pragma once
 
 #include "StreamAPI.h"
+#include <deque>
 #include <memory>
+#include <vector>
 
 #define SERVER_API_DEFAULT_PORT 4403
 
+/// How many TCP API clients may be connected at once. On the embedded targets every client costs packet buffers from a static
+/// pool, so they keep the old single connection behavior: a new connection replaces the open one.
+#ifndef MAX_API_CLIENTS
+#ifdef ARCH_PORTDUINO
+#define MAX_API_CLIENTS 4
+#else
+#define MAX_API_CLIENTS 1
+#endif
+#endif
+
+/// How many mesh packets may wait for one TCP client before its oldest ones are dropped
+#ifndef MAX_API_CLIENT_PACKETS
+#define MAX_API_CLIENT_PACKETS MAX_RX_TOPHONE
+#endif
+
+/// How many FromRadio packets one TCP client may write before letting the other threads run
+#define API_CLIENT_WRITES_PER_PASS 8
+
 /**
  * Provides both debug printing and, if the client starts sending protobufs to us, switches to send/receive protobufs
  * (and starts dropping debug printing - FIXME, eventually those prints should be encapsulated in protobufs).
@@ -14,6 +34,15 @@ template <class T> class ServerAPI : public StreamAPI, private concurrency::OSTh
   private:
     T client;
 
+    /// Copies of mesh packets handed to us by APIServerPort, waiting for this client to download them
+    std::deque<meshtastic_MeshPacket *> packetQueue;
+
+    /// Read packetQueue rather than the MeshService queue shared with the other transports
+    bool ownPacketQueue = false;
+
+    /// Number of packets this client missed because it did not keep up
+    uint32_t droppedPackets = 0;
+
   public:
     explicit ServerAPI(T &_client);
 
@@ -25,35 +54,63 @@ template <class T> class ServerAPI : public StreamAPI, private concurrency::OSTh
     /// Check the current underlying physical link to see if the client is currently connected
     virtual bool checkIsConnected() override;
 
+    /// Get mesh packets only through enqueuePacket() from now on
+    void useOwnPacketQueue() { ownPacketQueue = true; }
+
+    /**
+     * Keep a copy of a packet for this client. If the client has fallen MAX_API_CLIENT_PACKETS behind, its oldest packet
+     * is dropped, so a slow reader only loses its own packets and never holds up the other clients.
+     */
+    void enqueuePacket(const meshtastic_MeshPacket &p);
+
   protected:
     /// We override this method to prevent publishing EVENT_SERIAL_CONNECTED/DISCONNECTED for wifi links (we want the board to
     /// stay in the POWERED state to prevent disabling wifi)
     virtual void onConnectionChanged(bool connected) override {}
 
+    virtual meshtastic_MeshPacket *getPacketForPhone() override;
+
+    virtual bool readsSharedQueue() override { return !ownPacketQueue; }
+
     virtual int32_t runOnce() override; // Check for dropped client connections
+
+  private:
+    void releaseQueuedPackets();
 };
 
 /**
  * Listens for incoming connections and does accepts and creates instances of ServerAPI as needed
+ *
+ * Each connection runs its own ServerAPI thread with its own PhoneAPI state. With a single client allowed it reads the
+ * MeshService queue like the serial, BLE and HTTP clients do. With more, every client that has asked for its config gets
+ * its own copy of each packet as MeshService queues it for the phone, and the shared queue is left to the other transports.
+ * Once all slots are taken further connections are refused, except with a single slot, where the new connection replaces
+ * the open one as it always has, so a phone reconnecting after losing WiFi is not locked out by its own stale socket.
  */
 template <class T, class U> class APIServerPort : public U, private concurrency::OSThread
 {
-    /** The currently open port
-     *
-     * FIXME: We currently only allow one open TCP connection at a time, because we depend on the loop() call in this class to
-     * delegate to the worker.  Once coroutines are implemented we can relax this restriction.
-     */
-    std::unique_ptr<T> openAPI;
+    /// The currently open connections, oldest first
+    std::vector<std::unique_ptr<T>> openAPIs;
+
+    size_t maxClients;
+
+    CallbackObserver<APIServerPort<T, U>, const meshtastic_MeshPacket *> packetObserver =
+        CallbackObserver<APIServerPort<T, U>, const meshtastic_MeshPacket *>(this, &APIServerPort<T, U>::onPacketToPhone);
+
 #if defined(RAK_4631) || defined(RAK11310)
     // Track wait time for RAK13800 Ethernet requests
     int32_t waitTime = 100;
 #endif
 
   public:
-    explicit APIServerPort(int port);
+    explicit APIServerPort(int port, size_t maxClients = MAX_API_CLIENTS);
 
     void init();
 
   protected:
     int32_t runOnce() override;
+
+  private:
+    /// Give every client that is ready for them a copy of a packet MeshService is queueing for the phone
+    int onPacketToPhone(const meshtastic_MeshPacket *p);
 };
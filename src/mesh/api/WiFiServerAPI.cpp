@@ -3,6 +3,9 @@
 
 #if HAS_WIFI
 #include "WiFiServerAPI.h"
+#ifdef ARCH_PORTDUINO
+#include "PortduinoGlue.h"
+#endif
 
 static WiFiServerPort *apiPort;
 
@@ -10,7 +13,11 @@ void initApiServer(int port)
 {
     // Start API server on port 4403
     if (!apiPort) {
+#ifdef ARCH_PORTDUINO
+        apiPort = new WiFiServerPort(port, portduino_config.maxAPIClients);
+#else
         apiPort = new WiFiServerPort(port);
+#endif
         LOG_INFO("API server listen on TCP port %d", port);
         apiPort->init();
     }
@@ -29,5 +36,5 @@ WiFiServerAPI::WiFiServerAPI(WiFiClient &_client) : ServerAPI(_client)
     LOG_INFO("Incoming wifi connection");
 }
 
-WiFiServerPort::WiFiServerPort(int port) : APIServerPort(port) {}
+WiFiServerPort::WiFiServerPort(int port, size_t maxClients) : APIServerPort(port, maxClients) {}
 #endif
\ No newline at end of file
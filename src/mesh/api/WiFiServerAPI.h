@@ -24,7 +24,7 @@ class WiFiServerAPI : public ServerAPI<WiFiClient>
 class WiFiServerPort : public APIServerPort<WiFiServerAPI, WiFiServer>
 {
   public:
-    explicit WiFiServerPort(int port);
+    explicit WiFiServerPort(int port, size_t maxClients = MAX_API_CLIENTS);
 };
 
 void initApiServer(int port = SERVER_API_DEFAULT_PORT);
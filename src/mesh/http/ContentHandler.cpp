@@ -1,5 +1,6 @@
 #if !MESHTASTIC_EXCLUDE_WEBSERVER
 #include "NodeDB.h"
+#include "PacketLatency.h"
 #include "PowerFSM.h"
 #include "RadioLibInterface.h"
 #include "airtime.h"
@@ -685,6 +686,28 @@ void handleReport(HTTPRequest *req, HTTPResponse *res)
     JSONObject jsonObjRadio;
     jsonObjRadio["frequency"] = new JSONValue(RadioLibInterface::instance->getFreq());
     jsonObjRadio["lora_channel"] = new JSONValue((int)RadioLibInterface::instance->getChannelNum() + 1);
+    const RadioLibInterface *radio = RadioLibInterface::instance;
+    jsonObjRadio["rebroadcast_cw_count"] = new JSONValue((int)radio->rebroadcastCWCount);
+    jsonObjRadio["rebroadcast_cw_avg"] =
+        new JSONValue(radio->rebroadcastCWCount ? (double)radio->rebroadcastCWSum / radio->rebroadcastCWCount : 0.0);
+    jsonObjRadio["rebroadcast_cw_widened"] = new JSONValue((int)radio->rebroadcastCWWidened);
+
+    // data->latency, bucket counts are for the limits in bucket_limits_us, the last bucket has no limit
+    JSONObject jsonObjLatency;
+    uint32_t bucketLimits[LatencyHistogram::NUM_BUCKETS - 1];
+    for (uint8_t i = 0; i < LatencyHistogram::NUM_BUCKETS - 1; i++)
+        bucketLimits[i] = LatencyHistogram::bucketLimit(i);
+    jsonObjLatency["bucket_limits_us"] = createJSONArrayFromLog(bucketLimits, LatencyHistogram::NUM_BUCKETS - 1);
+    for (uint8_t stage = 0; stage < PacketLatency::NUM_STAGES; stage++) {
+        const LatencyHistogram &h = packetLatency.get((PacketLatency::Stage)stage);
+        JSONObject jsonObjStage;
+        jsonObjStage["count"] = new JSONValue((int)h.getCount());
+        jsonObjStage["p50_us"] = new JSONValue((int)h.percentile(50));
+        jsonObjStage["p90_us"] = new JSONValue((int)h.percentile(90));
+        jsonObjStage["max_us"] = new JSONValue((int)h.getMax());
+        jsonObjStage["buckets"] = createJSONArrayFromLog(h.getBuckets(), LatencyHistogram::NUM_BUCKETS);
+        jsonObjLatency[PacketLatency::stageName((PacketLatency::Stage)stage)] = new JSONValue(jsonObjStage);
+    }
 
     // collect data to inner data object
     JSONObject jsonObjInner;
@@ -694,6 +717,7 @@ void handleReport(HTTPRequest *req, HTTPResponse *res)
     jsonObjInner["power"] = new JSONValue(jsonObjPower);
     jsonObjInner["device"] = new JSONValue(jsonObjDevice);
     jsonObjInner["radio"] = new JSONValue(jsonObjRadio);
+    jsonObjInner["latency"] = new JSONValue(jsonObjLatency);
 
     // create json output structure
     JSONObject jsonObjOuter;
@@ -56,6 +56,8 @@ mail:   marchammermann@googlemail.com
 #include <ulfius.h>
 #include <yder.h>
 
+#include <algorithm>
+#include <chrono>
 #include <cstring>
 #include <string>
 
@@ -248,20 +250,73 @@ int handleAPIv1ToRadio(const struct _u_request *req, struct _u_response *res, vo
     portduinoVFS->mountpoint(configWeb.rootPath);
 
     LOG_DEBUG("Received %d bytes from PUT request", s);
-    static_cast<HttpAPI *>(user_data)->handleToRadio(buffer, s);
+    static_cast<HttpAPI *>(user_data)->writeToRadio(buffer, s);
     LOG_DEBUG("end web->radio  ");
     return U_CALLBACK_COMPLETE;
 }
 
+void HttpAPI::writeToRadio(const uint8_t *buf, size_t len)
+{
+    std::lock_guard<std::mutex> lock(apiMutex);
+    handleToRadio(buf, len);
+}
+
+void HttpAPI::onNowHasData(uint32_t fromRadioNum)
+{
+    std::lock_guard<std::mutex> lock(dataMutex);
+    dataCount++;
+    dataReady.notify_all();
+}
+
+size_t HttpAPI::readFromRadio(uint8_t *buf, size_t size, bool all, uint32_t waitMs)
+{
+    // Not everything the client is sent comes with onNowHasData(), so check again at least this often
+    const auto recheck = std::chrono::milliseconds(250);
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(waitMs);
+
+    while (true) {
+        // Taken before looking, so data queued while we look is not missed
+        uint32_t seen;
+        {
+            std::lock_guard<std::mutex> lock(dataMutex);
+            seen = dataCount;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(apiMutex);
+            if (available()) {
+                size_t len = getFromRadio(buf);
+                while (all && len && size - len >= meshtastic_FromRadio_size) {
+                    size_t next = getFromRadio(buf + len);
+                    if (!next)
+                        break;
+                    len += next;
+                }
+                return len;
+            }
+        }
+
+        std::unique_lock<std::mutex> lock(dataMutex);
+        auto now = std::chrono::steady_clock::now();
+        if (now >= deadline)
+            return 0;
+        dataReady.wait_until(lock, std::min(deadline, now + recheck), [&] { return dataCount != seen; });
+    }
+}
+
 /*
  * Adapt the radioapi to the Webservice handleAPIv1FromRadio
  * Trigger : WebGui(POLL)->handleAPIv1FromRadio->phoneapi->Meshtastic(Radio) events
+ *
+ * Query parameters:
+ *   all=true  return every FromRadio queued, up to HTTP_FROMRADIO_MAX_BODY bytes
+ *   wait=<ms> long poll: if nothing is queued, hold the request until something is or the time is up, instead of the
+ *             client polling. ulfius runs each connection in its own thread, so this only blocks the one waiting.
  */
 int handleAPIv1FromRadio(const struct _u_request *req, struct _u_response *res, void *user_data)
 {
 
     // LOG_DEBUG("handleAPIv1FromRadio radio -> web");
-    std::string valueAll;
 
     // Status code is 200 OK by default.
     ulfius_add_header_to_response(res, "Content-Type", "application/x-protobuf");
@@ -275,28 +330,18 @@ int handleAPIv1FromRadio(const struct _u_request *req, struct _u_response *res,
         return U_CALLBACK_COMPLETE;
     }
 
-    uint8_t txBuf[MAX_STREAM_BUF_SIZE];
-    uint32_t len = 1;
-
-    if (valueAll == "true") {
-        while (len) {
-            len = static_cast<HttpAPI *>(user_data)->getFromRadio(txBuf);
-            ulfius_set_response_properties(res, U_OPT_STATUS, 200, U_OPT_BINARY_BODY, txBuf, len);
-            const char *tmpa = (const char *)txBuf;
-            ulfius_set_string_body_response(res, 200, tmpa);
-            // LOG_DEBUG("\n----webAPI response all:----");
-            // LOG_DEBUG(tmpa);
-            // LOG_DEBUG("");
-        }
-        // Otherwise, just return one protobuf
-    } else {
-        len = static_cast<HttpAPI *>(user_data)->getFromRadio(txBuf);
-        const char *tmpa = (const char *)txBuf;
-        ulfius_set_binary_body_response(res, 200, tmpa, len);
-        // LOG_DEBUG("\n----webAPI response:");
-        // LOG_DEBUG(tmpa);
-        // LOG_DEBUG("");
-    }
+    const char *valueAll = u_map_get(req->map_url, "all");
+    bool all = valueAll && strcmp(valueAll, "true") == 0;
+
+    const char *valueWait = u_map_get(req->map_url, "wait");
+    uint32_t waitMs = valueWait ? strtoul(valueWait, NULL, 10) : 0;
+    if (waitMs > HTTP_FROMRADIO_MAX_WAIT_MS)
+        waitMs = HTTP_FROMRADIO_MAX_WAIT_MS;
+
+    static_assert(HTTP_FROMRADIO_MAX_BODY >= meshtastic_FromRadio_size, "HTTP_FROMRADIO_MAX_BODY must hold one FromRadio");
+    uint8_t txBuf[HTTP_FROMRADIO_MAX_BODY];
+    size_t len = static_cast<HttpAPI *>(user_data)->readFromRadio(txBuf, sizeof(txBuf), all, waitMs);
+    ulfius_set_binary_body_response(res, 200, (const char *)txBuf, len);
 
     // LOG_DEBUG("end radio->web", len);
     return U_CALLBACK_COMPLETE;
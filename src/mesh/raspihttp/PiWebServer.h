@@ -5,10 +5,22 @@
 #include "ulfius-cfg.h"
 #include "ulfius.h"
 #include <Arduino.h>
+#include <condition_variable>
 #include <functional>
+#include <mutex>
 
 #define STATIC_FILE_CHUNK 256
 
+// Longest a GET /api/v1/fromradio?wait=<ms> long poll is held open waiting for data
+#ifndef HTTP_FROMRADIO_MAX_WAIT_MS
+#define HTTP_FROMRADIO_MAX_WAIT_MS 30000
+#endif
+
+// Most bytes of FromRadio protobufs returned by one GET /api/v1/fromradio?all=true
+#ifndef HTTP_FROMRADIO_MAX_BODY
+#define HTTP_FROMRADIO_MAX_BODY 4096
+#endif
+
 void initWebServer();
 void createSSLCert();
 int callback_static_file(const struct _u_request *request, struct _u_response *response, void *user_data);
@@ -32,10 +44,27 @@ class HttpAPI : public PhoneAPI
     /// Check the current underlying physical link to see if the client is currently connected
     virtual bool checkIsConnected() override { return true; } // FIXME, be smarter about this
 
+    /**
+     * Copy FromRadio protobufs into buf, waiting up to waitMs for the first one. If all is set, further ones are added
+     * while they are sure to fit in size.
+     * @return bytes copied, 0 if nothing arrived in time
+     */
+    size_t readFromRadio(uint8_t *buf, size_t size, bool all, uint32_t waitMs);
+
+    /// Pass a ToRadio protobuf from a web client to handleToRadio()
+    void writeToRadio(const uint8_t *buf, size_t len);
+
   private:
-    // Nothing here yet
+    // Web server threads waiting in readFromRadio() are woken when the mesh thread queues data
+    std::mutex dataMutex;
+    std::condition_variable dataReady;
+    uint32_t dataCount = 0;
+
+    // The PhoneAPI state is used from one web server thread at a time, whether it reads FromRadio or handles a ToRadio
+    std::mutex apiMutex;
 
   protected:
+    virtual void onNowHasData(uint32_t fromRadioNum) override;
 };
 
 class PiWebServerThread
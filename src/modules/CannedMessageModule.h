@@ -98,6 +98,8 @@ class CannedMessageModule : public SinglePortModule, public Observable<const UIF
             lastRxSnr = p->rx_snr;
         return (p->decoded.portnum == meshtastic_PortNum_ROUTING_APP) ? waitingForAck : false;
     }
+    // Sees every packet for the signal report above
+    virtual bool getDispatchPort(meshtastic_PortNum &port) const override { return false; }
 
   protected:
     // === Thread Entry Point ===
@@ -69,6 +69,8 @@ class ExternalNotificationModule : public SinglePortModule, private concurrency:
     virtual int32_t runOnce() override;
 
     virtual bool wantPacket(const meshtastic_MeshPacket *p) override;
+    // Text arrives on several portnums, see MeshService::isTextPayload
+    virtual bool getDispatchPort(meshtastic_PortNum &port) const override { return false; }
 
     bool isNagging = false;
 
@@ -0,0 +1,420 @@
+#include "StoreForwardArchive.h"
+#include "FSCommon.h"
+#include "SPILock.h"
+#include "configuration.h"
+#include <ErriezCRC32.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(ARCH_ESP32) && defined(HAS_SDCARD) && !defined(SDCARD_USE_SOFT_SPI)
+#include <SD.h>
+// A card mounted by setupSDCard() holds far more history than the flash
+static fs::FS &archiveFS()
+{
+    if (SD.cardType() != CARD_NONE)
+        return SD;
+    return FSCom;
+}
+#define ArchiveFS archiveFS()
+#elif defined(FSCom)
+#define ArchiveFS FSCom
+#endif
+
+static const char *archiveDir = "/sf";
+
+// Starts every segment, the last byte changes whenever the record layout does so old archives are ignored
+static const uint8_t segmentHeader[4] = {'S', 'F', 'A', sizeof(PacketHistoryStruct)};
+
+/// Read the next record of a segment file into buf, which must hold MAX_RECORD_SIZE bytes. @return its length or 0.
+template <typename F> static size_t readRecord(F &f, uint8_t *buf, PacketHistoryStruct &packet, const uint8_t *&payload)
+{
+    if (f.read(buf, 2) != 2)
+        return 0;
+    size_t bodyLen = buf[0] | (buf[1] << 8);
+    if (bodyLen < sizeof(PacketHistoryStruct) ||
+        bodyLen + StoreForwardArchive::RECORD_OVERHEAD > StoreForwardArchive::MAX_RECORD_SIZE)
+        return 0;
+    size_t rest = bodyLen + 4;
+    if ((size_t)f.read(buf + 2, rest) != rest)
+        return 0;
+    return StoreForwardArchive::decodeRecord(buf, 2 + rest, packet, payload);
+}
+
+template <typename F> static bool readHeader(F &f)
+{
+    uint8_t header[sizeof(segmentHeader)];
+    return f.read(header, sizeof(header)) == sizeof(header) && memcmp(header, segmentHeader, sizeof(header)) == 0;
+}
+
+void StoreForwardArchiveIndex::begin(Entry *buffer, uint32_t capacity)
+{
+    entries = buffer;
+    this->capacity = buffer ? capacity : 0;
+    oldest = 0;
+    numEntries = 0;
+    nextSeq = 1;
+    broadcasts = List();
+    directs.clear();
+}
+
+void StoreForwardArchiveIndex::add(const Entry &entry)
+{
+    if (capacity == 0)
+        return;
+    if (numEntries == capacity)
+        dropOldest();
+
+    uint32_t seq = nextSeq++;
+    Entry &e = entries[(oldest + numEntries) % capacity];
+    numEntries++;
+    e = entry;
+    e.next = StoreForwardHistory::NONE;
+
+    List &list = listFor(e.to);
+    if (list.tail == StoreForwardHistory::NONE)
+        list.head = seq;
+    else
+        bySeq(list.tail).next = seq;
+    list.tail = seq;
+}
+
+void StoreForwardArchiveIndex::dropOldest()
+{
+    const Entry &e = at(0);
+    // The oldest entry is always the oldest of its list
+    List &list = listFor(e.to);
+    list.head = e.next;
+    if (list.head == StoreForwardHistory::NONE) {
+        list.tail = StoreForwardHistory::NONE;
+        if (e.to != NODENUM_BROADCAST)
+            directs.erase(e.to);
+    }
+    oldest = (oldest + 1) % capacity;
+    numEntries--;
+}
+
+void StoreForwardArchiveIndex::dropBefore(uint32_t segment)
+{
+    while (numEntries > 0 && at(0).segment < segment)
+        dropOldest();
+}
+
+uint32_t StoreForwardArchiveIndex::resumeAt(const List *list, uint32_t at) const
+{
+    // Entries are dropped oldest first, so the one we stopped at is still there if it is not older than the oldest
+    if (at != StoreForwardHistory::NONE && at >= firstSeq())
+        return bySeq(at).next;
+    return list ? list->head : StoreForwardHistory::NONE;
+}
+
+uint32_t StoreForwardArchiveIndex::findIn(uint32_t seq, NodeNum dest, uint32_t sinceTime, uint32_t lastSeq) const
+{
+    while (seq != StoreForwardHistory::NONE) {
+        const Entry &e = bySeq(seq);
+        if (seq > lastSeq && e.time > sinceTime && e.from != dest)
+            return seq;
+        seq = e.next;
+    }
+    return StoreForwardHistory::NONE;
+}
+
+void StoreForwardArchiveIndex::advance(const List *list, uint32_t &at, uint32_t &atSeq, uint32_t seq) const
+{
+    uint32_t s = resumeAt(list, at);
+    while (s != StoreForwardHistory::NONE && s <= seq) {
+        at = atSeq = s;
+        s = bySeq(s).next;
+    }
+}
+
+const StoreForwardArchiveIndex::Entry *StoreForwardArchiveIndex::next(NodeNum dest, uint32_t sinceTime,
+                                                                      StoreForwardHistory::Cursor &cursor) const
+{
+    auto it = directs.find(dest);
+    const List *direct = (it != directs.end()) ? &it->second : nullptr;
+
+    // Cursor positions are seqs here rather than buffer offsets, so at and seq are the same
+    uint32_t b = findIn(resumeAt(&broadcasts, cursor.broadcastAt), dest, sinceTime, cursor.lastSeq);
+    uint32_t d = findIn(resumeAt(direct, cursor.directAt), dest, sinceTime, cursor.lastSeq);
+    if (b == StoreForwardHistory::NONE && d == StoreForwardHistory::NONE)
+        return nullptr;
+
+    // Hand out broadcasts and DMs in the order they arrived
+    cursor.lastSeq = (d == StoreForwardHistory::NONE || (b != StoreForwardHistory::NONE && b < d)) ? b : d;
+    advance(&broadcasts, cursor.broadcastAt, cursor.broadcastSeq, cursor.lastSeq);
+    advance(direct, cursor.directAt, cursor.directSeq, cursor.lastSeq);
+    return &bySeq(cursor.lastSeq);
+}
+
+uint32_t StoreForwardArchiveIndex::count(NodeNum dest, uint32_t sinceTime, StoreForwardHistory::Cursor cursor,
+                                         uint32_t limit) const
+{
+    uint32_t n = 0;
+    while (n < limit && next(dest, sinceTime, cursor))
+        n++;
+    return n;
+}
+
+size_t StoreForwardArchive::encodeRecord(const PacketHistoryStruct &packet, const uint8_t *payload, uint8_t *buf, size_t bufSize)
+{
+    size_t bodyLen = sizeof(PacketHistoryStruct) + packet.payload_size;
+    if (packet.payload_size > meshtastic_Constants_DATA_PAYLOAD_LEN || bufSize < bodyLen + RECORD_OVERHEAD)
+        return 0;
+    buf[0] = bodyLen & 0xff;
+    buf[1] = (bodyLen >> 8) & 0xff;
+    memcpy(buf + 2, &packet, sizeof(packet));
+    memcpy(buf + 2 + sizeof(packet), payload, packet.payload_size);
+    uint32_t crc = crc32Buffer(buf, 2 + bodyLen);
+    for (int i = 0; i < 4; i++)
+        buf[2 + bodyLen + i] = (crc >> (8 * i)) & 0xff;
+    return bodyLen + RECORD_OVERHEAD;
+}
+
+size_t StoreForwardArchive::decodeRecord(const uint8_t *buf, size_t len, PacketHistoryStruct &packet, const uint8_t *&payload)
+{
+    if (len < RECORD_OVERHEAD + sizeof(PacketHistoryStruct))
+        return 0;
+    size_t bodyLen = buf[0] | (buf[1] << 8);
+    if (bodyLen < sizeof(PacketHistoryStruct) || len < bodyLen + RECORD_OVERHEAD)
+        return 0;
+
+    const uint8_t *crcBytes = buf + 2 + bodyLen;
+    uint32_t crc = crcBytes[0] | (crcBytes[1] << 8) | (crcBytes[2] << 16) | ((uint32_t)crcBytes[3] << 24);
+    if (crc != crc32Buffer(buf, 2 + bodyLen))
+        return 0;
+
+    PacketHistoryStruct decoded;
+    memcpy(&decoded, buf + 2, sizeof(decoded));
+    if (decoded.payload_size != bodyLen - sizeof(PacketHistoryStruct))
+        return 0;
+    packet = decoded;
+    payload = buf + 2 + sizeof(PacketHistoryStruct);
+    return bodyLen + RECORD_OVERHEAD;
+}
+
+void StoreForwardArchive::segmentName(uint32_t segment, char *name, size_t size)
+{
+    snprintf(name, size, "%s/%08x.sf", archiveDir, (unsigned)segment);
+}
+
+bool StoreForwardArchive::begin(StoreForwardArchiveIndex::Entry *indexBuffer, uint32_t indexCapacity)
+{
+    ready = false;
+    index.begin(indexBuffer, indexCapacity);
+#ifdef ArchiveFS
+    concurrency::LockGuard g(spiLock);
+    if (!ArchiveFS.exists(archiveDir))
+        ArchiveFS.mkdir(archiveDir);
+
+    auto dir = ArchiveFS.open(archiveDir, FILE_O_READ);
+    if (!dir || !dir.isDirectory()) {
+        LOG_ERROR("S&F: could not open archive directory %s", archiveDir);
+        return false;
+    }
+    bool found = false;
+    for (auto file = dir.openNextFile(); file; file = dir.openNextFile()) {
+        // Some platforms give the full path, some only the file name
+        const char *name = strrchr(file.name(), '/');
+        name = name ? name + 1 : file.name();
+        char *end;
+        uint32_t segment = strtoul(name, &end, 16);
+        bool isSegment = end != name && strcmp(end, ".sf") == 0;
+        file.close();
+        if (!isSegment)
+            continue;
+        if (!found || segment < firstSegment)
+            firstSegment = segment;
+        if (!found || segment > lastSegment)
+            lastSegment = segment;
+        found = true;
+    }
+    dir.close();
+
+    if (!found) {
+        firstSegment = 1;
+        lastSegment = 0;
+        ready = startSegment();
+        return ready;
+    }
+
+    // Only the segment being written when we went down can be damaged, keep what is intact and go on in a new one
+    char name[32];
+    segmentName(lastSegment, name, sizeof(name));
+    size_t fileBytes = 0;
+    auto f = ArchiveFS.open(name, FILE_O_READ);
+    if (f) {
+        fileBytes = f.size();
+        f.close();
+    }
+    lastSegmentBytes = validBytes(lastSegment);
+    for (uint32_t segment = firstSegment; segment < lastSegment; segment++)
+        indexSegment(segment, SIZE_MAX);
+    indexSegment(lastSegment, lastSegmentBytes);
+
+    if (lastSegmentBytes == 0 || lastSegmentBytes < fileBytes) {
+        LOG_WARN("S&F: archive %s damaged after %u of %u bytes, start a new one", name, (unsigned)lastSegmentBytes,
+                 (unsigned)fileBytes);
+        ready = startSegment();
+    } else {
+        ready = true;
+    }
+    LOG_INFO("S&F: archive has %u files, %u messages indexed", getSegmentCount(), index.size());
+    return ready;
+#else
+    return false;
+#endif
+}
+
+size_t StoreForwardArchive::validBytes(uint32_t segment)
+{
+#ifdef ArchiveFS
+    char name[32];
+    segmentName(segment, name, sizeof(name));
+    auto f = ArchiveFS.open(name, FILE_O_READ);
+    if (!f)
+        return 0;
+    size_t bytes = 0;
+    if (readHeader(f)) {
+        bytes = sizeof(segmentHeader);
+        uint8_t record[MAX_RECORD_SIZE];
+        PacketHistoryStruct packet;
+        const uint8_t *payload;
+        while (size_t len = readRecord(f, record, packet, payload))
+            bytes += len;
+    }
+    f.close();
+    return bytes;
+#else
+    return 0;
+#endif
+}
+
+void StoreForwardArchive::indexSegment(uint32_t segment, size_t bytes)
+{
+#ifdef ArchiveFS
+    char name[32];
+    segmentName(segment, name, sizeof(name));
+    auto f = ArchiveFS.open(name, FILE_O_READ);
+    if (!f)
+        return;
+    if (bytes > f.size())
+        bytes = f.size();
+    if (readHeader(f)) {
+        // Older segments were checked when they were written, their CRCs are checked again when a message is served
+        size_t offset = sizeof(segmentHeader);
+        uint8_t len[2];
+        PacketHistoryStruct packet;
+        while (offset + 2 + sizeof(packet) <= bytes && f.read(len, sizeof(len)) == sizeof(len)) {
+            size_t bodyLen = len[0] | (len[1] << 8);
+            if (bodyLen < sizeof(packet) || bodyLen + RECORD_OVERHEAD > MAX_RECORD_SIZE ||
+                offset + bodyLen + RECORD_OVERHEAD > bytes ||
+                f.read(reinterpret_cast<uint8_t *>(&packet), sizeof(packet)) != sizeof(packet))
+                break;
+            index.add({packet.time, packet.to, packet.from, segment, (uint32_t)offset, StoreForwardHistory::NONE});
+            offset += bodyLen + RECORD_OVERHEAD;
+            if (!f.seek(offset))
+                break;
+        }
+    }
+    f.close();
+#endif
+}
+
+bool StoreForwardArchive::startSegment()
+{
+#ifdef ArchiveFS
+    char name[32];
+    segmentName(lastSegment + 1, name, sizeof(name));
+    auto f = ArchiveFS.open(name, FILE_O_WRITE);
+    if (!f) {
+        LOG_ERROR("S&F: could not create archive %s", name);
+        return false;
+    }
+    bool ok = f.write(segmentHeader, sizeof(segmentHeader)) == sizeof(segmentHeader);
+    f.flush();
+    f.close();
+    if (!ok) {
+        LOG_ERROR("S&F: could not write archive %s", name);
+        return false;
+    }
+    lastSegment++;
+    lastSegmentBytes = sizeof(segmentHeader);
+
+    while (lastSegment - firstSegment + 1 > STOREFORWARD_ARCHIVE_MAX_SEGMENTS) {
+        segmentName(firstSegment++, name, sizeof(name));
+        ArchiveFS.remove(name);
+    }
+    index.dropBefore(firstSegment);
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool StoreForwardArchive::append(const PacketHistoryStruct &packet, const uint8_t *payload)
+{
+#ifdef ArchiveFS
+    if (!ready)
+        return false;
+    uint8_t record[MAX_RECORD_SIZE];
+    size_t len = encodeRecord(packet, payload, record, sizeof(record));
+    if (len == 0)
+        return false;
+
+    concurrency::LockGuard g(spiLock);
+    if (lastSegmentBytes + len > STOREFORWARD_ARCHIVE_SEGMENT_BYTES && !startSegment())
+        return false;
+
+    char name[32];
+    segmentName(lastSegment, name, sizeof(name));
+    auto f = ArchiveFS.open(name, FILE_O_APPEND);
+    if (!f) {
+        LOG_ERROR("S&F: could not open archive %s for append", name);
+        return false;
+    }
+    size_t written = f.write(record, len);
+    f.flush();
+    f.close();
+    if (written != len) {
+        // Readers stop at the partial record, so anything appended after it would be lost
+        LOG_ERROR("S&F: short write to archive %s, %u of %u bytes", name, (unsigned)written, (unsigned)len);
+        startSegment();
+        return false;
+    }
+    index.add({packet.time, packet.to, packet.from, lastSegment, (uint32_t)lastSegmentBytes, StoreForwardHistory::NONE});
+    lastSegmentBytes += len;
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool StoreForwardArchive::next(NodeNum dest, uint32_t sinceTime, StoreForwardHistory::Cursor &cursor,
+                               PacketHistoryStruct &packet, uint8_t *payload)
+{
+#ifdef ArchiveFS
+    if (!ready)
+        return false;
+    uint8_t record[MAX_RECORD_SIZE];
+    char name[32];
+    concurrency::LockGuard g(spiLock);
+    while (const StoreForwardArchiveIndex::Entry *e = index.next(dest, sinceTime, cursor)) {
+        segmentName(e->segment, name, sizeof(name));
+        auto f = ArchiveFS.open(name, FILE_O_READ);
+        size_t len = 0;
+        const uint8_t *recordPayload = nullptr;
+        if (f) {
+            if (f.seek(e->offset))
+                len = readRecord(f, record, packet, recordPayload);
+            f.close();
+        }
+        if (len) {
+            memcpy(payload, recordPayload, packet.payload_size);
+            return true;
+        }
+        // The cursor is already past it, go on with the next one
+        LOG_WARN("S&F: skip damaged archive record at %s:%u", name, (unsigned)e->offset);
+    }
+#endif
+    return false;
+}
@@ -0,0 +1,174 @@
+#pragma once
+
+#include "StoreForwardHistory.h"
+#include "mesh-pb-constants.h"
+#include <stddef.h>
+#include <stdint.h>
+
+// Keep store & forward messages on flash (or the SD card if one is mounted) so a server keeps its history across reboots
+#ifndef STOREFORWARD_ARCHIVE
+#define STOREFORWARD_ARCHIVE 0
+#endif
+
+// Size of one archive file. Only the newest one is appended to and checked for damage at boot.
+#ifndef STOREFORWARD_ARCHIVE_SEGMENT_BYTES
+#define STOREFORWARD_ARCHIVE_SEGMENT_BYTES (64 * 1024)
+#endif
+
+// How many archive files to keep, the oldest is deleted when a new one is started
+#ifndef STOREFORWARD_ARCHIVE_MAX_SEGMENTS
+#define STOREFORWARD_ARCHIVE_MAX_SEGMENTS 16
+#endif
+
+// How many archived messages can be served, each takes sizeof(StoreForwardArchiveIndex::Entry) bytes of RAM
+#ifndef STOREFORWARD_ARCHIVE_INDEX_ENTRIES
+#define STOREFORWARD_ARCHIVE_INDEX_ENTRIES 8192
+#endif
+
+/**
+ * Where each archived message is on disk, plus what is needed to decide who gets it, so history requests only read the
+ * messages they hand out. A ring of fixed size entries, the oldest is dropped when it is full or its segment is deleted.
+ *
+ * Like StoreForwardHistory, every entry is also linked into the broadcast list or the list of DMs to its destination, and
+ * next() walks those two lists from the cursor instead of scanning every entry.
+ */
+class StoreForwardArchiveIndex
+{
+  public:
+    struct Entry {
+        uint32_t time;
+        NodeNum to;
+        NodeNum from;
+        uint32_t segment;
+        uint32_t offset; // of the record in its segment file
+        uint32_t next;   // seq of the next entry in the same list, or StoreForwardHistory::NONE
+    };
+
+    /// Use capacity entries at buffer, which must stay allocated
+    void begin(Entry *buffer, uint32_t capacity);
+
+    /// Index a message, dropping the oldest one if full
+    void add(const Entry &entry);
+
+    /// Forget every message in a segment older than segment
+    void dropBefore(uint32_t segment);
+
+    /// Same rules and cursor as StoreForwardHistory::next(). @return nullptr if there is none.
+    const Entry *next(NodeNum dest, uint32_t sinceTime, StoreForwardHistory::Cursor &cursor) const;
+
+    /// Count what next() would return, stopping at limit
+    uint32_t count(NodeNum dest, uint32_t sinceTime, StoreForwardHistory::Cursor cursor, uint32_t limit = UINT32_MAX) const;
+
+    /// @return how many messages are indexed, and how many fit
+    uint32_t size() const { return numEntries; }
+    uint32_t getCapacity() const { return capacity; }
+
+    /// @return how many messages were ever indexed
+    uint32_t getTotalAdded() const { return nextSeq - 1; }
+
+  private:
+    struct List {
+        uint32_t head = StoreForwardHistory::NONE; // seq of the oldest entry
+        uint32_t tail = StoreForwardHistory::NONE; // seq of the newest entry
+    };
+
+    Entry *entries = nullptr;
+    uint32_t capacity = 0;
+    uint32_t oldest = 0; // slot of the oldest entry
+    uint32_t numEntries = 0;
+    uint32_t nextSeq = 1; // seq of the entry in slot (oldest + i) is nextSeq - numEntries + i
+
+    List broadcasts;
+    std::unordered_map<NodeNum, List> directs;
+
+    const Entry &at(uint32_t i) const { return entries[(oldest + i) % capacity]; }
+    uint32_t firstSeq() const { return nextSeq - numEntries; }
+    Entry &bySeq(uint32_t seq) const { return entries[(oldest + seq - firstSeq()) % capacity]; }
+    List &listFor(NodeNum to) { return to == NODENUM_BROADCAST ? broadcasts : directs[to]; }
+
+    void dropOldest();
+
+    /// seq of the first entry in a list to look at for a cursor, given where it stopped last time
+    uint32_t resumeAt(const List *list, uint32_t at) const;
+    /// seq of the first entry from seq on in its list that dest wants
+    uint32_t findIn(uint32_t seq, NodeNum dest, uint32_t sinceTime, uint32_t lastSeq) const;
+    /// Move a cursor position in list past every entry up to seq
+    void advance(const List *list, uint32_t &at, uint32_t &atSeq, uint32_t seq) const;
+};
+
+/**
+ * Append-only, segmented on-disk log of store & forward messages.
+ *
+ * Every message added to the history is also appended to the newest segment file as one CRC protected record, so writes are
+ * always sequential. Full segments are never written again and the oldest ones are deleted to stay within
+ * STOREFORWARD_ARCHIVE_MAX_SEGMENTS. After a crash at most the newest segment can end in a torn record: begin() checks only that
+ * one and starts a new segment after it if needed, and readers stop at the first damaged record of a segment.
+ *
+ * History requests are served straight from the segment files: a StoreForwardArchiveIndex in RAM says where each message
+ * is, so how much history a server keeps is bounded by the filesystem and the index, not by PSRAM. begin() rebuilds the
+ * index by reading only the record headers.
+ */
+class StoreForwardArchive
+{
+  public:
+    /// [length u16][PacketHistoryStruct][payload][crc32], length counts the struct and payload
+    static constexpr size_t RECORD_OVERHEAD = 2 + 4;
+    static constexpr size_t MAX_RECORD_SIZE =
+        RECORD_OVERHEAD + sizeof(PacketHistoryStruct) + meshtastic_Constants_DATA_PAYLOAD_LEN;
+
+    /**
+     * Find the archive files, repair the newest one and index them in indexCapacity entries at indexBuffer, which must stay
+     * allocated. @return false if there is no filesystem to archive to.
+     */
+    bool begin(StoreForwardArchiveIndex::Entry *indexBuffer, uint32_t indexCapacity);
+
+    /// Append a message, starting a new segment when the current one is full. @return false if it was not written.
+    bool append(const PacketHistoryStruct &packet, const uint8_t *payload);
+
+    /**
+     * Read the next message for dest after its cursor that arrived after sinceTime, see StoreForwardHistory::next().
+     * payload must hold meshtastic_Constants_DATA_PAYLOAD_LEN bytes. A record damaged on disk is skipped.
+     * @return false if there is none.
+     */
+    bool next(NodeNum dest, uint32_t sinceTime, StoreForwardHistory::Cursor &cursor, PacketHistoryStruct &packet,
+              uint8_t *payload);
+
+    /// Count what next() would return, stopping at limit
+    uint32_t count(NodeNum dest, uint32_t sinceTime, const StoreForwardHistory::Cursor &cursor, uint32_t limit) const
+    {
+        return index.count(dest, sinceTime, cursor, limit);
+    }
+
+    bool isReady() const { return ready; }
+    const StoreForwardArchiveIndex &getIndex() const { return index; }
+
+    /// @return how many archive files there are
+    uint32_t getSegmentCount() const { return ready ? lastSegment - firstSegment + 1 : 0; }
+
+    /// Encode a message into buf. @return the record length, or 0 if buf is too small.
+    static size_t encodeRecord(const PacketHistoryStruct &packet, const uint8_t *payload, uint8_t *buf, size_t bufSize);
+
+    /**
+     * Decode the record at the start of buf, payload points into buf.
+     * @return the record length, or 0 if buf does not start with a complete and undamaged record.
+     */
+    static size_t decodeRecord(const uint8_t *buf, size_t len, PacketHistoryStruct &packet, const uint8_t *&payload);
+
+  private:
+    bool ready = false;
+    uint32_t firstSegment = 0; // oldest archive file
+    uint32_t lastSegment = 0;  // the one being appended to
+    size_t lastSegmentBytes = 0;
+    StoreForwardArchiveIndex index;
+
+    static void segmentName(uint32_t segment, char *name, size_t size);
+
+    /// Bytes of undamaged records at the start of a segment, including its header. 0 if it is not a valid segment.
+    static size_t validBytes(uint32_t segment);
+
+    /// Add the first bytes of a segment to the index, trusting the record lengths
+    void indexSegment(uint32_t segment, size_t bytes);
+
+    /// Create the next segment and delete the oldest ones over the limit
+    bool startSegment();
+};
@@ -0,0 +1,154 @@
+#include "StoreForwardHistory.h"
+#include <assert.h>
+#include <string.h>
+
+void StoreForwardHistory::begin(uint8_t *buffer, size_t bytes)
+{
+    this->buffer = buffer;
+    // Offsets are 32 bit and NONE must never be a valid one
+    capacity = bytes < NONE ? bytes & ~(size_t)3 : (NONE - 1) & ~(size_t)3;
+    head = tail = wrapAt = 0;
+    wrapped = false;
+    numRecords = 0;
+    usedBytes = 0;
+    nextSeq = 1;
+    broadcasts = List();
+    directs.clear();
+}
+
+bool StoreForwardHistory::add(const PacketHistoryStruct &packet, const uint8_t *payload)
+{
+    size_t bytes = recordSize(packet.payload_size);
+    if (!buffer || bytes > capacity)
+        return false;
+
+    uint32_t offset = makeRoom(bytes);
+    Record *r = recordAt(offset);
+    r->seq = nextSeq++;
+    r->next = NONE;
+    r->packet = packet;
+    memcpy(r + 1, payload, packet.payload_size);
+    numRecords++;
+    usedBytes += bytes;
+
+    List &list = listFor(packet.to);
+    if (list.tail != NONE)
+        recordAt(list.tail)->next = offset;
+    else
+        list.head = offset;
+    list.tail = offset;
+    return true;
+}
+
+size_t StoreForwardHistory::makeRoom(size_t bytes)
+{
+    while (true) {
+        if (numRecords == 0) {
+            head = tail = 0;
+            wrapped = false;
+        }
+        if (!wrapped) {
+            if (capacity - head >= bytes) {
+                head += bytes;
+                return head - bytes;
+            }
+            // No room left at the end, start over at the front if the oldest records left enough space there
+            if (tail >= bytes) {
+                wrapAt = head;
+                wrapped = true;
+                head = bytes;
+                return 0;
+            }
+        } else if (tail - head >= bytes) {
+            head += bytes;
+            return head - bytes;
+        }
+        evictOldest();
+    }
+}
+
+void StoreForwardHistory::evictOldest()
+{
+    assert(numRecords > 0);
+    const Record *r = recordAt(tail);
+    size_t bytes = recordSize(r->packet.payload_size);
+
+    // The oldest record is always the oldest of its list
+    List &list = listFor(r->packet.to);
+    assert(list.head == tail);
+    list.head = r->next;
+    if (list.head == NONE) {
+        list.tail = NONE;
+        if (r->packet.to != NODENUM_BROADCAST)
+            directs.erase(r->packet.to);
+    }
+
+    tail += bytes;
+    if (wrapped && tail >= wrapAt) {
+        tail = 0;
+        wrapped = false;
+    }
+    numRecords--;
+    usedBytes -= bytes;
+}
+
+uint32_t StoreForwardHistory::resumeAt(const List *list, uint32_t at, uint32_t seq) const
+{
+    // Records are overwritten oldest first, so the one we stopped at is still there if it is not older than the oldest
+    if (at != NONE && numRecords > 0 && seq >= recordAt(tail)->seq)
+        return recordAt(at)->next;
+    return list ? list->head : NONE;
+}
+
+uint32_t StoreForwardHistory::findIn(uint32_t offset, NodeNum dest, uint32_t sinceTime, uint32_t lastSeq) const
+{
+    while (offset != NONE) {
+        const Record *r = recordAt(offset);
+        if (r->seq > lastSeq && r->packet.time > sinceTime && r->packet.from != dest)
+            return offset;
+        offset = r->next;
+    }
+    return NONE;
+}
+
+void StoreForwardHistory::advance(const List *list, uint32_t &at, uint32_t &atSeq, uint32_t seq) const
+{
+    uint32_t offset = resumeAt(list, at, atSeq);
+    while (offset != NONE && recordAt(offset)->seq <= seq) {
+        at = offset;
+        atSeq = recordAt(offset)->seq;
+        offset = recordAt(offset)->next;
+    }
+}
+
+const StoreForwardHistory::Record *StoreForwardHistory::next(NodeNum dest, uint32_t sinceTime, Cursor &cursor) const
+{
+    auto it = directs.find(dest);
+    const List *direct = (it != directs.end()) ? &it->second : nullptr;
+
+    uint32_t b = findIn(resumeAt(&broadcasts, cursor.broadcastAt, cursor.broadcastSeq), dest, sinceTime, cursor.lastSeq);
+    uint32_t d = findIn(resumeAt(direct, cursor.directAt, cursor.directSeq), dest, sinceTime, cursor.lastSeq);
+    if (b == NONE && d == NONE)
+        return nullptr;
+
+    // Hand out broadcasts and DMs in the order they arrived
+    uint32_t found = (d == NONE || (b != NONE && recordAt(b)->seq < recordAt(d)->seq)) ? b : d;
+    cursor.lastSeq = recordAt(found)->seq;
+    advance(&broadcasts, cursor.broadcastAt, cursor.broadcastSeq, cursor.lastSeq);
+    advance(direct, cursor.directAt, cursor.directSeq, cursor.lastSeq);
+    return recordAt(found);
+}
+
+uint32_t StoreForwardHistory::count(NodeNum dest, uint32_t sinceTime, Cursor cursor, uint32_t limit) const
+{
+    uint32_t n = 0;
+    while (n < limit && next(dest, sinceTime, cursor))
+        n++;
+    return n;
+}
+
+uint32_t StoreForwardHistory::estimateMaxRecords() const
+{
+    size_t average = numRecords ? usedBytes / numRecords : recordSize(meshtastic_Constants_DATA_PAYLOAD_LEN);
+    return average ? capacity / average : 0;
+}
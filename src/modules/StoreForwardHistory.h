@@ -0,0 +1,122 @@
+#pragma once
+
+#include "MeshTypes.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <unordered_map>
+
+/// The fixed part of a stored text message, the payload follows it in the history buffer
+struct PacketHistoryStruct {
+    uint32_t time;
+    uint32_t to;
+    uint32_t from;
+    uint32_t id;
+    uint32_t reply_id;
+    int32_t rx_rssi;
+    float rx_snr;
+    uint16_t payload_size;
+    uint8_t channel;
+    uint8_t hop_start;
+    uint8_t hop_limit;
+    uint8_t transport_mechanism;
+    bool emoji;
+    bool via_mqtt;
+};
+
+/**
+ * Store & Forward message history: a ring buffer of variable length records, oldest overwritten first.
+ *
+ * Records only take the space their payload needs. Every record is also linked into one list, either the broadcast list or
+ * the list of direct messages to its destination, through an offset stored in the record itself, so the index costs no
+ * memory per record. Replaying history to a client walks the broadcast list and its own DM list from its Cursor, which
+ * makes each step O(1) instead of a scan over the whole history.
+ */
+class StoreForwardHistory
+{
+  public:
+    /// A stored message, as handed out by next()
+    struct Record {
+        uint32_t seq;  // 1 for the first record ever added, never reused
+        uint32_t next; // offset of the next record in the same list, or NONE
+        PacketHistoryStruct packet;
+
+        const uint8_t *payload() const { return reinterpret_cast<const uint8_t *>(this + 1); }
+    };
+
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    /// How far a client got, keep one per client and pass it to every call for that client
+    struct Cursor {
+        uint32_t lastSeq = 0; // last record handed out, records up to here are never handed out again
+        // The last record we looked at in each list, to continue from there if it is still stored
+        uint32_t broadcastAt = NONE, broadcastSeq = 0;
+        uint32_t directAt = NONE, directSeq = 0;
+    };
+
+    /// Use bytes of memory at buffer for the history, which must stay allocated and 4 byte aligned
+    void begin(uint8_t *buffer, size_t bytes);
+
+    /// Store a message, overwriting the oldest ones if needed. @return false if it can never fit.
+    bool add(const PacketHistoryStruct &packet, const uint8_t *payload);
+
+    /**
+     * Find the next message for dest after its cursor that arrived after sinceTime: broadcasts and DMs to dest, but not what
+     * dest sent itself. Moves the cursor past it.
+     * @return nullptr if there is none. Valid until the next add().
+     */
+    const Record *next(NodeNum dest, uint32_t sinceTime, Cursor &cursor) const;
+
+    /// Count what next() would return, stopping at limit
+    uint32_t count(NodeNum dest, uint32_t sinceTime, Cursor cursor, uint32_t limit = UINT32_MAX) const;
+
+    /// @return how many messages are stored right now
+    uint32_t size() const { return numRecords; }
+
+    /// @return how many messages were ever stored
+    uint32_t getTotalAdded() const { return nextSeq - 1; }
+
+    /// @return bytes used by stored messages, and the size of the buffer
+    size_t getUsedBytes() const { return usedBytes; }
+    size_t getCapacity() const { return capacity; }
+
+    /// @return how many messages fit at the current average message size
+    uint32_t estimateMaxRecords() const;
+
+    /// Bytes a record with this payload size takes in the buffer
+    static size_t recordSize(size_t payloadSize) { return (sizeof(Record) + payloadSize + 3) & ~(size_t)3; }
+
+  private:
+    struct List {
+        uint32_t head = NONE; // oldest record
+        uint32_t tail = NONE; // newest record
+    };
+
+    uint8_t *buffer = nullptr;
+    size_t capacity = 0;
+
+    // Stored records are [tail, head), or [tail, wrapAt) followed by [0, head) once wrapped
+    size_t head = 0;
+    size_t tail = 0;
+    size_t wrapAt = 0;
+    bool wrapped = false;
+    uint32_t numRecords = 0;
+    size_t usedBytes = 0;
+    uint32_t nextSeq = 1;
+
+    List broadcasts;
+    std::unordered_map<NodeNum, List> directs;
+
+    Record *recordAt(uint32_t offset) const { return reinterpret_cast<Record *>(buffer + offset); }
+    List &listFor(NodeNum to) { return to == NODENUM_BROADCAST ? broadcasts : directs[to]; }
+
+    /// @return the offset for a new record of size bytes, after evicting as many old records as needed
+    size_t makeRoom(size_t bytes);
+    void evictOldest();
+
+    /// First record in a list to look at for a cursor, given where it stopped last time
+    uint32_t resumeAt(const List *list, uint32_t at, uint32_t seq) const;
+    /// First record from offset on in its list that dest wants
+    uint32_t findIn(uint32_t offset, NodeNum dest, uint32_t sinceTime, uint32_t lastSeq) const;
+    /// Move a cursor position in list past every record up to seq
+    void advance(const List *list, uint32_t &at, uint32_t &atSeq, uint32_t seq) const;
+};
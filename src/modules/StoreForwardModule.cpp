@@ -73,22 +73,47 @@ void StoreForwardModule::populatePSRAM()
     LOG_DEBUG("Before PSRAM init: heap %d/%d PSRAM %d/%d", memGet.getFreeHeap(), memGet.getHeapSize(), memGet.getFreePsram(),
               memGet.getPsramSize());
 
-    /* Use a maximum of 3/4 the available PSRAM unless otherwise specified.
+#if STOREFORWARD_ARCHIVE
+    // Messages are served from the archive when there is one, it only needs its index in memory
+    size_t indexBytes = STOREFORWARD_ARCHIVE_INDEX_ENTRIES * sizeof(StoreForwardArchiveIndex::Entry);
+    StoreForwardArchiveIndex::Entry *indexBuffer = nullptr;
+#if defined(ARCH_ESP32)
+    indexBuffer = static_cast<StoreForwardArchiveIndex::Entry *>(ps_malloc(indexBytes));
+#elif defined(ARCH_PORTDUINO)
+    indexBuffer = static_cast<StoreForwardArchiveIndex::Entry *>(malloc(indexBytes));
+#endif
+    if (indexBuffer && this->archive.begin(indexBuffer, STOREFORWARD_ARCHIVE_INDEX_ENTRIES)) {
+        this->records = STOREFORWARD_ARCHIVE_INDEX_ENTRIES;
+        LOG_INFO("S&F: serve history from the archive, %u messages indexed in %u bytes", this->archive.getIndex().size(),
+                 (unsigned)indexBytes);
+        return;
+    }
+    LOG_WARN("S&F: archive not available, keep history in PSRAM only");
+    free(indexBuffer);
+#endif
+
+    /* Use a maximum of 3/4 the available PSRAM unless otherwise specified. A configured number of records reserves room
+        for that many messages of the maximum size, shorter messages leave room for more.
         Note: This needs to be done after every thing that would use PSRAM
     */
-    uint32_t numberOfPackets =
-        (this->records ? this->records : (((memGet.getFreePsram() / 4) * 3) / sizeof(PacketHistoryStruct)));
-    this->records = numberOfPackets;
+    size_t historyBytes = this->records ? this->records * StoreForwardHistory::recordSize(meshtastic_Constants_DATA_PAYLOAD_LEN)
+                                        : (memGet.getFreePsram() / 4) * 3;
+    uint8_t *historyBuffer = nullptr;
 #if defined(ARCH_ESP32)
-    this->packetHistory = static_cast<PacketHistoryStruct *>(ps_calloc(numberOfPackets, sizeof(PacketHistoryStruct)));
+    historyBuffer = static_cast<uint8_t *>(ps_malloc(historyBytes));
 #elif defined(ARCH_PORTDUINO)
-    this->packetHistory = static_cast<PacketHistoryStruct *>(calloc(numberOfPackets, sizeof(PacketHistoryStruct)));
-
+    historyBuffer = static_cast<uint8_t *>(malloc(historyBytes));
 #endif
+    if (!historyBuffer) {
+        LOG_ERROR("S&F: could not allocate %u bytes for packetHistory", (unsigned)historyBytes);
+        historyBytes = 0;
+    }
+    this->packetHistory.begin(historyBuffer, historyBytes);
+    this->records = this->packetHistory.estimateMaxRecords();
 
     LOG_DEBUG("After PSRAM init: heap %d/%d PSRAM %d/%d", memGet.getFreeHeap(), memGet.getHeapSize(), memGet.getFreePsram(),
               memGet.getPsramSize());
-    LOG_DEBUG("numberOfPackets for packetHistory - %u", numberOfPackets);
+    LOG_DEBUG("packetHistory uses %u bytes, room for about %u packets", (unsigned)historyBytes, this->records);
 }
 
 /**
@@ -116,7 +141,7 @@ void StoreForwardModule::historySend(uint32_t secAgo, uint32_t to)
     sf.which_variant = meshtastic_StoreAndForward_history_tag;
     sf.variant.history.history_messages = queueSize;
     sf.variant.history.window = secAgo * 1000;
-    sf.variant.history.last_request = lastRequest[to];
+    sf.variant.history.last_request = lastRequest[to].lastSeq;
     storeForwardModule->sendMessage(to, sf);
     setIntervalFromNow(this->packetTimeMax); // Delay start of sending payloads
 }
@@ -126,22 +151,16 @@ void StoreForwardModule::historySend(uint32_t secAgo, uint32_t to)
  *
  * @param dest The destination node number.
  * @param last_time The relative time to start counting messages from.
- * @return The number of available packets in the message history.
+ * @return The number of available packets in the message history, counting stops at historyReturnMax.
  */
 uint32_t StoreForwardModule::getNumAvailablePackets(NodeNum dest, uint32_t last_time)
 {
-    uint32_t count = 0;
-    lastRequest.emplace(dest, 0);
-    for (uint32_t i = lastRequest[dest]; i < this->packetHistoryTotalCount; i++) {
-        if (this->packetHistory[i].time && (this->packetHistory[i].time > last_time)) {
-            // Client is only interested in packets not from itself and only in broadcast packets or packets towards it.
-            if (this->packetHistory[i].from != dest &&
-                (this->packetHistory[i].to == NODENUM_BROADCAST || this->packetHistory[i].to == dest)) {
-                count++;
-            }
-        }
-    }
-    return count;
+    // Client is only interested in packets not from itself and only in broadcast packets or packets towards it.
+#if STOREFORWARD_ARCHIVE
+    if (this->archive.isReady())
+        return this->archive.count(dest, last_time, lastRequest[dest], this->historyReturnMax);
+#endif
+    return this->packetHistory.count(dest, last_time, lastRequest[dest], this->historyReturnMax);
 }
 
 /**
@@ -184,31 +203,35 @@ void StoreForwardModule::historyAdd(const meshtastic_MeshPacket &mp)
 {
     const auto &p = mp.decoded;
 
-    if (this->packetHistoryTotalCount == this->records) {
-        LOG_WARN("S&F - PSRAM Full. Starting overwrite");
-        this->packetHistoryTotalCount = 0;
-        for (auto &i : lastRequest) {
-            i.second = 0; // Clear the last request index for each client device
-        }
+    PacketHistoryStruct packet = {};
+    packet.time = getTime();
+    packet.to = mp.to;
+    packet.channel = mp.channel;
+    packet.from = getFrom(&mp);
+    packet.id = mp.id;
+    packet.reply_id = p.reply_id;
+    packet.emoji = (bool)p.emoji;
+    packet.payload_size = p.payload.size;
+    packet.rx_rssi = mp.rx_rssi;
+    packet.rx_snr = mp.rx_snr;
+    packet.hop_start = mp.hop_start;
+    packet.hop_limit = mp.hop_limit;
+    packet.via_mqtt = mp.via_mqtt;
+    packet.transport_mechanism = mp.transport_mechanism;
+
+#if STOREFORWARD_ARCHIVE
+    if (this->archive.isReady()) {
+        if (!this->archive.append(packet, p.payload.bytes))
+            LOG_WARN("S&F - Could not archive packet");
+        return;
+    }
+#endif
+    uint32_t before = this->packetHistory.size();
+    if (!this->packetHistory.add(packet, p.payload.bytes)) {
+        LOG_WARN("S&F - No room for packetHistory");
+    } else if (this->packetHistory.size() <= before) {
+        LOG_DEBUG("S&F - PSRAM Full. Overwrote the oldest packets");
     }
-
-    this->packetHistory[this->packetHistoryTotalCount].time = getTime();
-    this->packetHistory[this->packetHistoryTotalCount].to = mp.to;
-    this->packetHistory[this->packetHistoryTotalCount].channel = mp.channel;
-    this->packetHistory[this->packetHistoryTotalCount].from = getFrom(&mp);
-    this->packetHistory[this->packetHistoryTotalCount].id = mp.id;
-    this->packetHistory[this->packetHistoryTotalCount].reply_id = p.reply_id;
-    this->packetHistory[this->packetHistoryTotalCount].emoji = (bool)p.emoji;
-    this->packetHistory[this->packetHistoryTotalCount].payload_size = p.payload.size;
-    this->packetHistory[this->packetHistoryTotalCount].rx_rssi = mp.rx_rssi;
-    this->packetHistory[this->packetHistoryTotalCount].rx_snr = mp.rx_snr;
-    this->packetHistory[this->packetHistoryTotalCount].hop_start = mp.hop_start;
-    this->packetHistory[this->packetHistoryTotalCount].hop_limit = mp.hop_limit;
-    this->packetHistory[this->packetHistoryTotalCount].via_mqtt = mp.via_mqtt;
-    this->packetHistory[this->packetHistoryTotalCount].transport_mechanism = mp.transport_mechanism;
-    memcpy(this->packetHistory[this->packetHistoryTotalCount].payload, p.payload.bytes, meshtastic_Constants_DATA_PAYLOAD_LEN);
-
-    this->packetHistoryTotalCount++;
 }
 
 /**
@@ -239,60 +262,68 @@ bool StoreForwardModule::sendPayload(NodeNum dest, uint32_t last_time)
  */
 meshtastic_MeshPacket *StoreForwardModule::preparePayload(NodeNum dest, uint32_t last_time, bool local)
 {
-    for (uint32_t i = lastRequest[dest]; i < this->packetHistoryTotalCount; i++) {
-        if (this->packetHistory[i].time && (this->packetHistory[i].time > last_time)) {
-            /*  Copy the messages that were received by the server in the last msAgo
-                to the packetHistoryTXQueue structure.
-                Client not interested in packets from itself and only in broadcast packets or packets towards it. */
-            if (this->packetHistory[i].from != dest &&
-                (this->packetHistory[i].to == NODENUM_BROADCAST || this->packetHistory[i].to == dest)) {
-
-                meshtastic_MeshPacket *p = allocDataPacket();
-
-                p->to = local ? this->packetHistory[i].to : dest; // PhoneAPI can handle original `to`
-                p->from = this->packetHistory[i].from;
-                p->id = this->packetHistory[i].id;
-                p->channel = this->packetHistory[i].channel;
-                p->decoded.reply_id = this->packetHistory[i].reply_id;
-                p->rx_time = this->packetHistory[i].time;
-                p->decoded.emoji = (uint32_t)this->packetHistory[i].emoji;
-                p->rx_rssi = this->packetHistory[i].rx_rssi;
-                p->rx_snr = this->packetHistory[i].rx_snr;
-                p->hop_start = this->packetHistory[i].hop_start;
-                p->hop_limit = this->packetHistory[i].hop_limit;
-                p->via_mqtt = this->packetHistory[i].via_mqtt;
-                p->transport_mechanism = (meshtastic_MeshPacket_TransportMechanism)this->packetHistory[i].transport_mechanism;
-
-                // Let's assume that if the server received the S&F request that the client is in range.
-                //   TODO: Make this configurable.
-                p->want_ack = false;
-
-                if (local) { // PhoneAPI gets normal TEXT_MESSAGE_APP
-                    p->decoded.portnum = meshtastic_PortNum_TEXT_MESSAGE_APP;
-                    memcpy(p->decoded.payload.bytes, this->packetHistory[i].payload, this->packetHistory[i].payload_size);
-                    p->decoded.payload.size = this->packetHistory[i].payload_size;
-                } else {
-                    meshtastic_StoreAndForward sf = meshtastic_StoreAndForward_init_zero;
-                    sf.which_variant = meshtastic_StoreAndForward_text_tag;
-                    sf.variant.text.size = this->packetHistory[i].payload_size;
-                    memcpy(sf.variant.text.bytes, this->packetHistory[i].payload, this->packetHistory[i].payload_size);
-                    if (this->packetHistory[i].to == NODENUM_BROADCAST) {
-                        sf.rr = meshtastic_StoreAndForward_RequestResponse_ROUTER_TEXT_BROADCAST;
-                    } else {
-                        sf.rr = meshtastic_StoreAndForward_RequestResponse_ROUTER_TEXT_DIRECT;
-                    }
-
-                    p->decoded.payload.size = pb_encode_to_bytes(p->decoded.payload.bytes, sizeof(p->decoded.payload.bytes),
-                                                                 &meshtastic_StoreAndForward_msg, &sf);
-                }
+    /*  Copy the messages that were received by the server in the last msAgo
+        to the packetHistoryTXQueue structure.
+        Client not interested in packets from itself and only in broadcast packets or packets towards it.
+        This also moves the client's position in the history past the packet. */
+    PacketHistoryStruct packet;
+    const uint8_t *payload;
+#if STOREFORWARD_ARCHIVE
+    if (this->archive.isReady()) {
+        if (!this->archive.next(dest, last_time, lastRequest[dest], packet, this->archivedPayload))
+            return nullptr;
+        payload = this->archivedPayload;
+    } else
+#endif
+    {
+        const StoreForwardHistory::Record *record = this->packetHistory.next(dest, last_time, lastRequest[dest]);
+        if (!record)
+            return nullptr;
+        packet = record->packet;
+        payload = record->payload();
+    }
 
-                lastRequest[dest] = i + 1; // Update the last request index for the client device
+    meshtastic_MeshPacket *p = allocDataPacket();
+
+    p->to = local ? packet.to : dest; // PhoneAPI can handle original `to`
+    p->from = packet.from;
+    p->id = packet.id;
+    p->channel = packet.channel;
+    p->decoded.reply_id = packet.reply_id;
+    p->rx_time = packet.time;
+    p->decoded.emoji = (uint32_t)packet.emoji;
+    p->rx_rssi = packet.rx_rssi;
+    p->rx_snr = packet.rx_snr;
+    p->hop_start = packet.hop_start;
+    p->hop_limit = packet.hop_limit;
+    p->via_mqtt = packet.via_mqtt;
+    p->transport_mechanism = (meshtastic_MeshPacket_TransportMechanism)packet.transport_mechanism;
 
-                return p;
-            }
+    // Let's assume that if the server received the S&F request that the client is in range.
+    //   TODO: Make this configurable.
+    p->want_ack = false;
+
+    if (local) { // PhoneAPI gets normal TEXT_MESSAGE_APP
+        p->decoded.portnum = meshtastic_PortNum_TEXT_MESSAGE_APP;
+        memcpy(p->decoded.payload.bytes, payload, packet.payload_size);
+        p->decoded.payload.size = packet.payload_size;
+    } else {
+        meshtastic_StoreAndForward sf = meshtastic_StoreAndForward_init_zero;
+        sf.which_variant = meshtastic_StoreAndForward_text_tag;
+        sf.variant.text.size = packet.payload_size;
+        memcpy(sf.variant.text.bytes, payload, packet.payload_size);
+        if (packet.to == NODENUM_BROADCAST) {
+            sf.rr = meshtastic_StoreAndForward_RequestResponse_ROUTER_TEXT_BROADCAST;
+        } else {
+            sf.rr = meshtastic_StoreAndForward_RequestResponse_ROUTER_TEXT_DIRECT;
         }
+
+        p->decoded.payload.size =
+            pb_encode_to_bytes(p->decoded.payload.bytes, sizeof(p->decoded.payload.bytes), &meshtastic_StoreAndForward_msg, &sf);
     }
-    return nullptr;
+
+    this->records_served++;
+    return p;
 }
 
 /**
@@ -371,9 +402,18 @@ void StoreForwardModule::statsSend(uint32_t to)
 
     sf.rr = meshtastic_StoreAndForward_RequestResponse_ROUTER_STATS;
     sf.which_variant = meshtastic_StoreAndForward_stats_tag;
-    sf.variant.stats.messages_total = this->records;
-    sf.variant.stats.messages_saved = this->packetHistoryTotalCount;
-    sf.variant.stats.messages_max = this->records;
+#if STOREFORWARD_ARCHIVE
+    if (this->archive.isReady()) {
+        sf.variant.stats.messages_total = this->archive.getIndex().getTotalAdded();
+        sf.variant.stats.messages_saved = this->archive.getIndex().size();
+        sf.variant.stats.messages_max = this->archive.getIndex().getCapacity();
+    } else
+#endif
+    {
+        sf.variant.stats.messages_total = this->packetHistory.getTotalAdded();
+        sf.variant.stats.messages_saved = this->packetHistory.size();
+        sf.variant.stats.messages_max = this->packetHistory.estimateMaxRecords();
+    }
     sf.variant.stats.up_time = millis() / 1000;
     sf.variant.stats.requests = this->requests;
     sf.variant.stats.requests_history = this->requests_history;
@@ -381,7 +421,17 @@ void StoreForwardModule::statsSend(uint32_t to)
     sf.variant.stats.return_max = this->historyReturnMax;
     sf.variant.stats.return_window = this->historyReturnWindow;
 
-    LOG_DEBUG("Send S&F Stats");
+    // The stats message has no fields for these, so at least show them on the server
+#if STOREFORWARD_ARCHIVE
+    if (this->archive.isReady())
+        LOG_DEBUG("Send S&F Stats, archive indexes %u of %u records in %u segments, %u records served",
+                  this->archive.getIndex().size(), this->archive.getIndex().getCapacity(), this->archive.getSegmentCount(),
+                  this->records_served);
+    else
+#endif
+        LOG_DEBUG("Send S&F Stats, history uses %u of %u bytes, %u records served",
+                  (unsigned)this->packetHistory.getUsedBytes(), (unsigned)this->packetHistory.getCapacity(),
+                  this->records_served);
     storeForwardModule->sendMessage(to, sf);
 }
 
@@ -409,7 +459,12 @@ ProcessMessage StoreForwardModule::handleReceived(const meshtastic_MeshPacket &m
                 }
             } else {
                 storeForwardModule->historyAdd(mp);
-                LOG_INFO("S&F stored. Message history contains %u records now", this->packetHistoryTotalCount);
+#if STOREFORWARD_ARCHIVE
+                if (this->archive.isReady())
+                    LOG_INFO("S&F stored. Archive contains %u records now", this->archive.getIndex().size());
+                else
+#endif
+                    LOG_INFO("S&F stored. Message history contains %u records now", this->packetHistory.size());
             }
         } else if (!isFromUs(&mp) && mp.decoded.portnum == meshtastic_PortNum_STORE_FORWARD_APP) {
             auto &p = mp.decoded;
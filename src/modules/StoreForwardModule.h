@@ -1,6 +1,8 @@
 #pragma once
 
 #include "ProtobufModule.h"
+#include "StoreForwardArchive.h"
+#include "StoreForwardHistory.h"
 #include "concurrency/OSThread.h"
 #include "mesh/generated/meshtastic/storeforward.pb.h"
 
@@ -9,32 +11,17 @@
 #include <functional>
 #include <unordered_map>
 
-struct PacketHistoryStruct {
-    uint32_t time;
-    uint32_t to;
-    uint32_t from;
-    uint32_t id;
-    uint8_t channel;
-    uint32_t reply_id;
-    bool emoji;
-    uint8_t payload[meshtastic_Constants_DATA_PAYLOAD_LEN];
-    pb_size_t payload_size;
-    int32_t rx_rssi;
-    float rx_snr;
-    uint8_t hop_start;
-    uint8_t hop_limit;
-    bool via_mqtt;
-    uint8_t transport_mechanism;
-};
-
 class StoreForwardModule : private concurrency::OSThread, public ProtobufModule<meshtastic_StoreAndForward>
 {
     bool busy = 0;
     uint32_t busyTo = 0;
     char routerMessage[meshtastic_Constants_DATA_PAYLOAD_LEN] = {0};
 
-    PacketHistoryStruct *packetHistory = 0;
-    uint32_t packetHistoryTotalCount = 0;
+    StoreForwardHistory packetHistory;
+#if STOREFORWARD_ARCHIVE
+    StoreForwardArchive archive; // when ready, history is kept and served from here instead of packetHistory
+    uint8_t archivedPayload[meshtastic_Constants_DATA_PAYLOAD_LEN];
+#endif
     uint32_t last_time = 0;
     uint32_t requestCount = 0;
 
@@ -43,8 +30,8 @@ class StoreForwardModule : private concurrency::OSThread, public ProtobufModule<
     bool is_client = false;
     bool is_server = false;
 
-    // Unordered_map stores the last request for each nodeNum (`to` field)
-    std::unordered_map<NodeNum, uint32_t> lastRequest;
+    // How far into the history each client (by nodeNum) got
+    std::unordered_map<NodeNum, StoreForwardHistory::Cursor> lastRequest;
 
   public:
     StoreForwardModule();
@@ -64,8 +51,8 @@ class StoreForwardModule : private concurrency::OSThread, public ProtobufModule<
     /**
      * Send our payload into the mesh
      */
-    bool sendPayload(NodeNum dest = NODENUM_BROADCAST, uint32_t packetHistory_index = 0);
-    meshtastic_MeshPacket *preparePayload(NodeNum dest, uint32_t packetHistory_index, bool local = false);
+    bool sendPayload(NodeNum dest = NODENUM_BROADCAST, uint32_t last_time = 0);
+    meshtastic_MeshPacket *preparePayload(NodeNum dest, uint32_t last_time, bool local = false);
     void sendMessage(NodeNum dest, const meshtastic_StoreAndForward &payload);
     void sendMessage(NodeNum dest, meshtastic_StoreAndForward_RequestResponse rr);
     void sendErrorTextMessage(NodeNum dest, bool want_response);
@@ -86,6 +73,7 @@ class StoreForwardModule : private concurrency::OSThread, public ProtobufModule<
             return false;
         }
     }
+    virtual bool getDispatchPort(meshtastic_PortNum &port) const override { return false; }
 
   private:
     void populatePSRAM();
@@ -99,6 +87,7 @@ class StoreForwardModule : private concurrency::OSThread, public ProtobufModule<
     // stats
     uint32_t requests = 0;         // Number of times any client sent a request to the S&F.
     uint32_t requests_history = 0; // Number of times the history was requested.
+    uint32_t records_served = 0;   // Number of history records sent to clients.
 
     uint32_t retry_delay = 0; // If server is busy, retry after this delay (in ms).
 
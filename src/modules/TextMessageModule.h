@@ -30,6 +30,8 @@ class TextMessageModule : public SinglePortModule, public Observable<const mesht
      */
     virtual ProcessMessage handleReceived(const meshtastic_MeshPacket &mp) override;
     virtual bool wantPacket(const meshtastic_MeshPacket *p) override;
+    // Text arrives on several portnums, see MeshService::isTextPayload
+    virtual bool getDispatchPort(meshtastic_PortNum &port) const override { return false; }
 
   private:
     uint32_t textPacketList[TEXT_PACKET_LIST_SIZE] = {0};
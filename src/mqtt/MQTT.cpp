@@ -50,6 +50,11 @@ constexpr int reconnectMax = 5;
 // FIXME - this size calculation is super sloppy, but it will go away once we dynamically alloc meshpackets
 static uint8_t bytes[meshtastic_MqttClientProxyMessage_size + 30]; // 12 for channel name and 16 for nodeid
 
+#if !defined(ARCH_NRF52) || defined(NRF52_USE_JSON)
+// JSON for the json topic is serialized straight into here instead of into a JSONValue tree and a std::string
+static char jsonBuffer[MESHPACKET_JSON_BUFFER_SIZE];
+#endif
+
 static bool isMqttServerAddressPrivate = false;
 static bool isConnected = false;
 
@@ -413,9 +418,9 @@ void mqttInit()
 #if HAS_NETWORKING
 MQTT::MQTT() : MQTT(std::unique_ptr<MQTTClient>(new MQTTClient())) {}
 MQTT::MQTT(std::unique_ptr<MQTTClient> _mqttClient)
-    : concurrency::OSThread("mqtt"), mqttQueue(MAX_MQTT_QUEUE), mqttClient(std::move(_mqttClient)), pubSub(*mqttClient)
+    : concurrency::OSThread("mqtt"), mqttClient(std::move(_mqttClient)), pubSub(*mqttClient)
 #else
-MQTT::MQTT() : concurrency::OSThread("mqtt"), mqttQueue(MAX_MQTT_QUEUE)
+MQTT::MQTT() : concurrency::OSThread("mqtt")
 #endif
 {
     if (moduleConfig.mqtt.enabled) {
@@ -463,6 +468,11 @@ MQTT::MQTT() : concurrency::OSThread("mqtt"), mqttQueue(MAX_MQTT_QUEUE)
             publishNodeInfo();
 #endif
         }
+#if MQTT_QUEUE_SPILL
+        mqttQueue.loadSpill();
+        rebootObserver.observe(&notifyReboot);
+        deepSleepObserver.observe(&notifyDeepSleep);
+#endif
         // preflightSleepObserver.observe(&preflightSleep);
     } else {
         disable();
@@ -621,8 +631,8 @@ int32_t MQTT::runOnce()
             return 5000; // If we don't want connection now, check again in 5 secs
         else {
             reconnect();
-            // If we succeeded, empty the queue one by one and start reading rapidly, else try again in 30 seconds (TCP
-            // connections are EXPENSIVE so try rarely)
+            // If we succeeded, start emptying the queue and reading rapidly, else try again in 30 seconds (TCP connections are
+            // EXPENSIVE so try rarely)
             if (isConnectedDirectly()) {
                 publishQueuedMessages();
                 return 200;
@@ -634,6 +644,9 @@ int32_t MQTT::runOnce()
         if (!wantConnection) {
             LOG_INFO("MQTT link not needed, drop");
             pubSub.disconnect();
+        } else {
+            // Keep draining whatever queued up while we were disconnected, a burst per run
+            publishQueuedMessages();
         }
 
         powerFSM.trigger(EVENT_CONTACT_FROM_PHONE); // Suppress entering light sleep (because that would turn off bluetooth)
@@ -712,37 +725,51 @@ void MQTT::publishQueuedMessages()
     if (!moduleConfig.mqtt.proxy_to_client_enabled && !isConnected)
         return;
 
-    LOG_DEBUG("Publish enqueued MQTT message");
-    const std::unique_ptr<QueueEntry> entry(mqttQueue.dequeuePtr(0));
-    LOG_INFO("publish %s, %u bytes from queue", entry->topic.c_str(), entry->envBytes.size());
-    publish(entry->topic.c_str(), entry->envBytes.data(), entry->envBytes.size(), false);
+    // The client proxy queue toward the phone is small and drops its oldest message when full, so feed it one at a time
+    const uint32_t burst = moduleConfig.mqtt.proxy_to_client_enabled ? 1 : MQTT_QUEUE_BURST;
+    const uint32_t start = millis();
+    MQTTQueue::Entry entry;
+    for (uint32_t published = 0; published < burst && Throttle::isWithinTimespanMs(start, MQTT_QUEUE_BURST_MS); published++) {
+        if (!mqttQueue.pop(entry))
+            break;
+        LOG_INFO("publish %s, %u bytes from queue", entry.topic.c_str(), entry.envBytes.size());
+        if (!publish(entry.topic.c_str(), entry.envBytes.data(), entry.envBytes.size(), false)) {
+            if (!moduleConfig.mqtt.proxy_to_client_enabled && !isConnectedDirectly()) {
+                // Lost the connection, try again after reconnecting
+                mqttQueue.pushFront(std::move(entry));
+                break;
+            }
+            LOG_WARN("MQTT could not publish %u bytes to %s, discard", entry.envBytes.size(), entry.topic.c_str());
+            continue;
+        }
 
 #if !defined(ARCH_NRF52) ||                                                                                                      \
     defined(NRF52_USE_JSON) // JSON is not supported on nRF52, see issue #2804 ### Fixed by using ArduinoJson ###
-    if (!moduleConfig.mqtt.json_enabled)
-        return;
+        if (!moduleConfig.mqtt.json_enabled)
+            continue;
 
-    // handle json topic
-    const DecodedServiceEnvelope env(entry->envBytes.data(), entry->envBytes.size());
-    if (!env.validDecode || env.packet == NULL || env.channel_id == NULL)
-        return;
+        // handle json topic
+        const DecodedServiceEnvelope env(entry.envBytes.data(), entry.envBytes.size());
+        if (!env.validDecode || env.packet == NULL || env.channel_id == NULL)
+            continue;
 
-    auto jsonString = MeshPacketSerializer::JsonSerialize(env.packet);
-    if (jsonString.length() == 0)
-        return;
+        size_t jsonLength = MeshPacketSerializer::JsonSerialize(env.packet, jsonBuffer, sizeof(jsonBuffer));
+        if (jsonLength == 0)
+            continue;
 
-    // Generate node ID from nodenum for topic
-    std::string nodeId = nodeDB->getNodeId();
+        // Generate node ID from nodenum for topic
+        std::string nodeId = nodeDB->getNodeId();
 
-    std::string topicJson;
-    if (env.packet->pki_encrypted) {
-        topicJson = jsonTopic + "PKI/" + nodeId;
-    } else {
-        topicJson = jsonTopic + env.channel_id + "/" + nodeId;
-    }
-    LOG_INFO("JSON publish message to %s, %u bytes: %s", topicJson.c_str(), jsonString.length(), jsonString.c_str());
-    publish(topicJson.c_str(), jsonString.c_str(), false);
+        std::string topicJson;
+        if (env.packet->pki_encrypted) {
+            topicJson = jsonTopic + "PKI/" + nodeId;
+        } else {
+            topicJson = jsonTopic + env.channel_id + "/" + nodeId;
+        }
+        LOG_INFO("JSON publish message to %s, %u bytes: %s", topicJson.c_str(), (unsigned)jsonLength, jsonBuffer);
+        publish(topicJson.c_str(), jsonBuffer, false);
 #endif // ARCH_NRF52 NRF52_USE_JSON
+    }
 }
 
 void MQTT::onSend(const meshtastic_MeshPacket &mp_encrypted, const meshtastic_MeshPacket &mp_decoded, ChannelIndex chIndex)
@@ -812,30 +839,23 @@ void MQTT::onSend(const meshtastic_MeshPacket &mp_encrypted, const meshtastic_Me
         if (!moduleConfig.mqtt.json_enabled)
             return;
         // handle json topic
-        auto jsonString = MeshPacketSerializer::JsonSerialize(&mp_decoded);
-        if (jsonString.length() == 0)
+        size_t jsonLength = MeshPacketSerializer::JsonSerialize(&mp_decoded, jsonBuffer, sizeof(jsonBuffer));
+        if (jsonLength == 0)
             return;
         // Generate node ID from nodenum for JSON topic
         std::string nodeIdForJson = nodeDB->getNodeId();
         std::string topicJson = jsonTopic + channelId + "/" + nodeIdForJson;
-        LOG_INFO("JSON publish message to %s, %u bytes: %s", topicJson.c_str(), jsonString.length(), jsonString.c_str());
-        publish(topicJson.c_str(), jsonString.c_str(), false);
+        LOG_INFO("JSON publish message to %s, %u bytes: %s", topicJson.c_str(), (unsigned)jsonLength, jsonBuffer);
+        publish(topicJson.c_str(), jsonBuffer, false);
 #endif // ARCH_NRF52 NRF52_USE_JSON
     } else {
         LOG_INFO("MQTT not connected, queue packet");
-        QueueEntry *entry;
-        if (mqttQueue.numFree() == 0) {
-            LOG_WARN("MQTT queue is full, discard oldest");
-            entry = mqttQueue.dequeuePtr(0);
-        } else {
-            entry = new QueueEntry;
-        }
-        entry->topic = std::move(topic);
-        entry->envBytes.assign(bytes, numBytes);
-        if (mqttQueue.enqueue(entry, 0) == false) {
-            LOG_CRIT("Failed to add a message to mqttQueue!");
-            abort();
-        }
+        MQTTQueue::Entry entry;
+        entry.topic = std::move(topic);
+        entry.envBytes.assign(bytes, numBytes);
+        entry.priority = MQTTQueue::classify(mp_decoded);
+        if (!mqttQueue.push(std::move(entry)))
+            LOG_WARN("MQTT queue dropped %u messages so far", mqttQueue.getDropped());
     }
 }
 
@@ -3,6 +3,8 @@
 #include "Default.h"
 #include "configuration.h"
 
+#include "MQTTQueue.h"
+#include "Observer.h"
 #include "concurrency/OSThread.h"
 #include "mesh/Channels.h"
 #include "mesh/generated/meshtastic/mqtt.pb.h"
@@ -24,8 +26,6 @@
 #include <memory>
 #endif
 
-#define MAX_MQTT_QUEUE 16
-
 /**
  * Our wrapper/singleton for sending/receiving MQTT "udp" packets.  This object isolates the MQTT protocol implementation from
  * the two components that use it: MQTTPlugin and MQTTSimInterface.
@@ -65,11 +65,7 @@ class MQTT : private concurrency::OSThread
     static bool isValidConfig(const meshtastic_ModuleConfig_MQTTConfig &config) { return isValidConfig(config, nullptr); }
 
   protected:
-    struct QueueEntry {
-        std::string topic;
-        std::basic_string<uint8_t> envBytes; // binary/pb_encode_to_bytes ServiceEnvelope
-    };
-    PointerQueue<QueueEntry> mqttQueue;
+    MQTTQueue mqttQueue;
 
     int reconnectCount = 0;
     bool isConfiguredForDefaultServer = true;
@@ -127,6 +123,7 @@ class MQTT : private concurrency::OSThread
     /// Called when a new publish arrives from the MQTT server
     void onReceive(char *topic, byte *payload, size_t length);
 
+    /// Publish queued messages, a burst of them when connected directly
     void publishQueuedMessages();
 
     void publishNodeInfo();
@@ -134,6 +131,17 @@ class MQTT : private concurrency::OSThread
     // Check if we should report unencrypted information about our node for consumption by a map
     void perhapsReportToMap();
 
+#if MQTT_QUEUE_SPILL
+    /// Keep queued messages across a reboot or shutdown
+    int saveQueue(void *unused)
+    {
+        mqttQueue.spillAll();
+        return 0;
+    }
+    CallbackObserver<MQTT, void *> rebootObserver = CallbackObserver<MQTT, void *>(this, &MQTT::saveQueue);
+    CallbackObserver<MQTT, void *> deepSleepObserver = CallbackObserver<MQTT, void *>(this, &MQTT::saveQueue);
+#endif
+
     /// Return 0 if sleep is okay, veto sleep if we are connected to pubsub server
     // int preflightSleepCb(void *unused = NULL) { return pubSub.connected() ? 1 : 0; }
 };
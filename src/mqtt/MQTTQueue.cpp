@@ -0,0 +1,298 @@
+#include "MQTTQueue.h"
+#include "FSCommon.h"
+#include "MeshTypes.h"
+#include "SPILock.h"
+#include "configuration.h"
+#include <ErriezCRC32.h>
+#include <string.h>
+
+#if MQTT_QUEUE_SPILL && defined(FSCom)
+#define SpillFS FSCom
+static const char *spillDir = "/mqtt";
+static const char *spillFile = "/mqtt/queue";
+static const char *spillTempFile = "/mqtt/queue.tmp";
+#endif
+
+MQTTQueue::Priority MQTTQueue::classify(const meshtastic_MeshPacket &decoded)
+{
+    if (decoded.which_payload_variant != meshtastic_MeshPacket_decoded_tag)
+        return decoded.pki_encrypted ? PRIORITY_HIGH : PRIORITY_NORMAL;
+
+    switch (decoded.decoded.portnum) {
+    case meshtastic_PortNum_TEXT_MESSAGE_APP:
+    case meshtastic_PortNum_TEXT_MESSAGE_COMPRESSED_APP:
+    case meshtastic_PortNum_ALERT_APP:
+        return PRIORITY_HIGH;
+    case meshtastic_PortNum_TELEMETRY_APP:
+    case meshtastic_PortNum_POSITION_APP:
+    case meshtastic_PortNum_NODEINFO_APP:
+    case meshtastic_PortNum_MAP_REPORT_APP:
+    case meshtastic_PortNum_NEIGHBORINFO_APP:
+    case meshtastic_PortNum_PAXCOUNTER_APP:
+    case meshtastic_PortNum_NODE_STATUS_APP:
+        return PRIORITY_LOW;
+    default:
+        return isBroadcast(decoded.to) ? PRIORITY_NORMAL : PRIORITY_HIGH;
+    }
+}
+
+void MQTTQueue::add(Entry &&entry, bool atFront)
+{
+    usedBytes += entry.cost();
+    count++;
+    auto &queue = entries[entry.priority];
+    if (atFront)
+        queue.push_front(std::move(entry));
+    else
+        queue.push_back(std::move(entry));
+}
+
+bool MQTTQueue::push(Entry &&entry)
+{
+    if (entry.priority >= NUM_PRIORITIES)
+        entry.priority = PRIORITY_NORMAL;
+
+    // Spilled messages are older, anything new goes behind them while the file is read back
+    if (spillPending() && spill(entry))
+        return true;
+    if (entry.cost() > maxBytes)
+        return discard(std::move(entry));
+
+    bool kept = true;
+    while (usedBytes + entry.cost() > maxBytes) {
+        int lowest = 0;
+        while (entries[lowest].empty())
+            lowest++;
+        if (lowest > entry.priority) {
+            LOG_WARN("MQTT queue is full of more important messages, discard new one");
+            discard(std::move(entry));
+            return false;
+        }
+        LOG_WARN("MQTT queue is full, discard oldest of priority %d", lowest);
+        Entry oldest = std::move(entries[lowest].front());
+        entries[lowest].pop_front();
+        usedBytes -= oldest.cost();
+        count--;
+        kept = discard(std::move(oldest)) && kept;
+    }
+    add(std::move(entry), false);
+    return kept;
+}
+
+bool MQTTQueue::pop(Entry &entry)
+{
+    if (count == 0)
+        refill();
+    for (int p = NUM_PRIORITIES - 1; p >= 0; p--) {
+        if (entries[p].empty())
+            continue;
+        entry = std::move(entries[p].front());
+        entries[p].pop_front();
+        usedBytes -= entry.cost();
+        count--;
+        return true;
+    }
+    return false;
+}
+
+void MQTTQueue::pushFront(Entry &&entry)
+{
+    add(std::move(entry), true);
+}
+
+bool MQTTQueue::discard(Entry &&entry)
+{
+    if (spill(entry))
+        return true;
+    dropped++;
+    return false;
+}
+
+size_t MQTTQueue::encodeRecord(const Entry &entry, uint8_t *buf, size_t bufSize)
+{
+    size_t bodyLen = 2 + entry.topic.size() + entry.envBytes.size();
+    if (entry.topic.size() > MAX_TOPIC_LENGTH || bufSize < bodyLen + 2 + 4)
+        return 0;
+    buf[0] = bodyLen & 0xff;
+    buf[1] = (bodyLen >> 8) & 0xff;
+    buf[2] = entry.priority;
+    buf[3] = entry.topic.size();
+    memcpy(buf + 4, entry.topic.data(), entry.topic.size());
+    memcpy(buf + 4 + entry.topic.size(), entry.envBytes.data(), entry.envBytes.size());
+    uint32_t crc = crc32Buffer(buf, 2 + bodyLen);
+    for (int i = 0; i < 4; i++)
+        buf[2 + bodyLen + i] = (crc >> (8 * i)) & 0xff;
+    return bodyLen + 2 + 4;
+}
+
+size_t MQTTQueue::decodeRecord(const uint8_t *buf, size_t len, Entry &entry)
+{
+    if (len < RECORD_OVERHEAD)
+        return 0;
+    size_t bodyLen = buf[0] | (buf[1] << 8);
+    if (bodyLen < 2 || len < bodyLen + 2 + 4)
+        return 0;
+
+    const uint8_t *crcBytes = buf + 2 + bodyLen;
+    uint32_t crc = crcBytes[0] | (crcBytes[1] << 8) | (crcBytes[2] << 16) | ((uint32_t)crcBytes[3] << 24);
+    if (crc != crc32Buffer(buf, 2 + bodyLen))
+        return 0;
+
+    size_t topicLen = buf[3];
+    if (buf[2] >= NUM_PRIORITIES || 2 + topicLen > bodyLen)
+        return 0;
+    entry.priority = (Priority)buf[2];
+    entry.topic.assign((const char *)buf + 4, topicLen);
+    entry.envBytes.assign(buf + 4 + topicLen, bodyLen - 2 - topicLen);
+    return bodyLen + 2 + 4;
+}
+
+/// Read the record at the current position of f into buf, which must hold MAX_RECORD_SIZE bytes. @return its length or 0.
+template <typename F> static size_t readRecord(F &f, uint8_t *buf, MQTTQueue::Entry &entry)
+{
+    if (f.read(buf, 2) != 2)
+        return 0;
+    size_t rest = (buf[0] | (buf[1] << 8)) + 4;
+    if (rest + 2 > MQTTQueue::MAX_RECORD_SIZE || (size_t)f.read(buf + 2, rest) != rest)
+        return 0;
+    return MQTTQueue::decodeRecord(buf, 2 + rest, entry);
+}
+
+bool MQTTQueue::spill(const Entry &entry)
+{
+#ifdef SpillFS
+    uint8_t record[MAX_RECORD_SIZE];
+    size_t len = encodeRecord(entry, record, sizeof(record));
+    if (len == 0 || spillBytes + len > MQTT_QUEUE_SPILL_BYTES)
+        return false;
+
+    concurrency::LockGuard g(spiLock);
+    if (!SpillFS.exists(spillDir))
+        SpillFS.mkdir(spillDir);
+    auto f = SpillFS.open(spillFile, FILE_O_APPEND);
+    if (!f) {
+        LOG_ERROR("MQTT: could not open %s for append", spillFile);
+        return false;
+    }
+    size_t written = f.write(record, len);
+    f.flush();
+    f.close();
+    spillBytes += written;
+    if (written != len) {
+        // The reader stops at the partial record, nothing can be appended after it
+        LOG_ERROR("MQTT: short write to %s, %u of %u bytes", spillFile, (unsigned)written, (unsigned)len);
+        spillBytes = MQTT_QUEUE_SPILL_BYTES;
+        return false;
+    }
+    return true;
+#else
+    (void)entry;
+    return false;
+#endif
+}
+
+void MQTTQueue::refill()
+{
+#ifdef SpillFS
+    if (!spillPending())
+        return;
+
+    concurrency::LockGuard g(spiLock);
+    auto f = SpillFS.open(spillFile, FILE_O_READ);
+    bool done = !f;
+    if (f) {
+        f.seek(spillOffset);
+        uint8_t record[MAX_RECORD_SIZE];
+        Entry entry;
+        while (true) {
+            size_t len = readRecord(f, record, entry);
+            if (len == 0) {
+                done = true;
+                break;
+            }
+            // Always take one, so the file keeps moving even if the budget is smaller than a record
+            if (count > 0 && usedBytes + entry.cost() > maxBytes)
+                break;
+            add(std::move(entry), false);
+            spillOffset += len;
+        }
+        f.close();
+    }
+    if (done) {
+        SpillFS.remove(spillFile);
+        spillOffset = spillBytes = 0;
+    }
+    LOG_DEBUG("MQTT: %u messages back from %s", (unsigned)count, spillFile);
+#endif
+}
+
+void MQTTQueue::loadSpill()
+{
+#ifdef SpillFS
+    {
+        concurrency::LockGuard g(spiLock);
+        auto f = SpillFS.open(spillFile, FILE_O_READ);
+        if (!f)
+            return;
+        spillOffset = 0;
+        spillBytes = f.size();
+        f.close();
+    }
+    LOG_INFO("MQTT: %u bytes of queued messages saved before reboot", (unsigned)spillBytes);
+    if (count == 0)
+        refill();
+#endif
+}
+
+void MQTTQueue::spillAll()
+{
+#ifdef SpillFS
+    // Records before spillOffset were already taken back into RAM, keep only the rest so they are not published twice
+    if (spillOffset > 0) {
+        bool copied = false;
+        {
+            concurrency::LockGuard g(spiLock);
+            auto from = SpillFS.open(spillFile, FILE_O_READ);
+            auto to = SpillFS.open(spillTempFile, FILE_O_WRITE);
+            if (from && to && from.size() >= spillOffset && from.seek(spillOffset)) {
+                size_t remaining = from.size() - spillOffset;
+                uint8_t buf[64];
+                while (remaining > 0) {
+                    size_t n = from.read(buf, remaining < sizeof(buf) ? remaining : sizeof(buf));
+                    if (n == 0 || to.write(buf, n) != n)
+                        break;
+                    remaining -= n;
+                }
+                copied = remaining == 0;
+            }
+            if (from)
+                from.close();
+            if (to) {
+                to.flush();
+                to.close();
+                if (!copied)
+                    SpillFS.remove(spillTempFile);
+            }
+        }
+        // Only forget what was taken back once the rest is in place. Otherwise the file and spillOffset still agree, and the
+        // next spillAll() tries again.
+        if (copied && renameFile(spillTempFile, spillFile)) {
+            spillBytes -= spillOffset;
+            spillOffset = 0;
+        } else {
+            LOG_WARN("MQTT: could not compact %s, %u bytes in it were already published", spillFile, (unsigned)spillOffset);
+        }
+    }
+
+    uint32_t saved = 0;
+    for (int p = NUM_PRIORITIES - 1; p >= 0; p--) {
+        for (auto &entry : entries[p]) {
+            if (spill(entry))
+                saved++;
+        }
+        entries[p].clear();
+    }
+    usedBytes = count = 0;
+    LOG_INFO("MQTT: saved %u queued messages to %s", (unsigned)saved, spillFile);
+#endif
+}
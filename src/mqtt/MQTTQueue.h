@@ -0,0 +1,120 @@
+#pragma once
+
+#include "mesh/generated/meshtastic/mesh.pb.h"
+#include <deque>
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+// Bytes of topics and envelopes held in RAM while the MQTT server can not be reached
+#ifndef MQTT_QUEUE_BYTES
+#define MQTT_QUEUE_BYTES (16 * 1024)
+#endif
+
+// Most queued messages published per run once connected again, and how long one run may take doing it
+#ifndef MQTT_QUEUE_BURST
+#define MQTT_QUEUE_BURST 16
+#endif
+#ifndef MQTT_QUEUE_BURST_MS
+#define MQTT_QUEUE_BURST_MS 50
+#endif
+
+// Write messages which do not fit in RAM (and everything queued at reboot or shutdown) to flash instead of dropping them
+#ifndef MQTT_QUEUE_SPILL
+#define MQTT_QUEUE_SPILL 0
+#endif
+
+// Most bytes the spill file may grow to
+#ifndef MQTT_QUEUE_SPILL_BYTES
+#define MQTT_QUEUE_SPILL_BYTES (128 * 1024)
+#endif
+
+/**
+ * Messages waiting for the MQTT server to come back.
+ *
+ * Each message is given a priority from its packet: text and direct messages are kept over ordinary traffic, which is kept over
+ * telemetry, positions and the like. When the byte budget is used up the oldest message of the lowest priority makes room, a new
+ * message is only refused if everything queued is more important. Messages come out highest priority first, oldest first within
+ * a priority.
+ *
+ * With MQTT_QUEUE_SPILL, messages which would have been dropped are appended to a file instead and read back as the queue
+ * empties. Before a reboot or shutdown the whole queue is written there too, and it is read back at boot.
+ */
+class MQTTQueue
+{
+  public:
+    enum Priority : uint8_t { PRIORITY_LOW, PRIORITY_NORMAL, PRIORITY_HIGH, NUM_PRIORITIES };
+
+    struct Entry {
+        std::string topic;
+        std::basic_string<uint8_t> envBytes; // binary/pb_encode_to_bytes ServiceEnvelope
+        Priority priority = PRIORITY_NORMAL;
+
+        /// What this entry counts against the byte budget
+        size_t cost() const { return sizeof(Entry) + topic.size() + envBytes.size(); }
+    };
+
+    /// [length u16][priority u8][topic length u8][topic][envelope][crc32], length counts priority to envelope
+    static constexpr size_t RECORD_OVERHEAD = 2 + 1 + 1 + 4;
+    static constexpr size_t MAX_TOPIC_LENGTH = 255;
+    static constexpr size_t MAX_RECORD_SIZE = RECORD_OVERHEAD + MAX_TOPIC_LENGTH + meshtastic_MqttClientProxyMessage_size + 30;
+
+    explicit MQTTQueue(size_t maxBytes = MQTT_QUEUE_BYTES) : maxBytes(maxBytes) {}
+
+    /// Priority for a packet. decoded is the packet as we could decode it, which may still be encrypted.
+    static Priority classify(const meshtastic_MeshPacket &decoded);
+
+    /// Queue a message, making room if needed. @return false if it (or something it replaced) was dropped.
+    bool push(Entry &&entry);
+
+    /// Take the most important message. @return false if there is none.
+    bool pop(Entry &entry);
+
+    /// Put back a message taken by pop() which could not be published, it will be the next one out
+    void pushFront(Entry &&entry);
+
+    bool isEmpty() const { return count == 0 && !spillPending(); }
+
+    /// Messages in RAM
+    size_t size() const { return count; }
+
+    /// Bytes of the budget in use
+    size_t bytes() const { return usedBytes; }
+
+    /// How many messages were dropped since boot
+    uint32_t getDropped() const { return dropped; }
+
+    /// Read back any messages spilled before the last reboot
+    void loadSpill();
+
+    /// Write everything in RAM to the spill file, for a reboot or shutdown
+    void spillAll();
+
+    /// Encode an entry into buf. @return the record length, or 0 if buf is too small or the topic too long.
+    static size_t encodeRecord(const Entry &entry, uint8_t *buf, size_t bufSize);
+
+    /// Decode the record at the start of buf. @return the record length, or 0 if buf does not start with an undamaged record.
+    static size_t decodeRecord(const uint8_t *buf, size_t len, Entry &entry);
+
+  private:
+    std::deque<Entry> entries[NUM_PRIORITIES];
+    size_t maxBytes;
+    size_t usedBytes = 0;
+    size_t count = 0;
+    uint32_t dropped = 0;
+
+    // Read position in the spill file and its size, records before spillOffset are already back in RAM
+    size_t spillOffset = 0;
+    size_t spillBytes = 0;
+    bool spillPending() const { return spillOffset < spillBytes; }
+
+    void add(Entry &&entry, bool atFront);
+
+    /// Give up on an entry, into the spill file if there is one. @return true if it was spilled.
+    bool discard(Entry &&entry);
+
+    bool spill(const Entry &entry);
+
+    /// Move spilled messages back into RAM while they fit
+    void refill();
+};
@@ -8,6 +8,9 @@ class ESP32CryptoEngine : public CryptoEngine
 
     mbedtls_aes_context aes;
 
+    /// The key currently expanded into aes, so consecutive packets on the same channel skip mbedtls_aes_setkey_enc
+    CryptoKey aesKey = {{0}, -1};
+
   public:
     ESP32CryptoEngine() { mbedtls_aes_init(&aes); }
 
@@ -23,7 +26,10 @@ class ESP32CryptoEngine : public CryptoEngine
     {
         if (_key.length > 0) {
             if (numBytes <= MAX_BLOCKSIZE) {
-                mbedtls_aes_setkey_enc(&aes, _key.bytes, _key.length * 8);
+                if (aesKey.length != _key.length || memcmp(aesKey.bytes, _key.bytes, _key.length) != 0) {
+                    mbedtls_aes_setkey_enc(&aes, _key.bytes, _key.length * 8);
+                    aesKey = _key;
+                }
                 static uint8_t scratch[MAX_BLOCKSIZE];
                 uint8_t stream_block[16];
                 size_t nc_off = 0;
@@ -4,6 +4,10 @@
 #include <Adafruit_nRFCrypto.h>
 class NRF52CryptoEngine : public CryptoEngine
 {
+    /// Software AES256 context and the key expanded into it, so consecutive packets on the same channel skip the key schedule
+    AES_ctx aes256 = {};
+    CryptoKey aes256Key = {{0}, -1};
+
   public:
     NRF52CryptoEngine() {}
 
@@ -12,9 +16,12 @@ class NRF52CryptoEngine : public CryptoEngine
     virtual void encryptAESCtr(CryptoKey _key, uint8_t *_nonce, size_t numBytes, uint8_t *bytes) override
     {
         if (_key.length > 16) {
-            AES_ctx ctx;
-            AES_init_ctx_iv(&ctx, _key.bytes, _nonce);
-            AES_CTR_xcrypt_buffer(&ctx, bytes, numBytes);
+            if (aes256Key.length != _key.length || memcmp(aes256Key.bytes, _key.bytes, _key.length) != 0) {
+                AES_init_ctx(&aes256, _key.bytes);
+                aes256Key = _key;
+            }
+            AES_ctx_set_iv(&aes256, _nonce);
+            AES_CTR_xcrypt_buffer(&aes256, bytes, numBytes);
         } else if (_key.length > 0) {
             nRFCrypto.begin();
             nRFCrypto_AES ctx;
@@ -0,0 +1,444 @@
+#include "MeshSimulator.h"
+#include "NextHopRouter.h"
+#include "RadioInterface.h"
+#include <algorithm>
+#include <math.h>
+#include <stdio.h>
+
+// A frame survives an overlapping one if it is this much stronger
+static const float CAPTURE_DB = 6;
+
+// Encrypted payload of a routing ACK
+static const uint8_t ACK_PAYLOAD_LEN = 12;
+
+// Channel utilization periods, as in AirTime
+static const uint32_t UTIL_PERIOD_MSEC = 10000;
+static const uint32_t UTIL_PERIODS = 6;
+
+MeshSimulator::MeshSimulator(uint32_t seed) : MeshSimulator(seed, Modem()) {}
+
+MeshSimulator::MeshSimulator(uint32_t seed, const Modem &modem) : modem(modem), rng(seed)
+{
+    slotTimeMsec = RadioInterface::computeSlotTimeMsec(modem.bw, modem.sf, false);
+    // Demodulation floor of the spreading factor
+    sensitivitySnr = -7.5f - 2.5f * (modem.sf - 7);
+}
+
+uint32_t MeshSimulator::getAirtimeMsec(uint8_t payloadLen) const
+{
+    uint32_t pl = payloadLen + MESHTASTIC_HEADER_LENGTH;
+    float bandwidthHz = modem.bw * 1000.0f;
+    float tSym = (1 << modem.sf) / bandwidthHz;
+    bool lowDataOptEn = tSym > 16e-3;
+    float tPreamble = (modem.preambleLength + 4.25f) * tSym;
+    float numPayloadSym =
+        8 + std::max(ceilf(((8.0f * pl - 4 * modem.sf + 28 + 16) / (4 * (modem.sf - 2 * lowDataOptEn))) * modem.cr), 0.0f);
+    return (tPreamble + numPayloadSym * tSym) * 1000;
+}
+
+size_t MeshSimulator::addNode(bool isRouter)
+{
+    Node node;
+    node.isRouter = isRouter;
+    // Random node numbers like real devices, so relay ids (their last byte) clash as often as they do on a real mesh
+    bool unique;
+    do {
+        node.num = rng();
+        unique = node.num != 0 && node.num != NODENUM_BROADCAST;
+        for (auto &other : nodes)
+            unique = unique && other.num != node.num;
+    } while (!unique);
+    nodes.push_back(std::move(node));
+    return nodes.size() - 1;
+}
+
+void MeshSimulator::setLink(size_t a, size_t b, float snr)
+{
+    if (a == b || snr < sensitivitySnr)
+        return;
+    nodes[a].links.push_back({b, snr});
+    nodes[b].links.push_back({a, snr});
+}
+
+void MeshSimulator::addRandomNodes(size_t count, float sideKm, float routerFraction)
+{
+    const float txPowerDbm = 20, pathLossAt1KmDb = 128, pathLossExponent = 3.5, noiseFigureDb = 6;
+    const float noiseFloorDbm = -174 + 10 * log10f(modem.bw * 1000) + noiseFigureDb;
+
+    size_t first = nodes.size();
+    std::vector<std::pair<float, float>> positions;
+    for (size_t i = 0; i < count; i++) {
+        addNode(rng() < routerFraction * rng.max());
+        float x = (float)rng() / rng.max() * sideKm;
+        float y = (float)rng() / rng.max() * sideKm;
+        positions.push_back({x, y});
+    }
+    for (size_t i = 0; i < count; i++) {
+        for (size_t j = i + 1; j < count; j++) {
+            float dx = positions[i].first - positions[j].first, dy = positions[i].second - positions[j].second;
+            float km = std::max(sqrtf(dx * dx + dy * dy), 0.01f);
+            float pathLoss = pathLossAt1KmDb + 10 * pathLossExponent * log10f(km);
+            setLink(first + i, first + j, txPowerDbm - pathLoss - noiseFloorDbm);
+        }
+    }
+}
+
+void MeshSimulator::schedule(uint32_t atMsec, EventType type, uint32_t node, uint32_t arg)
+{
+    events.push({atMsec, nextSeq++, type, node, arg});
+}
+
+void MeshSimulator::sendPacket(uint32_t atMsec, size_t from, NodeNum to, uint8_t hopLimit, uint8_t payloadLen)
+{
+    Frame frame = {};
+    frame.from = nodes[from].num;
+    frame.to = to;
+    frame.id = nextId++;
+    frame.hopLimit = hopLimit;
+    frame.payloadLen = payloadLen;
+    pendingSends.push_back(frame);
+    schedule(atMsec, EVENT_SEND, from, pendingSends.size() - 1);
+}
+
+void MeshSimulator::run(uint32_t untilMsec)
+{
+    while (!events.empty() && events.top().atMsec <= untilMsec) {
+        Event event = events.top();
+        events.pop();
+        nowMsec = event.atMsec;
+        switch (event.type) {
+        case EVENT_SEND:
+            originate(event.node, pendingSends[event.arg]);
+            break;
+        case EVENT_TX_TIMER:
+            onTransmitTimer(event.node, event.arg);
+            break;
+        case EVENT_TX_END:
+            endTransmission(event.node, event.arg);
+            break;
+        case EVENT_RX_END:
+            endReception(event.node, event.arg);
+            break;
+        }
+    }
+}
+
+void MeshSimulator::originate(uint32_t node, Frame frame)
+{
+    Node &n = nodes[node];
+    uint8_t ourRelayId = relayId(n.num);
+    frame.hopStart = frame.hopLimit;
+    frame.relayNode = ourRelayId;
+    frame.createdMsec = nowMsec;
+    frame.nextHop = 0;
+    auto hop = n.nextHop.find(frame.to);
+    if (frame.to != NODENUM_BROADCAST && hop != n.nextHop.end())
+        frame.nextHop = hop->second;
+    n.seen[key(frame.from, frame.id)].relayers.insert(ourRelayId);
+
+    if (frame.requestId) {
+        stats.acksSent++;
+    } else {
+        stats.packetsSent++;
+        Wanted &w = wanted[key(frame.from, frame.id)];
+        w.createdMsec = nowMsec;
+        if (frame.to == NODENUM_BROADCAST) {
+            for (auto &other : nodes) {
+                if (other.num != n.num)
+                    w.pending.insert(other.num);
+            }
+        } else {
+            w.pending.insert(frame.to);
+        }
+        stats.wanted += w.pending.size();
+    }
+    enqueue(node, frame, false, 0);
+}
+
+void MeshSimulator::enqueue(uint32_t node, const Frame &frame, bool relayed, float rxSnr)
+{
+    Node &n = nodes[node];
+    n.txQueue.push_back({frame, relayed, rxSnr, false});
+    if (!n.timerPending && !n.transmitting)
+        startTransmitTimer(node);
+}
+
+uint32_t MeshSimulator::getTxDelayMsec(uint32_t node)
+{
+    Node &n = nodes[node];
+    Queued &q = n.txQueue.front();
+    // RadioInterface::getTxDelayMsec() for our own packets, getTxDelayMsecWeighted() for rebroadcasts
+    if (!q.relayed)
+        return randomInt(0, 1 << RadioInterface::getCWsizeForUtil(channelUtilizationPercent(node))) * slotTimeMsec;
+    uint8_t snrCWsize = RadioInterface::getCWsize(q.rxSnr);
+    uint8_t CWsize = snrCWsize;
+    if (adaptiveCW && CWsize < RadioInterface::CWmax) {
+        // The history holds us and the node we heard it from before anyone else
+        uint8_t others = 0;
+        auto seen = n.seen.find(key(q.frame.from, q.frame.id));
+        if (seen != n.seen.end())
+            others = seen->second.relayers.size() - seen->second.relayers.count(relayId(n.num));
+        uint8_t steps = RadioInterface::getCongestionCWsteps(channelUtilizationPercent(node), others);
+        CWsize = RadioInterface::widenCWsize(CWsize, steps);
+    }
+    // A busy channel picks the window again, count each rebroadcast once
+    if (!q.counted) {
+        q.counted = true;
+        stats.rebroadcastCWCount++;
+        stats.rebroadcastCWSum += CWsize;
+        if (CWsize > snrCWsize)
+            stats.rebroadcastCWWidened++;
+    }
+    return (RadioInterface::getRebroadcastOffsetSlots(n.isRouter) +
+            randomInt(0, RadioInterface::getRebroadcastWindowSlots(CWsize, n.isRouter))) *
+           slotTimeMsec;
+}
+
+void MeshSimulator::startTransmitTimer(uint32_t node)
+{
+    Node &n = nodes[node];
+    if (n.txQueue.empty())
+        return;
+    n.timerPending = true;
+    schedule(nowMsec + getTxDelayMsec(node), EVENT_TX_TIMER, node, ++n.timerGeneration);
+}
+
+void MeshSimulator::onTransmitTimer(uint32_t node, uint32_t generation)
+{
+    Node &n = nodes[node];
+    if (generation != n.timerGeneration)
+        return; // Replaced by a later timer
+    n.timerPending = false;
+    if (n.transmitting || n.txQueue.empty())
+        return;
+    // Something on the channel (SimRadio::isChannelActive()), wait again. Channel activity detection needs a slot time to
+    // notice a transmission, so nodes which start within a slot of each other collide.
+    bool channelActive = std::any_of(n.receiving.begin(), n.receiving.end(),
+                                     [this](const Reception &r) { return nowMsec - r.startMsec >= slotTimeMsec; });
+    if (channelActive)
+        startTransmitTimer(node);
+    else
+        startTransmission(node);
+}
+
+/// Mark a frame at a receiver as lost, counting it once
+static void lose(bool &lost, uint32_t &counter)
+{
+    if (!lost)
+        counter++;
+    lost = true;
+}
+
+void MeshSimulator::startTransmission(uint32_t node)
+{
+    Node &n = nodes[node];
+    Frame frame = n.txQueue.front().frame;
+    n.txQueue.pop_front();
+    n.transmitting = true;
+
+    uint32_t t = transmissions.size();
+    transmissions.push_back({node, frame});
+    uint32_t airtime = getAirtimeMsec(frame.payloadLen);
+    stats.transmissions++;
+    stats.airtimeMsec += airtime;
+    schedule(nowMsec + airtime, EVENT_TX_END, node, t);
+
+    // Half duplex, anything we were in the middle of receiving is gone
+    for (auto &r : n.receiving)
+        lose(r.lost, stats.halfDuplexLost);
+
+    for (auto &link : n.links) {
+        Node &neighbour = nodes[link.first];
+        if (neighbour.transmitting) {
+            stats.halfDuplexLost++;
+            continue;
+        }
+        Reception incoming = {t, nowMsec, link.second, false};
+        for (auto &r : neighbour.receiving) {
+            if (incoming.snr < r.snr + CAPTURE_DB)
+                lose(incoming.lost, stats.collisions);
+            if (r.snr < incoming.snr + CAPTURE_DB)
+                lose(r.lost, stats.collisions);
+        }
+        neighbour.receiving.push_back(incoming);
+        schedule(nowMsec + airtime, EVENT_RX_END, link.first, t);
+    }
+}
+
+void MeshSimulator::addBusy(uint32_t node, uint32_t msec)
+{
+    Node &n = nodes[node];
+    uint32_t period = nowMsec / UTIL_PERIOD_MSEC;
+    uint32_t slot = period % UTIL_PERIODS;
+    if (n.busyPeriod[slot] != period) {
+        n.busyPeriod[slot] = period;
+        n.busyMsec[slot] = 0;
+    }
+    n.busyMsec[slot] += msec;
+}
+
+float MeshSimulator::channelUtilizationPercent(size_t node) const
+{
+    const Node &n = nodes[node];
+    uint32_t period = nowMsec / UTIL_PERIOD_MSEC;
+    uint32_t busy = 0;
+    for (uint32_t slot = 0; slot < UTIL_PERIODS; slot++) {
+        if (n.busyPeriod[slot] + UTIL_PERIODS > period)
+            busy += n.busyMsec[slot];
+    }
+    return busy * 100.0f / (UTIL_PERIOD_MSEC * UTIL_PERIODS);
+}
+
+void MeshSimulator::endTransmission(uint32_t node, uint32_t transmission)
+{
+    Node &n = nodes[node];
+    n.transmitting = false;
+    addBusy(node, getAirtimeMsec(transmissions[transmission].frame.payloadLen));
+    if (!n.timerPending)
+        startTransmitTimer(node);
+}
+
+void MeshSimulator::endReception(uint32_t node, uint32_t transmission)
+{
+    Node &n = nodes[node];
+    auto r = std::find_if(n.receiving.begin(), n.receiving.end(),
+                          [transmission](const Reception &r) { return r.transmission == transmission; });
+    if (r == n.receiving.end())
+        return;
+    Reception reception = *r;
+    n.receiving.erase(r);
+    addBusy(node, nowMsec - reception.startMsec);
+    if (reception.lost)
+        return;
+    stats.receptions++;
+    handleReceived(node, transmissions[transmission].frame, reception.snr);
+}
+
+bool MeshSimulator::cancelQueued(uint32_t node, NodeNum from, PacketId id)
+{
+    auto &queue = nodes[node].txQueue;
+    for (auto q = queue.begin(); q != queue.end(); ++q) {
+        if (q->frame.from == from && q->frame.id == id) {
+            queue.erase(q);
+            return true;
+        }
+    }
+    return false;
+}
+
+void MeshSimulator::handleReceived(uint32_t node, const Frame &frame, float snr)
+{
+    Node &n = nodes[node];
+    uint8_t ourRelayId = relayId(n.num);
+    auto seenBefore = n.seen.find(key(frame.from, frame.id));
+    bool dupe = seenBefore != n.seen.end();
+    n.seen[key(frame.from, frame.id)].relayers.insert(frame.relayNode);
+
+    if (dupe) {
+        // Someone else relayed it, no need for us to (unless we are a router, or were asked to relay it)
+        if (!n.isRouter && frame.nextHop != ourRelayId && cancelQueued(node, frame.from, frame.id))
+            stats.relaysCanceled++;
+        return;
+    }
+
+    if (frame.requestId) {
+        // An ACK: if it came back through a node which also relayed the message, that node is the way to its destination
+        auto message = n.seen.find(key(frame.to, frame.requestId));
+        if (message != n.seen.end()) {
+            const auto &relayers = message->second.relayers;
+            bool weWereRelayer = relayers.count(ourRelayId);
+            bool weWereSoleRelayer = weWereRelayer && relayers.size() == 1;
+            bool direct = frame.hopStart == frame.hopLimit;
+            if (NextHopRouter::learnsNextHop(weWereRelayer, relayers.count(frame.relayNode), weWereSoleRelayer, direct))
+                n.nextHop[frame.from] = frame.relayNode;
+        }
+        if (frame.to != n.num)
+            cancelQueued(node, frame.to, frame.requestId); // No need to keep flooding the message
+    } else {
+        auto w = wanted.find(key(frame.from, frame.id));
+        if (w != wanted.end() && w->second.pending.erase(n.num)) {
+            uint32_t latency = nowMsec - w->second.createdMsec;
+            stats.delivered++;
+            stats.latencyMsecTotal += latency;
+            stats.latencyMsecMax = std::max(stats.latencyMsecMax, latency);
+        }
+    }
+
+    if (frame.to == n.num) {
+        if (!frame.requestId) {
+            Frame ack = {};
+            ack.from = n.num;
+            ack.to = frame.from;
+            ack.id = nextId++;
+            ack.requestId = frame.id;
+            ack.hopLimit = frame.hopStart;
+            ack.payloadLen = ACK_PAYLOAD_LEN;
+            originate(node, ack);
+        }
+        return;
+    }
+
+    // NextHopRouter::perhapsRebroadcast()
+    if (frame.hopLimit == 0 || frame.from == n.num || !NextHopRouter::mayRelay(frame.nextHop, ourRelayId))
+        return;
+    Frame relay = frame;
+    relay.hopLimit--;
+    relay.relayNode = ourRelayId;
+    if (frame.nextHop) {
+        auto hop = n.nextHop.find(frame.to);
+        relay.nextHop = hop != n.nextHop.end() && hop->second != frame.relayNode ? hop->second : 0;
+    }
+    n.seen[key(frame.from, frame.id)].relayers.insert(ourRelayId);
+    enqueue(node, relay, true, snr);
+}
+
+void MeshSimulator::printReport() const
+{
+    size_t routers = 0, links = 0;
+    for (auto &n : nodes) {
+        routers += n.isRouter;
+        links += n.links.size();
+    }
+    printf("Nodes: %u (%u routers), %.1f neighbours on average\n", (unsigned)nodes.size(), (unsigned)routers,
+           nodes.empty() ? 0.0 : (double)links / nodes.size());
+    printf("Packets sent: %u, ACKs: %u\n", stats.packetsSent, stats.acksSent);
+    printf("Transmissions: %u (%.1f per packet), relays canceled: %u\n", stats.transmissions, stats.transmissionsPerPacket(),
+           stats.relaysCanceled);
+    printf("Receptions: %u, lost to collisions: %u, lost while transmitting: %u\n", stats.receptions, stats.collisions,
+           stats.halfDuplexLost);
+    printf("Delivered: %u of %u (%.1f%%)\n", stats.delivered, stats.wanted, 100.0 * stats.deliveryRatio());
+    printf("Latency: average %u ms, max %u ms\n", stats.delivered ? (unsigned)(stats.latencyMsecTotal / stats.delivered) : 0,
+           stats.latencyMsecMax);
+    printf("Airtime: %.1f s over %.1f s of simulated time\n", stats.airtimeMsec / 1000.0, nowMsec / 1000.0);
+    if (stats.rebroadcastCWCount)
+        printf("Rebroadcast contention window: average %.2f, widened for congestion %u of %u times\n",
+               (double)stats.rebroadcastCWSum / stats.rebroadcastCWCount, stats.rebroadcastCWWidened, stats.rebroadcastCWCount);
+}
+
+void MeshSimulator::runBenchmark(size_t numNodes, uint32_t seed)
+{
+    const uint32_t durationMsec = 60 * 60 * 1000;
+
+    // The same mesh and traffic, with fixed and with congestion adaptive contention windows
+    for (bool adaptive : {false, true}) {
+        MeshSimulator sim(seed);
+        sim.setAdaptiveContentionWindow(adaptive);
+
+        // About 2km^2 per node, with a router for every 10 nodes
+        sim.addRandomNodes(numNodes, sqrtf(2.0f * numNodes), 0.1f);
+
+        // Every node broadcasts twice and sends one direct message during the hour
+        for (size_t i = 0; i < numNodes; i++) {
+            sim.sendPacket(sim.randomInt(0, durationMsec), i, NODENUM_BROADCAST);
+            sim.sendPacket(sim.randomInt(0, durationMsec), i, NODENUM_BROADCAST);
+            if (numNodes > 1) {
+                size_t to = (i + 1 + sim.randomInt(0, numNodes - 1)) % numNodes;
+                sim.sendPacket(sim.randomInt(0, durationMsec), i, sim.getNodeNum(to));
+            }
+        }
+        sim.run();
+        printf("%s contention window:\n", adaptive ? "Adaptive" : "Fixed");
+        sim.printReport();
+        printf("\n");
+    }
+}
@@ -0,0 +1,205 @@
+#pragma once
+
+#include "MeshTypes.h"
+#include <deque>
+#include <map>
+#include <queue>
+#include <random>
+#include <set>
+#include <stdint.h>
+#include <vector>
+
+/**
+ * A deterministic discrete-event simulation of many nodes sharing one LoRa channel, driven by a virtual clock.
+ *
+ * Router, NodeDB and the radio are singletons in the firmware, so rather than running many copies of them in one process each
+ * simulated node keeps its own state and applies the rules which decide what goes on air, through the static helpers of
+ * RadioInterface and NextHopRouter:
+ * - duplicate detection, hop limits, and dropping a queued rebroadcast when another node is heard relaying it (FloodingRouter)
+ * - ACKs for direct messages, learning a next hop from the ACK path and only letting that node relay (NextHopRouter)
+ * - the SNR weighted contention window, slot time and airtime of RadioInterface/SimRadio for the modem settings, optionally
+ *   widened for channel utilization and relays already heard
+ * - collisions: a transmission can only be detected a slot time after it starts, a node can not hear while it transmits, and
+ *   overlapping frames are lost unless one is strong enough to capture the receiver
+ *
+ * The same seed, topology and traffic always give the same results, so runs can be compared.
+ */
+class MeshSimulator
+{
+  public:
+    /// Defaults are LongFast
+    struct Modem {
+        float bw = 250;
+        uint8_t sf = 11;
+        uint8_t cr = 5;
+        uint16_t preambleLength = 16;
+    };
+
+    struct Stats {
+        uint32_t packetsSent = 0;    // originated by nodes, not counting ACKs
+        uint32_t acksSent = 0;       // ACKs for direct messages
+        uint32_t transmissions = 0;  // everything which went on air, originals and relays
+        uint32_t relaysCanceled = 0; // queued rebroadcasts dropped after hearing another node relay the packet
+        uint32_t receptions = 0;     // frames received without errors, including duplicates
+        uint32_t collisions = 0;     // frames lost to another frame at a receiver
+        uint32_t halfDuplexLost = 0; // frames missed because the receiver was transmitting
+        uint32_t wanted = 0;         // (packet, node) pairs which should get through
+        uint32_t delivered = 0;      // of those, how many did
+        uint64_t airtimeMsec = 0;
+        uint64_t latencyMsecTotal = 0; // over delivered pairs
+        uint32_t latencyMsecMax = 0;
+        uint32_t rebroadcastCWCount = 0, rebroadcastCWSum = 0, rebroadcastCWWidened = 0; // as in RadioInterface
+
+        float deliveryRatio() const { return wanted ? (float)delivered / wanted : 0; }
+        float transmissionsPerPacket() const { return packetsSent ? (float)transmissions / packetsSent : 0; }
+    };
+
+    explicit MeshSimulator(uint32_t seed = 1);
+    MeshSimulator(uint32_t seed, const Modem &modem);
+
+    /// Add a node, which can hear nothing until links are added. @return its index.
+    size_t addNode(bool isRouter = false);
+
+    size_t numNodes() const { return nodes.size(); }
+
+    NodeNum getNodeNum(size_t node) const { return nodes[node].num; }
+
+    /// Let two nodes hear each other at the given SNR. Links below the sensitivity of the modem are ignored.
+    void setLink(size_t a, size_t b, float snr);
+
+    /**
+     * Scatter nodes at random over a square and link them with a log-distance path loss model (20dBm, 128dB at 1km,
+     * exponent 3.5, 6dB noise figure). A fraction of them are routers.
+     */
+    void addRandomNodes(size_t count, float sideKm, float routerFraction = 0);
+
+    /// Have a node send a packet at a virtual time. A direct message (to is not NODENUM_BROADCAST) asks for an ACK.
+    void sendPacket(uint32_t atMsec, size_t from, NodeNum to, uint8_t hopLimit = 3, uint8_t payloadLen = 40);
+
+    /// Widen rebroadcast contention windows for congestion, as RadioInterface::getCongestionCWsteps() does. On by default.
+    void setAdaptiveContentionWindow(bool enabled) { adaptiveCW = enabled; }
+
+    /// Process events until there are none left or the next one is after untilMsec
+    void run(uint32_t untilMsec = UINT32_MAX);
+
+    uint32_t now() const { return nowMsec; }
+
+    const Stats &getStats() const { return stats; }
+
+    /// Airtime of a frame with this payload (not counting the packet header), the same formula as SimRadio::getPacketTime()
+    uint32_t getAirtimeMsec(uint8_t payloadLen) const;
+
+    uint32_t getSlotTimeMsec() const { return slotTimeMsec; }
+
+    void printReport() const;
+
+    /// Run traffic over a random mesh of the given size and print the results, for --sim-mesh
+    static void runBenchmark(size_t numNodes, uint32_t seed = 1);
+
+    /// Channel utilization a node measures over the last minute, like AirTime::channelUtilizationPercent()
+    float channelUtilizationPercent(size_t node) const;
+
+  private:
+    struct Frame {
+        NodeNum from;
+        NodeNum to;
+        PacketId id;
+        PacketId requestId; // for ACKs, the id of the direct message
+        uint8_t hopLimit;
+        uint8_t hopStart;
+        uint8_t relayNode;
+        uint8_t nextHop;
+        uint8_t payloadLen;
+        uint32_t createdMsec;
+    };
+
+    struct Queued {
+        Frame frame;
+        bool relayed; // waits in the SNR weighted contention window
+        float rxSnr;
+        bool counted; // its window is in the rebroadcast stats
+    };
+
+    struct Reception {
+        uint32_t transmission;
+        uint32_t startMsec;
+        float snr;
+        bool lost;
+    };
+
+    /// What a node remembers about a packet it has seen
+    struct Seen {
+        std::set<uint8_t> relayers; // relay ids heard sending it, including ours if we sent it
+    };
+
+    struct Node {
+        NodeNum num;
+        bool isRouter;
+        std::vector<std::pair<size_t, float>> links; // neighbour index and SNR
+        std::deque<Queued> txQueue;
+        bool transmitting = false;
+        uint32_t timerGeneration = 0;
+        bool timerPending = false;
+        std::vector<Reception> receiving;
+        std::map<uint64_t, Seen> seen; // by from << 32 | id
+        std::map<NodeNum, uint8_t> nextHop;
+        // Milliseconds of transmitting or receiving in each 10s period of the last minute, and which period each one is
+        uint32_t busyMsec[6] = {};
+        uint32_t busyPeriod[6] = {};
+    };
+
+    enum EventType : uint8_t { EVENT_SEND, EVENT_TX_TIMER, EVENT_TX_END, EVENT_RX_END };
+
+    struct Event {
+        uint32_t atMsec;
+        uint64_t seq; // ties are handled in the order events were scheduled
+        EventType type;
+        uint32_t node;
+        uint32_t arg; // send: index into pendingSends, timer: generation, tx/rx end: transmission
+        bool operator>(const Event &o) const { return atMsec != o.atMsec ? atMsec > o.atMsec : seq > o.seq; }
+    };
+
+    struct Transmission {
+        uint32_t sender;
+        Frame frame;
+    };
+
+    struct Wanted {
+        uint32_t createdMsec;
+        std::set<NodeNum> pending; // nodes which should still get the packet
+    };
+
+    Modem modem;
+    bool adaptiveCW = true;
+    uint32_t slotTimeMsec;
+    float sensitivitySnr;
+    std::mt19937 rng;
+    uint32_t nowMsec = 0;
+    uint64_t nextSeq = 0;
+    PacketId nextId = 1;
+    std::priority_queue<Event, std::vector<Event>, std::greater<Event>> events;
+    std::vector<Node> nodes;
+    std::vector<Frame> pendingSends;
+    std::vector<Transmission> transmissions;
+    std::map<uint64_t, Wanted> wanted;
+    Stats stats;
+
+    static uint64_t key(NodeNum from, PacketId id) { return ((uint64_t)from << 32) | id; }
+    static uint8_t relayId(NodeNum num) { return (num & 0xff) ? (num & 0xff) : 0xff; }
+
+    uint32_t randomInt(uint32_t min, uint32_t max) { return max > min ? min + rng() % (max - min) : min; }
+
+    void schedule(uint32_t atMsec, EventType type, uint32_t node, uint32_t arg);
+
+    void originate(uint32_t node, Frame frame);
+    void enqueue(uint32_t node, const Frame &frame, bool relayed, float rxSnr);
+    uint32_t getTxDelayMsec(uint32_t node);
+    void startTransmitTimer(uint32_t node);
+    void onTransmitTimer(uint32_t node, uint32_t generation);
+    void startTransmission(uint32_t node);
+    void endTransmission(uint32_t node, uint32_t transmission);
+    void addBusy(uint32_t node, uint32_t msec);
+    void endReception(uint32_t node, uint32_t transmission);
+    void handleReceived(uint32_t node, const Frame &frame, float snr);
+    bool cancelQueued(uint32_t node, NodeNum from, PacketId id);
+};
@@ -5,6 +5,7 @@
 #include "sleep.h"
 #include "target_specific.h"
 
+#include "MeshSimulator.h"
 #include "PortduinoGlue.h"
 #include "SHA256.h"
 #include "api/ServerAPI.h"
@@ -39,6 +40,7 @@ char *configPath = nullptr;
 char *optionMac = nullptr;
 bool verboseEnabled = false;
 bool yamlOnly = false;
+size_t simMeshNodes = 0;
 
 const char *argp_program_version = optstr(APP_VERSION);
 
@@ -86,6 +88,10 @@ static error_t parse_opt(int key, char *arg, struct argp_state *state)
     case 'y':
         yamlOnly = true;
         break;
+    case 'm':
+        if (sscanf(arg, "%zu", &simMeshNodes) < 1 || simMeshNodes == 0)
+            return ARGP_ERR_UNKNOWN;
+        break;
     case ARGP_KEY_ARG:
         return 0;
     default:
@@ -102,6 +108,7 @@ void portduinoCustomInit()
                                            {"sim", 's', 0, 0, "Run in Simulated radio mode"},
                                            {"verbose", 'v', 0, 0, "Set log level to full debug"},
                                            {"output-yaml", 'y', 0, 0, "Output config yaml and exit"},
+                                           {"sim-mesh", 'm', "NODES", 0, "Simulate a mesh of NODES nodes and exit"},
                                            {0}};
     static void *childArguments;
     static char doc[] = "Meshtastic native build.";
@@ -181,6 +188,11 @@ void portduinoSetup()
     // Force stdout to be line buffered
     setvbuf(stdout, stdoutBuffer, _IOLBF, sizeof(stdoutBuffer));
 
+    if (simMeshNodes > 0) {
+        MeshSimulator::runBenchmark(simMeshNodes);
+        exit(EXIT_SUCCESS);
+    }
+
     if (portduino_config.force_simradio == true) {
         portduino_config.lora_module = use_simradio;
     } else if (configPath != nullptr) {
@@ -985,7 +997,13 @@ bool loadConfig(const char *configPath)
 
         if (yamlConfig["General"]) {
             portduino_config.MaxNodes = (yamlConfig["General"]["MaxNodes"]).as<int>(200);
+            // NodeDB keeps its display order and NodeNum index as 16 bit positions
+            if (portduino_config.MaxNodes > UINT16_MAX - 1) {
+                std::cout << "MaxNodes " << portduino_config.MaxNodes << " is too large, using " << UINT16_MAX - 1 << std::endl;
+                portduino_config.MaxNodes = UINT16_MAX - 1;
+            }
             portduino_config.maxtophone = (yamlConfig["General"]["MaxMessageQueue"]).as<int>(100);
+            portduino_config.maxAPIClients = (yamlConfig["General"]["MaxAPIClients"]).as<int>(4);
             portduino_config.config_directory = (yamlConfig["General"]["ConfigDirectory"]).as<std::string>("");
             portduino_config.available_directory =
                 (yamlConfig["General"]["AvailableDirectory"]).as<std::string>("/etc/meshtasticd/available.d/");
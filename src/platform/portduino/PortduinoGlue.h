@@ -196,6 +196,7 @@ extern struct portduino_config_struct {
     std::string available_directory = "/etc/meshtasticd/available.d/";
     int maxtophone = 100;
     int MaxNodes = 200;
+    int maxAPIClients = 4;
 
     std::unordered_map<std::string, std::string> hat_plus_custom_fields;
 
@@ -566,6 +567,7 @@ extern struct portduino_config_struct {
             out << YAML::Key << "AvailableDirectory" << YAML::Value << available_directory;
         out << YAML::Key << "MaxMessageQueue" << YAML::Value << maxtophone;
         out << YAML::Key << "MaxNodes" << YAML::Value << MaxNodes;
+        out << YAML::Key << "MaxAPIClients" << YAML::Value << maxAPIClients;
         out << YAML::EndMap; // General
         return out.c_str();
     }
@@ -15,6 +15,10 @@
 #ifndef HAS_WIRE
 #define HAS_WIRE 1
 #endif
+// Not enough RAM to keep an expanded AES key for every channel
+#ifndef AES_KEY_CACHE_SIZE
+#define AES_KEY_CACHE_SIZE 1
+#endif
 
 //
 // set HW_VENDOR
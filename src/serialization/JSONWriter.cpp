@@ -0,0 +1,164 @@
+#include "JSONWriter.h"
+#include <math.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+JSONWriter::JSONWriter(char *buf, size_t size) : buf(buf), size(size)
+{
+    if (size)
+        buf[0] = '\0';
+    else
+        overflow = true;
+}
+
+void JSONWriter::beginObject()
+{
+    separator();
+    append('{');
+    needComma = false;
+}
+
+void JSONWriter::endObject()
+{
+    append('}');
+    needComma = true;
+}
+
+void JSONWriter::beginArray()
+{
+    separator();
+    append('[');
+    needComma = false;
+}
+
+void JSONWriter::endArray()
+{
+    append(']');
+    needComma = true;
+}
+
+void JSONWriter::key(const char *name)
+{
+    separator();
+    appendString(name);
+    append(':');
+    needComma = false;
+}
+
+void JSONWriter::value(const char *str)
+{
+    separator();
+    appendString(str);
+    needComma = true;
+}
+
+void JSONWriter::value(int v)
+{
+    separator();
+    appendNumber("%d", v);
+    needComma = true;
+}
+
+void JSONWriter::value(unsigned int v)
+{
+    separator();
+    appendNumber("%u", v);
+    needComma = true;
+}
+
+void JSONWriter::value(double v)
+{
+    separator();
+    // Same as the precision(15) stringstream JSONValue uses
+    if (isinf(v) || isnan(v))
+        append("null", 4);
+    else
+        appendNumber("%.15g", v);
+    needComma = true;
+}
+
+void JSONWriter::value(bool v)
+{
+    separator();
+    if (v)
+        append("true", 4);
+    else
+        append("false", 5);
+    needComma = true;
+}
+
+void JSONWriter::rawValue(const char *json)
+{
+    separator();
+    append(json, strlen(json));
+    needComma = true;
+}
+
+void JSONWriter::separator()
+{
+    if (needComma)
+        append(',');
+}
+
+void JSONWriter::append(char c)
+{
+    append(&c, 1);
+}
+
+void JSONWriter::append(const char *s, size_t n)
+{
+    if (overflow)
+        return;
+    if (len + n >= size) {
+        overflow = true;
+        return;
+    }
+    memcpy(buf + len, s, n);
+    len += n;
+    buf[len] = '\0';
+}
+
+void JSONWriter::appendNumber(const char *format, ...)
+{
+    if (overflow)
+        return;
+    va_list args;
+    va_start(args, format);
+    int n = vsnprintf(buf + len, size - len, format, args);
+    va_end(args);
+    if (n < 0 || (size_t)n >= size - len) {
+        overflow = true;
+        buf[len] = '\0';
+        return;
+    }
+    len += n;
+}
+
+/// Escapes like JSONValue::StringifyString, bytes of multi byte UTF-8 sequences are copied as they are
+void JSONWriter::appendString(const char *str)
+{
+    append('"');
+    for (const unsigned char *p = (const unsigned char *)str; *p && !overflow; p++) {
+        unsigned char chr = *p;
+        if (chr == '"' || chr == '\\' || chr == '/') {
+            char escaped[2] = {'\\', (char)chr};
+            append(escaped, 2);
+        } else if (chr == '\b') {
+            append("\\b", 2);
+        } else if (chr == '\f') {
+            append("\\f", 2);
+        } else if (chr == '\n') {
+            append("\\n", 2);
+        } else if (chr == '\r') {
+            append("\\r", 2);
+        } else if (chr == '\t') {
+            append("\\t", 2);
+        } else if (chr < 0x20 || chr == 0x7F) {
+            appendNumber("\\u%04x", chr);
+        } else {
+            append((char)chr);
+        }
+    }
+    append('"');
+}
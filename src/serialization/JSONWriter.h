@@ -0,0 +1,57 @@
+#pragma once
+
+#include <stddef.h>
+
+/**
+ * Writes compact JSON straight into a caller provided buffer, without building a JSONValue tree first.
+ *
+ * The writer takes care of quoting, escaping and commas. The caller emits keys in whatever order it wants and keeps
+ * begin/end calls balanced. Nothing is allocated: once the buffer is full the writer stops and overflowed() becomes
+ * true. The buffer is always left NUL terminated.
+ *
+ * Numbers are formatted the way JSONValue::Stringify formats them. Strings are escaped like it too, except that bytes of
+ * multi byte UTF-8 sequences are always copied as they are.
+ */
+class JSONWriter
+{
+  public:
+    JSONWriter(char *buf, size_t size);
+
+    void beginObject();
+    void endObject();
+    void beginArray();
+    void endArray();
+
+    /// Start a member of the current object, must be followed by exactly one value() or begin call
+    void key(const char *name);
+
+    void value(const char *str);
+    void value(int v);
+    void value(unsigned int v);
+    void value(double v);
+    void value(bool v);
+
+    /// Append text that is already serialized JSON as the next value
+    void rawValue(const char *json);
+
+    /// Number of characters written, not counting the NUL terminator
+    size_t length() const { return len; }
+
+    /// True if the output did not fit, the buffer then holds a truncated document
+    bool overflowed() const { return overflow; }
+
+  private:
+    char *buf;
+    size_t size;
+    size_t len = 0;
+    bool overflow = false;
+
+    /// The next value in the current object or array must be preceded by a comma
+    bool needComma = false;
+
+    void separator();
+    void append(char c);
+    void append(const char *s, size_t n);
+    void appendNumber(const char *format, ...);
+    void appendString(const char *str);
+};
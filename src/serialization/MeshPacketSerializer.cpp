@@ -1,6 +1,7 @@
 #ifndef NRF52_USE_JSON
 #include "MeshPacketSerializer.h"
 #include "JSON.h"
+#include "JSONWriter.h"
 #include "NodeDB.h"
 #include "mesh/generated/meshtastic/mqtt.pb.h"
 #include "mesh/generated/meshtastic/telemetry.pb.h"
@@ -15,430 +16,467 @@
 
 static const char *errStr = "Error decoding proto for %s message!";
 
-std::string MeshPacketSerializer::JsonSerialize(const meshtastic_MeshPacket *mp, bool shouldLog)
+/// Floats are written as doubles, so they print with 15 significant digits
+static void writeFloat(JSONWriter &w, const char *name, float v)
 {
-    // the created jsonObj is immutable after creation, so
-    // we need to do the heavy lifting before assembling it.
-    std::string msgType;
-    JSONObject jsonObj;
+    w.key(name);
+    w.value((double)v);
+}
 
-    if (mp->which_payload_variant == meshtastic_MeshPacket_decoded_tag) {
-        JSONObject msgPayload;
-        switch (mp->decoded.portnum) {
-        case meshtastic_PortNum_TEXT_MESSAGE_APP: {
-            msgType = "text";
-            // convert bytes to string
-            if (shouldLog)
-                LOG_DEBUG("got text message of size %u", mp->decoded.payload.size);
+static void writeUInt(JSONWriter &w, const char *name, uint32_t v)
+{
+    w.key(name);
+    w.value((unsigned int)v);
+}
+
+static void writeInt(JSONWriter &w, const char *name, int32_t v)
+{
+    w.key(name);
+    w.value((int)v);
+}
+
+static void writeTelemetryPayload(JSONWriter &w, const meshtastic_Telemetry *decoded)
+{
+    if (decoded->which_variant == meshtastic_Telemetry_device_metrics_tag) {
+        const meshtastic_DeviceMetrics &m = decoded->variant.device_metrics;
+        writeFloat(w, "air_util_tx", m.air_util_tx);
+        if (m.has_battery_level)
+            writeInt(w, "battery_level", m.battery_level);
+        writeFloat(w, "channel_utilization", m.channel_utilization);
+        writeUInt(w, "uptime_seconds", m.uptime_seconds);
+        writeFloat(w, "voltage", m.voltage);
+    } else if (decoded->which_variant == meshtastic_Telemetry_environment_metrics_tag) {
+        // Avoid sending 0s for sensors that could be 0
+        const meshtastic_EnvironmentMetrics &m = decoded->variant.environment_metrics;
+        if (m.has_barometric_pressure)
+            writeFloat(w, "barometric_pressure", m.barometric_pressure);
+        if (m.has_current)
+            writeFloat(w, "current", m.current);
+        if (m.has_distance)
+            writeFloat(w, "distance", m.distance);
+        if (m.has_gas_resistance)
+            writeFloat(w, "gas_resistance", m.gas_resistance);
+        if (m.has_iaq)
+            writeUInt(w, "iaq", m.iaq);
+        if (m.has_ir_lux)
+            writeFloat(w, "ir_lux", m.ir_lux);
+        if (m.has_lux)
+            writeFloat(w, "lux", m.lux);
+        if (m.has_radiation)
+            writeFloat(w, "radiation", m.radiation);
+        if (m.has_rainfall_1h)
+            writeFloat(w, "rainfall_1h", m.rainfall_1h);
+        if (m.has_rainfall_24h)
+            writeFloat(w, "rainfall_24h", m.rainfall_24h);
+        if (m.has_relative_humidity)
+            writeFloat(w, "relative_humidity", m.relative_humidity);
+        if (m.has_soil_moisture)
+            writeUInt(w, "soil_moisture", m.soil_moisture);
+        if (m.has_soil_temperature)
+            writeFloat(w, "soil_temperature", m.soil_temperature);
+        if (m.has_temperature)
+            writeFloat(w, "temperature", m.temperature);
+        if (m.has_uv_lux)
+            writeFloat(w, "uv_lux", m.uv_lux);
+        if (m.has_voltage)
+            writeFloat(w, "voltage", m.voltage);
+        if (m.has_weight)
+            writeFloat(w, "weight", m.weight);
+        if (m.has_white_lux)
+            writeFloat(w, "white_lux", m.white_lux);
+        if (m.has_wind_direction)
+            writeUInt(w, "wind_direction", m.wind_direction);
+        if (m.has_wind_gust)
+            writeFloat(w, "wind_gust", m.wind_gust);
+        if (m.has_wind_lull)
+            writeFloat(w, "wind_lull", m.wind_lull);
+        if (m.has_wind_speed)
+            writeFloat(w, "wind_speed", m.wind_speed);
+    } else if (decoded->which_variant == meshtastic_Telemetry_air_quality_metrics_tag) {
+        const meshtastic_AirQualityMetrics &m = decoded->variant.air_quality_metrics;
+        if (m.has_co2)
+            writeUInt(w, "co2", m.co2);
+        if (m.has_co2_humidity)
+            writeFloat(w, "co2_humidity", m.co2_humidity);
+        if (m.has_co2_temperature)
+            writeFloat(w, "co2_temperature", m.co2_temperature);
+        if (m.has_form_formaldehyde)
+            writeFloat(w, "form_formaldehyde", m.form_formaldehyde);
+        if (m.has_form_humidity)
+            writeFloat(w, "form_humidity", m.form_humidity);
+        if (m.has_form_temperature)
+            writeFloat(w, "form_temperature", m.form_temperature);
+        if (m.has_pm10_standard)
+            writeUInt(w, "pm10", m.pm10_standard);
+        if (m.has_pm100_standard)
+            writeUInt(w, "pm100", m.pm100_standard);
+        if (m.has_pm25_standard)
+            writeUInt(w, "pm25", m.pm25_standard);
+    } else if (decoded->which_variant == meshtastic_Telemetry_power_metrics_tag) {
+        const meshtastic_PowerMetrics &m = decoded->variant.power_metrics;
+        if (m.has_ch1_current)
+            writeFloat(w, "current_ch1", m.ch1_current);
+        if (m.has_ch2_current)
+            writeFloat(w, "current_ch2", m.ch2_current);
+        if (m.has_ch3_current)
+            writeFloat(w, "current_ch3", m.ch3_current);
+        if (m.has_ch1_voltage)
+            writeFloat(w, "voltage_ch1", m.ch1_voltage);
+        if (m.has_ch2_voltage)
+            writeFloat(w, "voltage_ch2", m.ch2_voltage);
+        if (m.has_ch3_voltage)
+            writeFloat(w, "voltage_ch3", m.ch3_voltage);
+    }
+}
+
+static void writePositionPayload(JSONWriter &w, const meshtastic_Position *decoded)
+{
+    // Upper case keys sort first, like they do in a JSONObject
+    if ((int)decoded->HDOP)
+        writeInt(w, "HDOP", decoded->HDOP);
+    if ((int)decoded->PDOP)
+        writeInt(w, "PDOP", decoded->PDOP);
+    if ((int)decoded->VDOP)
+        writeInt(w, "VDOP", decoded->VDOP);
+    if ((int)decoded->altitude)
+        writeInt(w, "altitude", decoded->altitude);
+    if ((int)decoded->ground_speed)
+        writeUInt(w, "ground_speed", decoded->ground_speed);
+    if (int(decoded->ground_track))
+        writeUInt(w, "ground_track", decoded->ground_track);
+    writeInt(w, "latitude_i", decoded->latitude_i);
+    writeInt(w, "longitude_i", decoded->longitude_i);
+    if ((int)decoded->precision_bits)
+        writeInt(w, "precision_bits", decoded->precision_bits);
+    if (int(decoded->sats_in_view))
+        writeUInt(w, "sats_in_view", decoded->sats_in_view);
+    if ((int)decoded->time)
+        writeUInt(w, "time", decoded->time);
+    if ((int)decoded->timestamp)
+        writeUInt(w, "timestamp", decoded->timestamp);
+}
+
+/// Write the long name of num, or "Unknown", as the next traceroute hop
+static void writeRouteHop(JSONWriter &w, NodeNum num)
+{
+    char long_name[40] = "Unknown";
+    meshtastic_NodeInfoLite *node = nodeDB->getMeshNode(num);
+    bool name_known = node ? node->has_user : false;
+    if (name_known)
+        memcpy(long_name, node->user.long_name, sizeof(long_name));
+    w.value(long_name);
+}
 
-            char payloadStr[(mp->decoded.payload.size) + 1];
-            memcpy(payloadStr, mp->decoded.payload.bytes, mp->decoded.payload.size);
-            payloadStr[mp->decoded.payload.size] = 0; // null terminated string
-            // check if this is a JSON payload
-            JSONValue *json_value = JSON::Parse(payloadStr);
-            if (json_value != NULL) {
-                if (shouldLog)
-                    LOG_INFO("text message payload is of type json");
+/**
+ * Decode the payload of mp and write it as the "payload" member, if we know how to.
+ *
+ * @return the message type for the "type" member
+ */
+static const char *writeJsonPayload(JSONWriter &w, const meshtastic_MeshPacket *mp, bool shouldLog)
+{
+    const char *msgType = "";
 
-                // if it is, then we can just use the json object
-                jsonObj["payload"] = json_value;
-            } else {
-                // if it isn't, then we need to create a json object
-                // with the string as the value
-                if (shouldLog)
-                    LOG_INFO("text message payload is of type plaintext");
+    switch (mp->decoded.portnum) {
+    case meshtastic_PortNum_TEXT_MESSAGE_APP: {
+        msgType = "text";
+        // convert bytes to string
+        if (shouldLog)
+            LOG_DEBUG("got text message of size %u", mp->decoded.payload.size);
 
-                msgPayload["text"] = new JSONValue(payloadStr);
-                jsonObj["payload"] = new JSONValue(msgPayload);
-            }
-            break;
+        char payloadStr[(mp->decoded.payload.size) + 1];
+        memcpy(payloadStr, mp->decoded.payload.bytes, mp->decoded.payload.size);
+        payloadStr[mp->decoded.payload.size] = 0; // null terminated string
+        // check if this is a JSON payload. Ordinary text fails on its first character, before anything is allocated
+        JSONValue *json_value = JSON::Parse(payloadStr);
+        w.key("payload");
+        if (json_value != NULL) {
+            if (shouldLog)
+                LOG_INFO("text message payload is of type json");
+            w.rawValue(json_value->Stringify().c_str());
+            delete json_value;
+        } else {
+            if (shouldLog)
+                LOG_INFO("text message payload is of type plaintext");
+            w.beginObject();
+            w.key("text");
+            w.value(payloadStr);
+            w.endObject();
         }
-        case meshtastic_PortNum_TELEMETRY_APP: {
-            msgType = "telemetry";
-            meshtastic_Telemetry scratch;
-            meshtastic_Telemetry *decoded = NULL;
-            memset(&scratch, 0, sizeof(scratch));
-            if (pb_decode_from_bytes(mp->decoded.payload.bytes, mp->decoded.payload.size, &meshtastic_Telemetry_msg, &scratch)) {
-                decoded = &scratch;
-                if (decoded->which_variant == meshtastic_Telemetry_device_metrics_tag) {
-                    // If battery is present, encode the battery level value
-                    // TODO - Add a condition to send a code for a non-present value
-                    if (decoded->variant.device_metrics.has_battery_level) {
-                        msgPayload["battery_level"] = new JSONValue((int)decoded->variant.device_metrics.battery_level);
-                    }
-                    msgPayload["voltage"] = new JSONValue(decoded->variant.device_metrics.voltage);
-                    msgPayload["channel_utilization"] = new JSONValue(decoded->variant.device_metrics.channel_utilization);
-                    msgPayload["air_util_tx"] = new JSONValue(decoded->variant.device_metrics.air_util_tx);
-                    msgPayload["uptime_seconds"] = new JSONValue((unsigned int)decoded->variant.device_metrics.uptime_seconds);
-                } else if (decoded->which_variant == meshtastic_Telemetry_environment_metrics_tag) {
-                    // Avoid sending 0s for sensors that could be 0
-                    if (decoded->variant.environment_metrics.has_temperature) {
-                        msgPayload["temperature"] = new JSONValue(decoded->variant.environment_metrics.temperature);
-                    }
-                    if (decoded->variant.environment_metrics.has_relative_humidity) {
-                        msgPayload["relative_humidity"] = new JSONValue(decoded->variant.environment_metrics.relative_humidity);
-                    }
-                    if (decoded->variant.environment_metrics.has_barometric_pressure) {
-                        msgPayload["barometric_pressure"] =
-                            new JSONValue(decoded->variant.environment_metrics.barometric_pressure);
-                    }
-                    if (decoded->variant.environment_metrics.has_gas_resistance) {
-                        msgPayload["gas_resistance"] = new JSONValue(decoded->variant.environment_metrics.gas_resistance);
-                    }
-                    if (decoded->variant.environment_metrics.has_voltage) {
-                        msgPayload["voltage"] = new JSONValue(decoded->variant.environment_metrics.voltage);
-                    }
-                    if (decoded->variant.environment_metrics.has_current) {
-                        msgPayload["current"] = new JSONValue(decoded->variant.environment_metrics.current);
-                    }
-                    if (decoded->variant.environment_metrics.has_lux) {
-                        msgPayload["lux"] = new JSONValue(decoded->variant.environment_metrics.lux);
-                    }
-                    if (decoded->variant.environment_metrics.has_white_lux) {
-                        msgPayload["white_lux"] = new JSONValue(decoded->variant.environment_metrics.white_lux);
-                    }
-                    if (decoded->variant.environment_metrics.has_iaq) {
-                        msgPayload["iaq"] = new JSONValue((uint)decoded->variant.environment_metrics.iaq);
-                    }
-                    if (decoded->variant.environment_metrics.has_distance) {
-                        msgPayload["distance"] = new JSONValue(decoded->variant.environment_metrics.distance);
-                    }
-                    if (decoded->variant.environment_metrics.has_wind_speed) {
-                        msgPayload["wind_speed"] = new JSONValue(decoded->variant.environment_metrics.wind_speed);
-                    }
-                    if (decoded->variant.environment_metrics.has_wind_direction) {
-                        msgPayload["wind_direction"] = new JSONValue((uint)decoded->variant.environment_metrics.wind_direction);
-                    }
-                    if (decoded->variant.environment_metrics.has_wind_gust) {
-                        msgPayload["wind_gust"] = new JSONValue(decoded->variant.environment_metrics.wind_gust);
-                    }
-                    if (decoded->variant.environment_metrics.has_wind_lull) {
-                        msgPayload["wind_lull"] = new JSONValue(decoded->variant.environment_metrics.wind_lull);
-                    }
-                    if (decoded->variant.environment_metrics.has_radiation) {
-                        msgPayload["radiation"] = new JSONValue(decoded->variant.environment_metrics.radiation);
-                    }
-                    if (decoded->variant.environment_metrics.has_ir_lux) {
-                        msgPayload["ir_lux"] = new JSONValue(decoded->variant.environment_metrics.ir_lux);
-                    }
-                    if (decoded->variant.environment_metrics.has_uv_lux) {
-                        msgPayload["uv_lux"] = new JSONValue(decoded->variant.environment_metrics.uv_lux);
-                    }
-                    if (decoded->variant.environment_metrics.has_weight) {
-                        msgPayload["weight"] = new JSONValue(decoded->variant.environment_metrics.weight);
-                    }
-                    if (decoded->variant.environment_metrics.has_rainfall_1h) {
-                        msgPayload["rainfall_1h"] = new JSONValue(decoded->variant.environment_metrics.rainfall_1h);
-                    }
-                    if (decoded->variant.environment_metrics.has_rainfall_24h) {
-                        msgPayload["rainfall_24h"] = new JSONValue(decoded->variant.environment_metrics.rainfall_24h);
-                    }
-                    if (decoded->variant.environment_metrics.has_soil_moisture) {
-                        msgPayload["soil_moisture"] = new JSONValue((uint)decoded->variant.environment_metrics.soil_moisture);
-                    }
-                    if (decoded->variant.environment_metrics.has_soil_temperature) {
-                        msgPayload["soil_temperature"] = new JSONValue(decoded->variant.environment_metrics.soil_temperature);
-                    }
-                } else if (decoded->which_variant == meshtastic_Telemetry_air_quality_metrics_tag) {
-                    if (decoded->variant.air_quality_metrics.has_pm10_standard) {
-                        msgPayload["pm10"] = new JSONValue((unsigned int)decoded->variant.air_quality_metrics.pm10_standard);
-                    }
-                    if (decoded->variant.air_quality_metrics.has_pm25_standard) {
-                        msgPayload["pm25"] = new JSONValue((unsigned int)decoded->variant.air_quality_metrics.pm25_standard);
-                    }
-                    if (decoded->variant.air_quality_metrics.has_pm100_standard) {
-                        msgPayload["pm100"] = new JSONValue((unsigned int)decoded->variant.air_quality_metrics.pm100_standard);
-                    }
-                    if (decoded->variant.air_quality_metrics.has_co2) {
-                        msgPayload["co2"] = new JSONValue((unsigned int)decoded->variant.air_quality_metrics.co2);
-                    }
-                    if (decoded->variant.air_quality_metrics.has_co2_temperature) {
-                        msgPayload["co2_temperature"] = new JSONValue(decoded->variant.air_quality_metrics.co2_temperature);
-                    }
-                    if (decoded->variant.air_quality_metrics.has_co2_humidity) {
-                        msgPayload["co2_humidity"] = new JSONValue(decoded->variant.air_quality_metrics.co2_humidity);
-                    }
-                    if (decoded->variant.air_quality_metrics.has_form_formaldehyde) {
-                        msgPayload["form_formaldehyde"] = new JSONValue(decoded->variant.air_quality_metrics.form_formaldehyde);
-                    }
-                    if (decoded->variant.air_quality_metrics.has_form_temperature) {
-                        msgPayload["form_temperature"] = new JSONValue(decoded->variant.air_quality_metrics.form_temperature);
-                    }
-                    if (decoded->variant.air_quality_metrics.has_form_humidity) {
-                        msgPayload["form_humidity"] = new JSONValue(decoded->variant.air_quality_metrics.form_humidity);
-                    }
-                } else if (decoded->which_variant == meshtastic_Telemetry_power_metrics_tag) {
-                    if (decoded->variant.power_metrics.has_ch1_voltage) {
-                        msgPayload["voltage_ch1"] = new JSONValue(decoded->variant.power_metrics.ch1_voltage);
-                    }
-                    if (decoded->variant.power_metrics.has_ch1_current) {
-                        msgPayload["current_ch1"] = new JSONValue(decoded->variant.power_metrics.ch1_current);
-                    }
-                    if (decoded->variant.power_metrics.has_ch2_voltage) {
-                        msgPayload["voltage_ch2"] = new JSONValue(decoded->variant.power_metrics.ch2_voltage);
-                    }
-                    if (decoded->variant.power_metrics.has_ch2_current) {
-                        msgPayload["current_ch2"] = new JSONValue(decoded->variant.power_metrics.ch2_current);
-                    }
-                    if (decoded->variant.power_metrics.has_ch3_voltage) {
-                        msgPayload["voltage_ch3"] = new JSONValue(decoded->variant.power_metrics.ch3_voltage);
-                    }
-                    if (decoded->variant.power_metrics.has_ch3_current) {
-                        msgPayload["current_ch3"] = new JSONValue(decoded->variant.power_metrics.ch3_current);
-                    }
-                }
-                jsonObj["payload"] = new JSONValue(msgPayload);
-            } else if (shouldLog) {
-                LOG_ERROR(errStr, msgType.c_str());
-            }
-            break;
+        break;
+    }
+    case meshtastic_PortNum_TELEMETRY_APP: {
+        msgType = "telemetry";
+        meshtastic_Telemetry scratch;
+        memset(&scratch, 0, sizeof(scratch));
+        if (pb_decode_from_bytes(mp->decoded.payload.bytes, mp->decoded.payload.size, &meshtastic_Telemetry_msg, &scratch)) {
+            w.key("payload");
+            w.beginObject();
+            writeTelemetryPayload(w, &scratch);
+            w.endObject();
+        } else if (shouldLog) {
+            LOG_ERROR(errStr, msgType);
         }
-        case meshtastic_PortNum_NODEINFO_APP: {
-            msgType = "nodeinfo";
-            meshtastic_User scratch;
-            meshtastic_User *decoded = NULL;
-            memset(&scratch, 0, sizeof(scratch));
-            if (pb_decode_from_bytes(mp->decoded.payload.bytes, mp->decoded.payload.size, &meshtastic_User_msg, &scratch)) {
-                decoded = &scratch;
-                msgPayload["id"] = new JSONValue(decoded->id);
-                msgPayload["longname"] = new JSONValue(decoded->long_name);
-                msgPayload["shortname"] = new JSONValue(decoded->short_name);
-                msgPayload["hardware"] = new JSONValue(decoded->hw_model);
-                msgPayload["role"] = new JSONValue((int)decoded->role);
-                jsonObj["payload"] = new JSONValue(msgPayload);
-            } else if (shouldLog) {
-                LOG_ERROR(errStr, msgType.c_str());
-            }
-            break;
+        break;
+    }
+    case meshtastic_PortNum_NODEINFO_APP: {
+        msgType = "nodeinfo";
+        meshtastic_User scratch;
+        memset(&scratch, 0, sizeof(scratch));
+        if (pb_decode_from_bytes(mp->decoded.payload.bytes, mp->decoded.payload.size, &meshtastic_User_msg, &scratch)) {
+            w.key("payload");
+            w.beginObject();
+            writeInt(w, "hardware", scratch.hw_model);
+            w.key("id");
+            w.value(scratch.id);
+            w.key("longname");
+            w.value(scratch.long_name);
+            writeInt(w, "role", scratch.role);
+            w.key("shortname");
+            w.value(scratch.short_name);
+            w.endObject();
+        } else if (shouldLog) {
+            LOG_ERROR(errStr, msgType);
         }
-        case meshtastic_PortNum_POSITION_APP: {
-            msgType = "position";
-            meshtastic_Position scratch;
-            meshtastic_Position *decoded = NULL;
-            memset(&scratch, 0, sizeof(scratch));
-            if (pb_decode_from_bytes(mp->decoded.payload.bytes, mp->decoded.payload.size, &meshtastic_Position_msg, &scratch)) {
-                decoded = &scratch;
-                if ((int)decoded->time) {
-                    msgPayload["time"] = new JSONValue((unsigned int)decoded->time);
-                }
-                if ((int)decoded->timestamp) {
-                    msgPayload["timestamp"] = new JSONValue((unsigned int)decoded->timestamp);
-                }
-                msgPayload["latitude_i"] = new JSONValue((int)decoded->latitude_i);
-                msgPayload["longitude_i"] = new JSONValue((int)decoded->longitude_i);
-                if ((int)decoded->altitude) {
-                    msgPayload["altitude"] = new JSONValue((int)decoded->altitude);
-                }
-                if ((int)decoded->ground_speed) {
-                    msgPayload["ground_speed"] = new JSONValue((unsigned int)decoded->ground_speed);
-                }
-                if (int(decoded->ground_track)) {
-                    msgPayload["ground_track"] = new JSONValue((unsigned int)decoded->ground_track);
-                }
-                if (int(decoded->sats_in_view)) {
-                    msgPayload["sats_in_view"] = new JSONValue((unsigned int)decoded->sats_in_view);
-                }
-                if ((int)decoded->PDOP) {
-                    msgPayload["PDOP"] = new JSONValue((int)decoded->PDOP);
-                }
-                if ((int)decoded->HDOP) {
-                    msgPayload["HDOP"] = new JSONValue((int)decoded->HDOP);
-                }
-                if ((int)decoded->VDOP) {
-                    msgPayload["VDOP"] = new JSONValue((int)decoded->VDOP);
-                }
-                if ((int)decoded->precision_bits) {
-                    msgPayload["precision_bits"] = new JSONValue((int)decoded->precision_bits);
-                }
-                jsonObj["payload"] = new JSONValue(msgPayload);
-            } else if (shouldLog) {
-                LOG_ERROR(errStr, msgType.c_str());
-            }
-            break;
+        break;
+    }
+    case meshtastic_PortNum_POSITION_APP: {
+        msgType = "position";
+        meshtastic_Position scratch;
+        memset(&scratch, 0, sizeof(scratch));
+        if (pb_decode_from_bytes(mp->decoded.payload.bytes, mp->decoded.payload.size, &meshtastic_Position_msg, &scratch)) {
+            w.key("payload");
+            w.beginObject();
+            writePositionPayload(w, &scratch);
+            w.endObject();
+        } else if (shouldLog) {
+            LOG_ERROR(errStr, msgType);
         }
-        case meshtastic_PortNum_WAYPOINT_APP: {
-            msgType = "waypoint";
-            meshtastic_Waypoint scratch;
-            meshtastic_Waypoint *decoded = NULL;
-            memset(&scratch, 0, sizeof(scratch));
-            if (pb_decode_from_bytes(mp->decoded.payload.bytes, mp->decoded.payload.size, &meshtastic_Waypoint_msg, &scratch)) {
-                decoded = &scratch;
-                msgPayload["id"] = new JSONValue((unsigned int)decoded->id);
-                msgPayload["name"] = new JSONValue(decoded->name);
-                msgPayload["description"] = new JSONValue(decoded->description);
-                msgPayload["expire"] = new JSONValue((unsigned int)decoded->expire);
-                msgPayload["locked_to"] = new JSONValue((unsigned int)decoded->locked_to);
-                msgPayload["latitude_i"] = new JSONValue((int)decoded->latitude_i);
-                msgPayload["longitude_i"] = new JSONValue((int)decoded->longitude_i);
-                jsonObj["payload"] = new JSONValue(msgPayload);
-            } else if (shouldLog) {
-                LOG_ERROR(errStr, msgType.c_str());
+        break;
+    }
+    case meshtastic_PortNum_WAYPOINT_APP: {
+        msgType = "waypoint";
+        meshtastic_Waypoint scratch;
+        memset(&scratch, 0, sizeof(scratch));
+        if (pb_decode_from_bytes(mp->decoded.payload.bytes, mp->decoded.payload.size, &meshtastic_Waypoint_msg, &scratch)) {
+            w.key("payload");
+            w.beginObject();
+            w.key("description");
+            w.value(scratch.description);
+            writeUInt(w, "expire", scratch.expire);
+            writeUInt(w, "id", scratch.id);
+            writeInt(w, "latitude_i", scratch.latitude_i);
+            writeUInt(w, "locked_to", scratch.locked_to);
+            writeInt(w, "longitude_i", scratch.longitude_i);
+            w.key("name");
+            w.value(scratch.name);
+            w.endObject();
+        } else if (shouldLog) {
+            LOG_ERROR(errStr, msgType);
+        }
+        break;
+    }
+    case meshtastic_PortNum_NEIGHBORINFO_APP: {
+        msgType = "neighborinfo";
+        meshtastic_NeighborInfo scratch;
+        memset(&scratch, 0, sizeof(scratch));
+        if (pb_decode_from_bytes(mp->decoded.payload.bytes, mp->decoded.payload.size, &meshtastic_NeighborInfo_msg,
+                                 &scratch)) {
+            w.key("payload");
+            w.beginObject();
+            writeUInt(w, "last_sent_by_id", scratch.last_sent_by_id);
+            w.key("neighbors");
+            w.beginArray();
+            for (uint8_t i = 0; i < scratch.neighbors_count; i++) {
+                w.beginObject();
+                writeUInt(w, "node_id", scratch.neighbors[i].node_id);
+                writeInt(w, "snr", (int)scratch.neighbors[i].snr);
+                w.endObject();
             }
-            break;
+            w.endArray();
+            writeUInt(w, "neighbors_count", scratch.neighbors_count);
+            writeUInt(w, "node_broadcast_interval_secs", scratch.node_broadcast_interval_secs);
+            writeUInt(w, "node_id", scratch.node_id);
+            w.endObject();
+        } else if (shouldLog) {
+            LOG_ERROR(errStr, msgType);
         }
-        case meshtastic_PortNum_NEIGHBORINFO_APP: {
-            msgType = "neighborinfo";
-            meshtastic_NeighborInfo scratch;
-            meshtastic_NeighborInfo *decoded = NULL;
+        break;
+    }
+    case meshtastic_PortNum_TRACEROUTE_APP: {
+        if (mp->decoded.request_id) { // Only report the traceroute response
+            msgType = "traceroute";
+            meshtastic_RouteDiscovery scratch;
             memset(&scratch, 0, sizeof(scratch));
-            if (pb_decode_from_bytes(mp->decoded.payload.bytes, mp->decoded.payload.size, &meshtastic_NeighborInfo_msg,
+            if (pb_decode_from_bytes(mp->decoded.payload.bytes, mp->decoded.payload.size, &meshtastic_RouteDiscovery_msg,
                                      &scratch)) {
-                decoded = &scratch;
-                msgPayload["node_id"] = new JSONValue((unsigned int)decoded->node_id);
-                msgPayload["node_broadcast_interval_secs"] = new JSONValue((unsigned int)decoded->node_broadcast_interval_secs);
-                msgPayload["last_sent_by_id"] = new JSONValue((unsigned int)decoded->last_sent_by_id);
-                msgPayload["neighbors_count"] = new JSONValue(decoded->neighbors_count);
-                JSONArray neighbors;
-                for (uint8_t i = 0; i < decoded->neighbors_count; i++) {
-                    JSONObject neighborObj;
-                    neighborObj["node_id"] = new JSONValue((unsigned int)decoded->neighbors[i].node_id);
-                    neighborObj["snr"] = new JSONValue((int)decoded->neighbors[i].snr);
-                    neighbors.push_back(new JSONValue(neighborObj));
-                }
-                msgPayload["neighbors"] = new JSONValue(neighbors);
-                jsonObj["payload"] = new JSONValue(msgPayload);
-            } else if (shouldLog) {
-                LOG_ERROR(errStr, msgType.c_str());
-            }
-            break;
-        }
-        case meshtastic_PortNum_TRACEROUTE_APP: {
-            if (mp->decoded.request_id) { // Only report the traceroute response
-                msgType = "traceroute";
-                meshtastic_RouteDiscovery scratch;
-                meshtastic_RouteDiscovery *decoded = NULL;
-                memset(&scratch, 0, sizeof(scratch));
-                if (pb_decode_from_bytes(mp->decoded.payload.bytes, mp->decoded.payload.size, &meshtastic_RouteDiscovery_msg,
-                                         &scratch)) {
-                    decoded = &scratch;
-                    JSONArray route;      // Route this message took
-                    JSONArray routeBack;  // Route this message took back
-                    JSONArray snrTowards; // Snr for forward route
-                    JSONArray snrBack;    // Snr for reverse route
+                w.key("payload");
+                w.beginObject();
 
-                    // Lambda function for adding a long name to the route
-                    auto addToRoute = [](JSONArray *route, NodeNum num) {
-                        char long_name[40] = "Unknown";
-                        meshtastic_NodeInfoLite *node = nodeDB->getMeshNode(num);
-                        bool name_known = node ? node->has_user : false;
-                        if (name_known)
-                            memcpy(long_name, node->user.long_name, sizeof(long_name));
-                        route->push_back(new JSONValue(long_name));
-                    };
-                    addToRoute(&route, mp->to); // Started at the original transmitter (destination of response)
-                    for (uint8_t i = 0; i < decoded->route_count; i++) {
-                        addToRoute(&route, decoded->route[i]);
-                    }
-                    addToRoute(&route, mp->from); // Ended at the original destination (source of response)
+                // Route this message took
+                w.key("route");
+                w.beginArray();
+                writeRouteHop(w, mp->to); // Started at the original transmitter (destination of response)
+                for (uint8_t i = 0; i < scratch.route_count; i++)
+                    writeRouteHop(w, scratch.route[i]);
+                writeRouteHop(w, mp->from); // Ended at the original destination (source of response)
+                w.endArray();
 
-                    addToRoute(&routeBack, mp->from); // Started at the original destination (source of response)
-                    for (uint8_t i = 0; i < decoded->route_back_count; i++) {
-                        addToRoute(&routeBack, decoded->route_back[i]);
-                    }
-                    addToRoute(&routeBack, mp->to); // Ended at the original transmitter (destination of response)
+                // Route this message took back
+                w.key("route_back");
+                w.beginArray();
+                writeRouteHop(w, mp->from); // Started at the original destination (source of response)
+                for (uint8_t i = 0; i < scratch.route_back_count; i++)
+                    writeRouteHop(w, scratch.route_back[i]);
+                writeRouteHop(w, mp->to); // Ended at the original transmitter (destination of response)
+                w.endArray();
 
-                    for (uint8_t i = 0; i < decoded->snr_back_count; i++) {
-                        snrBack.push_back(new JSONValue((float)decoded->snr_back[i] / 4));
-                    }
+                // Snr for reverse route
+                w.key("snr_back");
+                w.beginArray();
+                for (uint8_t i = 0; i < scratch.snr_back_count; i++)
+                    w.value((double)((float)scratch.snr_back[i] / 4));
+                w.endArray();
 
-                    for (uint8_t i = 0; i < decoded->snr_towards_count; i++) {
-                        snrTowards.push_back(new JSONValue((float)decoded->snr_towards[i] / 4));
-                    }
+                // Snr for forward route
+                w.key("snr_towards");
+                w.beginArray();
+                for (uint8_t i = 0; i < scratch.snr_towards_count; i++)
+                    w.value((double)((float)scratch.snr_towards[i] / 4));
+                w.endArray();
 
-                    msgPayload["route"] = new JSONValue(route);
-                    msgPayload["route_back"] = new JSONValue(routeBack);
-                    msgPayload["snr_back"] = new JSONValue(snrBack);
-                    msgPayload["snr_towards"] = new JSONValue(snrTowards);
-                    jsonObj["payload"] = new JSONValue(msgPayload);
-                } else if (shouldLog) {
-                    LOG_ERROR(errStr, msgType.c_str());
-                }
+                w.endObject();
+            } else if (shouldLog) {
+                LOG_ERROR(errStr, msgType);
             }
-            break;
-        }
-        case meshtastic_PortNum_DETECTION_SENSOR_APP: {
-            msgType = "detection";
-            char payloadStr[(mp->decoded.payload.size) + 1];
-            memcpy(payloadStr, mp->decoded.payload.bytes, mp->decoded.payload.size);
-            payloadStr[mp->decoded.payload.size] = 0; // null terminated string
-            msgPayload["text"] = new JSONValue(payloadStr);
-            jsonObj["payload"] = new JSONValue(msgPayload);
-            break;
         }
+        break;
+    }
+    case meshtastic_PortNum_DETECTION_SENSOR_APP: {
+        msgType = "detection";
+        char payloadStr[(mp->decoded.payload.size) + 1];
+        memcpy(payloadStr, mp->decoded.payload.bytes, mp->decoded.payload.size);
+        payloadStr[mp->decoded.payload.size] = 0; // null terminated string
+        w.key("payload");
+        w.beginObject();
+        w.key("text");
+        w.value(payloadStr);
+        w.endObject();
+        break;
+    }
 #ifdef ARCH_ESP32
-        case meshtastic_PortNum_PAXCOUNTER_APP: {
-            msgType = "paxcounter";
-            meshtastic_Paxcount scratch;
-            meshtastic_Paxcount *decoded = NULL;
-            memset(&scratch, 0, sizeof(scratch));
-            if (pb_decode_from_bytes(mp->decoded.payload.bytes, mp->decoded.payload.size, &meshtastic_Paxcount_msg, &scratch)) {
-                decoded = &scratch;
-                msgPayload["wifi_count"] = new JSONValue((unsigned int)decoded->wifi);
-                msgPayload["ble_count"] = new JSONValue((unsigned int)decoded->ble);
-                msgPayload["uptime"] = new JSONValue((unsigned int)decoded->uptime);
-                jsonObj["payload"] = new JSONValue(msgPayload);
-            } else if (shouldLog) {
-                LOG_ERROR(errStr, msgType.c_str());
-            }
-            break;
+    case meshtastic_PortNum_PAXCOUNTER_APP: {
+        msgType = "paxcounter";
+        meshtastic_Paxcount scratch;
+        memset(&scratch, 0, sizeof(scratch));
+        if (pb_decode_from_bytes(mp->decoded.payload.bytes, mp->decoded.payload.size, &meshtastic_Paxcount_msg, &scratch)) {
+            w.key("payload");
+            w.beginObject();
+            writeUInt(w, "ble_count", scratch.ble);
+            writeUInt(w, "uptime", scratch.uptime);
+            writeUInt(w, "wifi_count", scratch.wifi);
+            w.endObject();
+        } else if (shouldLog) {
+            LOG_ERROR(errStr, msgType);
         }
+        break;
+    }
 #endif
-        case meshtastic_PortNum_REMOTE_HARDWARE_APP: {
-            meshtastic_HardwareMessage scratch;
-            meshtastic_HardwareMessage *decoded = NULL;
-            memset(&scratch, 0, sizeof(scratch));
-            if (pb_decode_from_bytes(mp->decoded.payload.bytes, mp->decoded.payload.size, &meshtastic_HardwareMessage_msg,
-                                     &scratch)) {
-                decoded = &scratch;
-                if (decoded->type == meshtastic_HardwareMessage_Type_GPIOS_CHANGED) {
-                    msgType = "gpios_changed";
-                    msgPayload["gpio_value"] = new JSONValue((unsigned int)decoded->gpio_value);
-                    jsonObj["payload"] = new JSONValue(msgPayload);
-                } else if (decoded->type == meshtastic_HardwareMessage_Type_READ_GPIOS_REPLY) {
-                    msgType = "gpios_read_reply";
-                    msgPayload["gpio_value"] = new JSONValue((unsigned int)decoded->gpio_value);
-                    msgPayload["gpio_mask"] = new JSONValue((unsigned int)decoded->gpio_mask);
-                    jsonObj["payload"] = new JSONValue(msgPayload);
-                }
-            } else if (shouldLog) {
-                LOG_ERROR(errStr, "RemoteHardware");
+    case meshtastic_PortNum_REMOTE_HARDWARE_APP: {
+        meshtastic_HardwareMessage scratch;
+        memset(&scratch, 0, sizeof(scratch));
+        if (pb_decode_from_bytes(mp->decoded.payload.bytes, mp->decoded.payload.size, &meshtastic_HardwareMessage_msg,
+                                 &scratch)) {
+            if (scratch.type == meshtastic_HardwareMessage_Type_GPIOS_CHANGED) {
+                msgType = "gpios_changed";
+                w.key("payload");
+                w.beginObject();
+                writeUInt(w, "gpio_value", scratch.gpio_value);
+                w.endObject();
+            } else if (scratch.type == meshtastic_HardwareMessage_Type_READ_GPIOS_REPLY) {
+                msgType = "gpios_read_reply";
+                w.key("payload");
+                w.beginObject();
+                writeUInt(w, "gpio_mask", scratch.gpio_mask);
+                writeUInt(w, "gpio_value", scratch.gpio_value);
+                w.endObject();
             }
-            break;
-        }
-        // add more packet types here if needed
-        default:
-            break;
+        } else if (shouldLog) {
+            LOG_ERROR(errStr, "RemoteHardware");
         }
-    } else if (shouldLog) {
-        LOG_WARN("Couldn't convert encrypted payload of MeshPacket to JSON");
+        break;
+    }
+    // add more packet types here if needed
+    default:
+        break;
     }
+    return msgType;
+}
 
-    jsonObj["id"] = new JSONValue((unsigned int)mp->id);
-    jsonObj["timestamp"] = new JSONValue((unsigned int)mp->rx_time);
-    jsonObj["to"] = new JSONValue((unsigned int)mp->to);
-    jsonObj["from"] = new JSONValue((unsigned int)mp->from);
-    jsonObj["channel"] = new JSONValue((unsigned int)mp->channel);
-    jsonObj["type"] = new JSONValue(msgType.c_str());
-    jsonObj["sender"] = new JSONValue(nodeDB->getNodeId().c_str());
-    if (mp->rx_rssi != 0)
-        jsonObj["rssi"] = new JSONValue((int)mp->rx_rssi);
-    if (mp->rx_snr != 0)
-        jsonObj["snr"] = new JSONValue((float)mp->rx_snr);
+/// Write the whole packet as one JSON object
+static void writeJsonPacket(JSONWriter &w, const meshtastic_MeshPacket *mp, bool shouldLog)
+{
+    // Members are written in key order, like the JSONObject (a std::map) that used to be built here
+    const char *msgType = "";
     const int8_t hopsAway = getHopsAway(*mp);
+
+    w.beginObject();
+    writeUInt(w, "channel", mp->channel);
+    writeUInt(w, "from", mp->from);
     if (hopsAway >= 0) {
-        jsonObj["hops_away"] = new JSONValue((unsigned int)(hopsAway));
-        jsonObj["hop_start"] = new JSONValue((unsigned int)(mp->hop_start));
+        writeUInt(w, "hop_start", mp->hop_start);
+        writeUInt(w, "hops_away", hopsAway);
     }
+    writeUInt(w, "id", mp->id);
+    if (mp->which_payload_variant == meshtastic_MeshPacket_decoded_tag) {
+        msgType = writeJsonPayload(w, mp, shouldLog);
+    } else if (shouldLog) {
+        LOG_WARN("Couldn't convert encrypted payload of MeshPacket to JSON");
+    }
+    if (mp->rx_rssi != 0)
+        writeInt(w, "rssi", mp->rx_rssi);
+    w.key("sender");
+    w.value(nodeDB->getNodeId().c_str());
+    if (mp->rx_snr != 0)
+        writeFloat(w, "snr", mp->rx_snr);
+    writeUInt(w, "timestamp", mp->rx_time);
+    writeUInt(w, "to", mp->to);
+    w.key("type");
+    w.value(msgType);
+    w.endObject();
+}
 
-    // serialize and write it to the stream
-    JSONValue *value = new JSONValue(jsonObj);
-    std::string jsonStr = value->Stringify();
-
+std::string MeshPacketSerializer::JsonSerialize(const meshtastic_MeshPacket *mp, bool shouldLog)
+{
+    // Almost every packet fits the first time. Escaped long names in a traceroute can need more.
+    std::string json;
+    for (size_t size = MESHPACKET_JSON_BUFFER_SIZE; size <= 8 * MESHPACKET_JSON_BUFFER_SIZE; size *= 2) {
+        json.resize(size);
+        JSONWriter w(&json[0], size);
+        writeJsonPacket(w, mp, shouldLog && size == MESHPACKET_JSON_BUFFER_SIZE);
+        if (!w.overflowed()) {
+            json.resize(w.length());
+            if (shouldLog)
+                LOG_INFO("serialized json message: %s", json.c_str());
+            return json;
+        }
+    }
     if (shouldLog)
-        LOG_INFO("serialized json message: %s", jsonStr.c_str());
+        LOG_WARN("JSON for packet 0x%08x is too large", mp->id);
+    return "";
+}
 
-    delete value;
-    return jsonStr;
+size_t MeshPacketSerializer::JsonSerialize(const meshtastic_MeshPacket *mp, char *buf, size_t bufLen, bool shouldLog)
+{
+    JSONWriter w(buf, bufLen);
+    writeJsonPacket(w, mp, shouldLog);
+    if (w.overflowed()) {
+        if (shouldLog)
+            LOG_WARN("JSON for packet 0x%08x does not fit in %u bytes", mp->id, (unsigned)bufLen);
+        return 0;
+    }
+    if (shouldLog)
+        LOG_INFO("serialized json message: %s", buf);
+    return w.length();
 }
 
 std::string MeshPacketSerializer::JsonSerializeEncrypted(const meshtastic_MeshPacket *mp)
@@ -1,12 +1,27 @@
 #include <meshtastic/mesh.pb.h>
+#include <stddef.h>
 #include <string>
 
+/// Buffer size that fits the JSON of any packet JsonSerialize() knows how to decode
+#ifndef MESHPACKET_JSON_BUFFER_SIZE
+#define MESHPACKET_JSON_BUFFER_SIZE 2048
+#endif
+
 static const char hexChars[16] = {'0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'A', 'B', 'C', 'D', 'E', 'F'};
 
 class MeshPacketSerializer
 {
   public:
+    /// The JSON for a packet, empty if it is too large
     static std::string JsonSerialize(const meshtastic_MeshPacket *mp, bool shouldLog = true);
+
+    /**
+     * Same output as JsonSerialize(mp), written straight into buf without allocating.
+     * Only text messages whose payload is itself JSON still allocate, to parse it.
+     *
+     * @return the length of the JSON in buf, or 0 if it did not fit in bufLen
+     */
+    static size_t JsonSerialize(const meshtastic_MeshPacket *mp, char *buf, size_t bufLen, bool shouldLog = true);
     static std::string JsonSerializeEncrypted(const meshtastic_MeshPacket *mp);
 
   private:
@@ -388,6 +388,19 @@ std::string MeshPacketSerializer::JsonSerialize(const meshtastic_MeshPacket *mp,
     return jsonStr;
 }
 
+size_t MeshPacketSerializer::JsonSerialize(const meshtastic_MeshPacket *mp, char *buf, size_t bufLen, bool shouldLog)
+{
+    // ArduinoJson already builds the document in a fixed pool, just copy the result out
+    std::string jsonStr = JsonSerialize(mp, shouldLog);
+    if (jsonStr.length() >= bufLen) {
+        if (shouldLog)
+            LOG_WARN("JSON for packet 0x%08x does not fit in %u bytes", mp->id, (unsigned)bufLen);
+        return 0;
+    }
+    memcpy(buf, jsonStr.c_str(), jsonStr.length() + 1);
+    return jsonStr.length();
+}
+
 std::string MeshPacketSerializer::JsonSerializeEncrypted(const meshtastic_MeshPacket *mp)
 {
     jsonObj.clear();
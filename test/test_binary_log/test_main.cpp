@@ -0,0 +1,254 @@
+#include "BinaryLog.h"
+#include "TestUtil.h"
+#include <map>
+#include <memory>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <unity.h>
+#include <vector>
+
+class MemoryPrint : public Print
+{
+  public:
+    std::vector<uint8_t> data;
+
+    size_t write(uint8_t c) override
+    {
+        data.push_back(c);
+        return 1;
+    }
+};
+
+// A dump read back, with the raw arguments of each record
+struct Dump {
+    uint32_t millisNow, rtcNow, dropped;
+    std::map<uint16_t, std::string> formats;
+    struct Record {
+        uint32_t millis;
+        uint16_t formatId;
+        uint8_t level;
+        std::string thread;
+        std::vector<uint8_t> args;
+    };
+    std::vector<Record> records;
+};
+
+template <typename T> static T readAt(const std::vector<uint8_t> &data, size_t &pos)
+{
+    T value;
+    TEST_ASSERT_TRUE(pos + sizeof(value) <= data.size());
+    memcpy(&value, data.data() + pos, sizeof(value));
+    pos += sizeof(value);
+    return value;
+}
+
+static Dump readDump(const BinaryLog &log, uint32_t millisNow = 5000, uint32_t rtcNow = 1700000000)
+{
+    MemoryPrint out;
+    size_t written = log.dump(out, millisNow, rtcNow);
+    TEST_ASSERT_EQUAL(out.data.size(), written);
+
+    Dump dump;
+    const std::vector<uint8_t> &data = out.data;
+    TEST_ASSERT_EQUAL_MEMORY("MTBL", data.data(), 4);
+    TEST_ASSERT_EQUAL(BinaryLog::VERSION, data[4]);
+    TEST_ASSERT_EQUAL(sizeof(long), data[5]);
+    size_t pos = 8;
+    dump.millisNow = readAt<uint32_t>(data, pos);
+    dump.rtcNow = readAt<uint32_t>(data, pos);
+    dump.dropped = readAt<uint32_t>(data, pos);
+
+    uint16_t count = readAt<uint16_t>(data, pos);
+    for (uint16_t i = 0; i < count; i++) {
+        uint16_t id = readAt<uint16_t>(data, pos);
+        uint16_t length = readAt<uint16_t>(data, pos);
+        dump.formats[id] = std::string((const char *)data.data() + pos, length);
+        pos += length;
+    }
+
+    uint32_t size = readAt<uint32_t>(data, pos);
+    TEST_ASSERT_EQUAL(data.size(), pos + size);
+    while (pos < data.size()) {
+        size_t start = pos;
+        uint16_t length = readAt<uint16_t>(data, pos);
+        Dump::Record r;
+        r.millis = readAt<uint32_t>(data, pos);
+        r.formatId = readAt<uint16_t>(data, pos);
+        r.level = readAt<uint8_t>(data, pos);
+        uint8_t threadLength = readAt<uint8_t>(data, pos);
+        r.thread = std::string((const char *)data.data() + pos, threadLength);
+        pos += threadLength;
+        TEST_ASSERT_TRUE(start + length >= pos);
+        r.args.assign(data.begin() + pos, data.begin() + start + length);
+        pos = start + length;
+        dump.records.push_back(r);
+    }
+    return dump;
+}
+
+static void recordf(BinaryLog &log, const char *level, uint32_t millis, const char *format, ...)
+{
+    va_list arg;
+    va_start(arg, format);
+    log.record(level, "Router", millis, format, arg);
+    va_end(arg);
+}
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+static void test_arguments_are_kept_raw()
+{
+    BinaryLog log(1024, 16, 512);
+    recordf(log, "DEBUG", 1234, "id=0x%08x rssi=%d snr=%.2f from %s %lu %llu%%", 0xdeadbeefu, -90, 5.25, "node", 7ul, 1ull << 40);
+
+    Dump dump = readDump(log);
+    TEST_ASSERT_EQUAL_UINT32(5000, dump.millisNow);
+    TEST_ASSERT_EQUAL_UINT32(1700000000, dump.rtcNow);
+    TEST_ASSERT_EQUAL(1, dump.records.size());
+    const Dump::Record &r = dump.records[0];
+    TEST_ASSERT_EQUAL_UINT32(1234, r.millis);
+    TEST_ASSERT_EQUAL(1, r.level);
+    TEST_ASSERT_EQUAL_STRING("Router", r.thread.c_str());
+    TEST_ASSERT_EQUAL_STRING("id=0x%08x rssi=%d snr=%.2f from %s %lu %llu%%", dump.formats[r.formatId].c_str());
+
+    size_t pos = 0;
+    TEST_ASSERT_EQUAL_UINT32(0xdeadbeef, readAt<uint32_t>(r.args, pos));
+    TEST_ASSERT_EQUAL_INT32(-90, readAt<int32_t>(r.args, pos));
+    TEST_ASSERT_TRUE(readAt<double>(r.args, pos) == 5.25);
+    TEST_ASSERT_EQUAL(4, readAt<uint8_t>(r.args, pos));
+    TEST_ASSERT_EQUAL_MEMORY("node", r.args.data() + pos, 4);
+    pos += 4;
+    TEST_ASSERT_TRUE(readAt<unsigned long>(r.args, pos) == 7);
+    TEST_ASSERT_TRUE(readAt<unsigned long long>(r.args, pos) == 1ull << 40);
+    TEST_ASSERT_EQUAL(r.args.size(), pos);
+}
+
+static void test_formats_are_interned_by_content()
+{
+    BinaryLog log(1024, 16, 512);
+    char format[32];
+    strcpy(format, "value %d");
+    recordf(log, "INFO ", 1, format, 1);
+    recordf(log, "INFO ", 2, "value %d", 2);
+    // Same buffer, other text: a caller formatting into a stack buffer
+    strcpy(format, "other %d");
+    recordf(log, "INFO ", 3, format, 3);
+
+    Dump dump = readDump(log);
+    TEST_ASSERT_EQUAL(3, dump.records.size());
+    TEST_ASSERT_EQUAL(2, dump.formats.size());
+    TEST_ASSERT_EQUAL(dump.records[0].formatId, dump.records[1].formatId);
+    TEST_ASSERT_TRUE(dump.records[0].formatId != dump.records[2].formatId);
+    TEST_ASSERT_EQUAL_STRING("other %d", dump.formats[dump.records[2].formatId].c_str());
+}
+
+static void test_oldest_records_are_overwritten()
+{
+    BinaryLog log(256, 16, 512);
+    for (uint32_t i = 0; i < 100; i++)
+        recordf(log, "TRACE", i, "tick %u", (unsigned)i);
+
+    Dump dump = readDump(log);
+    TEST_ASSERT_EQUAL(log.getRecordCount(), dump.records.size());
+    TEST_ASSERT_EQUAL_UINT32(100, dump.records.size() + dump.dropped);
+    TEST_ASSERT_EQUAL_UINT32(log.getDropped(), dump.dropped);
+    for (size_t i = 0; i < dump.records.size(); i++) {
+        uint32_t expected = 100 - dump.records.size() + i;
+        TEST_ASSERT_EQUAL_UINT32(expected, dump.records[i].millis);
+        size_t pos = 0;
+        TEST_ASSERT_EQUAL_UINT32(expected, readAt<uint32_t>(dump.records[i].args, pos));
+    }
+}
+
+static void test_long_arguments_are_truncated()
+{
+    BinaryLog log(1024, 16, 512);
+    std::string s(100, 'x');
+    recordf(log, "WARN ", 0, "%s %s %s %s %d", s.c_str(), s.c_str(), s.c_str(), s.c_str(), 1);
+
+    Dump dump = readDump(log);
+    const Dump::Record &r = dump.records[0];
+    TEST_ASSERT_TRUE(r.level & BinaryLog::LEVEL_TRUNCATED);
+    TEST_ASSERT_EQUAL(3, r.level & ~BinaryLog::LEVEL_TRUNCATED);
+    // Strings are cut at MAX_STRING, and only whole arguments are kept
+    TEST_ASSERT_EQUAL(BinaryLog::MAX_STRING, r.args[0]);
+    TEST_ASSERT_EQUAL(0, r.args.size() % (1 + BinaryLog::MAX_STRING));
+}
+
+static void test_string_precision_is_respected()
+{
+    BinaryLog log(1024, 16, 512);
+    // Not NUL terminated, like the NMEA and message buffers logged with %.*s
+    std::unique_ptr<char[]> raw(new char[4]);
+    memcpy(raw.get(), "abcd", 4);
+    recordf(log, "INFO ", 0, "%.*s %.2s %-*s", 4, raw.get(), "xyz", 6, "wide");
+
+    Dump dump = readDump(log);
+    const std::vector<uint8_t> &args = dump.records[0].args;
+    size_t pos = 0;
+    TEST_ASSERT_EQUAL(4, readAt<int>(args, pos));
+    TEST_ASSERT_EQUAL(4, args[pos]);
+    TEST_ASSERT_EQUAL_MEMORY("abcd", &args[pos + 1], 4);
+    pos += 5;
+    TEST_ASSERT_EQUAL(2, args[pos]);
+    TEST_ASSERT_EQUAL_MEMORY("xy", &args[pos + 1], 2);
+    pos += 3;
+    // A width is not a precision
+    TEST_ASSERT_EQUAL(6, readAt<int>(args, pos));
+    TEST_ASSERT_EQUAL(4, args[pos]);
+    TEST_ASSERT_EQUAL(pos + 5, args.size());
+}
+
+static void test_full_format_table()
+{
+    BinaryLog log(4096, 16, 64);
+    char format[16];
+    for (int i = 0; i < 20; i++) {
+        snprintf(format, sizeof(format), "format %d %%d", i);
+        recordf(log, "ERROR", i, format, i);
+    }
+    TEST_ASSERT_TRUE(log.getUnknownFormats() > 0);
+
+    Dump dump = readDump(log);
+    TEST_ASSERT_EQUAL(20, dump.records.size());
+    for (const Dump::Record &r : dump.records) {
+        if (r.formatId == BinaryLog::NO_FORMAT)
+            TEST_ASSERT_EQUAL(0, r.args.size());
+        else
+            TEST_ASSERT_TRUE(dump.formats.count(r.formatId));
+    }
+}
+
+static void test_paused_calls_are_dropped()
+{
+    BinaryLog log(1024, 16, 512);
+    recordf(log, "INFO ", 0, "kept");
+    log.setPaused(true);
+    recordf(log, "INFO ", 1, "not kept");
+    log.setPaused(false);
+
+    Dump dump = readDump(log);
+    TEST_ASSERT_EQUAL(1, dump.records.size());
+    TEST_ASSERT_EQUAL_UINT32(1, dump.dropped);
+}
+
+void setup()
+{
+    initializeTestEnvironment();
+
+    UNITY_BEGIN();
+    RUN_TEST(test_arguments_are_kept_raw);
+    RUN_TEST(test_formats_are_interned_by_content);
+    RUN_TEST(test_oldest_records_are_overwritten);
+    RUN_TEST(test_long_arguments_are_truncated);
+    RUN_TEST(test_string_precision_is_respected);
+    RUN_TEST(test_full_format_table);
+    RUN_TEST(test_paused_calls_are_dropped);
+    exit(UNITY_END());
+}
+
+void loop() {}
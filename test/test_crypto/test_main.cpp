@@ -152,6 +152,41 @@ void test_PKC(void)
     TEST_ASSERT_EQUAL_MEMORY(expected_decrypted, decrypted, 10);
 }
 
+void test_PKC_shared_key_cache(void)
+{
+    uint8_t private_key[32];
+    meshtastic_UserLite_public_key_t public_key;
+    uint8_t expected_shared[32];
+    uint8_t radioBytes[128] __attribute__((__aligned__));
+    uint8_t decrypted[128] __attribute__((__aligned__));
+
+    uint32_t fromNode = 0x0929;
+    uint64_t packetNum = 0x13b2d662;
+    HexToBytes(public_key.bytes, "db18fc50eea47f00251cb784819a3cf5fc361882597f589f0d7ff820e8064457");
+    public_key.size = 32;
+    HexToBytes(private_key, "a00330633e63522f8a4d81ec6d9d1e6617f6c8ffd3a4c698229537d44e522277");
+    HexToBytes(expected_shared, "777b1545c9d6f9a2");
+    HexToBytes(radioBytes, "8c646d7a2909000062d6b2136b00000040df24abfcc30a17a3d9046726099e796a1c036a792b");
+    crypto->setDHPrivateKey(private_key);
+
+    uint32_t hits = crypto->getSharedKeyCacheHits();
+    uint32_t misses = crypto->getSharedKeyCacheMisses();
+    TEST_ASSERT(crypto->decryptCurve25519(fromNode, public_key, packetNum, 22, radioBytes + 16, decrypted));
+    TEST_ASSERT_EQUAL_UINT32(misses + 1, crypto->getSharedKeyCacheMisses());
+
+    // Second packet from the same peer reuses the derived key
+    memset(crypto->shared_key, 0, 32);
+    TEST_ASSERT(crypto->decryptCurve25519(fromNode, public_key, packetNum, 22, radioBytes + 16, decrypted));
+    TEST_ASSERT_EQUAL_UINT32(hits + 1, crypto->getSharedKeyCacheHits());
+    TEST_ASSERT_EQUAL_MEMORY(expected_shared, crypto->shared_key, 8);
+
+    // A new private key must not decrypt with the shared key derived from the old one
+    HexToBytes(private_key, "10300724f3bea134eb1575245ef26ff9b8ccd59849cd98ce1a59002fe1d5986c");
+    crypto->setDHPrivateKey(private_key);
+    TEST_ASSERT_FALSE(crypto->decryptCurve25519(fromNode, public_key, packetNum, 22, radioBytes + 16, decrypted));
+    TEST_ASSERT_EQUAL_UINT32(misses + 2, crypto->getSharedKeyCacheMisses());
+}
+
 void test_AES_CTR(void)
 {
     uint8_t expected[32];
@@ -178,6 +213,34 @@ void test_AES_CTR(void)
     TEST_ASSERT_EQUAL_MEMORY(expected, plain, 16);
 }
 
+// Switching between channel keys must give the same output as a freshly set key, whether or not the key schedule was cached
+void test_AES_CTR_key_switching(void)
+{
+    uint8_t expected256[16], expected128[16];
+    uint8_t plain[32];
+    uint8_t nonce[32];
+    CryptoKey k256, k128;
+
+    k256.length = 32;
+    HexToBytes(k256.bytes, "776BEFF2851DB06F4C8A0542C8696F6C6A81AF1EEC96B4D37FC1D689E6C1C104");
+    HexToBytes(expected256, "145AD01DBF824EC7560863DC71E3E0C0");
+    k128.length = 16;
+    HexToBytes(k128.bytes, "AE6852F8121067CC4BF7A5765577F39E");
+    HexToBytes(expected128, "E4095D4FB7A7B3792D6175A3261311B8");
+
+    for (int i = 0; i < 3; i++) {
+        memcpy(plain, "Single block msg", 16);
+        HexToBytes(nonce, "00000060DB5672C97AA8F0B200000001");
+        crypto->encryptAESCtr(k256, nonce, 16, plain);
+        TEST_ASSERT_EQUAL_MEMORY(expected256, plain, 16);
+
+        memcpy(plain, "Single block msg", 16);
+        HexToBytes(nonce, "00000030000000000000000000000001");
+        crypto->encryptAESCtr(k128, nonce, 16, plain);
+        TEST_ASSERT_EQUAL_MEMORY(expected128, plain, 16);
+    }
+}
+
 void setup()
 {
     // NOTE!!! Wait for >2 secs
@@ -191,7 +254,9 @@ void setup()
     RUN_TEST(test_ECB_AES256);
     RUN_TEST(test_DH25519);
     RUN_TEST(test_AES_CTR);
+    RUN_TEST(test_AES_CTR_key_switching);
     RUN_TEST(test_PKC);
+    RUN_TEST(test_PKC_shared_key_cache);
     exit(UNITY_END()); // stop unit testing
 }
 
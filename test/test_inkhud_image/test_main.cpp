@@ -0,0 +1,168 @@
+// ImageBuffer is only built for InkHUD devices, it has no other dependencies so test it on its own
+#define MESHTASTIC_INCLUDE_INKHUD
+
+#include "TestUtil.h"
+#include "graphics/niche/InkHUD/ImageBuffer.h"
+#include <chrono>
+#include <stdlib.h>
+#include <unity.h>
+#include <vector>
+
+using NicheGraphics::InkHUD::ImageBuffer;
+
+static const uint16_t panelWidth = 250, panelHeight = 122; // Not a multiple of 8 wide, like most E-Ink panels
+static const size_t bufferSize = ((panelWidth + 7) / 8) * panelHeight;
+
+static std::vector<uint8_t> fast, reference;
+static ImageBuffer image;
+static uint8_t rotation;
+
+// The per-pixel path Renderer::handlePixel used to take for everything
+static void referencePixel(int32_t x, int32_t y, uint8_t value)
+{
+    int32_t w = (rotation & 1) ? panelHeight : panelWidth;
+    int32_t h = (rotation & 1) ? panelWidth : panelHeight;
+    if (x < 0 || y < 0 || x >= w || y >= h)
+        return;
+    int32_t px = x, py = y;
+    switch (rotation) {
+    case 1:
+        px = (panelWidth - 1) - y;
+        py = x;
+        break;
+    case 2:
+        px = (panelWidth - 1) - x;
+        py = (panelHeight - 1) - y;
+        break;
+    case 3:
+        px = y;
+        py = (panelHeight - 1) - x;
+        break;
+    }
+    uint8_t &byte = reference[py * ((panelWidth + 7) / 8) + px / 8];
+    uint8_t mask = 0x80 >> (px % 8);
+    byte = value ? (byte | mask) : (byte & ~mask);
+}
+
+static void useRotation(uint8_t r)
+{
+    rotation = r;
+    image.setRotation(r);
+}
+
+void setUp(void)
+{
+    fast.assign(bufferSize, 0xFF);
+    reference.assign(bufferSize, 0xFF);
+    image.begin(fast.data(), panelWidth, panelHeight);
+    useRotation(0);
+}
+
+void tearDown(void) {}
+
+static void test_fill_rect_matches_pixels()
+{
+    srand(1);
+    for (uint8_t r = 0; r < 4; r++) {
+        useRotation(r);
+        for (int i = 0; i < 500; i++) {
+            int32_t x = rand() % 300 - 25, y = rand() % 300 - 25, w = rand() % 60 - 5, h = rand() % 60 - 5;
+            uint8_t value = rand() & 1;
+            image.fillRect(x, y, w, h, value);
+            int32_t x0 = w < 0 ? x + w : x, y0 = h < 0 ? y + h : y;
+            for (int32_t py = y0; py < y0 + abs(h); py++)
+                for (int32_t px = x0; px < x0 + abs(w); px++)
+                    referencePixel(px, py, value);
+        }
+        TEST_ASSERT_EQUAL_MEMORY(reference.data(), fast.data(), bufferSize);
+    }
+}
+
+static void test_draw_bits_matches_pixels()
+{
+    std::vector<uint8_t> bits(64);
+    srand(2);
+    for (uint8_t r = 0; r < 4; r++) {
+        useRotation(r);
+        for (int i = 0; i < 500; i++) {
+            for (auto &b : bits)
+                b = rand();
+            uint16_t w = 1 + rand() % 20, h = 1 + rand() % 20;
+            uint32_t offset = rand() % 64;
+            int32_t x = rand() % 280 - 20, y = rand() % 280 - 20;
+            ImageBuffer::Region clip = {rand() % 200 - 10, rand() % 200 - 10, rand() % 300, rand() % 300};
+            uint8_t value = rand() & 1;
+            image.drawBits(x, y, bits.data(), offset, w, h, value, clip);
+            for (uint32_t row = 0; row < h; row++) {
+                for (uint32_t col = 0; col < w; col++) {
+                    uint32_t bit = offset + row * w + col;
+                    int32_t px = x + col, py = y + row;
+                    bool inClip = px >= clip.left && px < clip.right && py >= clip.top && py < clip.bottom;
+                    if (inClip && (bits[bit / 8] & (0x80 >> (bit % 8))))
+                        referencePixel(px, py, value);
+                }
+            }
+        }
+        TEST_ASSERT_EQUAL_MEMORY(reference.data(), fast.data(), bufferSize);
+    }
+}
+
+// A frame like the standard applets draw (filled header, dotted dividers, rows of 8 x 8 glyphs) in both rotations, built one
+// pixel at a time and through fillRect()/drawBits(). Both must give the same buffer, their times are printed side by side.
+static void test_benchmark_frame_build()
+{
+    static const uint8_t glyph[] = {0x3C, 0x42, 0x81, 0xFF, 0x81, 0x81, 0x81, 0x00}; // 8 x 8, like a small font's glyph
+    const int frames = 200;
+
+    for (uint8_t r = 0; r < 2; r++) {
+        useRotation(r);
+        const int32_t w = image.width(), h = image.height();
+        const ImageBuffer::Region screen = {0, 0, w, h};
+
+        auto start = std::chrono::steady_clock::now();
+        for (int f = 0; f < frames; f++) {
+            for (int32_t y = 0; y < 12; y++) // Header
+                for (int32_t x = 0; x < w; x++)
+                    referencePixel(x, y, 0);
+            for (int32_t line = 1; line * 12 < h; line++) {
+                for (int32_t x = 0; x < w; x += 2) // Dotted divider
+                    referencePixel(x, line * 12, 0);
+                for (int32_t x = 0; x + 8 <= w; x += 7) // Text
+                    for (int32_t gy = 0; gy < 8; gy++)
+                        for (int32_t gx = 0; gx < 8; gx++)
+                            if (glyph[gy] & (0x80 >> gx))
+                                referencePixel(x + gx, line * 12 + 2 + gy, 0);
+            }
+        }
+        auto perPixelUs = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+
+        start = std::chrono::steady_clock::now();
+        for (int f = 0; f < frames; f++) {
+            image.fillRect(0, 0, w, 12, 0);
+            for (int32_t line = 1; line * 12 < h; line++) {
+                for (int32_t x = 0; x < w; x += 2)
+                    image.setPixel(x, line * 12, 0);
+                for (int32_t x = 0; x + 8 <= w; x += 7)
+                    image.drawBits(x, line * 12 + 2, glyph, 0, 8, 8, 0, screen);
+            }
+        }
+        auto fastUs = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+
+        printf("InkHUD frame %dx%d: %.1f us per pixel, %.1f us with fast paths\n", (int)w, (int)h, (double)perPixelUs / frames,
+               (double)fastUs / frames);
+        TEST_ASSERT_EQUAL_MEMORY(reference.data(), fast.data(), bufferSize);
+    }
+}
+
+void setup()
+{
+    initializeTestEnvironment();
+
+    UNITY_BEGIN();
+    RUN_TEST(test_fill_rect_matches_pixels);
+    RUN_TEST(test_draw_bits_matches_pixels);
+    RUN_TEST(test_benchmark_frame_build);
+    exit(UNITY_END());
+}
+
+void loop() {}
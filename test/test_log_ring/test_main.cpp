@@ -0,0 +1,226 @@
+#include "LogRing.h"
+#include "TestUtil.h"
+#include <chrono>
+#include <memory>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <unity.h>
+
+static std::string readAll(LogRing &ring, LogRing::Sink sink)
+{
+    std::string out;
+    LogRing::Record record;
+    while (ring.peek(sink, record)) {
+        TEST_ASSERT_EQUAL(strlen(record.message), record.messageLength);
+        out += record.message;
+        out += ";";
+        ring.pop(sink);
+    }
+    return out;
+}
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+static void test_lines_come_back_in_order()
+{
+    LogRing ring(256);
+    TEST_ASSERT_TRUE(ring.isEmpty(LogRing::SINK_SERIAL));
+
+    ring.append("INFO ", "Router", "one", 3, 1000, 0);
+    ring.append("DEBUG", "", "two", 3, 2000, 1700000000);
+
+    LogRing::Record record;
+    TEST_ASSERT_TRUE(ring.peek(LogRing::SINK_SERIAL, record));
+    TEST_ASSERT_EQUAL_STRING("INFO ", record.level);
+    TEST_ASSERT_EQUAL_STRING("Router", record.thread);
+    TEST_ASSERT_EQUAL_STRING("one", record.message);
+    TEST_ASSERT_EQUAL_UINT32(1000, record.millis);
+    TEST_ASSERT_EQUAL_UINT32(0, record.rtcSec);
+    ring.pop(LogRing::SINK_SERIAL);
+
+    TEST_ASSERT_TRUE(ring.peek(LogRing::SINK_SERIAL, record));
+    TEST_ASSERT_EQUAL_STRING("", record.thread);
+    TEST_ASSERT_EQUAL_UINT32(1700000000, record.rtcSec);
+    ring.pop(LogRing::SINK_SERIAL);
+    TEST_ASSERT_FALSE(ring.peek(LogRing::SINK_SERIAL, record));
+    TEST_ASSERT_TRUE(ring.isEmpty(LogRing::SINK_SERIAL));
+}
+
+static void test_sinks_read_independently()
+{
+    LogRing ring(256);
+    ring.append("INFO ", "", "a", 1, 0, 0);
+    ring.append("INFO ", "", "b", 1, 0, 0);
+    TEST_ASSERT_EQUAL_STRING("a;b;", readAll(ring, LogRing::SINK_SERIAL).c_str());
+
+    ring.append("INFO ", "", "c", 1, 0, 0);
+    TEST_ASSERT_EQUAL_STRING("c;", readAll(ring, LogRing::SINK_SERIAL).c_str());
+    TEST_ASSERT_EQUAL_STRING("a;b;c;", readAll(ring, LogRing::SINK_BLE).c_str());
+
+    // A sink which is switched off skips what it missed without counting it as dropped
+    ring.skip(LogRing::SINK_SYSLOG);
+    TEST_ASSERT_TRUE(ring.isEmpty(LogRing::SINK_SYSLOG));
+    TEST_ASSERT_EQUAL_UINT32(0, ring.getDropped(LogRing::SINK_SYSLOG));
+}
+
+static void test_overwrite_counts_drops_per_sink()
+{
+    LogRing ring(256);
+    char message[16];
+    for (int i = 0; i < 100; i++) {
+        int len = snprintf(message, sizeof(message), "line %d", i);
+        ring.append("DEBUG", "Test", message, len, i, 0);
+        // Serial keeps up, the others never read
+        readAll(ring, LogRing::SINK_SERIAL);
+    }
+    TEST_ASSERT_EQUAL_UINT32(0, ring.getDropped(LogRing::SINK_SERIAL));
+
+    // BLE gets the newest lines, and the count of the ones it lost
+    std::string ble = readAll(ring, LogRing::SINK_BLE);
+    size_t kept = 0;
+    for (char c : ble)
+        kept += c == ';';
+    TEST_ASSERT_TRUE(kept > 0);
+    TEST_ASSERT_EQUAL_UINT32(100, kept + ring.getDropped(LogRing::SINK_BLE));
+    TEST_ASSERT_TRUE(ble.size() >= 8 && ble.compare(ble.size() - 8, 8, "line 99;") == 0);
+}
+
+static void test_records_never_wrap()
+{
+    LogRing ring(256);
+    std::string expected;
+    char message[128];
+    // Lengths which do not divide the ring, so records keep starting over at the beginning
+    for (int i = 0; i < 500; i++) {
+        size_t len = 1 + (i * 37) % 100;
+        memset(message, 'a' + i % 26, len);
+        message[len] = '\0';
+        ring.append("WARN ", "Thread", message, len, i, 0);
+
+        LogRing::Record record;
+        TEST_ASSERT_TRUE(ring.peek(LogRing::SINK_SERIAL, record));
+        TEST_ASSERT_EQUAL(len, record.messageLength);
+        TEST_ASSERT_EQUAL_UINT32(i, record.millis);
+        TEST_ASSERT_EQUAL_STRING("WARN ", record.level);
+        TEST_ASSERT_EQUAL_STRING("Thread", record.thread);
+        TEST_ASSERT_EQUAL_STRING(message, record.message);
+        ring.pop(LogRing::SINK_SERIAL);
+        TEST_ASSERT_TRUE(ring.isEmpty(LogRing::SINK_SERIAL));
+    }
+}
+
+static void test_long_lines_are_truncated()
+{
+    LogRing ring(256);
+    TEST_ASSERT_EQUAL(256, ring.getCapacity());
+    std::string longLine(1000, 'x');
+    ring.append("ERROR", "Thread", longLine.c_str(), longLine.size(), 0, 0);
+    ring.append("ERROR", "Thread", longLine.c_str(), longLine.size(), 0, 0);
+
+    LogRing::Record record;
+    TEST_ASSERT_TRUE(ring.peek(LogRing::SINK_SERIAL, record));
+    TEST_ASSERT_EQUAL(ring.getCapacity() / 2 - LogRing::recordSize(5, 6, 0), record.messageLength);
+    TEST_ASSERT_EQUAL(record.messageLength, strlen(record.message));
+}
+
+// The log pipeline as it was: the format is copied to the heap to add the newline, then formatted again for each sink
+// and written out a byte at a time
+static size_t oldPipeline(char *out, const char *format, ...)
+{
+    size_t len = strlen(format);
+    auto newFormat = std::unique_ptr<char[]>(new char[len + 2]);
+    strcpy(newFormat.get(), format);
+    newFormat[len] = '\n';
+    newFormat[len + 1] = '\0';
+
+    static char printBuf[256];
+    static char logRecord[384];
+    va_list arg, copy;
+    va_start(arg, format);
+    va_copy(copy, arg);
+    int n = vsnprintf(printBuf, sizeof(printBuf), newFormat.get(), copy);
+    va_end(copy);
+    va_copy(copy, arg);
+    vsnprintf(logRecord, sizeof(logRecord), newFormat.get(), copy);
+    va_end(copy);
+    vsnprintf(logRecord, sizeof(logRecord), newFormat.get(), arg);
+    va_end(arg);
+
+    size_t written = 0;
+    for (int i = 0; i < n && i < (int)sizeof(printBuf) - 1; i++)
+        out[written++] = printBuf[i];
+    return written;
+}
+
+// Formatted once into the ring, each sink reads it from there and writes it in one go
+static size_t newPipeline(LogRing &ring, char *out, const char *format, ...)
+{
+    static char lineBuf[256];
+    va_list arg;
+    va_start(arg, format);
+    int n = vsnprintf(lineBuf, sizeof(lineBuf), format, arg);
+    va_end(arg);
+    if (n > (int)sizeof(lineBuf) - 1)
+        n = sizeof(lineBuf) - 1;
+    ring.append("DEBUG", "Router", lineBuf, n, 0, 0);
+
+    size_t written = 0;
+    LogRing::Record record;
+    for (uint8_t sink = 0; sink < LogRing::NUM_SINKS; sink++) {
+        while (ring.peek((LogRing::Sink)sink, record)) {
+            if (sink == LogRing::SINK_SERIAL) {
+                memcpy(out, record.message, record.messageLength);
+                written = record.messageLength;
+            }
+            ring.pop((LogRing::Sink)sink);
+        }
+    }
+    return written;
+}
+
+// A typical packet log line through oldPipeline() and through LogRing, printed as ns per line. A 1KB ring read out after
+// every line must never drop one for the BLE sink.
+static void test_benchmark_log_line_cost()
+{
+    const size_t lines = 100000;
+    static char out[512];
+    LogRing ring(1024);
+    volatile size_t sink = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < lines; i++)
+        sink = sink + oldPipeline(out, "Received packet from 0x%08x id=0x%08x rssi=%d snr=%.2f hops=%u", (unsigned)i,
+                                  (unsigned)(i * 7), -90, 5.25, 3u);
+    auto oldNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < lines; i++)
+        sink = sink + newPipeline(ring, out, "Received packet from 0x%08x id=0x%08x rssi=%d snr=%.2f hops=%u", (unsigned)i,
+                                  (unsigned)(i * 7), -90, 5.25, 3u);
+    auto newNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+    printf("log line: before %8.1f ns (%8.0f lines/s), ring %8.1f ns (%8.0f lines/s)\n", (double)oldNs / lines,
+           lines * 1e9 / oldNs, (double)newNs / lines, lines * 1e9 / newNs);
+    TEST_ASSERT_EQUAL_UINT32(0, ring.getDropped(LogRing::SINK_BLE));
+    (void)sink;
+}
+
+void setup()
+{
+    initializeTestEnvironment();
+
+    UNITY_BEGIN();
+    RUN_TEST(test_lines_come_back_in_order);
+    RUN_TEST(test_sinks_read_independently);
+    RUN_TEST(test_overwrite_counts_drops_per_sink);
+    RUN_TEST(test_records_never_wrap);
+    RUN_TEST(test_long_lines_are_truncated);
+    RUN_TEST(test_benchmark_log_line_cost);
+    exit(UNITY_END());
+}
+
+void loop() {}
@@ -0,0 +1,103 @@
+#include "MemoryPool.h"
+#include "TestUtil.h"
+#include <thread>
+#include <unity.h>
+#include <vector>
+
+struct PoolItem {
+    uint32_t owner;
+    uint8_t payload[60];
+};
+
+void setUp(void) {}
+void tearDown(void) {}
+
+static void test_alloc_until_exhausted()
+{
+    MemoryPool<PoolItem, 8> pool;
+    std::vector<PoolItem *> items;
+    for (int i = 0; i < 8; i++) {
+        PoolItem *p = pool.allocZeroed(0);
+        TEST_ASSERT_NOT_NULL(p);
+        TEST_ASSERT_EQUAL_UINT32(0, p->owner);
+        p->owner = i + 1;
+        items.push_back(p);
+    }
+    TEST_ASSERT_NULL(pool.allocZeroed(0));
+    TEST_ASSERT_EQUAL_UINT32(8, pool.getNumInUse());
+    TEST_ASSERT_EQUAL_UINT32(8, pool.getHighWaterMark());
+    TEST_ASSERT_EQUAL_UINT32(1, pool.getAllocFailures());
+
+    // A released slot is handed out again, zeroed
+    pool.release(items[3]);
+    PoolItem *again = pool.allocZeroed(0);
+    TEST_ASSERT_EQUAL_PTR(items[3], again);
+    TEST_ASSERT_EQUAL_UINT32(0, again->owner);
+
+    for (auto *p : items)
+        pool.release(p);
+    TEST_ASSERT_EQUAL_UINT32(0, pool.getNumInUse());
+    TEST_ASSERT_EQUAL_UINT32(8, pool.getHighWaterMark());
+}
+
+static void test_foreign_pointer_is_ignored()
+{
+    MemoryPool<PoolItem, 2> pool;
+    PoolItem notFromPool;
+    pool.release(&notFromPool);
+    pool.release(nullptr);
+    TEST_ASSERT_EQUAL_UINT32(0, pool.getNumInUse());
+    TEST_ASSERT_NOT_NULL(pool.allocZeroed(0));
+    TEST_ASSERT_NOT_NULL(pool.allocZeroed(0));
+    TEST_ASSERT_NULL(pool.allocZeroed(0));
+}
+
+static void test_concurrent_alloc_release()
+{
+    // Stands in for ISRs and other tasks hammering the pool, every item must stay owned by exactly one of them.
+    // Together the threads never hold more than the pool size, so no allocation fails and nothing gets logged.
+    static MemoryPool<PoolItem, 32> pool;
+    const int numThreads = 4;
+    std::atomic<bool> corrupted{false};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < numThreads; t++) {
+        threads.emplace_back([t, &corrupted]() {
+            std::vector<PoolItem *> held;
+            for (int i = 0; i < 50000; i++) {
+                if (held.size() < 8 && i % 3) {
+                    PoolItem *p = pool.allocZeroed(0);
+                    if (p) {
+                        p->owner = t;
+                        held.push_back(p);
+                    }
+                } else if (!held.empty()) {
+                    if (held.back()->owner != (uint32_t)t)
+                        corrupted = true;
+                    pool.release(held.back());
+                    held.pop_back();
+                }
+            }
+            for (auto *p : held)
+                pool.release(p);
+        });
+    }
+    for (auto &thread : threads)
+        thread.join();
+
+    TEST_ASSERT_FALSE(corrupted);
+    TEST_ASSERT_EQUAL_UINT32(0, pool.getNumInUse());
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32(32, pool.getHighWaterMark());
+}
+
+void setup()
+{
+    initializeTestEnvironment();
+
+    UNITY_BEGIN();
+    RUN_TEST(test_alloc_until_exhausted);
+    RUN_TEST(test_foreign_pointer_is_ignored);
+    RUN_TEST(test_concurrent_alloc_release);
+    exit(UNITY_END());
+}
+
+void loop() {}
@@ -11,8 +11,35 @@ class TestModule : public MeshModule
     virtual bool wantPacket(const meshtastic_MeshPacket *p) override { return true; }
     using MeshModule::currentRequest;
     using MeshModule::isMultiHopBroadcastRequest;
+    using MeshModule::modulesFor;
 };
 
+// Claims one portnum, like a SinglePortModule
+class PortModule : public MeshModule
+{
+  public:
+    PortModule(meshtastic_PortNum port, bool encrypted = false) : MeshModule("PortModule"), port(port)
+    {
+        encryptedOk = encrypted;
+    }
+    virtual bool wantPacket(const meshtastic_MeshPacket *p) override { return p->decoded.portnum == port; }
+    virtual bool getDispatchPort(meshtastic_PortNum &p) const override
+    {
+        p = port;
+        return true;
+    }
+    meshtastic_PortNum port;
+};
+
+// Position of a module in the list callModules would use, or -1 if it is not there
+static int indexIn(const std::vector<MeshModule *> &list, MeshModule *module)
+{
+    for (size_t i = 0; i < list.size(); i++)
+        if (list[i] == module)
+            return i;
+    return -1;
+}
+
 static TestModule *testModule;
 static meshtastic_MeshPacket testPacket;
 
@@ -98,6 +125,50 @@ static void test_singleHopRelayedBroadcast_isBlocked()
     TEST_ASSERT_TRUE(testModule->isMultiHopBroadcastRequest());
 }
 
+// Modules only see the portnums they claim, modules which claim none see everything, in creation order
+static void test_dispatch_by_portnum()
+{
+    PortModule text(meshtastic_PortNum_TEXT_MESSAGE_APP);
+    PortModule position(meshtastic_PortNum_POSITION_APP, true);
+    TestModule anyPort;
+
+    meshtastic_MeshPacket p = meshtastic_MeshPacket_init_zero;
+    p.which_payload_variant = meshtastic_MeshPacket_decoded_tag;
+
+    p.decoded.portnum = meshtastic_PortNum_TEXT_MESSAGE_APP;
+    auto &forText = TestModule::modulesFor(p);
+    TEST_ASSERT_NOT_EQUAL(-1, indexIn(forText, &text));
+    TEST_ASSERT_EQUAL(-1, indexIn(forText, &position));
+    TEST_ASSERT_LESS_THAN(indexIn(forText, &anyPort), indexIn(forText, testModule));
+    TEST_ASSERT_LESS_THAN(indexIn(forText, &anyPort), indexIn(forText, &text));
+
+    p.decoded.portnum = meshtastic_PortNum_WAYPOINT_APP;
+    auto &forOther = TestModule::modulesFor(p);
+    TEST_ASSERT_EQUAL(-1, indexIn(forOther, &text));
+    TEST_ASSERT_EQUAL(-1, indexIn(forOther, &position));
+    TEST_ASSERT_NOT_EQUAL(-1, indexIn(forOther, &anyPort));
+
+    // Only modules which accept encrypted packets see those
+    p.which_payload_variant = meshtastic_MeshPacket_encrypted_tag;
+    auto &forEncrypted = TestModule::modulesFor(p);
+    TEST_ASSERT_NOT_EQUAL(-1, indexIn(forEncrypted, &position));
+    TEST_ASSERT_EQUAL(-1, indexIn(forEncrypted, &anyPort));
+}
+
+// Modules going away are no longer offered packets
+static void test_dispatch_after_module_removed()
+{
+    meshtastic_MeshPacket p = meshtastic_MeshPacket_init_zero;
+    p.which_payload_variant = meshtastic_MeshPacket_decoded_tag;
+    p.decoded.portnum = meshtastic_PortNum_TEXT_MESSAGE_APP;
+
+    PortModule *text = new PortModule(meshtastic_PortNum_TEXT_MESSAGE_APP);
+    TEST_ASSERT_NOT_EQUAL(-1, indexIn(TestModule::modulesFor(p), text));
+    delete text;
+    TEST_ASSERT_EQUAL(-1, indexIn(TestModule::modulesFor(p), text));
+    TEST_ASSERT_NOT_EQUAL(-1, indexIn(TestModule::modulesFor(p), testModule));
+}
+
 void setup()
 {
     initializeTestEnvironment();
@@ -110,6 +181,8 @@ void setup()
     RUN_TEST(test_noCurrentRequest_isAllowed);
     RUN_TEST(test_legacyPacket_zeroHopStart_isAllowed);
     RUN_TEST(test_singleHopRelayedBroadcast_isBlocked);
+    RUN_TEST(test_dispatch_by_portnum);
+    RUN_TEST(test_dispatch_after_module_removed);
     exit(UNITY_END());
 }
 
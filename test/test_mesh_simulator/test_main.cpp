@@ -0,0 +1,155 @@
+#include "TestUtil.h"
+#include "platform/portduino/MeshSimulator.h"
+#include <unity.h>
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+/// Nodes in a line, each only hearing its neighbours
+static void addLine(MeshSimulator &sim, size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        sim.addNode();
+        if (i > 0)
+            sim.setLink(i - 1, i, 5);
+    }
+}
+
+static void test_flood_follows_hop_limit()
+{
+    MeshSimulator sim;
+    addLine(sim, 4);
+    sim.sendPacket(0, 0, NODENUM_BROADCAST, 3);
+    sim.run();
+    TEST_ASSERT_EQUAL_UINT32(3, sim.getStats().wanted);
+    TEST_ASSERT_EQUAL_UINT32(3, sim.getStats().delivered);
+    // The original and one relay by each other node, the last one with hop limit 0
+    TEST_ASSERT_EQUAL_UINT32(4, sim.getStats().transmissions);
+    TEST_ASSERT_EQUAL_UINT32(0, sim.getStats().collisions);
+
+    MeshSimulator shortHops;
+    addLine(shortHops, 4);
+    shortHops.sendPacket(0, 0, NODENUM_BROADCAST, 1);
+    shortHops.run();
+    TEST_ASSERT_EQUAL_UINT32(2, shortHops.getStats().delivered);
+    TEST_ASSERT_EQUAL_UINT32(2, shortHops.getStats().transmissions);
+}
+
+static void test_relay_canceled_when_heard()
+{
+    MeshSimulator sim;
+    for (size_t i = 0; i < 3; i++)
+        sim.addNode();
+    sim.setLink(0, 1, 5);
+    sim.setLink(0, 2, 5);
+    sim.setLink(1, 2, 5);
+    sim.sendPacket(0, 0, NODENUM_BROADCAST);
+    sim.run();
+    TEST_ASSERT_EQUAL_UINT32(2, sim.getStats().delivered);
+    TEST_ASSERT_EQUAL_UINT32(2, sim.getStats().transmissions);
+    TEST_ASSERT_EQUAL_UINT32(1, sim.getStats().relaysCanceled);
+}
+
+static void test_hidden_terminals_collide()
+{
+    // 0 and 2 can't hear each other, so both transmit over each other at 1
+    MeshSimulator sim;
+    addLine(sim, 3);
+    sim.sendPacket(0, 0, NODENUM_BROADCAST, 0);
+    sim.sendPacket(0, 2, NODENUM_BROADCAST, 0);
+    sim.run();
+    TEST_ASSERT_EQUAL_UINT32(2, sim.getStats().collisions);
+    TEST_ASSERT_EQUAL_UINT32(0, sim.getStats().receptions);
+
+    // Unless one is strong enough to capture the receiver
+    MeshSimulator capture;
+    for (size_t i = 0; i < 3; i++)
+        capture.addNode();
+    capture.setLink(0, 1, 10);
+    capture.setLink(1, 2, -5);
+    capture.sendPacket(0, 0, NODENUM_BROADCAST, 0);
+    capture.sendPacket(0, 2, NODENUM_BROADCAST, 0);
+    capture.run();
+    TEST_ASSERT_EQUAL_UINT32(1, capture.getStats().collisions);
+    TEST_ASSERT_EQUAL_UINT32(1, capture.getStats().receptions);
+}
+
+static void test_direct_message_learns_next_hop()
+{
+    // 0 - 1 - 2, plus 3 which only hears 0 and would flood for nothing
+    MeshSimulator sim;
+    addLine(sim, 3);
+    sim.addNode();
+    sim.setLink(0, 3, -5);
+    NodeNum dest = sim.getNodeNum(2);
+
+    sim.sendPacket(0, 0, dest);
+    sim.run();
+    TEST_ASSERT_EQUAL_UINT32(1, sim.getStats().delivered);
+    TEST_ASSERT_EQUAL_UINT32(1, sim.getStats().acksSent);
+    uint32_t floodTransmissions = sim.getStats().transmissions;
+
+    // Now only 1 relays it
+    sim.sendPacket(sim.now() + 60000, 0, dest);
+    sim.run();
+    TEST_ASSERT_EQUAL_UINT32(2, sim.getStats().delivered);
+    TEST_ASSERT_EQUAL_UINT32(floodTransmissions - 1, sim.getStats().transmissions - floodTransmissions);
+}
+
+static void test_deterministic()
+{
+    MeshSimulator::Stats stats[2];
+    for (auto &s : stats) {
+        MeshSimulator sim(42);
+        sim.addRandomNodes(30, 8, 0.1);
+        for (size_t i = 0; i < 30; i++)
+            sim.sendPacket(i * 5000, i, NODENUM_BROADCAST);
+        sim.run();
+        s = sim.getStats();
+    }
+    TEST_ASSERT_GREATER_THAN_UINT32(0, stats[0].delivered);
+    TEST_ASSERT_EQUAL_UINT32(stats[0].transmissions, stats[1].transmissions);
+    TEST_ASSERT_EQUAL_UINT32(stats[0].delivered, stats[1].delivered);
+    TEST_ASSERT_EQUAL_UINT32(stats[0].collisions, stats[1].collisions);
+    TEST_ASSERT_EQUAL_UINT32(stats[0].latencyMsecMax, stats[1].latencyMsecMax);
+}
+
+static void test_adaptive_window_cuts_relays()
+{
+    MeshSimulator::Stats stats[2];
+    for (bool adaptive : {false, true}) {
+        MeshSimulator sim(7);
+        sim.setAdaptiveContentionWindow(adaptive);
+        sim.addRandomNodes(60, 8);
+        for (uint32_t i = 0; i < 240; i++)
+            sim.sendPacket(i * 2500, i % 60, NODENUM_BROADCAST);
+        sim.run();
+        stats[adaptive] = sim.getStats();
+    }
+    TEST_ASSERT_EQUAL_UINT32(0, stats[0].rebroadcastCWWidened);
+    TEST_ASSERT_GREATER_THAN_UINT32(0, stats[1].rebroadcastCWWidened);
+    TEST_ASSERT_LESS_THAN_UINT32(stats[0].transmissions, stats[1].transmissions);
+    TEST_ASSERT_LESS_THAN_UINT32(stats[0].collisions, stats[1].collisions);
+    // Once per relay that got to the front of its queue, however often a busy channel made it wait again
+    for (auto &s : stats) {
+        TEST_ASSERT_GREATER_THAN_UINT32(0, s.rebroadcastCWCount);
+        TEST_ASSERT_LESS_OR_EQUAL(s.transmissions - s.packetsSent + s.relaysCanceled, s.rebroadcastCWCount);
+    }
+}
+
+void setup()
+{
+    initializeTestEnvironment();
+
+    UNITY_BEGIN();
+    RUN_TEST(test_flood_follows_hop_limit);
+    RUN_TEST(test_relay_canceled_when_heard);
+    RUN_TEST(test_hidden_terminals_collide);
+    RUN_TEST(test_direct_message_learns_next_hop);
+    RUN_TEST(test_deterministic);
+    RUN_TEST(test_adaptive_window_cuts_relays);
+    exit(UNITY_END());
+}
+
+void loop() {}
@@ -0,0 +1,237 @@
+#include "../test_helpers.h"
+#include <chrono>
+
+// The buffer version must produce exactly the text of the std::string version
+static void assert_streaming_matches(const meshtastic_MeshPacket &packet)
+{
+    char buf[MESHPACKET_JSON_BUFFER_SIZE];
+    std::string expected = MeshPacketSerializer::JsonSerialize(&packet, false);
+    size_t len = MeshPacketSerializer::JsonSerialize(&packet, buf, sizeof(buf), false);
+
+    TEST_ASSERT_EQUAL(expected.length(), len);
+    TEST_ASSERT_EQUAL_STRING(expected.c_str(), buf);
+}
+
+template <typename T> static size_t encode(const pb_msgdesc_t *fields, const T &msg, uint8_t *buffer, size_t buffer_size)
+{
+    pb_ostream_t stream = pb_ostream_from_buffer(buffer, buffer_size);
+    pb_encode(&stream, fields, &msg);
+    return stream.bytes_written;
+}
+
+void test_streaming_text_message()
+{
+    const char *texts[] = {"Hello Meshtastic!", "Quotes \" and \\ backslashes / slashes\n\ttabs", "",
+                           "{\"nested\": [1, 2.5, true, null, \"x\"]}"};
+    for (const char *text : texts) {
+        meshtastic_MeshPacket packet = create_test_packet(meshtastic_PortNum_TEXT_MESSAGE_APP,
+                                                          reinterpret_cast<const uint8_t *>(text), strlen(text));
+        assert_streaming_matches(packet);
+    }
+}
+
+void test_streaming_position()
+{
+    meshtastic_Position position = meshtastic_Position_init_zero;
+    position.latitude_i = 374208000;
+    position.longitude_i = -1221981000;
+    position.altitude = 123;
+    position.has_altitude = true;
+    position.time = 1609459200;
+    position.PDOP = 150;
+    position.sats_in_view = 9;
+    position.precision_bits = 32;
+
+    uint8_t buffer[256];
+    size_t payload_size = encode(&meshtastic_Position_msg, position, buffer, sizeof(buffer));
+    assert_streaming_matches(create_test_packet(meshtastic_PortNum_POSITION_APP, buffer, payload_size));
+}
+
+void test_streaming_nodeinfo()
+{
+    meshtastic_User user = meshtastic_User_init_zero;
+    strcpy(user.short_name, "TEST");
+    strcpy(user.long_name, "Test User");
+    strcpy(user.id, "!12345678");
+    user.hw_model = meshtastic_HardwareModel_HELTEC_V3;
+    user.role = meshtastic_Config_DeviceConfig_Role_ROUTER;
+
+    uint8_t buffer[256];
+    size_t payload_size = encode(&meshtastic_User_msg, user, buffer, sizeof(buffer));
+    assert_streaming_matches(create_test_packet(meshtastic_PortNum_NODEINFO_APP, buffer, payload_size));
+}
+
+void test_streaming_waypoint()
+{
+    meshtastic_Waypoint waypoint = meshtastic_Waypoint_init_zero;
+    waypoint.id = 12345;
+    strcpy(waypoint.name, "Camp");
+    strcpy(waypoint.description, "Base camp");
+    waypoint.latitude_i = 374208000;
+    waypoint.longitude_i = -1221981000;
+    waypoint.expire = 1700000000;
+
+    uint8_t buffer[256];
+    size_t payload_size = encode(&meshtastic_Waypoint_msg, waypoint, buffer, sizeof(buffer));
+    assert_streaming_matches(create_test_packet(meshtastic_PortNum_WAYPOINT_APP, buffer, payload_size));
+}
+
+void test_streaming_telemetry()
+{
+    uint8_t buffer[256];
+
+    meshtastic_Telemetry device = meshtastic_Telemetry_init_zero;
+    device.which_variant = meshtastic_Telemetry_device_metrics_tag;
+    device.variant.device_metrics.has_battery_level = true;
+    device.variant.device_metrics.battery_level = 85;
+    device.variant.device_metrics.voltage = 3.72f;
+    device.variant.device_metrics.channel_utilization = 15.56f;
+    device.variant.device_metrics.air_util_tx = 8.23f;
+    device.variant.device_metrics.uptime_seconds = 12345;
+    size_t payload_size = encode(&meshtastic_Telemetry_msg, device, buffer, sizeof(buffer));
+    assert_streaming_matches(create_test_packet(meshtastic_PortNum_TELEMETRY_APP, buffer, payload_size));
+
+    meshtastic_Telemetry env = meshtastic_Telemetry_init_zero;
+    env.which_variant = meshtastic_Telemetry_environment_metrics_tag;
+    meshtastic_EnvironmentMetrics &m = env.variant.environment_metrics;
+    m.has_temperature = true;
+    m.temperature = -12.75f;
+    m.has_relative_humidity = true;
+    m.relative_humidity = 65.5f;
+    m.has_barometric_pressure = true;
+    m.barometric_pressure = 1013.25f;
+    m.has_iaq = true;
+    m.iaq = 42;
+    m.has_wind_direction = true;
+    m.wind_direction = 270;
+    m.has_wind_speed = true;
+    m.wind_speed = 3.3f;
+    m.has_soil_moisture = true;
+    m.soil_moisture = 30;
+    m.has_rainfall_24h = true;
+    m.rainfall_24h = 0.1f;
+    payload_size = encode(&meshtastic_Telemetry_msg, env, buffer, sizeof(buffer));
+    assert_streaming_matches(create_test_packet(meshtastic_PortNum_TELEMETRY_APP, buffer, payload_size));
+}
+
+void test_streaming_neighborinfo()
+{
+    meshtastic_NeighborInfo info = meshtastic_NeighborInfo_init_zero;
+    info.node_id = 0x11223344;
+    info.node_broadcast_interval_secs = 900;
+    info.neighbors_count = 2;
+    info.neighbors[0].node_id = 0xaabbccdd;
+    info.neighbors[0].snr = 6.25f;
+    info.neighbors[1].node_id = 0x01020304;
+    info.neighbors[1].snr = -3.5f;
+
+    uint8_t buffer[256];
+    size_t payload_size = encode(&meshtastic_NeighborInfo_msg, info, buffer, sizeof(buffer));
+    assert_streaming_matches(create_test_packet(meshtastic_PortNum_NEIGHBORINFO_APP, buffer, payload_size));
+}
+
+void test_streaming_header_variants()
+{
+    // No rssi/snr, unknown hop start and an encrypted payload leave members out
+    meshtastic_MeshPacket packet = create_test_packet(meshtastic_PortNum_TEXT_MESSAGE_APP, nullptr, 0);
+    packet.rx_rssi = 0;
+    packet.rx_snr = 0;
+    packet.hop_start = 0;
+    assert_streaming_matches(packet);
+
+    const uint8_t encrypted[] = {0xde, 0xad, 0xbe, 0xef};
+    assert_streaming_matches(create_test_packet(meshtastic_PortNum_TEXT_MESSAGE_APP, encrypted, sizeof(encrypted),
+                                                meshtastic_MeshPacket_encrypted_tag));
+}
+
+void test_streaming_overflow()
+{
+    const char *text = "Hello Meshtastic!";
+    meshtastic_MeshPacket packet =
+        create_test_packet(meshtastic_PortNum_TEXT_MESSAGE_APP, reinterpret_cast<const uint8_t *>(text), strlen(text));
+    std::string expected = MeshPacketSerializer::JsonSerialize(&packet, false);
+
+    // One byte short of room for the terminator must fail, an exact fit must not
+    char buf[MESHPACKET_JSON_BUFFER_SIZE];
+    TEST_ASSERT_EQUAL(0, MeshPacketSerializer::JsonSerialize(&packet, buf, expected.length(), false));
+    TEST_ASSERT_TRUE(strlen(buf) < expected.length());
+    TEST_ASSERT_EQUAL(expected.length(), MeshPacketSerializer::JsonSerialize(&packet, buf, expected.length() + 1, false));
+    TEST_ASSERT_EQUAL_STRING(expected.c_str(), buf);
+}
+
+void test_streaming_escaping()
+{
+    // UTF-8 (2 and 4 byte sequences) is copied as is, control characters become \u escapes
+    const char *text = "Gr\xc3\xbc\xc3\x9f \xf0\x9f\x91\x8b \x01\x1f\x7f \"\\/\b\f\n\r\t";
+    meshtastic_MeshPacket packet =
+        create_test_packet(meshtastic_PortNum_TEXT_MESSAGE_APP, reinterpret_cast<const uint8_t *>(text), strlen(text));
+    assert_streaming_matches(packet);
+
+    std::string json = MeshPacketSerializer::JsonSerialize(&packet, false);
+    const char *expected =
+        "\"payload\":{\"text\":\"Gr\xc3\xbc\xc3\x9f \xf0\x9f\x91\x8b \\u0001\\u001f\\u007f \\\"\\\\\\/\\b\\f\\n\\r\\t\"}";
+    TEST_ASSERT_NOT_NULL_MESSAGE(strstr(json.c_str(), expected), json.c_str());
+}
+
+/// The packet JSON as a tree of JSONValues, the way JsonSerialize built it before it used JSONWriter
+static std::string serializeTelemetryAsTree(const meshtastic_MeshPacket &packet, const meshtastic_EnvironmentMetrics &m)
+{
+    JSONObject payload;
+    payload["temperature"] = new JSONValue(m.temperature);
+    payload["relative_humidity"] = new JSONValue(m.relative_humidity);
+    payload["barometric_pressure"] = new JSONValue(m.barometric_pressure);
+
+    JSONObject jsonObj;
+    jsonObj["payload"] = new JSONValue(payload);
+    jsonObj["id"] = new JSONValue((unsigned int)packet.id);
+    jsonObj["timestamp"] = new JSONValue((unsigned int)packet.rx_time);
+    jsonObj["to"] = new JSONValue((unsigned int)packet.to);
+    jsonObj["from"] = new JSONValue((unsigned int)packet.from);
+    jsonObj["channel"] = new JSONValue((unsigned int)packet.channel);
+    jsonObj["type"] = new JSONValue("telemetry");
+    jsonObj["sender"] = new JSONValue("!12345678");
+    jsonObj["rssi"] = new JSONValue((int)packet.rx_rssi);
+    jsonObj["snr"] = new JSONValue((float)packet.rx_snr);
+    jsonObj["hops_away"] = new JSONValue(0u);
+    jsonObj["hop_start"] = new JSONValue((unsigned int)packet.hop_start);
+
+    JSONValue *value = new JSONValue(jsonObj);
+    std::string json = value->Stringify();
+    delete value;
+    return json;
+}
+
+// Cost of an MQTT JSON publish with JSONWriter against the JSONValue tree it replaced. Only printed, timings on shared CI
+// runners are too noisy to assert on.
+void test_streaming_benchmark()
+{
+    meshtastic_Telemetry env = meshtastic_Telemetry_init_zero;
+    env.which_variant = meshtastic_Telemetry_environment_metrics_tag;
+    env.variant.environment_metrics.has_temperature = true;
+    env.variant.environment_metrics.temperature = 21.5f;
+    env.variant.environment_metrics.has_relative_humidity = true;
+    env.variant.environment_metrics.relative_humidity = 45.25f;
+    env.variant.environment_metrics.has_barometric_pressure = true;
+    env.variant.environment_metrics.barometric_pressure = 1013.25f;
+    uint8_t payload[256];
+    size_t payload_size = encode(&meshtastic_Telemetry_msg, env, payload, sizeof(payload));
+    meshtastic_MeshPacket packet = create_test_packet(meshtastic_PortNum_TELEMETRY_APP, payload, payload_size);
+
+    const int iterations = 20000;
+    size_t sink = 0;
+    char buf[MESHPACKET_JSON_BUFFER_SIZE];
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++)
+        sink += serializeTelemetryAsTree(packet, env.variant.environment_metrics).length();
+    auto treeNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++)
+        sink += MeshPacketSerializer::JsonSerialize(&packet, buf, sizeof(buf), false);
+    auto streamNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+    printf("JsonSerialize telemetry: JSONValue %8.1f ns/packet, streaming %8.1f ns/packet\n", (double)treeNs / iterations,
+           (double)streamNs / iterations);
+    TEST_ASSERT_GREATER_THAN(0, sink);
+}
@@ -19,6 +19,16 @@ void test_telemetry_environment_metrics_complete_coverage();
 void test_telemetry_environment_metrics_unset_fields();
 void test_encrypted_packet_serialization();
 void test_empty_encrypted_packet();
+void test_streaming_text_message();
+void test_streaming_position();
+void test_streaming_nodeinfo();
+void test_streaming_waypoint();
+void test_streaming_telemetry();
+void test_streaming_neighborinfo();
+void test_streaming_header_variants();
+void test_streaming_overflow();
+void test_streaming_escaping();
+void test_streaming_benchmark();
 
 void setup()
 {
@@ -52,6 +62,18 @@ void setup()
     RUN_TEST(test_encrypted_packet_serialization);
     RUN_TEST(test_empty_encrypted_packet);
 
+    // Streaming serializer tests
+    RUN_TEST(test_streaming_text_message);
+    RUN_TEST(test_streaming_position);
+    RUN_TEST(test_streaming_nodeinfo);
+    RUN_TEST(test_streaming_waypoint);
+    RUN_TEST(test_streaming_telemetry);
+    RUN_TEST(test_streaming_neighborinfo);
+    RUN_TEST(test_streaming_header_variants);
+    RUN_TEST(test_streaming_overflow);
+    RUN_TEST(test_streaming_escaping);
+    RUN_TEST(test_streaming_benchmark);
+
     UNITY_END();
 }
 
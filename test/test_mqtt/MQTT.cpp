@@ -261,7 +261,7 @@ class MQTTUnitTest : public MQTT
     }
     using MQTT::isValidConfig;
     using MQTT::reconnect;
-    int queueSize() { return mqttQueue.numUsed(); }
+    int queueSize() { return mqttQueue.size(); }
     void reportToMap(std::optional<uint32_t> precision = std::nullopt)
     {
         if (precision.has_value())
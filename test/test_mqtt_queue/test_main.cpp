@@ -0,0 +1,137 @@
+#include "MeshTypes.h"
+#include "TestUtil.h"
+#include "mqtt/MQTTQueue.h"
+#include <string.h>
+#include <unity.h>
+
+static MQTTQueue::Entry makeEntry(MQTTQueue::Priority priority, uint8_t tag, size_t envLength = 100)
+{
+    MQTTQueue::Entry entry;
+    entry.topic = "msh/2/e/LongFast/!12345678";
+    entry.envBytes.assign(envLength, tag);
+    entry.priority = priority;
+    return entry;
+}
+
+static uint8_t popTag(MQTTQueue &queue)
+{
+    MQTTQueue::Entry entry;
+    TEST_ASSERT_TRUE(queue.pop(entry));
+    return entry.envBytes[0];
+}
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+static void test_classify()
+{
+    meshtastic_MeshPacket p = meshtastic_MeshPacket_init_zero;
+    p.to = NODENUM_BROADCAST;
+    p.which_payload_variant = meshtastic_MeshPacket_decoded_tag;
+
+    p.decoded.portnum = meshtastic_PortNum_TEXT_MESSAGE_APP;
+    TEST_ASSERT_EQUAL(MQTTQueue::PRIORITY_HIGH, MQTTQueue::classify(p));
+    p.decoded.portnum = meshtastic_PortNum_TELEMETRY_APP;
+    TEST_ASSERT_EQUAL(MQTTQueue::PRIORITY_LOW, MQTTQueue::classify(p));
+    p.decoded.portnum = meshtastic_PortNum_WAYPOINT_APP;
+    TEST_ASSERT_EQUAL(MQTTQueue::PRIORITY_NORMAL, MQTTQueue::classify(p));
+    // Direct message
+    p.to = 0x1234;
+    TEST_ASSERT_EQUAL(MQTTQueue::PRIORITY_HIGH, MQTTQueue::classify(p));
+
+    // Could not decode it
+    p.which_payload_variant = meshtastic_MeshPacket_encrypted_tag;
+    TEST_ASSERT_EQUAL(MQTTQueue::PRIORITY_NORMAL, MQTTQueue::classify(p));
+    p.pki_encrypted = true;
+    TEST_ASSERT_EQUAL(MQTTQueue::PRIORITY_HIGH, MQTTQueue::classify(p));
+}
+
+static void test_highest_priority_first()
+{
+    MQTTQueue queue;
+    TEST_ASSERT_TRUE(queue.push(makeEntry(MQTTQueue::PRIORITY_LOW, 1)));
+    TEST_ASSERT_TRUE(queue.push(makeEntry(MQTTQueue::PRIORITY_HIGH, 2)));
+    TEST_ASSERT_TRUE(queue.push(makeEntry(MQTTQueue::PRIORITY_NORMAL, 3)));
+    TEST_ASSERT_TRUE(queue.push(makeEntry(MQTTQueue::PRIORITY_HIGH, 4)));
+    TEST_ASSERT_EQUAL(4, queue.size());
+
+    TEST_ASSERT_EQUAL(2, popTag(queue));
+    TEST_ASSERT_EQUAL(4, popTag(queue));
+    TEST_ASSERT_EQUAL(3, popTag(queue));
+
+    // Put back after a failed publish, it comes out next
+    TEST_ASSERT_TRUE(queue.push(makeEntry(MQTTQueue::PRIORITY_NORMAL, 5)));
+    queue.pushFront(makeEntry(MQTTQueue::PRIORITY_NORMAL, 6));
+    TEST_ASSERT_EQUAL(6, popTag(queue));
+    TEST_ASSERT_EQUAL(5, popTag(queue));
+    TEST_ASSERT_EQUAL(1, popTag(queue));
+
+    MQTTQueue::Entry entry;
+    TEST_ASSERT_FALSE(queue.pop(entry));
+    TEST_ASSERT_TRUE(queue.isEmpty());
+    TEST_ASSERT_EQUAL(0, queue.bytes());
+}
+
+static void test_budget_drops_least_important()
+{
+    const size_t cost = makeEntry(MQTTQueue::PRIORITY_LOW, 0).cost();
+    MQTTQueue queue(cost * 3);
+
+    TEST_ASSERT_TRUE(queue.push(makeEntry(MQTTQueue::PRIORITY_LOW, 1)));
+    TEST_ASSERT_TRUE(queue.push(makeEntry(MQTTQueue::PRIORITY_HIGH, 2)));
+    TEST_ASSERT_TRUE(queue.push(makeEntry(MQTTQueue::PRIORITY_LOW, 3)));
+
+    // Full: the oldest low priority message makes room for a high one
+    TEST_ASSERT_FALSE(queue.push(makeEntry(MQTTQueue::PRIORITY_HIGH, 4)));
+    TEST_ASSERT_EQUAL(3, queue.size());
+    TEST_ASSERT_LESS_OR_EQUAL(cost * 3, queue.bytes());
+
+    // Then the other one
+    TEST_ASSERT_FALSE(queue.push(makeEntry(MQTTQueue::PRIORITY_NORMAL, 5)));
+
+    // A low priority message is refused rather than replacing a more important one
+    TEST_ASSERT_FALSE(queue.push(makeEntry(MQTTQueue::PRIORITY_LOW, 6)));
+    TEST_ASSERT_EQUAL(3, queue.getDropped());
+
+    TEST_ASSERT_EQUAL(2, popTag(queue));
+    TEST_ASSERT_EQUAL(4, popTag(queue));
+    TEST_ASSERT_EQUAL(5, popTag(queue));
+    TEST_ASSERT_TRUE(queue.isEmpty());
+}
+
+static void test_record_round_trip()
+{
+    uint8_t buf[MQTTQueue::MAX_RECORD_SIZE];
+    MQTTQueue::Entry entry = makeEntry(MQTTQueue::PRIORITY_HIGH, 7, 300);
+    size_t len = MQTTQueue::encodeRecord(entry, buf, sizeof(buf));
+    TEST_ASSERT_EQUAL(MQTTQueue::RECORD_OVERHEAD + entry.topic.size() + 300, len);
+
+    MQTTQueue::Entry decoded;
+    TEST_ASSERT_EQUAL(len, MQTTQueue::decodeRecord(buf, len, decoded));
+    TEST_ASSERT_EQUAL(MQTTQueue::PRIORITY_HIGH, decoded.priority);
+    TEST_ASSERT_EQUAL_STRING(entry.topic.c_str(), decoded.topic.c_str());
+    TEST_ASSERT_TRUE(entry.envBytes == decoded.envBytes);
+
+    // Cut short, or damaged
+    TEST_ASSERT_EQUAL(0, MQTTQueue::decodeRecord(buf, len - 1, decoded));
+    buf[len - 10] ^= 0x01;
+    TEST_ASSERT_EQUAL(0, MQTTQueue::decodeRecord(buf, len, decoded));
+
+    // Does not fit
+    TEST_ASSERT_EQUAL(0, MQTTQueue::encodeRecord(entry, buf, len - 1));
+}
+
+void setup()
+{
+    initializeTestEnvironment();
+
+    UNITY_BEGIN();
+    RUN_TEST(test_classify);
+    RUN_TEST(test_highest_priority_first);
+    RUN_TEST(test_budget_drops_least_important);
+    RUN_TEST(test_record_round_trip);
+    exit(UNITY_END());
+}
+
+void loop() {}
@@ -0,0 +1,156 @@
+#include "TestUtil.h"
+#include "gps/NMEAFramer.h"
+#include <algorithm>
+#include <stdio.h>
+#include <string>
+#include <unity.h>
+#include <vector>
+
+struct Framed {
+    std::string text;
+    NMEAFramer::SentenceType type;
+    bool inChunk; // passed as a pointer into the chunk rather than copied
+};
+
+static NMEAFramer *framer;
+static std::vector<Framed> framed;
+
+// body is what goes between the '$' and the '*'
+static std::string sentence(const std::string &body)
+{
+    uint8_t checksum = 0;
+    for (char c : body)
+        checksum ^= c;
+    char tail[8];
+    snprintf(tail, sizeof(tail), "*%02X\r\n", checksum);
+    return "$" + body + tail;
+}
+
+static void feed(const std::string &bytes, size_t chunkSize)
+{
+    for (size_t pos = 0; pos < bytes.size(); pos += chunkSize) {
+        const uint8_t *chunk = (const uint8_t *)bytes.data() + pos;
+        size_t length = std::min(chunkSize, bytes.size() - pos);
+        framer->feed(chunk, length, [&](const NMEAFramer::Sentence &s) {
+            bool inChunk = (const uint8_t *)s.text >= chunk && (const uint8_t *)s.text + s.length <= chunk + length;
+            framed.push_back({std::string(s.text, s.length), s.type, inChunk});
+        });
+    }
+}
+
+static const std::string GGA = sentence("GPGGA,092750.000,5321.6802,N,00630.3372,W,1,8,1.03,61.7,M,55.2,M,,");
+static const std::string RMC = sentence("GNRMC,092750.000,A,5321.6802,N,00630.3372,W,0.02,31.66,280511,,,A");
+static const std::string GSA = sentence("GNGSA,A,3,10,07,05,02,29,04,08,13,,,,,1.72,1.03,1.38");
+static const std::string GSV = sentence("GPGSV,3,1,11,10,63,137,17,07,61,098,15,05,59,290,20,08,54,157,30");
+static const std::string TXT = "$GPTXT,01,01,02,u-blox ag - www.u-blox.com*50\r\n";
+
+void setUp(void)
+{
+    delete framer;
+    framer = new NMEAFramer();
+    framed.clear();
+}
+
+void tearDown(void) {}
+
+static void test_sentences_are_typed_and_not_copied()
+{
+    feed(GGA + RMC + GSA + GSV + TXT, 4096);
+
+    TEST_ASSERT_EQUAL(5, framed.size());
+    TEST_ASSERT_EQUAL(NMEAFramer::NMEA_GGA, framed[0].type);
+    TEST_ASSERT_EQUAL(NMEAFramer::NMEA_RMC, framed[1].type);
+    TEST_ASSERT_EQUAL(NMEAFramer::NMEA_GSA, framed[2].type);
+    TEST_ASSERT_EQUAL(NMEAFramer::NMEA_OTHER, framed[3].type);
+    TEST_ASSERT_EQUAL(NMEAFramer::NMEA_TXT, framed[4].type);
+    // Without the CR LF
+    TEST_ASSERT_EQUAL_STRING(GGA.substr(0, GGA.size() - 2).c_str(), framed[0].text.c_str());
+    TEST_ASSERT_EQUAL_STRING("$GPTXT,01,01,02,u-blox ag - www.u-blox.com*50", framed[4].text.c_str());
+    for (const Framed &f : framed)
+        TEST_ASSERT_TRUE(f.inChunk);
+    TEST_ASSERT_EQUAL_UINT32(5, framer->getPassedChecksum());
+    TEST_ASSERT_EQUAL_UINT32(0, framer->getFailedChecksum());
+}
+
+static void test_bad_sentences_are_dropped()
+{
+    std::string corrupted = GGA;
+    corrupted[10] ^= 1;
+    std::string noChecksum = "$GPGGA,092750.000,5321.6802,N\r\n";
+    std::string cutShort = RMC.substr(0, 30) + "\r\n";
+    std::string tooLong = sentence("GPGSV," + std::string(NMEA_MAX_SENTENCE, '1'));
+    feed(corrupted + noChecksum + cutShort + tooLong + "\r\n\r\n" + RMC, 4096);
+
+    TEST_ASSERT_EQUAL(1, framed.size());
+    TEST_ASSERT_EQUAL(NMEAFramer::NMEA_RMC, framed[0].type);
+    TEST_ASSERT_EQUAL_UINT32(1, framer->getFailedChecksum());
+}
+
+static void test_any_chunking_gives_the_same_sentences()
+{
+    std::string stream;
+    for (int i = 0; i < 20; i++)
+        stream += GGA + GSV + RMC + GSA;
+
+    feed(stream, stream.size());
+    std::vector<Framed> whole = framed;
+    TEST_ASSERT_EQUAL(80, whole.size());
+
+    for (size_t chunkSize : {1, 2, 7, 64, 100}) {
+        setUp();
+        feed(stream, chunkSize);
+        TEST_ASSERT_EQUAL(whole.size(), framed.size());
+        bool copied = false;
+        for (size_t i = 0; i < whole.size(); i++) {
+            TEST_ASSERT_EQUAL_STRING(whole[i].text.c_str(), framed[i].text.c_str());
+            copied |= !framed[i].inChunk;
+        }
+        // Sentences split across chunks had to be copied
+        TEST_ASSERT_TRUE(copied);
+    }
+}
+
+static void test_ubx_frames_are_skipped()
+{
+    // A UBX-NAV frame whose payload happens to hold '$', '*' and line ends
+    std::string ubx = "\xb5\x62\x01\x07";
+    std::string payload = "$GPGGA,*00\r\n" + std::string(80, '\0');
+    ubx += (char)payload.size();
+    ubx += (char)0;
+    ubx += payload + "\x12\x34";
+    std::string stream = GGA + ubx + RMC + ubx + ubx + GSA;
+
+    for (size_t chunkSize : {1, 5, 4096}) {
+        setUp();
+        feed(stream, chunkSize);
+        TEST_ASSERT_EQUAL(3, framed.size());
+        TEST_ASSERT_EQUAL(NMEAFramer::NMEA_GGA, framed[0].type);
+        TEST_ASSERT_EQUAL(NMEAFramer::NMEA_RMC, framed[1].type);
+        TEST_ASSERT_EQUAL(NMEAFramer::NMEA_GSA, framed[2].type);
+        TEST_ASSERT_EQUAL_UINT32(0, framer->getFailedChecksum());
+    }
+}
+
+static void test_reset_drops_partial_sentence()
+{
+    feed(GGA.substr(0, 20), 4096);
+    framer->reset();
+    feed(GGA.substr(20) + RMC, 4096);
+    TEST_ASSERT_EQUAL(1, framed.size());
+    TEST_ASSERT_EQUAL(NMEAFramer::NMEA_RMC, framed[0].type);
+}
+
+void setup()
+{
+    initializeTestEnvironment();
+
+    UNITY_BEGIN();
+    RUN_TEST(test_sentences_are_typed_and_not_copied);
+    RUN_TEST(test_bad_sentences_are_dropped);
+    RUN_TEST(test_any_chunking_gives_the_same_sentences);
+    RUN_TEST(test_ubx_frames_are_skipped);
+    RUN_TEST(test_reset_drops_partial_sentence);
+    exit(UNITY_END());
+}
+
+void loop() {}
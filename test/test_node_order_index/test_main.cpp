@@ -0,0 +1,150 @@
+#include "NodeOrderIndex.h"
+#include "TestUtil.h"
+#include <algorithm>
+#include <random>
+#include <unity.h>
+#include <vector>
+
+static const NodeNum OUR_NODE = 0x11223344;
+
+static std::vector<meshtastic_NodeInfoLite> nodes;
+static NodeOrderIndex nodeOrder;
+
+// Our node first, then distinct last_heard values with every fifth node a favorite
+static void fillNodes(size_t count, size_t capacity)
+{
+    nodes.assign(capacity, meshtastic_NodeInfoLite());
+    for (size_t i = 0; i < count; i++) {
+        nodes[i].num = i == 0 ? OUR_NODE : 0xa0b00000 + (uint32_t)(i * 7919);
+        nodes[i].last_heard = 1000 + (uint32_t)((i * 7) % count);
+        nodes[i].is_favorite = i % 5 == 2;
+    }
+    nodeOrder.rebuild(&nodes, count, OUR_NODE);
+}
+
+// Display order of the given positions, sorted from scratch
+static std::vector<uint16_t> expectedOrder(std::vector<uint16_t> positions)
+{
+    std::stable_sort(positions.begin(), positions.end(), [](uint16_t a, uint16_t b) { return nodeOrder.before(a, b); });
+    return positions;
+}
+
+static void assertOrder(const std::vector<uint16_t> &expected)
+{
+    TEST_ASSERT_EQUAL_UINT32(expected.size(), nodeOrder.size());
+    for (size_t i = 0; i < expected.size(); i++)
+        TEST_ASSERT_EQUAL_UINT16(expected[i], nodeOrder.at(i));
+    TEST_ASSERT_EQUAL_UINT16(NodeOrderIndex::NOT_FOUND, nodeOrder.at(expected.size()));
+}
+
+void setUp(void)
+{
+    nodes.clear();
+    nodeOrder.rebuild(nullptr, 0, 0);
+}
+
+void tearDown(void) {}
+
+static void test_rebuild_sorts_our_node_then_favorites_then_recent()
+{
+    fillNodes(50, 60);
+    std::vector<uint16_t> all;
+    for (uint16_t i = 0; i < 50; i++)
+        all.push_back(i);
+    assertOrder(expectedOrder(all));
+
+    TEST_ASSERT_EQUAL_UINT16(0, nodeOrder.at(0));
+    TEST_ASSERT_TRUE(nodes[nodeOrder.at(1)].is_favorite);
+    TEST_ASSERT_FALSE(nodes[nodeOrder.at(49)].is_favorite);
+}
+
+static void test_equal_nodes_keep_storage_order()
+{
+    fillNodes(20, 20);
+    for (auto &node : nodes) {
+        node.last_heard = 5;
+        node.is_favorite = false;
+    }
+    nodeOrder.rebuild(&nodes, 20, OUR_NODE);
+    for (uint16_t i = 0; i < 20; i++)
+        TEST_ASSERT_EQUAL_UINT16(i, nodeOrder.at(i));
+}
+
+static void test_updates_match_full_sort()
+{
+    fillNodes(100, 120);
+    std::vector<uint16_t> present;
+    for (uint16_t i = 0; i < 100; i++)
+        present.push_back(i);
+
+    std::mt19937 rng(3);
+    uint32_t now = 5000, older = 999;
+    for (int step = 0; step < 2000; step++) {
+        uint16_t pos = present[1 + rng() % (present.size() - 1)];
+        switch (rng() % 4) {
+        case 0: // heard again, the usual case
+            nodes[pos].last_heard = ++now;
+            nodeOrder.update(pos);
+            break;
+        case 1: // favorite toggled
+            nodes[pos].is_favorite = !nodes[pos].is_favorite;
+            nodeOrder.update(pos);
+            break;
+        case 2: // an older last_heard from a node list
+            nodes[pos].last_heard = older--;
+            nodeOrder.update(pos);
+            break;
+        default: // evicted and its slot reused for a new node, the way getOrCreateMeshNode() does
+            nodeOrder.remove(pos);
+            nodes[pos] = meshtastic_NodeInfoLite();
+            nodes[pos].num = 0xc0000000 + step;
+            nodes[pos].last_heard = ++now;
+            nodeOrder.insert(pos);
+            break;
+        }
+    }
+    assertOrder(expectedOrder(present));
+}
+
+static void test_remove_and_move_last_into_hole()
+{
+    fillNodes(30, 30);
+    std::vector<uint16_t> present;
+    for (uint16_t i = 0; i < 30; i++)
+        present.push_back(i);
+
+    // Like NodeDB::eraseMeshNode(): drop pos, then move the last entry into it
+    for (uint16_t pos : {7, 3, 12}) {
+        uint16_t last = present.size() - 1;
+        nodeOrder.remove(pos);
+        if (pos != last) {
+            nodeOrder.remove(last);
+            nodes[pos] = nodes[last];
+            nodeOrder.insert(pos);
+        }
+        nodes[last] = meshtastic_NodeInfoLite();
+        present.pop_back();
+        assertOrder(expectedOrder(present));
+    }
+
+    // Removing twice or inserting twice changes nothing
+    nodeOrder.remove(present.back());
+    nodeOrder.remove(present.back());
+    nodeOrder.insert(present.back());
+    nodeOrder.insert(present.back());
+    assertOrder(expectedOrder(present));
+}
+
+void setup()
+{
+    initializeTestEnvironment();
+
+    UNITY_BEGIN();
+    RUN_TEST(test_rebuild_sorts_our_node_then_favorites_then_recent);
+    RUN_TEST(test_equal_nodes_keep_storage_order);
+    RUN_TEST(test_updates_match_full_sort);
+    RUN_TEST(test_remove_and_move_last_into_hole);
+    exit(UNITY_END());
+}
+
+void loop() {}
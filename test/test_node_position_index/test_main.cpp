@@ -0,0 +1,230 @@
+#include "NodePositionIndex.h"
+#include "TestUtil.h"
+#include "gps/GeoCoord.h"
+#include <algorithm>
+#include <random>
+#include <unity.h>
+#include <vector>
+
+static const NodeNum OUR_NODE = 0x1000;
+
+static std::vector<meshtastic_NodeInfoLite> nodes;
+static NodePositionIndex positionIndex;
+
+static meshtastic_NodeInfoLite makeNode(NodeNum num, double lat, double lon)
+{
+    meshtastic_NodeInfoLite node = meshtastic_NodeInfoLite_init_zero;
+    node.num = num;
+    node.has_position = true;
+    node.position.latitude_i = (int32_t)(lat * 1e7);
+    node.position.longitude_i = (int32_t)(lon * 1e7);
+    return node;
+}
+
+// Our node in Berlin, and a random scatter of others over a few hundred kilometers around it
+static void fillNodes(size_t count, uint32_t seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> offset(-2, 2);
+    nodes.clear();
+    nodes.push_back(makeNode(OUR_NODE, 52.52, 13.40));
+    for (size_t i = 1; i < count; i++)
+        nodes.push_back(makeNode(OUR_NODE + i, 52.52 + offset(rng), 13.40 + offset(rng)));
+    positionIndex.rebuild(&nodes, nodes.size(), OUR_NODE);
+}
+
+static float distanceTo(const meshtastic_NodeInfoLite &node)
+{
+    return GeoCoord::latLongToMeter(node.position.latitude_i * 1e-7, node.position.longitude_i * 1e-7,
+                                    nodes[0].position.latitude_i * 1e-7, nodes[0].position.longitude_i * 1e-7);
+}
+
+void setUp(void)
+{
+    nodes.clear();
+    positionIndex.rebuild(nullptr, 0, OUR_NODE);
+}
+
+void tearDown(void) {}
+
+static void test_only_valid_positions_are_indexed()
+{
+    fillNodes(10, 1);
+    nodes[3].has_position = false;
+    nodes[4].position.latitude_i = 0;
+    nodes[4].position.longitude_i = 0;
+    positionIndex.rebuild(&nodes, nodes.size(), OUR_NODE);
+
+    TEST_ASSERT_EQUAL(8, positionIndex.size());
+    TEST_ASSERT_NULL(positionIndex.find(nodes[3].num));
+    TEST_ASSERT_NULL(positionIndex.find(nodes[4].num));
+    TEST_ASSERT_NOT_NULL(positionIndex.find(nodes[5].num));
+    TEST_ASSERT_TRUE(positionIndex.hasOrigin());
+
+    // Grid order
+    const NodePositionIndex::Entry *previous = NULL;
+    for (const NodePositionIndex::Entry &e : positionIndex) {
+        if (previous)
+            TEST_ASSERT_TRUE(previous->cell <= e.cell);
+        previous = &e;
+    }
+}
+
+static void test_distance_and_bearing_follow_moves()
+{
+    fillNodes(5, 2);
+    float distance, bearing;
+    TEST_ASSERT_TRUE(positionIndex.getDistanceBearing(nodes[2].num, &distance, &bearing));
+    TEST_ASSERT_FLOAT_WITHIN(1, distanceTo(nodes[2]), distance);
+    TEST_ASSERT_FLOAT_WITHIN(1e-4, GeoCoord::bearing(52.52, 13.40, nodes[2].position.latitude_i * 1e-7,
+                                                     nodes[2].position.longitude_i * 1e-7),
+                             bearing);
+
+    // They move
+    nodes[2] = makeNode(nodes[2].num, 52.62, 13.40);
+    positionIndex.update(&nodes[2]);
+    TEST_ASSERT_TRUE(positionIndex.getDistanceBearing(nodes[2].num, &distance, &bearing));
+    TEST_ASSERT_FLOAT_WITHIN(1, distanceTo(nodes[2]), distance);
+    TEST_ASSERT_FLOAT_WITHIN(1e-3, 0, bearing); // due north
+
+    // We move: every distance is stale
+    nodes[0] = makeNode(OUR_NODE, 52.72, 13.40);
+    positionIndex.update(&nodes[0]);
+    TEST_ASSERT_TRUE(positionIndex.getDistanceBearing(nodes[2].num, &distance, &bearing));
+    TEST_ASSERT_FLOAT_WITHIN(1, distanceTo(nodes[2]), distance);
+    TEST_ASSERT_FLOAT_WITHIN(1e-3, PI, bearing); // due south
+    TEST_ASSERT_TRUE(positionIndex.getDistanceBearing(nodes[4].num, &distance, NULL));
+    TEST_ASSERT_FLOAT_WITHIN(1, distanceTo(nodes[4]), distance);
+
+    // We lose our position
+    nodes[0].has_position = false;
+    positionIndex.update(&nodes[0]);
+    TEST_ASSERT_FALSE(positionIndex.hasOrigin());
+    TEST_ASSERT_FALSE(positionIndex.getDistanceBearing(nodes[2].num, &distance, &bearing));
+    TEST_ASSERT_NULL(positionIndex.find(OUR_NODE));
+
+    // Dropped nodes are unknown
+    positionIndex.remove(nodes[2].num);
+    TEST_ASSERT_NULL(positionIndex.find(nodes[2].num));
+    TEST_ASSERT_EQUAL(3, positionIndex.size());
+}
+
+static void test_box_matches_brute_force()
+{
+    fillNodes(200, 3);
+    std::mt19937 rng(4);
+    std::uniform_real_distribution<double> corner(-2.5, 2.5), size(0, 2);
+    NodeNum found[200];
+
+    for (int box = 0; box < 50; box++) {
+        int32_t minLat = (int32_t)((52.52 + corner(rng)) * 1e7), minLon = (int32_t)((13.40 + corner(rng)) * 1e7);
+        int32_t maxLat = minLat + (int32_t)(size(rng) * 1e7), maxLon = minLon + (int32_t)(size(rng) * 1e7);
+
+        std::vector<NodeNum> expected;
+        for (const meshtastic_NodeInfoLite &node : nodes)
+            if (node.position.latitude_i >= minLat && node.position.latitude_i <= maxLat &&
+                node.position.longitude_i >= minLon && node.position.longitude_i <= maxLon)
+                expected.push_back(node.num);
+
+        size_t count = positionIndex.findInBox(minLat, minLon, maxLat, maxLon, found, 200);
+        TEST_ASSERT_EQUAL(expected.size(), count);
+        std::vector<NodeNum> actual(found, found + count);
+        std::sort(expected.begin(), expected.end());
+        std::sort(actual.begin(), actual.end());
+        TEST_ASSERT_TRUE(expected == actual);
+    }
+
+    // Only counted past maxCount
+    TEST_ASSERT_EQUAL(200, positionIndex.findInBox(-900000000, -1800000000, 900000000, 1800000000, found, 10));
+}
+
+static void test_box_across_antimeridian()
+{
+    nodes.clear();
+    nodes.push_back(makeNode(OUR_NODE, -17.7, 178.0));
+    nodes.push_back(makeNode(OUR_NODE + 1, -17.8, 179.9));
+    nodes.push_back(makeNode(OUR_NODE + 2, -17.9, -179.9));
+    nodes.push_back(makeNode(OUR_NODE + 3, -17.9, -170.0));
+    // Enough nodes elsewhere that the box is searched cell by cell rather than node by node
+    for (NodeNum i = 0; i < 20; i++)
+        nodes.push_back(makeNode(OUR_NODE + 4 + i, 52.0 + i * 0.1, 13.0));
+    positionIndex.rebuild(&nodes, nodes.size(), OUR_NODE);
+
+    NodeNum found[4];
+    size_t count = positionIndex.findInBox(-180000000, 1790000000, -170000000, -1790000000, found, 4);
+    TEST_ASSERT_EQUAL(2, count);
+    std::sort(found, found + count);
+    TEST_ASSERT_EQUAL_UINT32(OUR_NODE + 1, found[0]);
+    TEST_ASSERT_EQUAL_UINT32(OUR_NODE + 2, found[1]);
+}
+
+static void test_nearest_in_order()
+{
+    fillNodes(150, 5);
+    NodeNum nearest[8];
+    TEST_ASSERT_EQUAL(8, positionIndex.findNearest(nearest, 8));
+
+    std::vector<std::pair<float, NodeNum>> expected;
+    for (size_t i = 1; i < nodes.size(); i++)
+        expected.push_back({distanceTo(nodes[i]), nodes[i].num});
+    std::sort(expected.begin(), expected.end());
+    for (size_t i = 0; i < 8; i++)
+        TEST_ASSERT_EQUAL_UINT32(expected[i].second, nearest[i]);
+
+    // Fewer nodes than asked for
+    fillNodes(3, 6);
+    TEST_ASSERT_EQUAL(2, positionIndex.findNearest(nearest, 8));
+}
+
+static void test_moves_keep_grid_order()
+{
+    fillNodes(50, 7);
+    std::mt19937 rng(8);
+    std::uniform_real_distribution<double> offset(-2, 2);
+    for (int move = 0; move < 200; move++) {
+        meshtastic_NodeInfoLite &node = nodes[1 + rng() % (nodes.size() - 1)];
+        node = makeNode(node.num, 52.52 + offset(rng), 13.40 + offset(rng));
+        positionIndex.update(&node);
+    }
+    TEST_ASSERT_EQUAL(50, positionIndex.size());
+
+    const NodePositionIndex::Entry *previous = NULL;
+    for (const NodePositionIndex::Entry &e : positionIndex) {
+        if (previous)
+            TEST_ASSERT_TRUE(previous->cell <= e.cell);
+        previous = &e;
+    }
+    for (const meshtastic_NodeInfoLite &node : nodes) {
+        const NodePositionIndex::Entry *e = positionIndex.find(node.num);
+        TEST_ASSERT_NOT_NULL(e);
+        TEST_ASSERT_EQUAL_INT32(node.position.latitude_i, e->latitude_i);
+        TEST_ASSERT_EQUAL_INT32(node.position.longitude_i, e->longitude_i);
+    }
+
+    // Removing some nodes leaves the others findable
+    for (size_t i = 1; i < nodes.size(); i += 3)
+        positionIndex.remove(nodes[i].num);
+    for (size_t i = 0; i < nodes.size(); i++) {
+        const NodePositionIndex::Entry *e = positionIndex.find(nodes[i].num);
+        if (i % 3 == 1)
+            TEST_ASSERT_NULL(e);
+        else
+            TEST_ASSERT_EQUAL_UINT32(nodes[i].num, e->num);
+    }
+}
+
+void setup()
+{
+    initializeTestEnvironment();
+
+    UNITY_BEGIN();
+    RUN_TEST(test_only_valid_positions_are_indexed);
+    RUN_TEST(test_distance_and_bearing_follow_moves);
+    RUN_TEST(test_box_matches_brute_force);
+    RUN_TEST(test_box_across_antimeridian);
+    RUN_TEST(test_nearest_in_order);
+    RUN_TEST(test_moves_keep_grid_order);
+    exit(UNITY_END());
+}
+
+void loop() {}
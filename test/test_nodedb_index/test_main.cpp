@@ -0,0 +1,151 @@
+#include "NodeNumIndex.h"
+#include "TestUtil.h"
+#include <chrono>
+#include <unity.h>
+#include <vector>
+
+static std::vector<meshtastic_NodeInfoLite> nodes;
+static NodeNumIndex nodeIndex;
+
+// Fill the first count entries with node numbers that look like the low four bytes of MAC addresses
+static void fillNodes(size_t count, size_t capacity)
+{
+    nodes.assign(capacity, meshtastic_NodeInfoLite());
+    for (size_t i = 0; i < count; i++)
+        nodes[i].num = 0xa0b00000 + (uint32_t)(i * 7919);
+    nodeIndex.rebuild(&nodes, count);
+}
+
+static int32_t linearFind(size_t count, NodeNum n)
+{
+    for (size_t i = 0; i < count; i++)
+        if (nodes[i].num == n)
+            return (int32_t)i;
+    return NodeNumIndex::NOT_FOUND;
+}
+
+void setUp(void)
+{
+    nodes.clear();
+    nodeIndex.rebuild(nullptr, 0);
+}
+
+void tearDown(void) {}
+
+static void test_find_returns_position_of_every_node()
+{
+    fillNodes(100, 100);
+    for (size_t i = 0; i < 100; i++)
+        TEST_ASSERT_EQUAL_INT32((int32_t)i, nodeIndex.find(nodes[i].num));
+}
+
+static void test_find_missing_node()
+{
+    fillNodes(50, 100);
+    TEST_ASSERT_EQUAL_INT32(NodeNumIndex::NOT_FOUND, nodeIndex.find(0x12345678));
+    TEST_ASSERT_EQUAL_INT32(NodeNumIndex::NOT_FOUND, nodeIndex.find(NODENUM_BROADCAST));
+    // Entries past the node count are blank and must not be found
+    TEST_ASSERT_EQUAL_INT32(NodeNumIndex::NOT_FOUND, nodeIndex.find(0));
+}
+
+static void test_insert_appended_node()
+{
+    fillNodes(10, 20);
+    nodes[10].num = 0xdeadbeef;
+    TEST_ASSERT_EQUAL_INT32(NodeNumIndex::NOT_FOUND, nodeIndex.find(0xdeadbeef));
+    nodeIndex.insert(10);
+    TEST_ASSERT_EQUAL_INT32(10, nodeIndex.find(0xdeadbeef));
+    TEST_ASSERT_EQUAL_INT32(3, nodeIndex.find(nodes[3].num));
+}
+
+static void test_rebuild_after_entries_move()
+{
+    fillNodes(20, 20);
+    NodeNum first = nodes[0].num;
+    NodeNum last = nodes[19].num;
+    std::swap(nodes[0], nodes[19]);
+    nodeIndex.rebuild(&nodes, 20);
+    TEST_ASSERT_EQUAL_INT32(19, nodeIndex.find(first));
+    TEST_ASSERT_EQUAL_INT32(0, nodeIndex.find(last));
+
+    // Drop the last entry, the way removeNodeByNum compacts the vector
+    nodeIndex.rebuild(&nodes, 19);
+    TEST_ASSERT_EQUAL_INT32(NodeNumIndex::NOT_FOUND, nodeIndex.find(first));
+}
+
+static void test_colliding_node_nums()
+{
+    // Node numbers that only differ in their top bits share the low MAC bytes and tend to collide
+    nodes.assign(64, meshtastic_NodeInfoLite());
+    for (size_t i = 0; i < 64; i++)
+        nodes[i].num = (uint32_t)(i << 26) | 0x1234;
+    nodeIndex.rebuild(&nodes, 64);
+    for (size_t i = 0; i < 64; i++)
+        TEST_ASSERT_EQUAL_INT32((int32_t)i, nodeIndex.find(nodes[i].num));
+}
+
+static void test_remove_keeps_probe_runs_intact()
+{
+    // Colliding keys form long probe runs, removing from the middle of one must not hide the entries behind it
+    nodes.assign(64, meshtastic_NodeInfoLite());
+    for (size_t i = 0; i < 64; i++)
+        nodes[i].num = (uint32_t)(i << 26) | 0x1234;
+    nodeIndex.rebuild(&nodes, 64);
+    for (size_t i = 0; i < 64; i += 3)
+        nodeIndex.remove(nodes[i].num);
+    for (size_t i = 0; i < 64; i++)
+        TEST_ASSERT_EQUAL_INT32(i % 3 ? (int32_t)i : NodeNumIndex::NOT_FOUND, nodeIndex.find(nodes[i].num));
+
+    // Reuse a removed slot for a new node, the way eviction does
+    nodes[3].num = 0xcafef00d;
+    nodeIndex.insert(3);
+    TEST_ASSERT_EQUAL_INT32(3, nodeIndex.find(0xcafef00d));
+}
+
+// getMeshNode() cost for one NodeDB size, scanning the array against asking the index. The stride of 31 keeps the scan from
+// always finding its node near the start.
+static void benchmarkLookups(size_t count)
+{
+    fillNodes(count, count);
+    const size_t lookups = 100000;
+    volatile int32_t sink = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < lookups; i++)
+        sink = sink + linearFind(count, nodes[(i * 31) % count].num);
+    auto linearNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < lookups; i++)
+        sink = sink + nodeIndex.find(nodes[(i * 31) % count].num);
+    auto indexedNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+    printf("getMeshNode %5u nodes: linear %8.1f ns/lookup, indexed %6.1f ns/lookup\n", (unsigned)count,
+           (double)linearNs / lookups, (double)indexedNs / lookups);
+    (void)sink;
+}
+
+static void test_benchmark_lookup_cost()
+{
+    benchmarkLookups(100);
+    benchmarkLookups(1000);
+    benchmarkLookups(10000);
+    TEST_ASSERT_TRUE(nodeIndex.isActive());
+}
+
+void setup()
+{
+    initializeTestEnvironment();
+
+    UNITY_BEGIN();
+    RUN_TEST(test_find_returns_position_of_every_node);
+    RUN_TEST(test_find_missing_node);
+    RUN_TEST(test_insert_appended_node);
+    RUN_TEST(test_rebuild_after_entries_move);
+    RUN_TEST(test_colliding_node_nums);
+    RUN_TEST(test_remove_keeps_probe_runs_intact);
+    RUN_TEST(test_benchmark_lookup_cost);
+    exit(UNITY_END());
+}
+
+void loop() {}
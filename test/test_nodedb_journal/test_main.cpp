@@ -0,0 +1,122 @@
+#include "NodeDBJournal.h"
+#include "TestUtil.h"
+#include <string.h>
+#include <unity.h>
+#include <vector>
+
+static std::vector<meshtastic_NodeInfoLite> nodes;
+
+static void fillNodes(size_t count)
+{
+    nodes.assign(count, meshtastic_NodeInfoLite());
+    for (size_t i = 0; i < count; i++) {
+        nodes[i].num = 0xa0b00000 + (uint32_t)i;
+        nodes[i].has_user = true;
+        snprintf(nodes[i].user.long_name, sizeof(nodes[i].user.long_name), "Node %u", (unsigned)i);
+        nodes[i].last_heard = 1700000000 + i;
+    }
+}
+
+void setUp(void)
+{
+    nodes.clear();
+}
+
+void tearDown(void) {}
+
+static void test_upsert_round_trip()
+{
+    fillNodes(1);
+    nodes[0].is_favorite = true;
+    uint8_t buf[NodeDBJournal::MAX_RECORD_SIZE];
+    size_t len = NodeDBJournal::encodeUpsert(nodes[0], buf, sizeof(buf));
+    TEST_ASSERT_GREATER_THAN(NodeDBJournal::RECORD_OVERHEAD, len);
+
+    NodeDBJournal::RecordType type;
+    meshtastic_NodeInfoLite decoded;
+    TEST_ASSERT_EQUAL(len, NodeDBJournal::decodeRecord(buf, len, type, decoded));
+    TEST_ASSERT_EQUAL(NodeDBJournal::RECORD_UPSERT, type);
+    TEST_ASSERT_EQUAL_UINT32(nodes[0].num, decoded.num);
+    TEST_ASSERT_TRUE(decoded.is_favorite);
+    TEST_ASSERT_EQUAL_STRING("Node 0", decoded.user.long_name);
+}
+
+static void test_damaged_record_is_rejected()
+{
+    uint8_t buf[NodeDBJournal::MAX_RECORD_SIZE];
+    size_t len = NodeDBJournal::encodeRemove(0x12345678, buf, sizeof(buf));
+    NodeDBJournal::RecordType type;
+    meshtastic_NodeInfoLite decoded;
+    TEST_ASSERT_EQUAL(len, NodeDBJournal::decodeRecord(buf, len, type, decoded));
+    TEST_ASSERT_EQUAL(NodeDBJournal::RECORD_REMOVE, type);
+    TEST_ASSERT_EQUAL_UINT32(0x12345678, decoded.num);
+
+    // Cut short by a power loss
+    TEST_ASSERT_EQUAL(0, NodeDBJournal::decodeRecord(buf, len - 1, type, decoded));
+    // Flipped bit
+    buf[4] ^= 0x10;
+    TEST_ASSERT_EQUAL(0, NodeDBJournal::decodeRecord(buf, len, type, decoded));
+}
+
+static void test_diff_only_journals_changes()
+{
+    fillNodes(100);
+    NodeDBJournal journal;
+    journal.markPersisted(&nodes, nodes.size());
+
+    std::vector<uint8_t> records;
+    TEST_ASSERT_TRUE(journal.diff(&nodes, nodes.size(), NODEDB_JOURNAL_MAX_BYTES, records));
+    TEST_ASSERT_EQUAL(0, records.size());
+
+    // Toggle a favorite and drop the last node, the way removeNodeByNum does
+    nodes[42].is_favorite = true;
+    NodeNum removed = nodes[99].num;
+    TEST_ASSERT_TRUE(journal.diff(&nodes, 99, NODEDB_JOURNAL_MAX_BYTES, records));
+    TEST_ASSERT_LESS_THAN(2 * NodeDBJournal::MAX_RECORD_SIZE, records.size());
+    journal.commit(records.size());
+    TEST_ASSERT_EQUAL(records.size(), journal.getJournalBytes());
+
+    NodeDBJournal::RecordType type;
+    meshtastic_NodeInfoLite decoded;
+    size_t pos = NodeDBJournal::decodeRecord(records.data(), records.size(), type, decoded);
+    TEST_ASSERT_EQUAL(NodeDBJournal::RECORD_UPSERT, type);
+    TEST_ASSERT_EQUAL_UINT32(nodes[42].num, decoded.num);
+    TEST_ASSERT_TRUE(decoded.is_favorite);
+    pos += NodeDBJournal::decodeRecord(records.data() + pos, records.size() - pos, type, decoded);
+    TEST_ASSERT_EQUAL(NodeDBJournal::RECORD_REMOVE, type);
+    TEST_ASSERT_EQUAL_UINT32(removed, decoded.num);
+    TEST_ASSERT_EQUAL(records.size(), pos);
+
+    // Committed changes are not journaled again
+    TEST_ASSERT_TRUE(journal.diff(&nodes, 99, NODEDB_JOURNAL_MAX_BYTES, records));
+    TEST_ASSERT_EQUAL(0, records.size());
+}
+
+static void test_diff_over_budget_asks_for_snapshot()
+{
+    fillNodes(100);
+    NodeDBJournal journal;
+    journal.markPersisted(&nodes, nodes.size());
+    for (auto &node : nodes)
+        node.last_heard++;
+
+    std::vector<uint8_t> records;
+    TEST_ASSERT_FALSE(journal.diff(&nodes, nodes.size(), 10 * NodeDBJournal::MAX_RECORD_SIZE, records));
+
+    journal.invalidate();
+    TEST_ASSERT_FALSE(journal.hasSnapshot());
+}
+
+void setup()
+{
+    initializeTestEnvironment();
+
+    UNITY_BEGIN();
+    RUN_TEST(test_upsert_round_trip);
+    RUN_TEST(test_damaged_record_is_rejected);
+    RUN_TEST(test_diff_only_journals_changes);
+    RUN_TEST(test_diff_over_budget_asks_for_snapshot);
+    exit(UNITY_END());
+}
+
+void loop() {}
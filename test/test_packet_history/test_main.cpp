@@ -0,0 +1,136 @@
+#include "NodeDB.h"
+#include "PacketHistory.h"
+#include "TestUtil.h"
+#include <chrono>
+#include <memory>
+#include <unity.h>
+
+#if ARCH_PORTDUINO
+#include "platform/portduino/PortduinoGlue.h"
+#endif
+
+static meshtastic_MeshPacket makePacket(NodeNum from, PacketId id, uint8_t hopLimit = 3, uint8_t relayNode = 0x11)
+{
+    meshtastic_MeshPacket p = meshtastic_MeshPacket_init_zero;
+    p.from = from;
+    p.to = NODENUM_BROADCAST;
+    p.id = id;
+    p.hop_limit = hopLimit;
+    p.relay_node = relayNode;
+    p.next_hop = NO_NEXT_HOP_PREFERENCE;
+    return p;
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+static void test_duplicate_is_detected()
+{
+    PacketHistory history(16);
+    meshtastic_MeshPacket p = makePacket(0x1000, 1);
+    TEST_ASSERT_FALSE(history.wasSeenRecently(&p));
+    TEST_ASSERT_TRUE(history.wasSeenRecently(&p));
+
+    // Same id from another sender is a different packet
+    meshtastic_MeshPacket other = makePacket(0x2000, 1);
+    TEST_ASSERT_FALSE(history.wasSeenRecently(&other));
+}
+
+static void test_lookup_without_update_does_not_insert()
+{
+    PacketHistory history(16);
+    meshtastic_MeshPacket p = makePacket(0x1000, 1);
+    TEST_ASSERT_FALSE(history.wasSeenRecently(&p, false));
+    TEST_ASSERT_FALSE(history.wasSeenRecently(&p, false));
+}
+
+static void test_least_recently_seen_is_evicted()
+{
+    PacketHistory history(4);
+    meshtastic_MeshPacket packets[5];
+    for (int i = 0; i < 4; i++) {
+        packets[i] = makePacket(0x1000 + i, 100 + i);
+        history.wasSeenRecently(&packets[i]);
+    }
+
+    // Seeing the first packet again makes it the most recent, so the second one is now the oldest
+    TEST_ASSERT_TRUE(history.wasSeenRecently(&packets[0]));
+
+    packets[4] = makePacket(0x1004, 104);
+    TEST_ASSERT_FALSE(history.wasSeenRecently(&packets[4]));
+
+    TEST_ASSERT_TRUE(history.wasSeenRecently(&packets[0], false));
+    TEST_ASSERT_FALSE(history.wasSeenRecently(&packets[1], false));
+    TEST_ASSERT_TRUE(history.wasSeenRecently(&packets[2], false));
+    TEST_ASSERT_TRUE(history.wasSeenRecently(&packets[3], false));
+    TEST_ASSERT_TRUE(history.wasSeenRecently(&packets[4], false));
+}
+
+static void test_relayers_survive_updates()
+{
+    PacketHistory history(16);
+    uint8_t ourRelayID = nodeDB->getLastByteOfNodeNum(nodeDB->getNodeNum());
+    meshtastic_MeshPacket p = makePacket(0x1000, 7, 3, ourRelayID);
+    history.wasSeenRecently(&p);
+    TEST_ASSERT_TRUE(history.wasRelayer(ourRelayID, 7, 0x1000));
+
+    // A later copy relayed by someone else updates the record in place
+    meshtastic_MeshPacket copy = makePacket(0x1000, 7, 2, 0x22);
+    TEST_ASSERT_TRUE(history.wasSeenRecently(&copy));
+    TEST_ASSERT_TRUE(history.wasRelayer(ourRelayID, 7, 0x1000));
+    TEST_ASSERT_EQUAL(2, history.countRelayers(7, 0x1000));
+    TEST_ASSERT_EQUAL(1, history.countRelayers(7, 0x1000, ourRelayID));
+    TEST_ASSERT_EQUAL(0, history.countRelayers(8, 0x1000));
+
+    history.removeRelayer(ourRelayID, 7, 0x1000);
+    TEST_ASSERT_FALSE(history.wasRelayer(ourRelayID, 7, 0x1000));
+    TEST_ASSERT_EQUAL(1, history.countRelayers(7, 0x1000));
+}
+
+// wasSeenRecently() on a history that stays full, every other packet being a dupe of one heard 7 packets earlier. Only
+// checks that the dupes are caught, the packets/s figure is for comparing runs.
+static void test_benchmark_dedup_throughput()
+{
+#if ARCH_PORTDUINO
+    // Every insert logs a TRACE line at info level, keep that out of the measurement
+    auto savedLevel = portduino_config.logoutputlevel;
+    portduino_config.logoutputlevel = level_warn;
+#endif
+    PacketHistory history;
+    const uint32_t numPackets = 200000;
+    uint32_t duplicates = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < numPackets; i++) {
+        // Every packet is heard twice, the second time a few packets later, like a flood coming back via another relayer
+        uint32_t n = (i & 1) ? i - 7 : i;
+        meshtastic_MeshPacket p = makePacket(0x10000 + (n % 97), 0x100000 + n);
+        if (history.wasSeenRecently(&p))
+            duplicates++;
+    }
+    auto elapsedUs = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+#if ARCH_PORTDUINO
+    portduino_config.logoutputlevel = savedLevel;
+#endif
+
+    printf("PacketHistory dedup: %u packets in %lld us, %.0f packets/s, %u duplicates\n", numPackets, (long long)elapsedUs,
+           elapsedUs ? numPackets * 1e6 / elapsedUs : 0.0, duplicates);
+    TEST_ASSERT_GREATER_THAN_UINT32(0, duplicates);
+}
+
+void setup()
+{
+    initializeTestEnvironment();
+    const std::unique_ptr<NodeDB> testNodeDB(new NodeDB());
+    nodeDB = testNodeDB.get();
+
+    UNITY_BEGIN();
+    RUN_TEST(test_duplicate_is_detected);
+    RUN_TEST(test_lookup_without_update_does_not_insert);
+    RUN_TEST(test_least_recently_seen_is_evicted);
+    RUN_TEST(test_relayers_survive_updates);
+    RUN_TEST(test_benchmark_dedup_throughput);
+    exit(UNITY_END());
+}
+
+void loop() {}
@@ -0,0 +1,103 @@
+#include "TestUtil.h"
+#include "mesh/PacketLatency.h"
+#include <unity.h>
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+static void test_bucket_limits()
+{
+    TEST_ASSERT_EQUAL_UINT32(100, LatencyHistogram::bucketLimit(0));
+    TEST_ASSERT_EQUAL_UINT32(200, LatencyHistogram::bucketLimit(1));
+    TEST_ASSERT_EQUAL_UINT32(500, LatencyHistogram::bucketLimit(2));
+    TEST_ASSERT_EQUAL_UINT32(1000, LatencyHistogram::bucketLimit(3));
+    TEST_ASSERT_EQUAL_UINT32(5000000, LatencyHistogram::bucketLimit(LatencyHistogram::NUM_BUCKETS - 2));
+    TEST_ASSERT_EQUAL_UINT32(UINT32_MAX, LatencyHistogram::bucketLimit(LatencyHistogram::NUM_BUCKETS - 1));
+}
+
+static void test_record_and_percentiles()
+{
+    LatencyHistogram h;
+    TEST_ASSERT_EQUAL_UINT32(0, h.percentile(50));
+
+    h.record(0);
+    h.record(99);
+    h.record(100); // limits are exclusive
+    h.record(4000);
+    h.record(7000000);
+    const uint32_t *buckets = h.getBuckets();
+    TEST_ASSERT_EQUAL_UINT32(2, buckets[0]);
+    TEST_ASSERT_EQUAL_UINT32(1, buckets[1]);
+    TEST_ASSERT_EQUAL_UINT32(1, buckets[5]);
+    TEST_ASSERT_EQUAL_UINT32(1, buckets[LatencyHistogram::NUM_BUCKETS - 1]);
+    TEST_ASSERT_EQUAL_UINT32(5, h.getCount());
+    TEST_ASSERT_EQUAL_UINT32(7000000, h.getMax());
+
+    TEST_ASSERT_EQUAL_UINT32(100, h.percentile(0));
+    TEST_ASSERT_EQUAL_UINT32(100, h.percentile(40));
+    TEST_ASSERT_EQUAL_UINT32(200, h.percentile(50));
+    TEST_ASSERT_EQUAL_UINT32(5000, h.percentile(80));
+    // The open ended bucket reports the largest sample
+    TEST_ASSERT_EQUAL_UINT32(7000000, h.percentile(90));
+    TEST_ASSERT_EQUAL_UINT32(7000000, h.percentile(100));
+
+    h.clear();
+    TEST_ASSERT_EQUAL_UINT32(0, h.getCount());
+    TEST_ASSERT_EQUAL_UINT32(0, h.getMax());
+}
+
+static void test_marks()
+{
+    PacketLatency latency;
+    meshtastic_MeshPacket a = meshtastic_MeshPacket_init_zero, b = meshtastic_MeshPacket_init_zero;
+
+    // Not marked, nothing to record
+    latency.finish(PacketLatency::STAGE_TX_QUEUE, &a);
+    TEST_ASSERT_EQUAL_UINT32(0, latency.get(PacketLatency::STAGE_TX_QUEUE).getCount());
+
+    latency.mark(&a, micros());
+    latency.mark(&b, micros());
+    latency.finish(PacketLatency::STAGE_TX_QUEUE, &a);
+    latency.finish(PacketLatency::STAGE_AIRTIME, &b);
+    TEST_ASSERT_EQUAL_UINT32(1, latency.get(PacketLatency::STAGE_TX_QUEUE).getCount());
+    TEST_ASSERT_EQUAL_UINT32(1, latency.get(PacketLatency::STAGE_AIRTIME).getCount());
+
+    // A mark is only used once
+    latency.finish(PacketLatency::STAGE_TX_QUEUE, &a);
+    TEST_ASSERT_EQUAL_UINT32(1, latency.get(PacketLatency::STAGE_TX_QUEUE).getCount());
+
+    // Marks of packets which never finished are overwritten rather than filling the table
+    meshtastic_MeshPacket packets[PACKET_LATENCY_MARKS + 1];
+    for (auto &p : packets)
+        latency.mark(&p, micros());
+    latency.finish(PacketLatency::STAGE_DECODE, &packets[0]);
+    TEST_ASSERT_EQUAL_UINT32(0, latency.get(PacketLatency::STAGE_DECODE).getCount());
+    latency.finish(PacketLatency::STAGE_DECODE, &packets[PACKET_LATENCY_MARKS]);
+    TEST_ASSERT_EQUAL_UINT32(1, latency.get(PacketLatency::STAGE_DECODE).getCount());
+
+    // A mark left by a dropped packet is not used by the next packet in the same pool slot
+    a.id = 1;
+    latency.mark(&a, micros());
+    a.id = 2;
+    latency.finish(PacketLatency::STAGE_DECODE, &a);
+    TEST_ASSERT_EQUAL_UINT32(1, latency.get(PacketLatency::STAGE_DECODE).getCount());
+
+    // Nor is one which is too old to be the same packet
+    latency.mark(&a, micros() - PACKET_LATENCY_MAX_MICROS - 1);
+    latency.finish(PacketLatency::STAGE_DECODE, &a);
+    TEST_ASSERT_EQUAL_UINT32(1, latency.get(PacketLatency::STAGE_DECODE).getCount());
+}
+
+void setup()
+{
+    initializeTestEnvironment();
+
+    UNITY_BEGIN();
+    RUN_TEST(test_bucket_limits);
+    RUN_TEST(test_record_and_percentiles);
+    RUN_TEST(test_marks);
+    exit(UNITY_END());
+}
+
+void loop() {}
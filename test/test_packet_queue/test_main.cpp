@@ -0,0 +1,114 @@
+#include "MeshPacketQueue.h"
+#include "NodeDB.h"
+#include "TestUtil.h"
+#include <memory>
+#include <unity.h>
+#include <vector>
+
+static std::vector<std::unique_ptr<meshtastic_MeshPacket>> packets;
+
+static meshtastic_MeshPacket *makePacket(NodeNum from, PacketId id, meshtastic_MeshPacket_Priority priority,
+                                         uint32_t txAfter = 0)
+{
+    meshtastic_MeshPacket *p = new meshtastic_MeshPacket(meshtastic_MeshPacket_init_zero);
+    p->from = from;
+    p->id = id;
+    p->priority = priority;
+    p->tx_after = txAfter;
+    packets.emplace_back(p);
+    return p;
+}
+
+void setUp(void) {}
+void tearDown(void)
+{
+    packets.clear();
+}
+
+static void test_dequeue_in_priority_order()
+{
+    MeshPacketQueue queue(8);
+    auto *low = makePacket(0x1000, 1, meshtastic_MeshPacket_Priority_BACKGROUND);
+    auto *ack = makePacket(0x1000, 2, meshtastic_MeshPacket_Priority_ACK);
+    auto *first = makePacket(0x1000, 3, meshtastic_MeshPacket_Priority_DEFAULT);
+    auto *second = makePacket(0x1000, 4, meshtastic_MeshPacket_Priority_DEFAULT);
+    auto *late = makePacket(0x1000, 5, meshtastic_MeshPacket_Priority_ACK, millis() + 1000);
+    for (auto *p : {low, late, first, ack, second})
+        TEST_ASSERT_TRUE(queue.enqueue(p));
+
+    // Late packets go last whatever their priority, equal priorities keep their order
+    TEST_ASSERT_EQUAL_PTR(ack, queue.dequeue());
+    TEST_ASSERT_EQUAL_PTR(first, queue.dequeue());
+    TEST_ASSERT_EQUAL_PTR(second, queue.dequeue());
+    TEST_ASSERT_EQUAL_PTR(low, queue.dequeue());
+    TEST_ASSERT_EQUAL_PTR(late, queue.dequeue());
+    TEST_ASSERT_NULL(queue.dequeue());
+}
+
+static void test_remove_by_id()
+{
+    MeshPacketQueue queue(8);
+    auto *normal = makePacket(0x1000, 7, meshtastic_MeshPacket_Priority_DEFAULT);
+    auto *late = makePacket(0x2000, 7, meshtastic_MeshPacket_Priority_DEFAULT, millis() + 1000);
+    queue.enqueue(normal);
+    queue.enqueue(late);
+
+    TEST_ASSERT_TRUE(queue.find(0x1000, 7));
+    TEST_ASSERT_FALSE(queue.find(0x1000, 8));
+    TEST_ASSERT_EQUAL_PTR(late, queue.getPacketFromQueue(0x2000, 7));
+
+    // Only remove late packets when asked to
+    TEST_ASSERT_NULL(queue.remove(0x2000, 7, true, false));
+    TEST_ASSERT_EQUAL_PTR(late, queue.remove(0x2000, 7, false, true));
+    TEST_ASSERT_EQUAL_PTR(normal, queue.remove(0x1000, 7));
+    TEST_ASSERT_TRUE(queue.empty());
+    TEST_ASSERT_EQUAL(8, queue.getFree());
+}
+
+static void test_full_queue_drops_lower_priority()
+{
+    // Evicted packets go back to packetPool, so these have to come from it
+    auto pooled = [](PacketId id, meshtastic_MeshPacket_Priority priority) {
+        meshtastic_MeshPacket *p = packetPool.allocZeroed();
+        p->from = 0x1000;
+        p->id = id;
+        p->priority = priority;
+        return p;
+    };
+    MeshPacketQueue queue(2);
+    auto *low = pooled(1, meshtastic_MeshPacket_Priority_BACKGROUND);
+    auto *def = pooled(2, meshtastic_MeshPacket_Priority_DEFAULT);
+    queue.enqueue(low);
+    queue.enqueue(def);
+
+    // Same priority as the lowest queued packet is not enough to get in
+    bool dropped = false;
+    auto *background = pooled(3, meshtastic_MeshPacket_Priority_BACKGROUND);
+    TEST_ASSERT_FALSE(queue.enqueue(background, &dropped));
+    TEST_ASSERT_TRUE(dropped);
+    packetPool.release(background);
+
+    auto *ack = pooled(4, meshtastic_MeshPacket_Priority_ACK);
+    TEST_ASSERT_TRUE(queue.enqueue(ack, &dropped));
+    TEST_ASSERT_TRUE(dropped);
+    TEST_ASSERT_FALSE(queue.find(0x1000, 1));
+    TEST_ASSERT_EQUAL_PTR(ack, queue.dequeue());
+    TEST_ASSERT_EQUAL_PTR(def, queue.dequeue());
+    packetPool.release(ack);
+    packetPool.release(def);
+}
+
+void setup()
+{
+    initializeTestEnvironment();
+    const std::unique_ptr<NodeDB> testNodeDB(new NodeDB());
+    nodeDB = testNodeDB.get();
+
+    UNITY_BEGIN();
+    RUN_TEST(test_dequeue_in_priority_order);
+    RUN_TEST(test_remove_by_id);
+    RUN_TEST(test_full_queue_drops_lower_priority);
+    exit(UNITY_END());
+}
+
+void loop() {}
@@ -77,6 +77,29 @@ static void test_bootstrapLoRaConfigFromPreset_fallsBackIfBandwidthExceedsRegion
     TEST_ASSERT_EQUAL_UINT32(11, cfg.spread_factor);
 }
 
+static void test_lateRebroadcastWindow_startsAfterWidenedWindows()
+{
+    for (float snr = -20; snr <= 10; snr += 2.5f) {
+        uint32_t lateStart = RadioInterface::getRebroadcastWorstSlots(snr);
+        for (float util = 0; util <= 100; util += 10) {
+            for (uint8_t relayers = 0; relayers <= 5; relayers++) {
+                uint8_t steps = RadioInterface::getCongestionCWsteps(util, relayers);
+                uint8_t CWsize = RadioInterface::widenCWsize(RadioInterface::getCWsize(snr), steps);
+                for (bool likeRouter : {false, true}) {
+                    uint32_t lastSlot = RadioInterface::getRebroadcastOffsetSlots(likeRouter) +
+                                        RadioInterface::getRebroadcastWindowSlots(CWsize, likeRouter);
+                    TEST_ASSERT_LESS_OR_EQUAL(lateStart, lastSlot);
+                }
+            }
+        }
+    }
+    // Congestion does move the late window out, beyond where the plain SNR window would end
+    uint8_t plainCWsize = RadioInterface::getCWsize(-20);
+    TEST_ASSERT_GREATER_THAN(RadioInterface::getRebroadcastOffsetSlots(false) +
+                                 RadioInterface::getRebroadcastWindowSlots(plainCWsize, false),
+                             RadioInterface::getRebroadcastWorstSlots(-20));
+}
+
 void setUp(void) {}
 void tearDown(void) {}
 
@@ -94,6 +117,7 @@ void setup()
     RUN_TEST(test_bootstrapLoRaConfigFromPreset_setsDerivedFields_nonWideRegion);
     RUN_TEST(test_bootstrapLoRaConfigFromPreset_setsDerivedFields_wideRegion);
     RUN_TEST(test_bootstrapLoRaConfigFromPreset_fallsBackIfBandwidthExceedsRegionSpan);
+    RUN_TEST(test_lateRebroadcastWindow_startsAfterWidenedWindows);
     exit(UNITY_END());
 }
 
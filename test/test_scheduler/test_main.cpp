@@ -0,0 +1,100 @@
+#include "TestUtil.h"
+#include "concurrency/OSThread.h"
+#include <unity.h>
+
+using namespace concurrency;
+
+class CountingThread : public OSThread
+{
+  public:
+    int runs = 0;
+    int32_t nextDelay;
+
+    CountingThread(const char *name, uint32_t period, int32_t nextDelay) : OSThread(name, period), nextDelay(nextDelay) {}
+
+  protected:
+    int32_t runOnce() override
+    {
+        runs++;
+        return nextDelay;
+    }
+};
+
+void setUp(void) {}
+void tearDown(void) {}
+
+static void test_delay_is_time_until_next_thread()
+{
+    CountingThread slow("slow", 5000, 5000);
+    CountingThread fast("fast", 300, 300);
+
+    long delayMsec = mainController.runOrDelay();
+    TEST_ASSERT_EQUAL(0, fast.runs);
+    // Other threads (the serial console) may be due sooner, but never later than "fast"
+    TEST_ASSERT_LESS_OR_EQUAL_INT32(300, delayMsec);
+
+    testDelay(305);
+    mainController.runOrDelay();
+    TEST_ASSERT_EQUAL(1, fast.runs);
+    TEST_ASSERT_EQUAL(0, slow.runs);
+}
+
+static void test_thread_runs_once_per_pass()
+{
+    // A thread asking to run again right away must not starve the loop
+    CountingThread busy("busy", 0, 0);
+    mainController.runOrDelay();
+    TEST_ASSERT_EQUAL(1, busy.runs);
+    TEST_ASSERT_EQUAL(0, mainController.runOrDelay());
+    TEST_ASSERT_EQUAL(2, busy.runs);
+}
+
+static void test_disabled_thread_wakes_up()
+{
+    CountingThread sleeper("sleeper", 0, 0);
+    mainController.runOrDelay();
+    TEST_ASSERT_EQUAL(1, sleeper.runs);
+
+    sleeper.disable();
+    mainController.runOrDelay();
+    mainController.runOrDelay();
+    TEST_ASSERT_EQUAL(1, sleeper.runs);
+
+    // The way NotifiedWorkerThread wakes up, possibly from an ISR
+    sleeper.enabled = true;
+    sleeper.setInterval(0);
+    mainController.runOrDelay();
+    TEST_ASSERT_EQUAL(2, sleeper.runs);
+
+    // Modules also just flip enabled back on, with a due time already in the past
+    sleeper.enabled = false;
+    mainController.runOrDelay();
+    sleeper.enabled = true;
+    mainController.runOrDelay();
+    TEST_ASSERT_EQUAL(3, sleeper.runs);
+}
+
+static void test_deleted_threads_are_forgotten()
+{
+    int before = mainController.size();
+    CountingThread *temp = new CountingThread("temp", 0, 0);
+    TEST_ASSERT_EQUAL(before + 1, mainController.size());
+    temp->setInterval(0);
+    delete temp;
+    TEST_ASSERT_EQUAL(before, mainController.size());
+    mainController.runOrDelay();
+}
+
+void setup()
+{
+    initializeTestEnvironment();
+
+    UNITY_BEGIN();
+    RUN_TEST(test_delay_is_time_until_next_thread);
+    RUN_TEST(test_thread_runs_once_per_pass);
+    RUN_TEST(test_disabled_thread_wakes_up);
+    RUN_TEST(test_deleted_threads_are_forgotten);
+    exit(UNITY_END());
+}
+
+void loop() {}
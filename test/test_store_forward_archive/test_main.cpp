@@ -0,0 +1,254 @@
+#include "FSCommon.h"
+#include "SPILock.h"
+#include "TestUtil.h"
+#include "modules/StoreForwardArchive.h"
+#include <stdio.h>
+#include <string.h>
+#include <unity.h>
+
+static const char *text = "meet at the trailhead";
+
+static size_t encodeText(uint8_t *buf, size_t bufSize)
+{
+    PacketHistoryStruct packet = {};
+    packet.time = 1700000000;
+    packet.from = 0x1111;
+    packet.to = NODENUM_BROADCAST;
+    packet.id = 42;
+    packet.payload_size = strlen(text);
+    return StoreForwardArchive::encodeRecord(packet, reinterpret_cast<const uint8_t *>(text), buf, bufSize);
+}
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+static void test_record_round_trip()
+{
+    uint8_t buf[StoreForwardArchive::MAX_RECORD_SIZE];
+    size_t len = encodeText(buf, sizeof(buf));
+    TEST_ASSERT_EQUAL(StoreForwardArchive::RECORD_OVERHEAD + sizeof(PacketHistoryStruct) + strlen(text), len);
+
+    PacketHistoryStruct packet;
+    const uint8_t *payload;
+    TEST_ASSERT_EQUAL(len, StoreForwardArchive::decodeRecord(buf, len, packet, payload));
+    TEST_ASSERT_EQUAL_UINT32(1700000000, packet.time);
+    TEST_ASSERT_EQUAL_UINT32(NODENUM_BROADCAST, packet.to);
+    TEST_ASSERT_EQUAL_UINT32(42, packet.id);
+    TEST_ASSERT_EQUAL(strlen(text), packet.payload_size);
+    TEST_ASSERT_EQUAL_MEMORY(text, payload, packet.payload_size);
+
+    // Does not fit
+    TEST_ASSERT_EQUAL(0, encodeText(buf, len - 1));
+}
+
+static void test_damaged_record_is_rejected()
+{
+    uint8_t buf[StoreForwardArchive::MAX_RECORD_SIZE];
+    size_t len = encodeText(buf, sizeof(buf));
+    PacketHistoryStruct packet;
+    const uint8_t *payload;
+
+    // Cut short by a power loss
+    TEST_ASSERT_EQUAL(0, StoreForwardArchive::decodeRecord(buf, len - 1, packet, payload));
+    // Flipped bit in the payload
+    buf[len - 6] ^= 0x01;
+    TEST_ASSERT_EQUAL(0, StoreForwardArchive::decodeRecord(buf, len, packet, payload));
+}
+
+static StoreForwardArchiveIndex::Entry entry(uint32_t time, NodeNum from, NodeNum to, uint32_t segment)
+{
+    return {time, to, from, segment, 4, StoreForwardHistory::NONE};
+}
+
+static void test_index_serves_like_history()
+{
+    StoreForwardArchiveIndex::Entry buf[8];
+    StoreForwardArchiveIndex index;
+    index.begin(buf, 8);
+    index.add(entry(100, 0x1111, NODENUM_BROADCAST, 1));
+    index.add(entry(200, 0x2222, NODENUM_BROADCAST, 1)); // sent by the client itself
+    index.add(entry(300, 0x1111, 0x3333, 1));            // DM to someone else
+    index.add(entry(400, 0x1111, 0x2222, 2));            // DM to the client
+    index.add(entry(500, 0x3333, NODENUM_BROADCAST, 2));
+
+    StoreForwardHistory::Cursor cursor;
+    TEST_ASSERT_EQUAL_UINT32(3, index.count(0x2222, 0, cursor));
+    TEST_ASSERT_EQUAL_UINT32(2, index.count(0x2222, 100, cursor));
+    TEST_ASSERT_EQUAL_UINT32(1, index.count(0x2222, 0, cursor, 1));
+
+    const StoreForwardArchiveIndex::Entry *e = index.next(0x2222, 0, cursor);
+    TEST_ASSERT_EQUAL_UINT32(100, e->time);
+    e = index.next(0x2222, 0, cursor);
+    TEST_ASSERT_EQUAL_UINT32(400, e->time);
+    TEST_ASSERT_EQUAL_UINT32(1, index.count(0x2222, 0, cursor));
+
+    // The cursor survives newer messages and older ones being dropped
+    index.dropBefore(2);
+    TEST_ASSERT_EQUAL_UINT32(2, index.size());
+    index.add(entry(600, 0x1111, 0x2222, 3));
+    e = index.next(0x2222, 0, cursor);
+    TEST_ASSERT_EQUAL_UINT32(500, e->time);
+    e = index.next(0x2222, 0, cursor);
+    TEST_ASSERT_EQUAL_UINT32(600, e->time);
+    TEST_ASSERT_NULL(index.next(0x2222, 0, cursor));
+    TEST_ASSERT_EQUAL_UINT32(6, index.getTotalAdded());
+}
+
+static void test_index_drops_oldest_when_full()
+{
+    StoreForwardArchiveIndex::Entry buf[4];
+    StoreForwardArchiveIndex index;
+    index.begin(buf, 4);
+    for (uint32_t i = 1; i <= 10; i++)
+        index.add(entry(i, 0x1111, NODENUM_BROADCAST, 1));
+    TEST_ASSERT_EQUAL_UINT32(4, index.size());
+
+    StoreForwardHistory::Cursor cursor;
+    TEST_ASSERT_EQUAL_UINT32(7, index.next(0x2222, 0, cursor)->time);
+    TEST_ASSERT_EQUAL_UINT32(3, index.count(0x2222, 0, cursor));
+}
+
+static void test_index_skips_other_destinations()
+{
+    // Many DMs to other nodes between the ones we want, each next() must still hand out the right one in order
+    StoreForwardArchiveIndex::Entry buf[64];
+    StoreForwardArchiveIndex index;
+    index.begin(buf, 64);
+    for (uint32_t i = 1; i <= 100; i++)
+        index.add(entry(i, 0x1111, i % 10 == 0 ? 0x2222 : 0x3000 + i, 1));
+
+    StoreForwardHistory::Cursor cursor;
+    TEST_ASSERT_EQUAL_UINT32(7, index.count(0x2222, 0, cursor));
+    for (uint32_t time = 40; time <= 100; time += 10)
+        TEST_ASSERT_EQUAL_UINT32(time, index.next(0x2222, 0, cursor)->time);
+    TEST_ASSERT_NULL(index.next(0x2222, 0, cursor));
+    TEST_ASSERT_EQUAL_UINT32(0, index.count(0x3000 + 21, 0, StoreForwardHistory::Cursor())); // dropped
+    TEST_ASSERT_EQUAL_UINT32(1, index.count(0x3000 + 91, 0, StoreForwardHistory::Cursor()));
+}
+
+#ifdef FSCom
+static StoreForwardArchiveIndex::Entry archiveIndex[64];
+
+static bool appendText(StoreForwardArchive &archive, uint32_t time)
+{
+    PacketHistoryStruct packet = {};
+    packet.time = time;
+    packet.from = 0x1111;
+    packet.to = NODENUM_BROADCAST;
+    packet.id = time;
+    packet.payload_size = strlen(text);
+    return archive.append(packet, reinterpret_cast<const uint8_t *>(text));
+}
+
+// Serve everything the archive has to a new client, checking it comes back in order and intact
+static void assertServes(StoreForwardArchive &archive, uint32_t firstTime, uint32_t count)
+{
+    StoreForwardHistory::Cursor cursor;
+    PacketHistoryStruct packet;
+    uint8_t payload[meshtastic_Constants_DATA_PAYLOAD_LEN];
+    for (uint32_t i = 0; i < count; i++) {
+        TEST_ASSERT_TRUE(archive.next(0x2222, 0, cursor, packet, payload));
+        TEST_ASSERT_EQUAL_UINT32(firstTime + i, packet.time);
+        TEST_ASSERT_EQUAL_MEMORY(text, payload, strlen(text));
+    }
+    TEST_ASSERT_FALSE(archive.next(0x2222, 0, cursor, packet, payload));
+}
+
+static void test_begin_indexes_existing_segments()
+{
+    rmDir("/sf");
+    StoreForwardArchive archive;
+    TEST_ASSERT_TRUE(archive.begin(archiveIndex, 64));
+    for (uint32_t time = 1; time <= 5; time++)
+        TEST_ASSERT_TRUE(appendText(archive, time));
+
+    // As after a reboot
+    StoreForwardArchive reopened;
+    TEST_ASSERT_TRUE(reopened.begin(archiveIndex, 64));
+    TEST_ASSERT_EQUAL_UINT32(5, reopened.getIndex().size());
+    TEST_ASSERT_EQUAL_UINT32(1, reopened.getSegmentCount());
+    assertServes(reopened, 1, 5);
+
+    TEST_ASSERT_TRUE(appendText(reopened, 6));
+    assertServes(reopened, 1, 6);
+}
+
+static void test_begin_recovers_torn_segment()
+{
+    rmDir("/sf");
+    StoreForwardArchive archive;
+    TEST_ASSERT_TRUE(archive.begin(archiveIndex, 64));
+    for (uint32_t time = 1; time <= 3; time++)
+        TEST_ASSERT_TRUE(appendText(archive, time));
+
+    // Power lost halfway through writing the next record
+    uint8_t record[StoreForwardArchive::MAX_RECORD_SIZE];
+    size_t len = encodeText(record, sizeof(record));
+    char name[32];
+    snprintf(name, sizeof(name), "/sf/%08x.sf", 1u);
+    auto f = FSCom.open(name, FILE_O_APPEND);
+    TEST_ASSERT_TRUE(f);
+    f.write(record, len / 2);
+    f.close();
+
+    // The intact records are kept and new ones go to a fresh segment, so nothing is appended after the torn one
+    StoreForwardArchive reopened;
+    TEST_ASSERT_TRUE(reopened.begin(archiveIndex, 64));
+    TEST_ASSERT_EQUAL_UINT32(3, reopened.getIndex().size());
+    TEST_ASSERT_EQUAL_UINT32(2, reopened.getSegmentCount());
+    TEST_ASSERT_TRUE(appendText(reopened, 4));
+    assertServes(reopened, 1, 4);
+
+    // Once more, now that the torn segment is no longer the newest one
+    StoreForwardArchive again;
+    TEST_ASSERT_TRUE(again.begin(archiveIndex, 64));
+    TEST_ASSERT_EQUAL_UINT32(2, again.getSegmentCount());
+    assertServes(again, 1, 4);
+}
+
+static void test_begin_ignores_segment_without_header()
+{
+    rmDir("/sf");
+    StoreForwardArchive archive;
+    TEST_ASSERT_TRUE(archive.begin(archiveIndex, 64));
+    TEST_ASSERT_TRUE(appendText(archive, 1));
+
+    // Created, but cut off before its header was complete
+    char name[32];
+    snprintf(name, sizeof(name), "/sf/%08x.sf", 2u);
+    auto f = FSCom.open(name, FILE_O_WRITE);
+    TEST_ASSERT_TRUE(f);
+    f.write(reinterpret_cast<const uint8_t *>("SF"), 2);
+    f.close();
+
+    StoreForwardArchive reopened;
+    TEST_ASSERT_TRUE(reopened.begin(archiveIndex, 64));
+    TEST_ASSERT_EQUAL_UINT32(1, reopened.getIndex().size());
+    TEST_ASSERT_TRUE(appendText(reopened, 2));
+    assertServes(reopened, 1, 2);
+}
+#endif
+
+void setup()
+{
+    initializeTestEnvironment();
+    if (!spiLock)
+        initSPI();
+
+    UNITY_BEGIN();
+    RUN_TEST(test_record_round_trip);
+    RUN_TEST(test_damaged_record_is_rejected);
+    RUN_TEST(test_index_serves_like_history);
+    RUN_TEST(test_index_drops_oldest_when_full);
+    RUN_TEST(test_index_skips_other_destinations);
+#ifdef FSCom
+    RUN_TEST(test_begin_indexes_existing_segments);
+    RUN_TEST(test_begin_recovers_torn_segment);
+    RUN_TEST(test_begin_ignores_segment_without_header);
+    rmDir("/sf");
+#endif
+    exit(UNITY_END());
+}
+
+void loop() {}
@@ -0,0 +1,115 @@
+#include "TestUtil.h"
+#include "modules/StoreForwardHistory.h"
+#include <string.h>
+#include <unity.h>
+#include <vector>
+
+static const NodeNum alice = 0x1111, bob = 0x2222, carol = 0x3333;
+
+static std::vector<uint32_t> memory;
+static StoreForwardHistory history;
+static uint32_t now;
+
+static void useBuffer(size_t bytes)
+{
+    memory.assign(bytes / 4, 0);
+    history.begin(reinterpret_cast<uint8_t *>(memory.data()), bytes);
+}
+
+static void addText(NodeNum from, NodeNum to, const char *text)
+{
+    PacketHistoryStruct packet = {};
+    packet.time = ++now;
+    packet.from = from;
+    packet.to = to;
+    packet.payload_size = strlen(text);
+    TEST_ASSERT_TRUE(history.add(packet, reinterpret_cast<const uint8_t *>(text)));
+}
+
+static void assertNext(NodeNum dest, StoreForwardHistory::Cursor &cursor, const char *expected)
+{
+    const StoreForwardHistory::Record *r = history.next(dest, 0, cursor);
+    TEST_ASSERT_NOT_NULL(r);
+    TEST_ASSERT_EQUAL(strlen(expected), r->packet.payload_size);
+    TEST_ASSERT_EQUAL_MEMORY(expected, r->payload(), r->packet.payload_size);
+}
+
+void setUp(void)
+{
+    now = 1000;
+    useBuffer(4096);
+}
+
+void tearDown(void) {}
+
+static void test_replay_broadcasts_and_own_dms_in_order()
+{
+    addText(alice, NODENUM_BROADCAST, "hello all");
+    addText(alice, bob, "hi bob");
+    addText(bob, NODENUM_BROADCAST, "bob here");
+    addText(alice, carol, "hi carol");
+    addText(carol, NODENUM_BROADCAST, "carol here");
+
+    StoreForwardHistory::Cursor cursor;
+    TEST_ASSERT_EQUAL(3, history.count(bob, 0, cursor));
+    assertNext(bob, cursor, "hello all");
+    assertNext(bob, cursor, "hi bob");
+    assertNext(bob, cursor, "carol here");
+    TEST_ASSERT_NULL(history.next(bob, 0, cursor));
+
+    // New messages after the cursor are found on the next request
+    addText(carol, bob, "later");
+    TEST_ASSERT_EQUAL(1, history.count(bob, 0, cursor));
+    assertNext(bob, cursor, "later");
+}
+
+static void test_time_window_and_limit()
+{
+    for (int i = 0; i < 10; i++)
+        addText(alice, NODENUM_BROADCAST, "x");
+    StoreForwardHistory::Cursor cursor;
+    TEST_ASSERT_EQUAL(3, history.count(bob, now - 3, cursor));
+    TEST_ASSERT_EQUAL(5, history.count(bob, 0, cursor, 5));
+}
+
+static void test_oldest_records_are_overwritten()
+{
+    useBuffer(StoreForwardHistory::recordSize(8) * 4);
+    StoreForwardHistory::Cursor cursor;
+    addText(alice, NODENUM_BROADCAST, "first");
+    assertNext(bob, cursor, "first");
+
+    const char *texts[] = {"msg 1", "msg 2", "msg 3", "msg 4", "msg 5", "msg 6"};
+    for (const char *text : texts)
+        addText(alice, bob, text);
+    TEST_ASSERT_EQUAL(4, history.size());
+    TEST_ASSERT_EQUAL(7, history.getTotalAdded());
+    TEST_ASSERT_LESS_OR_EQUAL(history.getCapacity(), history.getUsedBytes());
+
+    // The cursor pointed at an overwritten record, replay continues with the oldest one left
+    assertNext(bob, cursor, "msg 3");
+    TEST_ASSERT_EQUAL(3, history.count(bob, 0, cursor));
+}
+
+static void test_short_messages_take_less_room()
+{
+    useBuffer(StoreForwardHistory::recordSize(meshtastic_Constants_DATA_PAYLOAD_LEN) * 4);
+    for (int i = 0; i < 12; i++)
+        addText(alice, NODENUM_BROADCAST, "ok");
+    TEST_ASSERT_EQUAL(12, history.size());
+    TEST_ASSERT_GREATER_THAN(12, history.estimateMaxRecords());
+}
+
+void setup()
+{
+    initializeTestEnvironment();
+
+    UNITY_BEGIN();
+    RUN_TEST(test_replay_broadcasts_and_own_dms_in_order);
+    RUN_TEST(test_time_window_and_limit);
+    RUN_TEST(test_oldest_records_are_overwritten);
+    RUN_TEST(test_short_messages_take_less_room);
+    exit(UNITY_END());
+}
+
+void loop() {}